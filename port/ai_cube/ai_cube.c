@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include "ndarray.h"
 #include "postprocess.h"
+#include "seg_render.h"
 
 STATIC mp_obj_t aicube_ocr_post_process(size_t n_args, const mp_obj_t *args) {
 
@@ -322,6 +323,26 @@ STATIC mp_obj_t aicube_gfldet_post_process(size_t n_args, const mp_obj_t *args)
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aicube_gfldet_post_process_obj, 10, 10, aicube_gfldet_post_process);
 
+STATIC mp_obj_t aicube_det_timing(void) {
+    ob_det_timing timing;
+    get_ob_det_timing(&timing);
+
+    mp_obj_t decode[3];
+    for (int i = 0; i < 3; i++) {
+        decode[i] = mp_obj_new_int(timing.decode_us[i]);
+    }
+
+    mp_obj_t dict = mp_obj_new_dict(3);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_decode), mp_obj_new_tuple(3, decode));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_nms), mp_obj_new_int(timing.nms_us));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_candidates), mp_obj_new_int(timing.candidates));
+    return dict;
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(aicube_det_timing_obj, aicube_det_timing);
+
+// seg_post_process(data, num_class, ori_shape, dst_shape, out=None, resize=SEG_RESIZE_BILINEAR, conf=None)
+// out和conf可以是任何可写的buffer，比如ndarray或者image，结果直接写进去，不再额外拷贝
 STATIC mp_obj_t aicube_seg_post_process(size_t n_args, const mp_obj_t *args) {
     ndarray_obj_t *data_mp = MP_ROM_PTR(args[0]);
     float *data = data_mp->array;
@@ -337,25 +358,47 @@ STATIC mp_obj_t aicube_seg_post_process(size_t n_args, const mp_obj_t *args) {
     dst_shape.height = mp_obj_get_int(dst_shape_mp->items[0]);
     dst_shape.width = mp_obj_get_int(dst_shape_mp->items[1]);
 
-    uint8_t *result = seg_post_process(data, num_class, ori_shape, dst_shape);
+    if (num_class < 1 || num_class > SEG_MAX_CLASS || data_mp->len < (size_t)ori_shape.height * ori_shape.width * num_class) {
+        mp_raise_msg(&mp_type_ValueError, "Invalid input");
+    }
 
-    size_t ndarray_shape[4];
-    ndarray_shape[1] = dst_shape.height;
-    ndarray_shape[2] = dst_shape.width;
-    ndarray_shape[3] = 4;
-    ndarray_obj_t *result_obj = ndarray_new_ndarray(3, ndarray_shape, NULL, NDARRAY_UINT8);
+    mp_obj_t result_obj;
+    uint8_t *dst;
+    if (n_args > 4 && args[4] != mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[4], &bufinfo, MP_BUFFER_WRITE);
+        if (bufinfo.len < (size_t)dst_shape.height * dst_shape.width * 4) {
+            mp_raise_msg(&mp_type_ValueError, "Output buffer too small");
+        }
+        dst = bufinfo.buf;
+        result_obj = args[4];
+    } else {
+        size_t ndarray_shape[4];
+        ndarray_shape[1] = dst_shape.height;
+        ndarray_shape[2] = dst_shape.width;
+        ndarray_shape[3] = 4;
+        ndarray_obj_t *ndarray = ndarray_new_ndarray(3, ndarray_shape, NULL, NDARRAY_UINT8);
+        dst = (uint8_t *)ndarray->array;
+        result_obj = MP_OBJ_FROM_PTR(ndarray);
+    }
 
-    uint8_t *result_data = (uint8_t *)result_obj->array;
-    for (int i=0; i<dst_shape.height*dst_shape.width*4; i++)
-    {
-        result_data[i] = result[i];
+    int resize = (n_args > 5) ? mp_obj_get_int(args[5]) : SEG_RESIZE_BILINEAR;
+
+    float *conf = NULL;
+    if (n_args > 6 && args[6] != mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[6], &bufinfo, MP_BUFFER_WRITE);
+        if (bufinfo.len < (size_t)ori_shape.height * ori_shape.width * sizeof(float)) {
+            mp_raise_msg(&mp_type_ValueError, "Confidence buffer too small");
+        }
+        conf = bufinfo.buf;
     }
 
-    free(result);
-    return MP_OBJ_FROM_PTR(result_obj);
+    seg_post_process(data, num_class, ori_shape, dst_shape, dst, resize, conf);
+    return result_obj;
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aicube_seg_post_process_obj, 4, 4, aicube_seg_post_process);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aicube_seg_post_process_obj, 4, 7, aicube_seg_post_process);
 
 STATIC const mp_rom_map_elem_t aicube_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_aicube) },
@@ -364,6 +407,9 @@ STATIC const mp_rom_map_elem_t aicube_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_anchorfreedet_post_process), MP_ROM_PTR(&aicube_anchorfreedet_post_process_obj) },
     { MP_ROM_QSTR(MP_QSTR_gfldet_post_process), MP_ROM_PTR(&aicube_gfldet_post_process_obj) },
     { MP_ROM_QSTR(MP_QSTR_seg_post_process), MP_ROM_PTR(&aicube_seg_post_process_obj) },
+    { MP_ROM_QSTR(MP_QSTR_det_timing), MP_ROM_PTR(&aicube_det_timing_obj) },
+    { MP_ROM_QSTR(MP_QSTR_RESIZE_NEAREST), MP_ROM_INT(SEG_RESIZE_NEAREST) },
+    { MP_ROM_QSTR(MP_QSTR_RESIZE_BILINEAR), MP_ROM_INT(SEG_RESIZE_BILINEAR) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(aicube_globals, aicube_globals_table);
@@ -4,6 +4,7 @@
 #include "postprocess.h"
 #include <opencv2/opencv.hpp>
 #include "clipper.h"
+#include "profiler.h"
 
 
 typedef struct ocr_det_res
@@ -212,6 +213,7 @@ void warppersp(cv::Mat src, cv::Mat& dst, ocr_det_res b, std::vector<cv::Point2f
 
 ArrayWrapper* ocr_post_process(FrameSize frame_size,FrameSize kmodel_frame_size,float box_thresh,float threshold, float *data_0, uint8_t *data_1, int* results_size)
 {   
+    PROF_SCOPE("aicube.ocr_post_process");
     int input_width=kmodel_frame_size.width;
     int input_height=kmodel_frame_size.height;
     int h;
@@ -0,0 +1,156 @@
+#include "nms.h"
+#include <algorithm>
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+
+NmsConfig nms_default_config(float iou_thresh)
+{
+    NmsConfig cfg;
+    cfg.iou_thresh = iou_thresh;
+    cfg.score_thresh = -FLT_MAX;
+    cfg.top_k = 0;
+    cfg.max_det = 0;
+    cfg.batched = false;
+    cfg.pixel_inclusive = false;
+    cfg.soft = NMS_SOFT_NONE;
+    cfg.sigma = 0.5f;
+    return cfg;
+}
+
+// 按得分排序后的候选框，坐标和面积连续存放，内层循环只顺序访问
+typedef struct NmsSorted
+{
+    std::vector<int> index;
+    std::vector<float> x1, y1, x2, y2, area;
+    std::vector<int> label;
+} NmsSorted;
+
+static inline float nms_iou(const NmsSorted& s, int i, int j, float pad)
+{
+    float w = std::min(s.x2[i], s.x2[j]) - std::max(s.x1[i], s.x1[j]) + pad;
+    float h = std::min(s.y2[i], s.y2[j]) - std::max(s.y1[i], s.y1[j]) + pad;
+    if (w <= 0 || h <= 0)
+        return 0;
+    float inter = w * h;
+    return inter / (s.area[i] + s.area[j] - inter);
+}
+
+static void nms_hard(const NmsSorted& s, const NmsConfig& cfg, float pad, std::vector<int>& keep)
+{
+    int n = s.index.size();
+    std::vector<uint32_t> suppressed((n + 31) / 32, 0);
+
+    for (int i = 0; i < n; i++)
+    {
+        if (suppressed[i >> 5] & (1u << (i & 31)))
+            continue;
+        keep.push_back(s.index[i]);
+        if (cfg.max_det > 0 && int(keep.size()) >= cfg.max_det)
+            break;
+
+        for (int j = i + 1; j < n; j++)
+        {
+            if (suppressed[j >> 5] & (1u << (j & 31)))
+                continue;
+            if (cfg.batched && s.label[j] != s.label[i])
+                continue;
+            if (nms_iou(s, i, j, pad) >= cfg.iou_thresh)
+                suppressed[j >> 5] |= 1u << (j & 31);
+        }
+    }
+}
+
+static void nms_soft(const NmsSorted& s, std::vector<float>& scores, const NmsConfig& cfg, float pad, std::vector<int>& keep)
+{
+    int n = s.index.size();
+    std::vector<float> score(n);
+    std::vector<uint8_t> alive(n, 1);
+    for (int i = 0; i < n; i++)
+        score[i] = scores[s.index[i]];
+
+    for (;;)
+    {
+        // 衰减会打乱顺序，每轮重新选出当前得分最高的框
+        int best = -1;
+        for (int i = 0; i < n; i++)
+        {
+            if (alive[i] && (best < 0 || score[i] > score[best]))
+                best = i;
+        }
+        if (best < 0)
+            break;
+
+        alive[best] = 0;
+        scores[s.index[best]] = score[best];
+        keep.push_back(s.index[best]);
+        if (cfg.max_det > 0 && int(keep.size()) >= cfg.max_det)
+            break;
+
+        for (int j = 0; j < n; j++)
+        {
+            if (!alive[j])
+                continue;
+            if (cfg.batched && s.label[j] != s.label[best])
+                continue;
+            float iou = nms_iou(s, best, j, pad);
+            if (cfg.soft == NMS_SOFT_GAUSSIAN)
+                score[j] *= expf(-(iou * iou) / cfg.sigma);
+            else if (iou >= cfg.iou_thresh)
+                score[j] *= 1.f - iou;
+            if (score[j] < cfg.score_thresh)
+                alive[j] = 0;
+        }
+    }
+}
+
+void nms_select(const std::vector<NmsBox>& boxes, std::vector<float>& scores, const int* labels, const NmsConfig& cfg, std::vector<int>& keep)
+{
+    keep.clear();
+
+    NmsSorted s;
+    s.index.reserve(boxes.size());
+    for (int i = 0; i < int(boxes.size()); i++)
+    {
+        if (scores[i] >= cfg.score_thresh)
+            s.index.push_back(i);
+    }
+
+    // 按索引排序，得分相同时索引小的在前，结果与排序算法无关
+    auto cmp = [&scores](int a, int b) { return scores[a] > scores[b] || (scores[a] == scores[b] && a < b); };
+    if (cfg.top_k > 0 && int(s.index.size()) > cfg.top_k)
+    {
+        std::partial_sort(s.index.begin(), s.index.begin() + cfg.top_k, s.index.end(), cmp);
+        s.index.resize(cfg.top_k);
+    }
+    else
+    {
+        std::sort(s.index.begin(), s.index.end(), cmp);
+    }
+
+    int n = s.index.size();
+    float pad = cfg.pixel_inclusive ? 1.f : 0.f;
+    s.x1.resize(n);
+    s.y1.resize(n);
+    s.x2.resize(n);
+    s.y2.resize(n);
+    s.area.resize(n);
+    s.label.resize(n, 0);
+    for (int i = 0; i < n; i++)
+    {
+        const NmsBox& b = boxes[s.index[i]];
+        s.x1[i] = b.x1;
+        s.y1[i] = b.y1;
+        s.x2[i] = b.x2;
+        s.y2[i] = b.y2;
+        s.area[i] = (b.x2 - b.x1 + pad) * (b.y2 - b.y1 + pad);
+        if (cfg.batched && labels)
+            s.label[i] = labels[s.index[i]];
+    }
+
+    keep.reserve(cfg.max_det > 0 ? std::min(n, cfg.max_det) : n);
+    if (cfg.soft == NMS_SOFT_NONE)
+        nms_hard(s, cfg, pad, keep);
+    else
+        nms_soft(s, scores, cfg, pad, keep);
+}
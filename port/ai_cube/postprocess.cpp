@@ -1,4 +1,6 @@
 #include "postprocess.h"
+#include "nms.h"
+#include "seg_render.h"
 #include <opencv2/imgproc.hpp>
 #include <vector>
 #include <string>
@@ -8,164 +10,133 @@
 #include <stdlib.h>
 #include <iostream>
 #include <stdint.h>
+#include <float.h>
+#include <time.h>
+#if defined(__riscv_vector) && defined(__riscv_v_intrinsic) && (__riscv_v_intrinsic >= 12000)
+#include <riscv_vector.h>
+#endif
 
 // #include <opencv/cv.hpp>
 #include <opencv2/core/core.hpp>
 #include <opencv2/highgui/highgui.hpp>
+#include "profiler.h"
 
 using namespace std;
 
 #define REG_MAX 16
 #define STRIDE_NUM 3
 #define STAGE_NUM 3
+#define DET_RESERVE 256
 
-vector<ob_det_res> anchorbasedet_decode_infer(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh, float anchors[3][2])
+// 每个网格点类别得分的最大值，大多数网格点在这里就被过滤掉
+static inline float class_max(const float* p, int n)
 {
-    float ratiow = (float)kmodel_frame_size.width / frame_size.width;
-    float ratioh = (float)kmodel_frame_size.height / frame_size.height;
-    float gain = ratiow < ratioh ? ratiow : ratioh;
-    std::vector<ob_det_res> result;
-    int grid_size_w = kmodel_frame_size.width / stride;
-    int grid_size_h = kmodel_frame_size.height / stride;
-    int one_rsize = num_class + 5;
-    float cx, cy, w, h;
-
-    for (int shift_y = 0; shift_y < grid_size_h; shift_y++)
+#if defined(__riscv_vector) && defined(__riscv_v_intrinsic) && (__riscv_v_intrinsic >= 12000)
+    size_t vlmax = __riscv_vsetvlmax_e32m8();
+    vfloat32m8_t vmax = __riscv_vfmv_v_f_f32m8(-FLT_MAX, vlmax);
+    for (size_t i = 0, vl; i < (size_t)n; i += vl)
     {
-        for (int shift_x = 0; shift_x < grid_size_w; shift_x++)
-        {
-            int loc = shift_x + shift_y * grid_size_w;
-            for (int i = 0; i < 3; i++)
-            {
-                float* record = data + (loc * 3 + i) * one_rsize;
-                float* cls_ptr = record + 5;
-                for (int cls = 0; cls < num_class; cls++)
-                {
-                    float score = (cls_ptr[cls]) * (record[4]);
-                    if (score > ob_det_thresh)
-                    {
-                        cx = ((record[0]) * 2.f - 0.5f + (float)shift_x) * (float)stride;
-                        cy = ((record[1]) * 2.f - 0.5f + (float)shift_y) * (float)stride;
-                        w = pow((record[2]) * 2.f, 2) * anchors[i][0];
-                        h = pow((record[3]) * 2.f, 2) * anchors[i][1];
-                        cx -= ((kmodel_frame_size.width - frame_size.width * gain) / 2);
-                        cy -= ((kmodel_frame_size.height - frame_size.height * gain) / 2);
-                        cx /= gain;
-                        cy /= gain;
-                        w /= gain;
-                        h /= gain;
-                        ob_det_res box;
-                        box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
-                        box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
-                        box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
-                        box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
-                        box.score = score;
-                        box.label_index = cls;
-                        result.push_back(box);
-                    }
-                }
-            }
-        }
+        vl = __riscv_vsetvl_e32m8(n - i);
+        vfloat32m8_t v = __riscv_vle32_v_f32m8(p + i, vl);
+        vmax = __riscv_vfmax_vv_f32m8_tu(vmax, vmax, v, vl);
     }
-    return result;
+    vfloat32m1_t red = __riscv_vfredmax_vs_f32m8_f32m1(vmax, __riscv_vfmv_s_f_f32m1(-FLT_MAX, 1), vlmax);
+    return __riscv_vfmv_f_s_f32m1_f32(red);
+#else
+    float m0 = -FLT_MAX, m1 = -FLT_MAX, m2 = -FLT_MAX, m3 = -FLT_MAX;
+    int i = 0;
+    for (; i + 4 <= n; i += 4)
+    {
+        m0 = p[i + 0] > m0 ? p[i + 0] : m0;
+        m1 = p[i + 1] > m1 ? p[i + 1] : m1;
+        m2 = p[i + 2] > m2 ? p[i + 2] : m2;
+        m3 = p[i + 3] > m3 ? p[i + 3] : m3;
+    }
+    for (; i < n; i++)
+        m0 = p[i] > m0 ? p[i] : m0;
+    m0 = m1 > m0 ? m1 : m0;
+    m2 = m3 > m2 ? m3 : m2;
+    return m2 > m0 ? m2 : m0;
+#endif
 }
 
-vector<vector<ob_det_res>> anchorbasedet_decode_infer_class(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh, float anchors[3][2])
+// 第一个等于最大值的类别
+static inline int class_argmax(const float* p, int n, float max_value)
 {
-    float ratiow = (float)kmodel_frame_size.width / frame_size.width;
-    float ratioh = (float)kmodel_frame_size.height / frame_size.height;
-    float gain = ratiow < ratioh ? ratiow : ratioh;
-    std::vector<std::vector<ob_det_res>> result;
-    for (int i = 0; i < num_class; i++)
+    for (int i = 0; i < n; i++)
     {
-        result.push_back(vector<ob_det_res>());
+        if (p[i] == max_value)
+            return i;
     }
-    int grid_size_w = kmodel_frame_size.width / stride;
-    int grid_size_h = kmodel_frame_size.height / stride;
-    int one_rsize = num_class + 5;
-    float cx, cy, w, h;
-    for (int shift_y = 0; shift_y < grid_size_h; shift_y++)
-    {
-        for (int shift_x = 0; shift_x < grid_size_w; shift_x++)
-        {
-            int loc = shift_x + shift_y * grid_size_w;
-            for (int i = 0; i < 3; i++)
-            {
-                float* record = data + (loc * 3 + i) * one_rsize;
-                float* cls_ptr = record + 5;
-                for (int cls = 0; cls < num_class; cls++)
-                {
-                    float score = (cls_ptr[cls]) * (record[4]);
-                    if (score > ob_det_thresh)
-                    {
-                        cx = ((record[0]) * 2.f - 0.5f + (float)shift_x) * (float)stride;
-                        cy = ((record[1]) * 2.f - 0.5f + (float)shift_y) * (float)stride;
-                        w = pow((record[2]) * 2.f, 2) * anchors[i][0];
-                        h = pow((record[3]) * 2.f, 2) * anchors[i][1];
-                        cx -= ((kmodel_frame_size.width - frame_size.width * gain) / 2);
-                        cy -= ((kmodel_frame_size.height - frame_size.height * gain) / 2);
-                        cx /= gain;
-                        cy /= gain;
-                        w /= gain;
-                        h /= gain;
-                        ob_det_res box;
-                        box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
-                        box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
-                        box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
-                        box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
-                        box.score = score;
-                        box.label_index = cls;
-                        result[cls].push_back(box);
-                    }
-                }
-            }
-        }
-    }
-    return result;
+    return 0;
 }
 
+static inline uint64_t time_us()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static ob_det_timing det_timing;
 
-vector<ob_det_res> anchorfreedet_decode_infer(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh)
+void get_ob_det_timing(ob_det_timing* timing)
+{
+    *timing = det_timing;
+}
+
+// 模型输出已经过sigmoid。类别概率不超过1，score = cls * obj <= obj，
+// 所以obj不超过阈值的网格点直接跳过，最大类别概率不够的网格点也不再逐类别计算
+void anchorbasedet_decode_infer(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh, float anchors[3][2], vector<ob_det_res>& result)
 {
     float ratiow = (float)kmodel_frame_size.width / frame_size.width;
     float ratioh = (float)kmodel_frame_size.height / frame_size.height;
     float gain = ratiow < ratioh ? ratiow : ratioh;
-    std::vector<ob_det_res> result;
+    float pad_w = (kmodel_frame_size.width - frame_size.width * gain) / 2;
+    float pad_h = (kmodel_frame_size.height - frame_size.height * gain) / 2;
     int grid_size_w = kmodel_frame_size.width / stride;
     int grid_size_h = kmodel_frame_size.height / stride;
     int one_rsize = num_class + 5;
     float cx, cy, w, h;
+
     for (int shift_y = 0; shift_y < grid_size_h; shift_y++)
     {
         for (int shift_x = 0; shift_x < grid_size_w; shift_x++)
         {
-
             int loc = shift_x + shift_y * grid_size_w;
-            for (int i = 0; i < 1; i++)
+            for (int i = 0; i < 3; i++)
             {
-                float* record = data + (loc + i) * one_rsize;
+                float* record = data + (loc * 3 + i) * one_rsize;
                 float* cls_ptr = record + 5;
+                float obj = record[4];
+                if (obj <= ob_det_thresh)
+                    continue;
+                if (class_max(cls_ptr, num_class) * obj <= ob_det_thresh)
+                    continue;
+
+                double bw = record[2] * 2.f;
+                double bh = record[3] * 2.f;
+                cx = ((record[0]) * 2.f - 0.5f + (float)shift_x) * (float)stride;
+                cy = ((record[1]) * 2.f - 0.5f + (float)shift_y) * (float)stride;
+                w = bw * bw * anchors[i][0];
+                h = bh * bh * anchors[i][1];
+                cx -= pad_w;
+                cy -= pad_h;
+                cx /= gain;
+                cy /= gain;
+                w /= gain;
+                h /= gain;
+                ob_det_res box;
+                box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
+                box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
+                box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
+                box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
+
                 for (int cls = 0; cls < num_class; cls++)
                 {
-                    // float score = sigmoid(record[4]);
-                    float score = record[4];
+                    float score = (cls_ptr[cls]) * obj;
                     if (score > ob_det_thresh)
                     {
-                        cx = ((record[0]) + (float)shift_x) * (float)stride;
-                        cy = ((record[1]) + (float)shift_y) * (float)stride;
-                        w = exp((record[2])) * (float)stride;
-                        h = exp((record[3])) * (float)stride;
-                        cx -= ((kmodel_frame_size.width - frame_size.width * gain) / 2);
-                        cy -= ((kmodel_frame_size.height - frame_size.height * gain) / 2);
-                        cx /= gain;
-                        cy /= gain;
-                        w /= gain;
-                        h /= gain;
-                        ob_det_res box;
-                        box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
-                        box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
-                        box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
-                        box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
                         box.score = score;
                         box.label_index = cls;
                         result.push_back(box);
@@ -174,97 +145,78 @@ vector<ob_det_res> anchorfreedet_decode_infer(float* data, FrameSize kmodel_fram
             }
         }
     }
-    return result;
 }
 
-vector<vector<ob_det_res>> anchorfreedet_decode_infer_class(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh)
+// 得分为objectness，类别取概率最大的一类
+void anchorfreedet_decode_infer(float* data, FrameSize kmodel_frame_size, FrameSize frame_size, int stride, int num_class, float ob_det_thresh, vector<ob_det_res>& result)
 {
     float ratiow = (float)kmodel_frame_size.width / frame_size.width;
     float ratioh = (float)kmodel_frame_size.height / frame_size.height;
     float gain = ratiow < ratioh ? ratiow : ratioh;
-    std::vector<std::vector<ob_det_res>> result;
-    for (int i = 0; i < num_class; i++)
-    {
-        result.push_back(vector<ob_det_res>());//不断往v2d里加行 
-    }
+    float pad_w = (kmodel_frame_size.width - frame_size.width * gain) / 2;
+    float pad_h = (kmodel_frame_size.height - frame_size.height * gain) / 2;
     int grid_size_w = kmodel_frame_size.width / stride;
     int grid_size_h = kmodel_frame_size.height / stride;
     int one_rsize = num_class + 5;
     float cx, cy, w, h;
+
     for (int shift_y = 0; shift_y < grid_size_h; shift_y++)
     {
         for (int shift_x = 0; shift_x < grid_size_w; shift_x++)
         {
-
             int loc = shift_x + shift_y * grid_size_w;
-            for (int i = 0; i < 1; i++)
-            {
-                float* record = data + (loc + i) * one_rsize;
-                float* cls_ptr = record + 5;
-                for (int cls = 0; cls < num_class; cls++)
-                {
-                    // float score = sigmoid(record[4]);
-                    float score = record[4];
-                    if (score > ob_det_thresh)
-                    {
-                        cx = ((record[0]) + (float)shift_x) * (float)stride;
-                        cy = ((record[1]) + (float)shift_y) * (float)stride;
-                        w = exp((record[2])) * (float)stride;
-                        h = exp((record[3])) * (float)stride;
-                        cx -= ((kmodel_frame_size.width - frame_size.width * gain) / 2);
-                        cy -= ((kmodel_frame_size.height - frame_size.height * gain) / 2);
-                        cx /= gain;
-                        cy /= gain;
-                        w /= gain;
-                        h /= gain;
-                        ob_det_res box;
-                        box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
-                        box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
-                        box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
-                        box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
-                        box.score = score;
-                        box.label_index = cls;
-                        result[cls].push_back(box);
-                    }
-                }
-            }
+            float* record = data + loc * one_rsize;
+            float* cls_ptr = record + 5;
+            float score = record[4];
+            if (score <= ob_det_thresh)
+                continue;
+
+            cx = ((record[0]) + (float)shift_x) * (float)stride;
+            cy = ((record[1]) + (float)shift_y) * (float)stride;
+            w = exp((record[2])) * (float)stride;
+            h = exp((record[3])) * (float)stride;
+            cx -= pad_w;
+            cy -= pad_h;
+            cx /= gain;
+            cy /= gain;
+            w /= gain;
+            h /= gain;
+            ob_det_res box;
+            box.x1 = std::max(0, std::min(int(frame_size.width), int(cx - w / 2.f)));
+            box.y1 = std::max(0, std::min(int(frame_size.height), int(cy - h / 2.f)));
+            box.x2 = std::max(0, std::min(int(frame_size.width), int(cx + w / 2.f)));
+            box.y2 = std::max(0, std::min(int(frame_size.height), int(cy + h / 2.f)));
+            box.score = score;
+            box.label_index = class_argmax(cls_ptr, num_class, class_max(cls_ptr, num_class));
+            result.push_back(box);
         }
     }
-    return result;
 }
 
-void nms(vector<ob_det_res>& input_boxes, float ob_nms_thresh)
+void nms(vector<ob_det_res>& input_boxes, float ob_nms_thresh, bool batched)
 {
-    std::sort(input_boxes.begin(), input_boxes.end(), [](ob_det_res a, ob_det_res b) { return a.score > b.score; });
-    std::vector<float> vArea(input_boxes.size());
-    for (int i = 0; i < int(input_boxes.size()); ++i)
+    int n = input_boxes.size();
+    vector<NmsBox> boxes(n);
+    vector<float> scores(n);
+    vector<int> labels(n);
+    for (int i = 0; i < n; ++i)
     {
-        vArea[i] = (input_boxes.at(i).x2 - input_boxes.at(i).x1 + 1)
-            * (input_boxes.at(i).y2 - input_boxes.at(i).y1 + 1);
-    }
-    for (int i = 0; i < int(input_boxes.size()); ++i)
-    {
-        for (int j = i + 1; j < int(input_boxes.size());)
-        {
-            float xx1 = std::max(input_boxes[i].x1, input_boxes[j].x1);
-            float yy1 = std::max(input_boxes[i].y1, input_boxes[j].y1);
-            float xx2 = std::min(input_boxes[i].x2, input_boxes[j].x2);
-            float yy2 = std::min(input_boxes[i].y2, input_boxes[j].y2);
-            float w = std::max(float(0), xx2 - xx1 + 1);
-            float h = std::max(float(0), yy2 - yy1 + 1);
-            float inter = w * h;
-            float ovr = inter / (vArea[i] + vArea[j] - inter);
-            if (ovr >= ob_nms_thresh)
-            {
-                input_boxes.erase(input_boxes.begin() + j);
-                vArea.erase(vArea.begin() + j);
-            }
-            else
-            {
-                j++;
-            }
-        }
+        boxes[i] = { input_boxes[i].x1, input_boxes[i].y1, input_boxes[i].x2, input_boxes[i].y2 };
+        scores[i] = input_boxes[i].score;
+        labels[i] = input_boxes[i].label_index;
     }
+
+    NmsConfig cfg = nms_default_config(ob_nms_thresh);
+    cfg.batched = batched;
+    cfg.pixel_inclusive = true;
+    vector<int> keep;
+    nms_select(boxes, scores, labels.data(), cfg, keep);
+
+    vector<ob_det_res> kept;
+    kept.reserve(keep.size());
+    for (int i : keep)
+        kept.push_back(input_boxes[i]);
+    input_boxes.swap(kept);
 }
 
 float fast_exp(float x)
@@ -314,19 +266,17 @@ ob_det_res disPred2Bbox(const float*& dfl_det, int label, float score, int x, in
     ct_x /= gain;
     ct_y /= gain;
 
-    std::vector<float> dis_pred;
-    dis_pred.resize(4);
+    float dis_pred[4];
+    float dis_after_sm[REG_MAX + 1];
     for (int i = 0; i < 4; i++)
     {
         float dis = 0;
-        float* dis_after_sm = new float[reg_max + 1];
         activation_function_softmax(dfl_det + i * (reg_max + 1), dis_after_sm, reg_max + 1);
         for (int j = 0; j < reg_max + 1; j++)
             dis += j * dis_after_sm[j];
         
         dis *= stride;
         dis_pred[i] = dis;
-        delete[] dis_after_sm;
     }
     float xmin = (std::max)(ct_x - dis_pred[0] /gain, .0f);
     float ymin = (std::max)(ct_y - dis_pred[1] /gain, .0f);
@@ -337,6 +287,8 @@ ob_det_res disPred2Bbox(const float*& dfl_det, int label, float score, int x, in
 }
 
 
+// 类别输出为logit，sigmoid单调，所以直接在logit上取最大值并和反算的阈值比较，
+// 只对通过的网格点计算sigmoid。fast_exp有误差，logit阈值留一点余量，最终以sigmoid后的得分为准
 void gfldet_decode_infer(float* pred, std::vector<CenterPrior>& center_priors,  std::vector<ob_det_res>& results, FrameSize frame_size, FrameSize kmodel_frame_size, int num_class, float ob_det_thresh)
 {
     int reg_max = REG_MAX;
@@ -345,73 +297,36 @@ void gfldet_decode_infer(float* pred, std::vector<CenterPrior>& center_priors,
     float gain = ratiow < ratioh ? ratiow : ratioh;
     const int num_points = center_priors.size();
     const int num_channels = num_class + (reg_max + 1) * 4;
-    for (int idx = 0; idx < num_points; idx++)
-    {
-        int ct_x = center_priors[idx].x;
-        int ct_y = center_priors[idx].y;
-        int stride = center_priors[idx].stride;
-        float score = 0;
-        int cur_label = 0;
-
-        for (int label = 0; label < num_class; label++)
-        {
-            
-            float sig_score = sigmoid(pred[idx * num_channels + label]);
-            if (sig_score > score)
-            {
-                score = sig_score;
-                cur_label = label;
-            }
-        }
-
-        if (score > ob_det_thresh)
-        {
-            const float* bbox_pred = pred + idx * num_channels + num_class;
-            results.push_back(disPred2Bbox(bbox_pred, cur_label, score, ct_x, ct_y, stride, reg_max, kmodel_frame_size.height, kmodel_frame_size.width, ratiow, ratioh, gain, frame_size, kmodel_frame_size));
-        }
-    }
-}
+    float logit_thresh = -FLT_MAX;
+    if (ob_det_thresh >= 1.f)
+        return;
+    if (ob_det_thresh > 0.f)
+        logit_thresh = logf(ob_det_thresh / (1.f - ob_det_thresh)) - 0.1f;
 
-void gfldet_decode_infer_class(float* pred, std::vector<CenterPrior>& center_priors,  std::vector<std::vector<ob_det_res>>& results, FrameSize frame_size, FrameSize kmodel_frame_size, int num_class, float ob_det_thresh)
-{
-    int reg_max = REG_MAX;
-    float ratiow = (float)kmodel_frame_size.width / frame_size.width;
-    float ratioh = (float)kmodel_frame_size.height / frame_size.height;
-    float gain = ratiow < ratioh ? ratiow : ratioh;
-    const int num_points = center_priors.size();
-    const int num_channels = num_class + (reg_max + 1) * 4;
     for (int idx = 0; idx < num_points; idx++)
     {
-        int ct_x = center_priors[idx].x;
-        int ct_y = center_priors[idx].y;
-        int stride = center_priors[idx].stride;
-        float score = 0;
-        int cur_label = 0;
-
-        for (int label = 0; label < num_class; label++)
-        {
-            
-            float sig_score = sigmoid(pred[idx * num_channels + label]);
-            if (sig_score > score)
-            {
-                score = sig_score;
-                cur_label = label;
-            }
-        }
+        const float* cls_pred = pred + idx * num_channels;
+        float max_logit = class_max(cls_pred, num_class);
+        if (max_logit <= logit_thresh)
+            continue;
 
+        float score = sigmoid(max_logit);
         if (score > ob_det_thresh)
         {
-            const float* bbox_pred = pred + idx * num_channels + num_class;
-            ob_det_res tmp_res = disPred2Bbox(bbox_pred, cur_label, score, ct_x, ct_y, stride, reg_max, kmodel_frame_size.height, kmodel_frame_size.width, ratiow, ratioh, gain, frame_size, kmodel_frame_size);
-            results[tmp_res.label_index].push_back(tmp_res);
+            int ct_x = center_priors[idx].x;
+            int ct_y = center_priors[idx].y;
+            int stride = center_priors[idx].stride;
+            int cur_label = class_argmax(cls_pred, num_class, max_logit);
+            const float* bbox_pred = cls_pred + num_class;
+            results.push_back(disPred2Bbox(bbox_pred, cur_label, score, ct_x, ct_y, stride, reg_max, kmodel_frame_size.height, kmodel_frame_size.width, ratiow, ratioh, gain, frame_size, kmodel_frame_size));
         }
     }
 }
 
 
-
 ob_det_res* anchorbasedet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, float* anchors, bool nms_option, int* results_size)
 {
+    PROF_SCOPE("aicube.anchorbasedet_post_process");
     float *output_0 = data0;
     float *output_1 = data1;
     float *output_2 = data2;
@@ -447,36 +362,23 @@ ob_det_res* anchorbasedet_post_process(float* data0, float* data1, float* data2,
     }
 
 
+    // nms_option为true时所有类别一起做NMS，否则每个类别单独做NMS
     vector<ob_det_res> results;
-    if (nms_option)
-    {
-        vector<ob_det_res> box0, box1, box2;
-        box0 = anchorbasedet_decode_infer(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh, anchors_0);
-        box1 = anchorbasedet_decode_infer(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh, anchors_1);
-        box2 = anchorbasedet_decode_infer(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh, anchors_2);
-
-        results.insert(results.begin(), box0.begin(), box0.end());
-        results.insert(results.begin(), box1.begin(), box1.end());
-        results.insert(results.begin(), box2.begin(), box2.end());
-        
-        nms(results, ob_nms_thresh);
-    }
-    else
-    {
-        vector<vector<ob_det_res>> box0, box1, box2;
-
-        box0 = anchorbasedet_decode_infer_class(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh, anchors_0);
-        box1 = anchorbasedet_decode_infer_class(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh, anchors_1);
-        box2 = anchorbasedet_decode_infer_class(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh, anchors_2);
-
-        for(int i = 0; i < num_class; i++)
-        {
-            box0[i].insert(box0[i].begin(), box1[i].begin(), box1[i].end());
-            box0[i].insert(box0[i].begin(), box2[i].begin(), box2[i].end());
-            nms(box0[i], ob_nms_thresh);
-            results.insert(results.begin(), box0[i].begin(), box0[i].end());
-        }
-    }
+    results.reserve(DET_RESERVE);
+    uint64_t t0 = time_us();
+    anchorbasedet_decode_infer(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh, anchors_0, results);
+    uint64_t t1 = time_us();
+    anchorbasedet_decode_infer(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh, anchors_1, results);
+    uint64_t t2 = time_us();
+    anchorbasedet_decode_infer(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh, anchors_2, results);
+    uint64_t t3 = time_us();
+    det_timing.candidates = results.size();
+
+    nms(results, ob_nms_thresh, !nms_option);
+    det_timing.decode_us[0] = t1 - t0;
+    det_timing.decode_us[1] = t2 - t1;
+    det_timing.decode_us[2] = t3 - t2;
+    det_timing.nms_us = time_us() - t3;
 
     *results_size = results.size();
     ob_det_res* results_ob = (ob_det_res *)malloc(*results_size * sizeof(ob_det_res));
@@ -489,42 +391,29 @@ ob_det_res* anchorbasedet_post_process(float* data0, float* data1, float* data2,
 
 ob_det_res* anchorfreedet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, bool nms_option, int* results_size)
 {
+    PROF_SCOPE("aicube.anchorfreedet_post_process");
     float *output_0 = data0;
     float *output_1 = data1;
     float *output_2 = data2;
 
 
+    // nms_option为true时所有类别一起做NMS，否则每个类别单独做NMS
     vector<ob_det_res> results;
-    if (nms_option)
-    {
-        vector<ob_det_res> box0, box1, box2;
-
-        box0 = anchorfreedet_decode_infer(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh);
-        box1 = anchorfreedet_decode_infer(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh);
-        box2 = anchorfreedet_decode_infer(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh);
-
-        results.insert(results.begin(), box0.begin(), box0.end());
-        results.insert(results.begin(), box1.begin(), box1.end());
-        results.insert(results.begin(), box2.begin(), box2.end());
-        
-        nms(results, ob_nms_thresh);
-    }
-    else
-    {
-        vector<vector<ob_det_res>> box0, box1, box2;
-
-        box0 = anchorfreedet_decode_infer_class(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh);
-        box1 = anchorfreedet_decode_infer_class(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh);
-        box2 = anchorfreedet_decode_infer_class(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh);
-
-        for(int i = 0; i < num_class; i++)
-        {
-            box0[i].insert(box0[i].begin(), box1[i].begin(), box1[i].end());
-            box0[i].insert(box0[i].begin(), box2[i].begin(), box2[i].end());
-            nms(box0[i], ob_nms_thresh);
-            results.insert(results.begin(), box0[i].begin(), box0[i].end());
-        }
-    }
+    results.reserve(DET_RESERVE);
+    uint64_t t0 = time_us();
+    anchorfreedet_decode_infer(output_0, kmodel_frame_size, frame_size, strides[0], num_class, ob_det_thresh, results);
+    uint64_t t1 = time_us();
+    anchorfreedet_decode_infer(output_1, kmodel_frame_size, frame_size, strides[1], num_class, ob_det_thresh, results);
+    uint64_t t2 = time_us();
+    anchorfreedet_decode_infer(output_2, kmodel_frame_size, frame_size, strides[2], num_class, ob_det_thresh, results);
+    uint64_t t3 = time_us();
+    det_timing.candidates = results.size();
+
+    nms(results, ob_nms_thresh, !nms_option);
+    det_timing.decode_us[0] = t1 - t0;
+    det_timing.decode_us[1] = t2 - t1;
+    det_timing.decode_us[2] = t3 - t2;
+    det_timing.nms_us = time_us() - t3;
 
     *results_size = results.size();
     ob_det_res* results_ob = (ob_det_res *)malloc(*results_size * sizeof(ob_det_res));
@@ -537,6 +426,7 @@ ob_det_res* anchorfreedet_post_process(float* data0, float* data1, float* data2,
 
 ob_det_res* gfldet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, bool nms_option, int* results_size)
 {
+    PROF_SCOPE("aicube.gfldet_post_process");
     float *output_0 = data0;
     float *output_1 = data1;
     float *output_2 = data2;
@@ -559,43 +449,24 @@ ob_det_res* gfldet_post_process(float* data0, float* data1, float* data2, FrameS
         
     }
 
+    // nms_option为true时所有类别一起做NMS，否则每个类别单独做NMS
     vector<ob_det_res> results;
-    if(nms_option)
-    {
-        vector<ob_det_res> b0, b1, b2;
-
-        gfldet_decode_infer(output_0, center_priors[0], b0, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
-        gfldet_decode_infer(output_1, center_priors[1], b1, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
-        gfldet_decode_infer(output_2, center_priors[2], b2, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
+    results.reserve(DET_RESERVE);
+    uint64_t t0 = time_us();
+    gfldet_decode_infer(output_0, center_priors[0], results, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
+    uint64_t t1 = time_us();
+    gfldet_decode_infer(output_1, center_priors[1], results, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
+    uint64_t t2 = time_us();
+    gfldet_decode_infer(output_2, center_priors[2], results, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
+    uint64_t t3 = time_us();
+    det_timing.candidates = results.size();
+
+    nms(results, ob_nms_thresh, !nms_option);
+    det_timing.decode_us[0] = t1 - t0;
+    det_timing.decode_us[1] = t2 - t1;
+    det_timing.decode_us[2] = t3 - t2;
+    det_timing.nms_us = time_us() - t3;
 
-        results.insert(results.begin(), b0.begin(), b0.end());
-        results.insert(results.begin(), b1.begin(), b1.end());
-        results.insert(results.begin(), b2.begin(), b2.end());
-
-        nms(results, ob_nms_thresh);
-    }
-    else
-    {
-        vector<vector<ob_det_res>> b0, b1, b2;
-        for (int i = 0; i < num_class; i++)
-        {
-            b0.push_back(vector<ob_det_res>());//不断往v2d里加行 
-            b1.push_back(vector<ob_det_res>());//不断往v2d里加行 
-            b2.push_back(vector<ob_det_res>());//不断往v2d里加行 
-        }
-
-        gfldet_decode_infer_class(output_0, center_priors[0], b0, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
-        gfldet_decode_infer_class(output_1, center_priors[1], b1, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
-        gfldet_decode_infer_class(output_2, center_priors[2], b2, frame_size, kmodel_frame_size, num_class, ob_det_thresh);
-
-        for(int i = 0; i < num_class; i++)
-        {
-            b0[i].insert(b0[i].begin(), b1[i].begin(), b1[i].end());
-            b0[i].insert(b0[i].begin(), b2[i].begin(), b2[i].end());
-            nms(b0[i], ob_nms_thresh);
-            results.insert(results.begin(), b0[i].begin(), b0[i].end());
-        }
-    }
     *results_size = results.size();
     ob_det_res* results_ob = (ob_det_res *)malloc(*results_size * sizeof(ob_det_res));
     for (int i = 0; i < *results_size; i++) {
@@ -604,46 +475,18 @@ ob_det_res* gfldet_post_process(float* data0, float* data1, float* data2, FrameS
     return results_ob;
 }
 
-uint8_t* seg_post_process(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape)
+void seg_post_process(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape, uint8_t* dst, int resize, float* conf)
 {
-    float* output = data;
-    cv::Mat images_pred_color = cv::Mat::zeros(ori_shape.height, ori_shape.width, CV_8UC4);
-
-    vector<float> scores(num_class);
-    for (int y = 0; y < ori_shape.height; ++y)
+    PROF_SCOPE("aicube.seg_post_process");
+    // 类别0为背景，其余类别的颜色按类别序号生成
+    uint8_t palette[SEG_MAX_CLASS * 4];
+    for (int i = 0; i < num_class; i++)
     {
-        for (int x = 0; x < ori_shape.width; ++x)
-        {
-            float s = 0.0;
-            int loc = num_class * (x + y * ori_shape.width);
-            for (int c = 0; c < num_class; c++)
-                s += exp(output[loc + c]);
-            for (int c = 0; c < num_class; c++)
-            {
-                output[loc + c] = output[loc + c] / s;
-                scores[c] = output[loc + c];
-            }
-            cv::Vec4b& color = images_pred_color.at<cv::Vec4b>(cv::Point(x, y));
-            color[0] = 128;
-            color[1] = 0;
-            color[2] = 0;
-            color[3] = 0;
-            float score0 = scores[0];
-            for (int i = 1; i < num_class; ++i)
-            {
-                if (scores[i] > score0)
-                {
-                    score0 = scores[i];
-                    color[1] = max(255 - (num_class - i) * 100, 255);
-                    color[2] = min(i * 80, 255);
-                    color[3] = max(255 - i * 60, 0);
-                }
-            }
-        }
+        palette[i * 4 + 0] = 128;
+        palette[i * 4 + 1] = i ? 255 : 0;
+        palette[i * 4 + 2] = min(i * 80, 255);
+        palette[i * 4 + 3] = i ? max(255 - i * 60, 0) : 0;
     }
-    cv::resize(images_pred_color, images_pred_color, cv::Size(dst_shape.width, dst_shape.height));
-
-    uint8_t *result = (uint8_t *)malloc(dst_shape.width * dst_shape.height * 4 * sizeof(uint8_t));
-    memcpy(result, images_pred_color.data, sizeof(uint8_t) * dst_shape.width * dst_shape.height * 4);
-    return result;
-}
\ No newline at end of file
+    seg_argmax_render(data, num_class, ori_shape.width, ori_shape.height, -FLT_MAX, palette,
+                      dst, dst_shape.width, dst_shape.height, dst_shape.width * 4, resize, conf);
+}
@@ -0,0 +1,123 @@
+#include "seg_render.h"
+#include <math.h>
+#include <string.h>
+
+#define SEG_COEF_BITS 11
+#define SEG_COEF_ONE  (1 << SEG_COEF_BITS)
+
+// 逐像素取最大logit的类别，第i个像素的类别写到 ((uint8_t*)logits)[i]。
+// 写入位置不会超过当前像素的第一个logit，所以不会覆盖还没读的数据
+static void seg_argmax(float* logits, int num_class, int n, float min_logit, float* conf)
+{
+    uint8_t* cls_map = (uint8_t*)logits;
+    for (int i = 0; i < n; i++)
+    {
+        const float* p = logits + (size_t)i * num_class;
+        float max_value = p[0];
+        int idx = 0;
+        for (int c = 1; c < num_class; c++)
+        {
+            if (p[c] > max_value)
+            {
+                max_value = p[c];
+                idx = c;
+            }
+        }
+        if (!(max_value > min_logit))
+            idx = 0;
+
+        if (conf)
+        {
+            float s = 0.f;
+            for (int c = 0; c < num_class; c++)
+                s += expf(p[c] - max_value);
+            conf[i] = expf(p[idx] - max_value) / s;
+        }
+
+        cls_map[i] = idx;
+    }
+}
+
+static void seg_render_nearest(const uint8_t* cls_map, int src_w, int src_h, const uint8_t* palette,
+                               uint8_t* dst, int dst_w, int dst_h, int dst_stride)
+{
+    for (int y = 0; y < dst_h; y++)
+    {
+        int sy = (int)(((int64_t)y * src_h) / dst_h);
+        const uint8_t* src_row = cls_map + (size_t)sy * src_w;
+        uint8_t* dst_row = dst + (size_t)y * dst_stride;
+        for (int x = 0; x < dst_w; x++)
+        {
+            int sx = (int)(((int64_t)x * src_w) / dst_w);
+            memcpy(dst_row + x * 4, palette + src_row[sx] * 4, 4);
+        }
+    }
+}
+
+// 源坐标按像素中心对齐: s = (d + 0.5) * src / dst - 0.5，与cv::resize的INTER_LINEAR一致
+static inline void seg_map_coord(int d, int src_n, int dst_n, int* s0, int* s1, int* w)
+{
+    int64_t fp = (((int64_t)(2 * d + 1) * src_n) << SEG_COEF_BITS) / (2 * dst_n) - SEG_COEF_ONE / 2;
+    if (fp < 0)
+        fp = 0;
+    *s0 = (int)(fp >> SEG_COEF_BITS);
+    *w = (int)(fp & (SEG_COEF_ONE - 1));
+    if (*s0 >= src_n - 1)
+    {
+        *s0 = src_n - 1;
+        *w = 0;
+    }
+    *s1 = *s0 + (*w ? 1 : 0);
+}
+
+static void seg_render_bilinear(const uint8_t* cls_map, int src_w, int src_h, const uint8_t* palette,
+                                uint8_t* dst, int dst_w, int dst_h, int dst_stride)
+{
+    for (int y = 0; y < dst_h; y++)
+    {
+        int y0, y1, wy;
+        seg_map_coord(y, src_h, dst_h, &y0, &y1, &wy);
+        const uint8_t* row0 = cls_map + (size_t)y0 * src_w;
+        const uint8_t* row1 = cls_map + (size_t)y1 * src_w;
+        uint8_t* dst_row = dst + (size_t)y * dst_stride;
+
+        for (int x = 0; x < dst_w; x++)
+        {
+            int x0, x1, wx;
+            seg_map_coord(x, src_w, dst_w, &x0, &x1, &wx);
+            int c00 = row0[x0], c01 = row0[x1], c10 = row1[x0], c11 = row1[x1];
+            uint8_t* out = dst_row + x * 4;
+
+            // 大部分像素四个邻点同类，直接查表
+            if (c00 == c01 && c00 == c10 && c00 == c11)
+            {
+                memcpy(out, palette + c00 * 4, 4);
+                continue;
+            }
+
+            const uint8_t* p00 = palette + c00 * 4;
+            const uint8_t* p01 = palette + c01 * 4;
+            const uint8_t* p10 = palette + c10 * 4;
+            const uint8_t* p11 = palette + c11 * 4;
+            for (int k = 0; k < 4; k++)
+            {
+                int top = p00[k] * (SEG_COEF_ONE - wx) + p01[k] * wx;
+                int bottom = p10[k] * (SEG_COEF_ONE - wx) + p11[k] * wx;
+                int64_t v = (int64_t)top * (SEG_COEF_ONE - wy) + (int64_t)bottom * wy;
+                out[k] = (uint8_t)((v + (1 << (2 * SEG_COEF_BITS - 1))) >> (2 * SEG_COEF_BITS));
+            }
+        }
+    }
+}
+
+void seg_argmax_render(float* logits, int num_class, int src_w, int src_h, float min_logit, const uint8_t* palette,
+                       uint8_t* dst, int dst_w, int dst_h, int dst_stride, int resize, float* conf)
+{
+    seg_argmax(logits, num_class, src_w * src_h, min_logit, conf);
+
+    const uint8_t* cls_map = (const uint8_t*)logits;
+    if (resize == SEG_RESIZE_NEAREST)
+        seg_render_nearest(cls_map, src_w, src_h, palette, dst, dst_w, dst_h, dst_stride);
+    else
+        seg_render_bilinear(cls_map, src_w, src_h, palette, dst, dst_w, dst_h, dst_stride);
+}
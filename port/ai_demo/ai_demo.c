@@ -35,6 +35,7 @@
 #include "ai_demo.h"
 #include "aidemo_type.h"
 #include "aidemo_wrap.h"
+#include "seg_render.h"
 
 //*****************************for cv*****************************
 STATIC mp_obj_t aidemo_invert_affine_transform(mp_obj_t matrix_ndarray) 
@@ -161,63 +162,206 @@ STATIC mp_obj_t aidemo_contours(size_t n_args, const mp_obj_t *args)
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_contours_obj, 6, 6, aidemo_contours);
 
 //*****************************for face det*****************************
-STATIC mp_obj_t aidemo_face_det_post_process(size_t n_args, const mp_obj_t *args)
+STATIC void face_det_get_outputs(mp_obj_t outputs_obj, float **p_outputs)
 {
-    float obj_thresh = mp_obj_get_float(args[0]);
-    float nms_thresh = mp_obj_get_float(args[1]);
-    int net_len = mp_obj_get_float(args[2]);
-    ndarray_obj_t *mp_anchors = MP_ROM_PTR(args[3]);      //hwc
-    float *anchors = (float*)mp_anchors->array;
-    mp_obj_list_t *ori_shape_list = MP_OBJ_TO_PTR(args[4]);
-    FrameSize frame_size;
-    frame_size.width = mp_obj_get_int(ori_shape_list->items[0]);
-    frame_size.height = mp_obj_get_int(ori_shape_list->items[1]);
-
-    mp_obj_list_t *mp_outputs = MP_OBJ_TO_PTR(args[5]);
-    float* p_outputs[9];
+    mp_obj_list_t *mp_outputs = MP_OBJ_TO_PTR(outputs_obj);
     for(int i=0;i<9;++i)
     {
         ndarray_obj_t *array_i = MP_ROM_PTR(mp_outputs->items[i]);
         p_outputs[i] =  (float*)(array_i->array);
     }
+}
+
+STATIC FrameSize face_det_get_frame_size(mp_obj_t ori_shape_obj)
+{
+    mp_obj_list_t *ori_shape_list = MP_OBJ_TO_PTR(ori_shape_obj);
+    FrameSize frame_size;
+    frame_size.width = mp_obj_get_int(ori_shape_list->items[0]);
+    frame_size.height = mp_obj_get_int(ori_shape_list->items[1]);
+    return frame_size;
+}
+
+STATIC FaceDetContext *face_det_new_context(mp_obj_t net_len_obj, mp_obj_t anchors_obj, int max_faces)
+{
+    int net_len = mp_obj_get_float(net_len_obj);
+    ndarray_obj_t *mp_anchors = MP_ROM_PTR(anchors_obj);      //hwc
+    FaceDetContext *ctx = face_det_create(net_len, (float*)mp_anchors->array, mp_anchors->len, max_faces);
+    if (ctx == NULL)
+        mp_raise_ValueError(MP_ERROR_TEXT("anchors do not match net_len"));
+    return ctx;
+}
+
+// face_det_post_process 缓存的context和结果缓冲，net_len和anchors不变时每帧复用
+static struct {
+    FaceDetContext *ctx;
+    Bbox *bbox;
+    SparseLandmarks *sparse_kps;
+    float *score;
+} face_det_legacy;
+
+STATIC FaceDetContext *face_det_legacy_context(mp_obj_t net_len_obj, mp_obj_t anchors_obj)
+{
+    int net_len = mp_obj_get_float(net_len_obj);
+    ndarray_obj_t *mp_anchors = MP_ROM_PTR(anchors_obj);
+    if (face_det_legacy.ctx != NULL &&
+        face_det_matches(face_det_legacy.ctx, net_len, (float*)mp_anchors->array, mp_anchors->len))
+        return face_det_legacy.ctx;
+
+    if (face_det_legacy.ctx != NULL) {
+        face_det_destroy(face_det_legacy.ctx);
+        free(face_det_legacy.bbox);
+        free(face_det_legacy.sparse_kps);
+        free(face_det_legacy.score);
+        face_det_legacy.ctx = NULL;
+    }
+    // 容量取anchor个数(每个anchor 4个float)，和以前一样不截断结果
+    int max_faces = mp_anchors->len / 4;
+    FaceDetContext *ctx = face_det_new_context(net_len_obj, anchors_obj, max_faces);
+    face_det_legacy.bbox = malloc(sizeof(Bbox) * max_faces);
+    face_det_legacy.sparse_kps = malloc(sizeof(SparseLandmarks) * max_faces);
+    face_det_legacy.score = malloc(sizeof(float) * max_faces);
+    if (face_det_legacy.bbox == NULL || face_det_legacy.sparse_kps == NULL || face_det_legacy.score == NULL) {
+        face_det_destroy(ctx);
+        free(face_det_legacy.bbox);
+        free(face_det_legacy.sparse_kps);
+        free(face_det_legacy.score);
+        mp_raise_msg(&mp_type_MemoryError, MP_ERROR_TEXT("face_det_post_process out of memory"));
+    }
+    face_det_legacy.ctx = ctx;
+    return ctx;
+}
+
+// face_det_post_process(obj_thresh, nms_thresh, net_len, anchors, ori_shape, outputs)
+// context按net_len和anchors缓存，多个模型交替调用时会重建；多线程处理视频帧时用 face_det_create/face_det_run
+STATIC mp_obj_t aidemo_face_det_post_process(size_t n_args, const mp_obj_t *args)
+{
+    float obj_thresh = mp_obj_get_float(args[0]);
+    float nms_thresh = mp_obj_get_float(args[1]);
+    FrameSize frame_size = face_det_get_frame_size(args[4]);
+    float* p_outputs[9];
+    face_det_get_outputs(args[5], p_outputs);
+
+    FaceDetContext *ctx = face_det_legacy_context(args[2], args[3]);
+    Bbox *bbox = face_det_legacy.bbox;
+    SparseLandmarks *sparse_kps = face_det_legacy.sparse_kps;
+    float *score = face_det_legacy.score;
+    int vec_len = face_det_post_process(ctx, obj_thresh, nms_thresh, &frame_size, p_outputs, bbox, sparse_kps, score);
 
-    FaceDetectionInfoVector* result = face_detetion_post_process(obj_thresh,nms_thresh,net_len,anchors,&frame_size,p_outputs);
     mp_obj_list_t *results_mp_list = mp_obj_new_list(0, NULL);
-    if(result->vec_len>0)
+    if(vec_len>0)
     {    
         size_t *bbox_shape = m_new(size_t, ULAB_MAX_DIMS);
-        bbox_shape[2] = result->vec_len;
+        bbox_shape[2] = vec_len;
         bbox_shape[3] = sizeof(Bbox) / sizeof(float);
         ndarray_obj_t *bbox_obj = ndarray_new_ndarray(2, bbox_shape, NULL, NDARRAY_FLOAT);
-        float *bbox_data = (float *)bbox_obj->array;
-        memcpy(bbox_data,result->bbox,sizeof(Bbox) * result->vec_len);
-        free(result->bbox);
+        memcpy(bbox_obj->array,bbox,sizeof(Bbox) * vec_len);
         mp_obj_list_append(results_mp_list, bbox_obj);
 
         size_t *kps_shape = m_new(size_t, ULAB_MAX_DIMS);
-        kps_shape[2] = result->vec_len;
+        kps_shape[2] = vec_len;
         kps_shape[3] = sizeof(SparseLandmarks) / sizeof(float);
         ndarray_obj_t *kps_obj = ndarray_new_ndarray(2, kps_shape, NULL, NDARRAY_FLOAT);
-        float *kps_data = (float *)kps_obj->array;
-        memcpy(kps_data,result->sparse_kps,sizeof(SparseLandmarks) * result->vec_len);
-        free(result->sparse_kps);
+        memcpy(kps_obj->array,sparse_kps,sizeof(SparseLandmarks) * vec_len);
         mp_obj_list_append(results_mp_list, kps_obj);
 
         size_t *score_shape = m_new(size_t, ULAB_MAX_DIMS);
-        score_shape[2] = result->vec_len;
+        score_shape[2] = vec_len;
         score_shape[3] = sizeof(float) / sizeof(float);
         ndarray_obj_t *score_obj = ndarray_new_ndarray(2, score_shape, NULL, NDARRAY_FLOAT);
-        float *score_data = (float *)score_obj->array;
-        memcpy(score_data,result->score,sizeof(float) * result->vec_len);
-        free(result->score);
+        memcpy(score_obj->array,score,sizeof(float) * vec_len);
         mp_obj_list_append(results_mp_list, score_obj);
     }
-    free(result);
-    
     return MP_OBJ_FROM_PTR(results_mp_list);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_face_det_post_process_obj, 6, 6, aidemo_face_det_post_process);
 
+// face_det_create 返回的context对象，析构或 face_det_destroy 之后 ctx 为NULL
+typedef struct _face_det_obj_t {
+    mp_obj_base_t base;
+    FaceDetContext *ctx;
+} face_det_obj_t;
+
+STATIC const mp_obj_type_t face_det_type;
+
+STATIC FaceDetContext *face_det_get_context(mp_obj_t ctx_obj)
+{
+    if (!mp_obj_is_type(ctx_obj, &face_det_type))
+        mp_raise_TypeError(MP_ERROR_TEXT("expected a context from face_det_create"));
+    face_det_obj_t *self = MP_OBJ_TO_PTR(ctx_obj);
+    if (self->ctx == NULL)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("face_det context already destroyed."));
+    return self->ctx;
+}
+
+// 可以重复调用，忘记调用时由GC在回收对象时释放
+STATIC mp_obj_t aidemo_face_det_destroy(mp_obj_t ctx_obj)
+{
+    if (!mp_obj_is_type(ctx_obj, &face_det_type))
+        mp_raise_TypeError(MP_ERROR_TEXT("expected a context from face_det_create"));
+    face_det_obj_t *self = MP_OBJ_TO_PTR(ctx_obj);
+    if (self->ctx != NULL) {
+        face_det_destroy(self->ctx);
+        self->ctx = NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(aidemo_face_det_destroy_obj, aidemo_face_det_destroy);
+
+STATIC const mp_rom_map_elem_t face_det_locals_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&aidemo_face_det_destroy_obj) },
+};
+STATIC MP_DEFINE_CONST_DICT(face_det_locals_dict, face_det_locals_dict_table);
+
+STATIC MP_DEFINE_CONST_OBJ_TYPE(
+    face_det_type,
+    MP_QSTR_face_det_context,
+    MP_TYPE_FLAG_NONE,
+    locals_dict, &face_det_locals_dict
+    );
+
+// face_det_create(net_len, anchors, max_faces)，anchors拷贝到context里，之后可以释放
+STATIC mp_obj_t aidemo_face_det_create(mp_obj_t net_len_obj, mp_obj_t anchors_obj, mp_obj_t max_faces_obj)
+{
+    int max_faces = mp_obj_get_int(max_faces_obj);
+    if (max_faces <= 0)
+        mp_raise_ValueError(MP_ERROR_TEXT("max_faces must be > 0"));
+    face_det_obj_t *self = m_new_obj_with_finaliser(face_det_obj_t);
+    self->base.type = &face_det_type;
+    // face_det_new_context 失败会抛异常，先置NULL，对象被回收时析构什么也不做
+    self->ctx = NULL;
+    self->ctx = face_det_new_context(net_len_obj, anchors_obj, max_faces);
+    return MP_OBJ_FROM_PTR(self);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(aidemo_face_det_create_obj, aidemo_face_det_create);
+
+STATIC float *face_det_get_result(mp_obj_t array_obj, size_t floats)
+{
+    ndarray_obj_t *array = MP_ROM_PTR(array_obj);
+    if (array->dtype != NDARRAY_FLOAT || !ndarray_is_dense(array) || array->len < floats)
+        mp_raise_ValueError(MP_ERROR_TEXT("result arrays must be float with max_faces rows"));
+    return (float *)array->array;
+}
+
+// face_det_run(ctx, obj_thresh, nms_thresh, ori_shape, outputs, bbox, kps, score) -> n
+// bbox/kps/score 是调用者预先分配的 (max_faces,4)/(max_faces,10)/(max_faces,) float 数组，前n行是结果
+STATIC mp_obj_t aidemo_face_det_run(size_t n_args, const mp_obj_t *args)
+{
+    FaceDetContext *ctx = face_det_get_context(args[0]);
+    float obj_thresh = mp_obj_get_float(args[1]);
+    float nms_thresh = mp_obj_get_float(args[2]);
+    FrameSize frame_size = face_det_get_frame_size(args[3]);
+    float* p_outputs[9];
+    face_det_get_outputs(args[4], p_outputs);
+
+    size_t max_faces = face_det_capacity(ctx);
+    Bbox *bbox = (Bbox *)face_det_get_result(args[5], max_faces * sizeof(Bbox) / sizeof(float));
+    SparseLandmarks *sparse_kps = (SparseLandmarks *)face_det_get_result(args[6], max_faces * sizeof(SparseLandmarks) / sizeof(float));
+    float *score = face_det_get_result(args[7], max_faces);
+    int vec_len = face_det_post_process(ctx, obj_thresh, nms_thresh, &frame_size, p_outputs, bbox, sparse_kps, score);
+    return mp_obj_new_int(vec_len);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_face_det_run_obj, 8, 8, aidemo_face_det_run);
+
 //*****************************for face parse*****************************
 STATIC mp_obj_t aidemo_face_parse_post_process(size_t n_args, const mp_obj_t *args)
 {
@@ -418,6 +562,93 @@ STATIC mp_obj_t aidemo_ocr_rec_preprocess(mp_obj_t data_obj, mp_obj_t ori_shape_
 
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(aidemo_ocr_rec_preprocess_obj, aidemo_ocr_rec_preprocess);
 
+// ocr_rec_affine(boxes, dst_shape) -> [[M, ...], [points, ...]]
+// 为每个检测框计算ai2d仿射矩阵M，配合 ai2d_builder.run_batch() 一次抠出所有框，
+// dst_shape为识别模型输入的 [height, width]，points为排序后的四个顶点，与ocr_rec_preprocess一致
+STATIC mp_obj_t aidemo_ocr_rec_affine(mp_obj_t boxpoint8_obj, mp_obj_t dst_shape_obj) {
+    mp_obj_list_t *dst_shape_list = MP_OBJ_TO_PTR(dst_shape_obj);
+    FrameSize dst_shape;
+    dst_shape.height = mp_obj_get_int(dst_shape_list->items[0]);
+    dst_shape.width = mp_obj_get_int(dst_shape_list->items[1]);
+
+    mp_obj_list_t *boxpoint8_list = MP_OBJ_TO_PTR(boxpoint8_obj);
+    int box_cnt = boxpoint8_list->len;
+    BoxPoint8 boxpoint8[box_cnt];
+    for (int i = 0; i < box_cnt; i++)
+    {
+        ndarray_obj_t *boxpoint8_ndarray = MP_ROM_PTR(boxpoint8_list->items[i]);
+        float *boxpoint8_ndarray_tmp = boxpoint8_ndarray->array;
+        for (int j = 0; j < 8; j++)
+        {
+            boxpoint8[i].points8[j] = boxpoint8_ndarray_tmp[j];
+        }
+    }
+
+    float matrix[box_cnt * 6];
+    float coordinates[box_cnt * 8];
+    ocr_rec_affine_matrix(boxpoint8, box_cnt, dst_shape, matrix, coordinates);
+
+    mp_obj_list_t *results_mp_list = mp_obj_new_list(0, NULL);
+    mp_obj_list_t *results_mp_list_matrix = mp_obj_new_list(0, NULL);
+    mp_obj_list_t *results_mp_list_points = mp_obj_new_list(0, NULL);
+    for (int i = 0; i < box_cnt; i++)
+    {
+        mp_obj_t m[6];
+        for (int j = 0; j < 6; j++)
+        {
+            m[j] = mp_obj_new_float(matrix[i * 6 + j]);
+        }
+        mp_obj_list_append(results_mp_list_matrix, mp_obj_new_list(6, m));
+
+        size_t point_shape[4];
+        point_shape[3] = 8;
+        ndarray_obj_t *point_obj = ndarray_new_ndarray(1, point_shape, NULL, NDARRAY_FLOAT);
+        memcpy(point_obj->array, coordinates + i * 8, 8 * sizeof(float));
+        mp_obj_list_append(results_mp_list_points, point_obj);
+    }
+    mp_obj_list_append(results_mp_list, results_mp_list_matrix);
+    mp_obj_list_append(results_mp_list, results_mp_list_points);
+    return MP_OBJ_FROM_PTR(results_mp_list);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(aidemo_ocr_rec_affine_obj, aidemo_ocr_rec_affine);
+
+// ocr_rec_gray(crops, n) -> [gray, ...]
+// crops为ai2d_builder.run_batch()输出的 [N,3,H,W] uint8 RGB，取前n个块转成识别模型要求的 [1,1,H,W] 灰度图，
+// 转换与 ocr_rec_preprocess 相同
+STATIC mp_obj_t aidemo_ocr_rec_gray(mp_obj_t crops_obj, mp_obj_t n_obj) {
+    ndarray_obj_t *crops = MP_ROM_PTR(crops_obj);
+    int n = mp_obj_get_int(n_obj);
+    int start_shape_index = ULAB_MAX_DIMS - crops->ndim;
+    if (crops->ndim != 4 || crops->dtype != NDARRAY_UINT8 || !ndarray_is_dense(crops) ||
+        crops->shape[start_shape_index + 1] != 3)
+        mp_raise_ValueError(MP_ERROR_TEXT("crops must be a dense uint8 [N,3,H,W] array"));
+    if (n < 0 || (size_t)n > crops->shape[start_shape_index])
+        mp_raise_ValueError(MP_ERROR_TEXT("n exceeds the number of crops"));
+
+    FrameSize shape;
+    shape.height = crops->shape[start_shape_index + 2];
+    shape.width = crops->shape[start_shape_index + 3];
+    size_t matsize = shape.height * shape.width;
+    uint8_t *crops_data = (uint8_t *)crops->array;
+
+    mp_obj_list_t *results_mp_list = mp_obj_new_list(0, NULL);
+    for (int i = 0; i < n; i++)
+    {
+        size_t ndarray_shape[4];
+        ndarray_shape[0] = 1;
+        ndarray_shape[1] = 1;
+        ndarray_shape[2] = shape.height;
+        ndarray_shape[3] = shape.width;
+        ndarray_obj_t *gray_obj = ndarray_new_ndarray(4, ndarray_shape, NULL, NDARRAY_UINT8);
+        ocr_rec_gray(crops_data + i * 3 * matsize, shape, (uint8_t *)gray_obj->array);
+        mp_obj_list_append(results_mp_list, gray_obj);
+    }
+    return MP_OBJ_FROM_PTR(results_mp_list);
+}
+
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(aidemo_ocr_rec_gray_obj, aidemo_ocr_rec_gray);
+
 //*****************************for licence det*****************************
 STATIC mp_obj_t aidemo_licence_det_postprocess(size_t n_args, const mp_obj_t *args) {
 
@@ -505,7 +736,6 @@ STATIC mp_obj_t aidemo_segment_postprocess(size_t n_args, const mp_obj_t *args)
     float conf_thres;
     float nms_thres;
     float mask_thres;
-    int box_cnt;
 
     mp_obj_list_t *frame_size_list = MP_OBJ_TO_PTR(args[1]);
     frame_size.height = mp_obj_get_int(frame_size_list->items[0]);
@@ -524,19 +754,18 @@ STATIC mp_obj_t aidemo_segment_postprocess(size_t n_args, const mp_obj_t *args)
     mask_thres = mp_obj_get_float(args[6]);
 
     ndarray_obj_t *masks_results = MP_ROM_PTR(args[7]);
+    // masks按字节当作display大小的ARGB8888图像使用
+    if (!ndarray_is_dense(masks_results) || masks_results->len * masks_results->itemsize < (size_t)display_frame_size.height * display_frame_size.width * 4)
+        mp_raise_ValueError(MP_ERROR_TEXT("masks buffer is smaller than display_size * 4 bytes"));
     uint8_t *masks_results_data = (uint8_t *)masks_results->array;
 
-    SegOutputs segOutputs = object_seg_post_process(data_0, data_1, frame_size, kmodel_frame_size, display_frame_size, conf_thres, nms_thres, mask_thres, &box_cnt);
+    SegOutput *segOutput;
+    int box_cnt = object_seg_post_process(data_0, data_1, frame_size, kmodel_frame_size, display_frame_size, conf_thres, nms_thres, mask_thres, masks_results_data, &segOutput);
 
     mp_obj_list_t *results_mp_list = mp_obj_new_list(0, NULL);
     mp_obj_list_t *results_mp_list_boxes = mp_obj_new_list(0, NULL);
     mp_obj_list_t *results_mp_list_ids = mp_obj_new_list(0, NULL);
     mp_obj_list_t *results_mp_list_scores = mp_obj_new_list(0, NULL);
-    
-    for (int i = 0; i < display_frame_size.height * display_frame_size.width * 4; i++)
-    {
-        masks_results_data[i] = segOutputs.masks_results[i];
-    }
 
     size_t ndarray_shape_box[4];
     ndarray_shape_box[3] = 4;
@@ -546,19 +775,18 @@ STATIC mp_obj_t aidemo_segment_postprocess(size_t n_args, const mp_obj_t *args)
         int16_t *box_data = (int16_t *)box_obj->array;
         for (int j = 0; j < 4; j++)
         {
-            box_data[j] = segOutputs.segOutput[i].box[j];
+            box_data[j] = segOutput[i].box[j];
         }
         mp_obj_list_append(results_mp_list_boxes, box_obj);
-        mp_obj_list_append(results_mp_list_ids, mp_obj_new_int(segOutputs.segOutput[i].id));
-        mp_obj_list_append(results_mp_list_scores, mp_obj_new_float(segOutputs.segOutput[i].confidence));
+        mp_obj_list_append(results_mp_list_ids, mp_obj_new_int(segOutput[i].id));
+        mp_obj_list_append(results_mp_list_scores, mp_obj_new_float(segOutput[i].confidence));
     }
     mp_obj_list_append(results_mp_list, results_mp_list_boxes);
     mp_obj_list_append(results_mp_list, results_mp_list_ids);
     mp_obj_list_append(results_mp_list, results_mp_list_scores);
 
 
-    free(segOutputs.masks_results);
-    free(segOutputs.segOutput);
+    free(segOutput);
     return MP_OBJ_FROM_PTR(results_mp_list);
 };
 
@@ -835,6 +1063,7 @@ STATIC mp_obj_t save_wav(size_t n_args, const mp_obj_t *args){
 STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_save_wav_obj, 4, 4, save_wav);
 
 //***********************************for body seg ******************/
+// body_seg_postprocess(data, num_class, ori_shape, dst_shape, color, out=None, resize=1, conf=None)
 STATIC mp_obj_t aidemo_body_seg_postprocess(size_t n_args, const mp_obj_t *args) {
     ndarray_obj_t *data_mp = MP_ROM_PTR(args[0]);
     float *data = data_mp->array;
@@ -842,7 +1071,7 @@ STATIC mp_obj_t aidemo_body_seg_postprocess(size_t n_args, const mp_obj_t *args)
     mp_obj_list_t *ori_shape_mp = MP_OBJ_TO_PTR(args[2]);
     mp_obj_list_t *dst_shape_mp = MP_OBJ_TO_PTR(args[3]);
 
-    ndarray_obj_t *data_1_mp=MP_ROM_PTR(args[5]);
+    ndarray_obj_t *data_1_mp=MP_ROM_PTR(args[4]);
     uint8_t *data_1=data_1_mp->array;
 
     FrameSize ori_shape;
@@ -853,25 +1082,48 @@ STATIC mp_obj_t aidemo_body_seg_postprocess(size_t n_args, const mp_obj_t *args)
     dst_shape.height = mp_obj_get_int(dst_shape_mp->items[0]);
     dst_shape.width = mp_obj_get_int(dst_shape_mp->items[1]);
 
-    uint8_t *result = body_seg_postprocess(data, num_class, ori_shape, dst_shape, data_1);
+    if (num_class < 1 || num_class > SEG_MAX_CLASS || data_mp->len < (size_t)ori_shape.height * ori_shape.width * num_class
+        || data_1_mp->len < (size_t)num_class * 4) {
+        mp_raise_msg(&mp_type_ValueError, "Invalid input");
+    }
+
+    mp_obj_t result_obj;
+    uint8_t *dst;
+    if (n_args > 5 && args[5] != mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[5], &bufinfo, MP_BUFFER_WRITE);
+        if (bufinfo.len < (size_t)dst_shape.height * dst_shape.width * 4) {
+            mp_raise_msg(&mp_type_ValueError, "Output buffer too small");
+        }
+        dst = bufinfo.buf;
+        result_obj = args[5];
+    } else {
+        size_t ndarray_shape[4];
+        ndarray_shape[1] = dst_shape.height;
+        ndarray_shape[2] = dst_shape.width;
+        ndarray_shape[3] = 4;
+        ndarray_obj_t *ndarray = ndarray_new_ndarray(3, ndarray_shape, NULL, NDARRAY_UINT8);
+        dst = (uint8_t *)ndarray->array;
+        result_obj = MP_OBJ_FROM_PTR(ndarray);
+    }
 
-    size_t ndarray_shape[4];
-    ndarray_shape[1] = dst_shape.height;
-    ndarray_shape[2] = dst_shape.width;
-    ndarray_shape[3] = 4;
-    ndarray_obj_t *result_obj = ndarray_new_ndarray(3, ndarray_shape, NULL, NDARRAY_UINT8);
+    int resize = (n_args > 6) ? mp_obj_get_int(args[6]) : SEG_RESIZE_BILINEAR;
 
-    uint8_t *result_data = (uint8_t *)result_obj->array;
-    for (int i=0; i<dst_shape.height*dst_shape.width*4; i++)
-    {
-        result_data[i] = result[i];
+    float *conf = NULL;
+    if (n_args > 7 && args[7] != mp_const_none) {
+        mp_buffer_info_t bufinfo;
+        mp_get_buffer_raise(args[7], &bufinfo, MP_BUFFER_WRITE);
+        if (bufinfo.len < (size_t)ori_shape.height * ori_shape.width * sizeof(float)) {
+            mp_raise_msg(&mp_type_ValueError, "Confidence buffer too small");
+        }
+        conf = bufinfo.buf;
     }
 
-    free(result);
-    return MP_OBJ_FROM_PTR(result_obj);
+    body_seg_postprocess(data, num_class, ori_shape, dst_shape, data_1, dst, resize, conf);
+    return result_obj;
 }
 
-STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_body_seg_postprocess_obj, 5, 5, aidemo_body_seg_postprocess);
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(aidemo_body_seg_postprocess_obj, 5, 8, aidemo_body_seg_postprocess);
 
 
 STATIC const mp_rom_map_elem_t aidemo_globals_table[] = {
@@ -880,9 +1132,14 @@ STATIC const mp_rom_map_elem_t aidemo_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR_polylines), MP_ROM_PTR(&aidemo_polylines_obj) },
     { MP_ROM_QSTR(MP_QSTR_contours), MP_ROM_PTR(&aidemo_contours_obj) },
     { MP_ROM_QSTR(MP_QSTR_face_det_post_process), MP_ROM_PTR(&aidemo_face_det_post_process_obj) },
+    { MP_ROM_QSTR(MP_QSTR_face_det_create), MP_ROM_PTR(&aidemo_face_det_create_obj) },
+    { MP_ROM_QSTR(MP_QSTR_face_det_destroy), MP_ROM_PTR(&aidemo_face_det_destroy_obj) },
+    { MP_ROM_QSTR(MP_QSTR_face_det_run), MP_ROM_PTR(&aidemo_face_det_run_obj) },
     { MP_ROM_QSTR(MP_QSTR_face_parse_post_process), MP_ROM_PTR(&aidemo_face_parse_post_process_obj) },
     { MP_ROM_QSTR(MP_QSTR_mask_resize), MP_ROM_PTR(&aidemo_mask_resize_obj) },
     { MP_ROM_QSTR(MP_QSTR_ocr_rec_preprocess), MP_ROM_PTR(&aidemo_ocr_rec_preprocess_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ocr_rec_affine), MP_ROM_PTR(&aidemo_ocr_rec_affine_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ocr_rec_gray), MP_ROM_PTR(&aidemo_ocr_rec_gray_obj) },
     { MP_ROM_QSTR(MP_QSTR_licence_det_postprocess), MP_ROM_PTR(&aidemo_licence_det_postprocess_obj) },
     { MP_ROM_QSTR(MP_QSTR_segment_postprocess), MP_ROM_PTR(&aidemo_segment_postprocess_obj) },
     { MP_ROM_QSTR(MP_QSTR_face_mesh_post_process), MP_ROM_PTR(&aidemo_face_mesh_post_process_obj) },
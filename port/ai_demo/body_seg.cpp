@@ -1,59 +1,17 @@
-#include <opencv2/imgproc.hpp>
-#include <vector>
-#include <string>
+#include <float.h>
 #include <string.h>
-#include <cmath>
-#include <algorithm>
-#include <stdlib.h>
-#include <iostream>
 #include <stdint.h>
-// #include <opencv/cv.hpp>
-#include <opencv2/core/core.hpp>
-#include <opencv2/highgui/highgui.hpp>
 #include "aidemo_wrap.h"
+#include "seg_render.h"
+#include "profiler.h"
 
-using namespace std;
-
-
-using std::vector;
-
-uint8_t* body_seg_postprocess(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape,uint8_t* color)
+void body_seg_postprocess(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape, uint8_t* color, uint8_t* dst, int resize, float* conf)
 {
-    float* output = data;
-    cv::Mat images_pred_color = cv::Mat::zeros(ori_shape.height, ori_shape.width, CV_8UC4);
-    for (int y = 0; y < ori_shape.height; ++y)
-    {
-        for (int x = 0; x < ori_shape.width; ++x)
-        {
-            float s = 0.0;
-            float score0 = 0.0;
-            int idx=0;
-            int loc = num_class * (x + y * ori_shape.width);
-            for (int c = 0; c < num_class; c++)
-                s += exp(output[loc + c]);
-            for (int c = 0; c < num_class; c++)
-            {
-                output[loc + c] = output[loc + c] / s;
-                if(output[loc + c]>score0){
-                    idx=c;
-                    score0=output[loc + c];
-                }
-
-            }
-
-            cv::Vec4b& color_xy = images_pred_color.at<cv::Vec4b>(cv::Point(x, y));
-            if(idx>0){
-                color_xy[0] = color[idx*4+0];
-                color_xy[1] = color[idx*4+1];
-                color_xy[2] = color[idx*4+2];
-                color_xy[3] = color[idx*4+3];
-            }
-
-        }
-    }
-    cv::resize(images_pred_color, images_pred_color, cv::Size(dst_shape.width, dst_shape.height));
-
-    uint8_t *result = (uint8_t *)malloc(dst_shape.width * dst_shape.height * 4 * sizeof(uint8_t));
-    memcpy(result, images_pred_color.data, sizeof(uint8_t) * dst_shape.width * dst_shape.height * 4);
-    return result;
-}
\ No newline at end of file
+    PROF_SCOPE("aidemo.body_seg_postprocess");
+    // 类别0保持透明，与 seg_post_process 一样不设logit下限
+    uint8_t palette[SEG_MAX_CLASS * 4];
+    memset(palette, 0, 4);
+    memcpy(palette + 4, color + 4, (num_class - 1) * 4);
+    seg_argmax_render(data, num_class, ori_shape.width, ori_shape.height, -FLT_MAX, palette,
+                      dst, dst_shape.width, dst_shape.height, dst_shape.width * 4, resize, conf);
+}
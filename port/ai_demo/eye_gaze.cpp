@@ -26,6 +26,7 @@
 #include <math.h>
 #include <algorithm>
 #include "aidemo_wrap.h"
+#include "profiler.h"
 
 using std::vector;
 const float PI = 3.1415926;
@@ -50,6 +51,7 @@ void eye_gaze_softmax(vector<float>& input,vector<float>& output)
 
 void eye_gaze_post_process(float** p_outputs_,float* pitch,float* yaw)
 {
+    PROF_SCOPE("aidemo.eye_gaze_post_process");
 	for(int out_index = 0;out_index < 2; ++out_index)
 	{
 		vector<float> pred(p_outputs_[out_index],p_outputs_[out_index] + 90);
@@ -23,9 +23,13 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #include <vector>
+#include <mutex>
+#include <memory>
+#include <algorithm>
 #include <math.h>
 #include <string.h>
 #include "aidemo_wrap.h"
+#include "profiler.h"
 
 using std::vector;
 
@@ -34,259 +38,218 @@ using std::vector;
 #define LAND_SIZE 10
 #define PI 3.1415926
 
-/**
- * @brief 单张/帧图片大小
- */
-typedef struct FrameCHWSize
-{
-    size_t channel; // 通道
-    size_t height;  // 高
-    size_t width;   // 宽
-} FrameCHWSize;
-
 /**
  * @brief 用于NMS排序的roi对象
  */
 typedef struct NMSRoiObj
 {
-    int index;        // roi对象所在原列表的索引
+    int index;        // roi对象在所有anchor中的索引
     float confidence; // roi对象的置信度
 } NMSRoiObj;
 
 /**
- * @brief 预测人脸roi信息
+ * @brief 一次后处理用到的临时缓冲区，大小由anchor个数决定，用完放回context复用
  */
-typedef struct FaceDetectionInfo
+struct FaceDetWorkspace
 {
-    Bbox bbox;                  // 人脸检测框
-    SparseLandmarks sparse_kps; // 人脸五官关键点
-    float score;                // 人脸检测框置信度
-} FaceDetectionInfo;
+    vector<NMSRoiObj> candidates; // 超过阈值的roi
+    vector<Bbox> boxes;           // 候选框解码后的结果，和candidates一一对应
+};
 
-float obj_thresh_;
-float nms_thresh_;
-int min_size_ = 0;
-int objs_num_ = 0;
-NMSRoiObj *so_ = nullptr;    // 指向经过softmax之后首个roi置信度的指针
-float *boxes_ = nullptr;     // 指向首个roi检测框的指针
-float *landmarks_ = nullptr; // 指向首个roi对应五官关键点的指针
-float *g_anchors;
-
-int face_nms_comparator(const void *pa, const void *pb)
+/**
+ * @brief 人脸检测后处理的上下文，anchors和容量在创建时确定
+ *        不同线程可以同时使用同一个context，每个线程从空闲链表取各自的workspace
+ */
+struct FaceDetContext
 {
-    NMSRoiObj a = *(NMSRoiObj *)pa;
-    NMSRoiObj b = *(NMSRoiObj *)pb;
-    float diff = a.confidence - b.confidence;
+    int min_size;
+    int objs_num;
+    int max_faces;
+    vector<float> anchors;
 
-    if (diff < 0)
-        return 1;
-    else if (diff > 0)
-        return -1;
-    return 0;
-}
+    std::mutex lock;
+    vector<std::unique_ptr<FaceDetWorkspace>> idle;
+};
 
 //Implemented in licence_det.cpp
 void local_softmax(float *x, float *dx, uint32_t len);
 
-void face_deal_conf(float *conf, NMSRoiObj *so, int size, int &obj_cnt)
+//Implemented in licence_det.cpp
+float box_iou(Bbox a, Bbox b);
+
+// 三个尺度的输出依次排列，每个位置2个anchor；第level层第ww个位置的第hh个anchor的序号为 offset + ww * 2 + hh
+static int face_level_size(const FaceDetContext *ctx, int level)
 {
-    float confidence[CONF_SIZE] = {0.0};
-    for (uint32_t ww = 0; ww < size; ww++)
-    {
-        for (uint32_t hh = 0; hh < 2; hh++)
-        {
-            for (uint32_t cc = 0; cc < CONF_SIZE; cc++)
-            {
-                confidence[cc] = conf[(hh * CONF_SIZE + cc) * size + ww];
-            }
-            local_softmax(confidence, confidence, 2);
-            so_[obj_cnt].index = obj_cnt;
-            so_[obj_cnt].confidence = confidence[1];
-            obj_cnt += 1;
-        }
-    }
+    static const int scale[3] = {16, 4, 1};
+    return scale[level] * ctx->min_size / 2;
 }
 
-void face_deal_loc(float *loc, float *boxes, int size, int &obj_cnt)
+static void face_locate(const FaceDetContext *ctx, int obj_index, int &level, int &size, int &ww, int &hh)
 {
-    for (uint32_t ww = 0; ww < size; ww++)
+    for (level = 0; level < 3; level++)
     {
-        for (uint32_t hh = 0; hh < 2; hh++)
-        {
-            for (uint32_t cc = 0; cc < LOC_SIZE; cc++)
-            {
-                boxes_[obj_cnt * LOC_SIZE + cc] = loc[(hh * LOC_SIZE + cc) * size + ww];
-            }
-            obj_cnt += 1;
-        }
+        size = face_level_size(ctx, level);
+        if (obj_index < size * 2)
+            break;
+        obj_index -= size * 2;
     }
+    ww = obj_index / 2;
+    hh = obj_index % 2;
 }
 
-void face_deal_landms(float *landms, float *landmarks, int size, int &obj_cnt)
+static void face_collect(const FaceDetContext *ctx, float **p_outputs, float obj_thresh, vector<NMSRoiObj> &candidates)
 {
-    // chw->hwc
-    for (uint32_t ww = 0; ww < size; ww++)
+    int obj_cnt = 0;
+    float confidence[CONF_SIZE];
+    for (int level = 0; level < 3; level++)
     {
-        for (uint32_t hh = 0; hh < 2; hh++)
+        float *conf = p_outputs[3 + level];
+        int size = face_level_size(ctx, level);
+        for (int ww = 0; ww < size; ww++)
         {
-            for (uint32_t cc = 0; cc < LAND_SIZE; cc++)
+            for (int hh = 0; hh < 2; hh++, obj_cnt++)
             {
-                landmarks_[obj_cnt * LAND_SIZE + cc] = landms[(hh * LAND_SIZE + cc) * size + ww];
+                for (int cc = 0; cc < CONF_SIZE; cc++)
+                    confidence[cc] = conf[(hh * CONF_SIZE + cc) * size + ww];
+                local_softmax(confidence, confidence, 2);
+                if (confidence[1] >= obj_thresh)
+                    candidates.push_back({obj_cnt, confidence[1]});
             }
-            obj_cnt += 1;
         }
     }
 }
 
-Bbox face_get_box(float *boxes, int obj_index)
+static Bbox face_get_box(const FaceDetContext *ctx, float **p_outputs, int obj_index)
 {
-    float cx, cy, w, h;
-    cx = boxes_[obj_index * LOC_SIZE + 0];
-    cy = boxes_[obj_index * LOC_SIZE + 1];
-    w = boxes_[obj_index * LOC_SIZE + 2];
-    h = boxes_[obj_index * LOC_SIZE + 3];
-    float *g_anchors_obj_index = g_anchors + obj_index * LOC_SIZE;
-    cx = g_anchors_obj_index[0] + cx * 0.1 * g_anchors_obj_index[2];
-    cy = g_anchors_obj_index[1] + cy * 0.1 * g_anchors_obj_index[3];
-    w = g_anchors_obj_index[2] * expf(w * 0.2);
-    h = g_anchors_obj_index[3] * expf(h * 0.2);
+    int level, size, ww, hh;
+    face_locate(ctx, obj_index, level, size, ww, hh);
+    const float *loc = p_outputs[level];
+    float cx = loc[(hh * LOC_SIZE + 0) * size + ww];
+    float cy = loc[(hh * LOC_SIZE + 1) * size + ww];
+    float w = loc[(hh * LOC_SIZE + 2) * size + ww];
+    float h = loc[(hh * LOC_SIZE + 3) * size + ww];
+    const float *anchor = ctx->anchors.data() + obj_index * LOC_SIZE;
     Bbox box;
-    box.x = cx;
-    box.y = cy;
-    box.w = w;
-    box.h = h;
+    box.x = anchor[0] + cx * 0.1 * anchor[2];
+    box.y = anchor[1] + cy * 0.1 * anchor[3];
+    box.w = anchor[2] * expf(w * 0.2);
+    box.h = anchor[3] * expf(h * 0.2);
     return box;
 }
 
-SparseLandmarks face_get_landmark(float *landmarks, int obj_index)
+static SparseLandmarks face_get_landmark(const FaceDetContext *ctx, float **p_outputs, int obj_index)
 {
+    int level, size, ww, hh;
+    face_locate(ctx, obj_index, level, size, ww, hh);
+    const float *landms = p_outputs[6 + level];
+    const float *anchor = ctx->anchors.data() + obj_index * LOC_SIZE;
     SparseLandmarks landmark;
-    float *g_anchors_obj_index = g_anchors + obj_index * LOC_SIZE;
     for (uint32_t ll = 0; ll < 5; ll++)
     {
-        landmark.points[2 * ll + 0] = g_anchors_obj_index[0] + landmarks_[obj_index * LAND_SIZE + 2 * ll + 0] * 0.1 * g_anchors_obj_index[2];
-        landmark.points[2 * ll + 1] = g_anchors_obj_index[1] + landmarks_[obj_index * LAND_SIZE + 2 * ll + 1] * 0.1 * g_anchors_obj_index[3];
+        landmark.points[2 * ll + 0] = anchor[0] + landms[(hh * LAND_SIZE + 2 * ll + 0) * size + ww] * 0.1 * anchor[2];
+        landmark.points[2 * ll + 1] = anchor[1] + landms[(hh * LAND_SIZE + 2 * ll + 1) * size + ww] * 0.1 * anchor[3];
     }
     return landmark;
 }
 
-float overlap(float x1, float w1, float x2, float w2);
-
-//Implemented in licence_det.cpp
-float box_intersection(Bbox a, Bbox b);
-
-//Implemented in licence_det.cpp
-float box_union(Bbox a, Bbox b);
+FaceDetContext *face_det_create(int net_len, const float *anchors, size_t anchors_len, int max_faces)
+{
+    int min_size = (net_len == 320 ? 200 : 800);
+    int objs_num = min_size * (1 + 4 + 16);
+    if (anchors_len < (size_t)objs_num * LOC_SIZE || max_faces <= 0)
+        return nullptr;
+    FaceDetContext *ctx = new FaceDetContext;
+    ctx->min_size = min_size;
+    ctx->objs_num = objs_num;
+    ctx->max_faces = max_faces;
+    ctx->anchors.assign(anchors, anchors + objs_num * LOC_SIZE);
+    return ctx;
+}
 
-//Implemented in licence_det.cpp
-float box_iou(Bbox a, Bbox b);
+void face_det_destroy(FaceDetContext *ctx)
+{
+    delete ctx;
+}
 
-void face_get_final_box(FrameSize &frame_size, vector<FaceDetectionInfo> &results)
+int face_det_post_process(FaceDetContext *ctx, float obj_thresh, float nms_thresh, FrameSize *frame_size, float **p_outputs, Bbox *bbox, SparseLandmarks *sparse_kps, float *score)
 {
-    int iou_cal_times = 0;
-    int i, j, obj_index;
-    for (i = 0; i < objs_num_; ++i)
+    PROF_SCOPE("aidemo.face_det_post_process");
+    std::unique_ptr<FaceDetWorkspace> ws;
     {
-        obj_index = so_[i].index;
-        if (so_[i].confidence < obj_thresh_)
-            continue;
-        FaceDetectionInfo obj;
-        obj.bbox = face_get_box(boxes_, obj_index);
-        obj.sparse_kps = face_get_landmark(landmarks_, obj_index);
-
-        for (j = i + 1; j < objs_num_; ++j)
+        std::lock_guard<std::mutex> guard(ctx->lock);
+        if (!ctx->idle.empty())
         {
-            obj_index = so_[j].index;
-            if (so_[j].confidence < obj_thresh_)
-                continue;
-            Bbox b = face_get_box(boxes_, obj_index);
-            iou_cal_times += 1;
-            if (box_iou(obj.bbox, b) >= nms_thresh_) // thres
-                so_[j].confidence = 0;
+            ws = std::move(ctx->idle.back());
+            ctx->idle.pop_back();
         }
-        obj.score = so_[i].confidence;
-        results.push_back(obj);
+    }
+    if (!ws)
+    {
+        ws.reset(new FaceDetWorkspace);
+        ws->candidates.reserve(ctx->objs_num);
+        ws->boxes.reserve(ctx->objs_num);
     }
 
-    // for src img
-    int max_src_size = std::max(frame_size.width, frame_size.height);
-    for (int i = 0; i < results.size(); ++i)
+    // 只有超过阈值的roi参与排序和NMS，框在排序后解码一次
+    vector<NMSRoiObj> &so = ws->candidates;
+    vector<Bbox> &boxes = ws->boxes;
+    so.clear();
+    boxes.clear();
+    face_collect(ctx, p_outputs, obj_thresh, so);
+    std::sort(so.begin(), so.end(), [](const NMSRoiObj &a, const NMSRoiObj &b) {
+        return a.confidence > b.confidence || (a.confidence == b.confidence && a.index < b.index);
+    });
+    for (auto &o : so)
+        boxes.push_back(face_get_box(ctx, p_outputs, o.index));
+
+    int count = 0;
+    int max_src_size = std::max(frame_size->width, frame_size->height);
+    for (size_t i = 0; i < so.size() && count < ctx->max_faces; ++i)
     {
-        auto &l = results[i].sparse_kps;
-        for (uint32_t ll = 0; ll < 5; ll++)
+        if (so[i].confidence < obj_thresh)
+            continue;
+        for (size_t j = i + 1; j < so.size(); ++j)
         {
-            l.points[2 * ll + 0] = l.points[2 * ll + 0] * max_src_size;
-            l.points[2 * ll + 1] = l.points[2 * ll + 1] * max_src_size;
+            if (so[j].confidence >= obj_thresh && box_iou(boxes[i], boxes[j]) >= nms_thresh)
+                so[j].confidence = 0;
         }
 
-        auto &b = results[i].bbox;
+        // for src img
+        SparseLandmarks &l = sparse_kps[count];
+        l = face_get_landmark(ctx, p_outputs, so[i].index);
+        for (uint32_t ll = 0; ll < 10; ll++)
+            l.points[ll] = l.points[ll] * max_src_size;
+
+        const Bbox &b = boxes[i];
         float x1 = (b.x + b.w / 2) * max_src_size;
         float x0 = (b.x - b.w / 2) * max_src_size;
         float y0 = (b.y - b.h / 2) * max_src_size;
         float y1 = (b.y + b.h / 2) * max_src_size;
-        x1 = std::max(float(0), std::min(x1, float(frame_size.width)));
-        x0 = std::max(float(0), std::min(x0, float(frame_size.width)));
-        y0 = std::max(float(0), std::min(y0, float(frame_size.height)));
-        y1 = std::max(float(0), std::min(y1, float(frame_size.height)));
-        b.x = x0;
-        b.y = y0;
-        b.w = x1 - x0;
-        b.h = y1 - y0;
+        x1 = std::max(float(0), std::min(x1, float(frame_size->width)));
+        x0 = std::max(float(0), std::min(x0, float(frame_size->width)));
+        y0 = std::max(float(0), std::min(y0, float(frame_size->height)));
+        y1 = std::max(float(0), std::min(y1, float(frame_size->height)));
+        bbox[count].x = x0;
+        bbox[count].y = y0;
+        bbox[count].w = x1 - x0;
+        bbox[count].h = y1 - y0;
+        score[count] = so[i].confidence;
+        count++;
     }
+
+    std::lock_guard<std::mutex> guard(ctx->lock);
+    ctx->idle.push_back(std::move(ws));
+    return count;
 }
 
-FaceDetectionInfoVector* face_detetion_post_process(float obj_thresh,float nms_thresh,int net_len,float* anchors,FrameSize* frame_size,float** p_outputs_)
+int face_det_capacity(FaceDetContext *ctx)
 {
-    int obj_cnt = 0;
-    obj_thresh_ = obj_thresh;
-    nms_thresh_ = nms_thresh;
-    min_size_ = (net_len == 320 ? 200 : 800);
-    objs_num_ = min_size_ * (1 + 4 + 16);
-    so_ = new NMSRoiObj[objs_num_];
-    boxes_ = new float[objs_num_ * LOC_SIZE];
-    landmarks_ = new float[objs_num_ * LAND_SIZE];
-    g_anchors = anchors;
-
-    face_deal_conf(p_outputs_[3], so_, 16 * min_size_ / 2, obj_cnt);
-    face_deal_conf(p_outputs_[4], so_, 4 * min_size_ / 2, obj_cnt);
-    face_deal_conf(p_outputs_[5], so_, 1 * min_size_ / 2, obj_cnt);
-    obj_cnt = 0;
-    face_deal_loc(p_outputs_[0], boxes_, 16 * min_size_ / 2, obj_cnt);
-    face_deal_loc(p_outputs_[1], boxes_, 4 * min_size_ / 2, obj_cnt);
-    face_deal_loc(p_outputs_[2], boxes_, 1 * min_size_ / 2, obj_cnt);
-    obj_cnt = 0;
-    face_deal_landms(p_outputs_[6], landmarks_, 16 * min_size_ / 2, obj_cnt);
-    face_deal_landms(p_outputs_[7], landmarks_, 4 * min_size_ / 2, obj_cnt);
-    face_deal_landms(p_outputs_[8], landmarks_, 1 * min_size_ / 2, obj_cnt);
-    qsort(so_, objs_num_, sizeof(NMSRoiObj), face_nms_comparator);
-
-    vector<FaceDetectionInfo> results;
-    face_get_final_box(*frame_size, results);
-
-    FaceDetectionInfoVector* mp_results = (FaceDetectionInfoVector *)malloc(sizeof(FaceDetectionInfoVector));
-    mp_results->vec_len = results.size();
-    mp_results->bbox = NULL;
-    mp_results->sparse_kps = NULL;
-    mp_results->score = NULL;
-    if(results.size()>0)
-    {
-        mp_results->bbox = (Bbox *)malloc((results.size()) * sizeof(Bbox));
-        mp_results->sparse_kps = (SparseLandmarks *)malloc((results.size()) * sizeof(SparseLandmarks));
-        mp_results->score = (float *)malloc((results.size()) * sizeof(float));
-        for(int ret_i = 0;ret_i <results.size();++ret_i)
-        {
-            (mp_results->bbox + ret_i)->x = results[ret_i].bbox.x;
-            (mp_results->bbox + ret_i)->y = results[ret_i].bbox.y;
-            (mp_results->bbox + ret_i)->w = results[ret_i].bbox.w;
-            (mp_results->bbox + ret_i)->h = results[ret_i].bbox.h;
-            memcpy((mp_results->sparse_kps + ret_i)->points,results[ret_i].sparse_kps.points,sizeof(SparseLandmarks));
-            mp_results->score[ret_i] = results[ret_i].score;
-        }
-    }
-    delete[] so_;
-    delete[] boxes_;
-    delete[] landmarks_;
-
-    return mp_results;
+    return ctx->max_faces;
 }
 
+bool face_det_matches(FaceDetContext *ctx, int net_len, const float *anchors, size_t anchors_len)
+{
+    int min_size = (net_len == 320 ? 200 : 800);
+    return ctx->min_size == min_size && anchors_len >= ctx->anchors.size() &&
+           memcmp(ctx->anchors.data(), anchors, ctx->anchors.size() * sizeof(float)) == 0;
+}
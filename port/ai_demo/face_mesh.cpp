@@ -27,6 +27,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "profiler.h"
 
 using std::vector;
 
@@ -94,6 +95,7 @@ void recon_vers(Bbox& roi_box_lst,float* vertices)
 
 void face_mesh_post_process(Bbox roi,generic_array* p_vertices)
 { 
+    PROF_SCOPE("aidemo.face_mesh_post_process");
     float *p_data = (float*)p_vertices->data_;
     recon_vers(roi, p_data);
 }
@@ -28,6 +28,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "profiler.h"
 
 void from_numpy(cv_and_ndarray_convert_info *info,cv::Mat& mat_data);
 
@@ -90,6 +91,7 @@ void get_affine_matrix_for_osd(Bbox& bbox)
 
 void face_parse_post_process(cv_and_ndarray_convert_info* in_info,FrameSize* ai_img_shape,FrameSize* osd_img_shape,int net_len,Bbox* bbox,CHWSize* model_out_shape,float* p_outputs)
 {
+    PROF_SCOPE("aidemo.face_parse_post_process");
     cv::Mat src_img;
     from_numpy(in_info,src_img);
 
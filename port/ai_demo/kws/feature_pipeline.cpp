@@ -15,92 +15,134 @@
 #include "feature_pipeline.h"
 
 #include <algorithm>
+#include <cstring>
 #include <utility>
 
 namespace wenet {
 
+// ring size in samples, must be a power of two and hold at least one frame
+// plus one shift
+static const int kWavRingSize = 2048;
+// features kept for the consumer, about 2.5s of audio
+static const int kFeatureQueueFrames = 256;
+// largest batch Peek() returns contiguously
+static const int kMaxReadFrames = 64;
+
 FeaturePipeline::FeaturePipeline()
     : feature_dim_(40),
       fbank_(40, 16000, 400,
              160),
+      feature_queue_(kFeatureQueueFrames, 40, kMaxReadFrames),
       num_frames_(0),
-      input_finished_(false) {
-        std::vector<float> remain_wav_init(320, 0.0f);
-        remained_wav_ = remain_wav_init;
-      }
-
-void FeaturePipeline::AcceptWaveform(const std::vector<float>& wav) {
-  std::vector<std::vector<float>> feats;
-  std::vector<float> waves;
-  waves.insert(waves.end(), remained_wav_.begin(), remained_wav_.end());
-  waves.insert(waves.end(), wav.begin(), wav.end());
-  int num_frames = fbank_.Compute(waves, &feats);
-
-  // std::cout << "==========num_frame_per_chunk:" << num_frames << "===========" << std::endl;
+      input_finished_(false),
+      wav_ring_(kWavRingSize, 0.0f),
+      wav_read_(0),
+      wav_write_(320),
+      frame_(400),
+      consumer_waiting_(false) {
+  // start with 320 zero samples, the first chunk then yields whole frames
+  CHECK(kWavRingSize >= fbank_.frame_length() + fbank_.frame_shift());
+}
 
+void FeaturePipeline::Notify() {
+  // Pairs with the fence in Peek(): the producer publishes frames (or
+  // input_finished_) and then reads consumer_waiting_, the consumer sets
+  // consumer_waiting_ and then reads the queue. With a full fence between
+  // the store and the load on both sides, either the consumer sees the new
+  // frames or we see it waiting.
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (consumer_waiting_.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    finish_condition_.notify_one();
+  }
+}
 
-  for (size_t i = 0; i < feats.size(); ++i) {
-    feature_queue_.Push(std::move(feats[i]));
+void FeaturePipeline::AcceptWaveform(const float* wav, size_t num_samples) {
+  const int frame_length = fbank_.frame_length();
+  const int frame_shift = fbank_.frame_shift();
+  const size_t mask = kWavRingSize - 1;
+  int num_frames = 0;
+  while (num_samples > 0) {
+    // fill the ring as far as it goes, then drain whole frames
+    size_t space = kWavRingSize - (wav_write_ - wav_read_);
+    size_t n = std::min(space, num_samples);
+    size_t pos = wav_write_ & mask;
+    size_t first = std::min(n, kWavRingSize - pos);
+    memcpy(wav_ring_.data() + pos, wav, sizeof(float) * first);
+    memcpy(wav_ring_.data(), wav + first, sizeof(float) * (n - first));
+    wav_write_ += n;
+    wav += n;
+    num_samples -= n;
+
+    while (wav_write_ - wav_read_ >= (size_t)frame_length) {
+      pos = wav_read_ & mask;
+      first = std::min((size_t)frame_length, kWavRingSize - pos);
+      memcpy(frame_.data(), wav_ring_.data() + pos, sizeof(float) * first);
+      memcpy(frame_.data() + first, wav_ring_.data(),
+             sizeof(float) * (frame_length - first));
+      float* feat = feature_queue_.BeginPush();
+      if (feat != nullptr) {
+        fbank_.ComputeFrame(frame_.data(), feat);
+        feature_queue_.EndPush();
+      }
+      wav_read_ += frame_shift;
+      num_frames++;
+    }
   }
   num_frames_ += num_frames;
 
-  // int left_samples = waves.size() - config_.frame_shift * num_frames;
-  int left_samples = waves.size() - 160 * num_frames;
-
-  // std::cout << "==========left_samples_per_chunk:" << left_samples << "===========" << std::endl;
-
-
-  remained_wav_.resize(left_samples);
-  // std::copy(waves.begin() + config_.frame_shift * num_frames, waves.end(),
-  //           remained_wav_.begin());
-  std::copy(waves.begin() + 160 * num_frames, waves.end(),
-            remained_wav_.begin());
-
   // We are still adding wave, notify input is not finished
-  finish_condition_.notify_one();
+  Notify();
 }
 
-void FeaturePipeline::AcceptWaveform(const std::vector<int16_t>& wav) {
-  std::vector<float> float_wav(wav.size());
-  for (size_t i = 0; i < wav.size(); i++) {
-    float_wav[i] = static_cast<float>(wav[i]);
+void FeaturePipeline::AcceptWaveform(const int16_t* wav, size_t num_samples) {
+  // convert through a small stack buffer instead of a temporary vector
+  float float_wav[256];
+  while (num_samples > 0) {
+    size_t n = std::min(num_samples, sizeof(float_wav) / sizeof(float_wav[0]));
+    for (size_t i = 0; i < n; i++) {
+      float_wav[i] = static_cast<float>(wav[i]);
+    }
+    this->AcceptWaveform(float_wav, n);
+    wav += n;
+    num_samples -= n;
   }
-  this->AcceptWaveform(float_wav);
 }
 
 void FeaturePipeline::set_input_finished() {
   CHECK(!input_finished_);
-  {
-    std::lock_guard<std::mutex> lock(mutex_);
-    input_finished_ = true;
-  }
-  finish_condition_.notify_one();
+  input_finished_.store(true, std::memory_order_release);
+  Notify();
+}
+
+const float* FeaturePipeline::Peek(int num_frames, bool wait) {
+  if (num_frames > feature_queue_.max_batch()) return nullptr;
+  const float* feats = feature_queue_.Peek(num_frames);
+  if (feats != nullptr || !wait) return feats;
+
+  std::unique_lock<std::mutex> lock(mutex_);
+  consumer_waiting_.store(true, std::memory_order_relaxed);
+  // Order the store above before the queue check in the predicate, see
+  // Notify()
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  // This will release the lock and wait for notify_one()
+  // from AcceptWaveform() or set_input_finished()
+  finish_condition_.wait(lock, [&] {
+    feats = feature_queue_.Peek(num_frames);
+    return feats != nullptr || input_finished_.load(std::memory_order_acquire);
+  });
+  consumer_waiting_.store(false, std::memory_order_relaxed);
+  // Double check the queue, see issue#893 for detailed discussions.
+  if (feats == nullptr) feats = feature_queue_.Peek(num_frames);
+  return feats;
 }
 
 bool FeaturePipeline::ReadOne(std::vector<float>* feat) {
-  if (!feature_queue_.Empty()) {
-    *feat = std::move(feature_queue_.Pop());
-    return true;
-  } else {
-    std::unique_lock<std::mutex> lock(mutex_);
-    while (!input_finished_) {
-      // This will release the lock and wait for notify_one()
-      // from AcceptWaveform() or set_input_finished()
-      finish_condition_.wait(lock);
-      if (!feature_queue_.Empty()) {
-        *feat = std::move(feature_queue_.Pop());
-        return true;
-      }
-    }
-    CHECK(input_finished_);
-    // Double check queue.empty, see issue#893 for detailed discussions.
-    if (!feature_queue_.Empty()) {
-      *feat = std::move(feature_queue_.Pop());
-      return true;
-    } else {
-      return false;
-    }
-  }
+  const float* frame = Peek(1);
+  if (frame == nullptr) return false;
+  feat->assign(frame, frame + feature_dim_);
+  Consume(1);
+  return true;
 }
 
 bool FeaturePipeline::Read(int num_frames,
@@ -117,10 +159,25 @@ bool FeaturePipeline::Read(int num_frames,
   return true;
 }
 
+bool FeaturePipeline::Read(int num_frames, float* feats) {
+  while (num_frames > 0) {
+    int n = std::min(num_frames, max_read_frames());
+    const float* block = Peek(n);
+    if (block == nullptr) return false;
+    memcpy(feats, block, sizeof(float) * n * feature_dim_);
+    Consume(n);
+    feats += n * feature_dim_;
+    num_frames -= n;
+  }
+  return true;
+}
+
+// Call only when neither thread is inside AcceptWaveform()/Read()
 void FeaturePipeline::Reset() {
   input_finished_ = false;
   num_frames_ = 0;
-  remained_wav_.clear();
+  wav_read_ = 0;
+  wav_write_ = 0;
   feature_queue_.Clear();
 }
 
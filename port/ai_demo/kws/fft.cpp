@@ -118,4 +118,35 @@ int fft(const int* bitrev, const float* sintbl, float* x, float* y, int n) {
   return 0; /* finished successfully */
 }
 
+void make_rfft_twiddle(int n, float* twiddle) {
+  for (int k = 0; k < n / 2; ++k) {
+    twiddle[2 * k] = cos(M_2PI * k / n);
+    twiddle[2 * k + 1] = sin(M_2PI * k / n);
+  }
+}
+
+void rfft_power(const int* bitrev, const float* sintbl, const float* twiddle,
+                const float* x, float* re, float* im, float* power, int n) {
+  int m = n / 2;
+  for (int i = 0; i < m; ++i) {
+    re[i] = x[2 * i];
+    im[i] = x[2 * i + 1];
+  }
+  fft(bitrev, sintbl, re, im, m);
+
+  // X[k] = E[k] + exp(-2*pi*i*k/n) * O[k], where E/O are the spectra of the
+  // even/odd samples, recovered from Z[k] and conj(Z[m - k])
+  for (int k = 0; k < m; ++k) {
+    int j = (m - k) & (m - 1);
+    float er = 0.5f * (re[k] + re[j]);
+    float ei = 0.5f * (im[k] - im[j]);
+    float orr = 0.5f * (im[k] + im[j]);
+    float oi = -0.5f * (re[k] - re[j]);
+    float c = twiddle[2 * k], s = twiddle[2 * k + 1];
+    float xr = er + c * orr + s * oi;
+    float xi = ei + c * oi - s * orr;
+    power[k] = xr * xr + xi * xi;
+  }
+}
+
 }  // namespace wenet
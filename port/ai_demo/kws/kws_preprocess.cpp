@@ -1,6 +1,7 @@
 #include "feature_pipeline.h"
 #include "aidemo_wrap.h"
 #include <iostream>
+#include "profiler.h"
 
 // feature_pipelien class
 struct feature_pipeline
@@ -31,27 +32,17 @@ void release_final_feats(float* feats)
 
 void release_preprocess_class(feature_pipeline *fp)
 {
+    delete fp->feature_pipe;
     delete fp;
 }
 
 
 void wav_preprocess(feature_pipeline *fp, float *wav, size_t wav_length, float* final_feats)
 {
-    // 将数组输入转为vector适配函数输入
-    std::vector<float> wav_vector(wav, wav + wav_length);
-
-    // 预处理函数
-    fp->feature_pipe->AcceptWaveform(wav_vector);
-
-    std::vector<std::vector<float>> feats;
-    bool ok = fp->feature_pipe->Read(30, &feats);
-    
-    // 将vector转换为数组形式，因为C返回不了vector
-    std::vector<float> flattened_feats;
-    for (const auto& inner_vector : feats) 
-    {
-        flattened_feats.insert(flattened_feats.end(), inner_vector.begin(), inner_vector.end());
-    }
+    PROF_SCOPE("aidemo.kws_preprocess");
+    // 预处理，特征直接写入队列，不再经过临时 vector
+    fp->feature_pipe->AcceptWaveform(wav, wav_length);
 
-    std::copy(flattened_feats.begin(), flattened_feats.end(), final_feats);
-}
\ No newline at end of file
+    // 30帧特征按顺序拷贝到 final_feats
+    fp->feature_pipe->Read(30, final_feats);
+}
@@ -27,20 +27,16 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "nms.h"
 
 #include <stdlib.h>
 #include <iostream>
+#include "profiler.h"
 
 #define LOC_SIZE  4
 #define CONF_SIZE 2
 #define LAND_SIZE 8
 
-typedef struct sortable_obj_t
-{
-	int index;
-	float* probs;
-} sortable_obj_t;
-
 typedef struct landmarks_t
 {
 	float points[8];
@@ -53,19 +49,6 @@ typedef struct BoxPoint
 
 extern float anchors[16800][4];
 
-int nms_comparator(const void *pa, const void *pb)
-{
-	sortable_obj_t a = *(sortable_obj_t*)pa;
-	sortable_obj_t b = *(sortable_obj_t*)pb;
-	float diff = a.probs[a.index] - b.probs[b.index];
-
-	if (diff < 0)
-		return 1;
-	else if (diff > 0)
-		return -1;
-	return 0;
-}
-
 int argmax(float* x, uint32_t len)
 {
 	float max_value = x[0];
@@ -107,7 +90,7 @@ void local_softmax(float* x, float* dx, uint32_t len)
 	}
 }
 
-void deal_conf(float* conf, float* s_probs, sortable_obj_t* s, int size, int& obj_cnt)
+void deal_conf(float* conf, float* s_probs, int size, int& obj_cnt)
 {
 	float prob[CONF_SIZE] = { 0.0 };
 	for (uint32_t ww = 0; ww < size; ww++)
@@ -119,7 +102,6 @@ void deal_conf(float* conf, float* s_probs, sortable_obj_t* s, int size, int& ob
 				prob[cc] = conf[(hh * CONF_SIZE + cc) * size + ww];
 			}
 			local_softmax(prob, prob, 2);
-			s[obj_cnt].index = obj_cnt;
 			s_probs[obj_cnt] = prob[1];
 			obj_cnt += 1;
 		}
@@ -224,6 +206,7 @@ float box_iou(Bbox a, Bbox b)
 
 BoxPoint8* licence_det_post_process(float* p_outputs_0,float* p_outputs_1,float* p_outputs_2,float* p_outputs_3,float* p_outputs_4,float* p_outputs_5,float* p_outputs_6,float* p_outputs_7,float* p_outputs_8,FrameSize frame_size,FrameSize kmodel_frame_size,float obj_thresh,float nms_thresh,int* box_cnt)
 {
+    PROF_SCOPE("aidemo.licence_det_postprocess");
     std::vector<BoxPoint> results;
     float* loc0 = p_outputs_0;
     float* loc1 = p_outputs_1;
@@ -240,12 +223,11 @@ BoxPoint8* licence_det_post_process(float* p_outputs_0,float* p_outputs_1,float*
     float box[LOC_SIZE] = { 0.0 };
 	float landms[LAND_SIZE] = { 0.0 };
 	int objs_num = min_size * (1 + 4 + 16);
-	sortable_obj_t* s = (sortable_obj_t*)malloc(objs_num * sizeof(sortable_obj_t));
 	float* s_probs = (float*)malloc(objs_num * sizeof(float));
 	int obj_cnt = 0;
-	deal_conf(conf0, s_probs, s, 16 * min_size / 2, obj_cnt);
-	deal_conf(conf1, s_probs, s, 4 * min_size / 2, obj_cnt);
-	deal_conf(conf2, s_probs, s, 1 * min_size / 2, obj_cnt);
+	deal_conf(conf0, s_probs, 16 * min_size / 2, obj_cnt);
+	deal_conf(conf1, s_probs, 4 * min_size / 2, obj_cnt);
+	deal_conf(conf2, s_probs, 1 * min_size / 2, obj_cnt);
 	float* boxes = (float*)malloc(objs_num * LOC_SIZE * sizeof(float));
 	obj_cnt = 0;
 	deal_loc(loc0, boxes, 16 * min_size / 2, obj_cnt);
@@ -256,36 +238,27 @@ BoxPoint8* licence_det_post_process(float* p_outputs_0,float* p_outputs_1,float*
 	deal_landms(landms0, landmarks, 16 * min_size / 2, obj_cnt);
 	deal_landms(landms1, landmarks, 4 * min_size / 2, obj_cnt);
 	deal_landms(landms2, landmarks, 1 * min_size / 2, obj_cnt);
-	for (uint32_t oo = 0; oo < objs_num; oo++)
+
+	std::vector<int> candidates;
+	std::vector<NmsBox> nms_boxes;
+	std::vector<float> scores;
+	for (int i = 0; i < objs_num; ++i)
 	{
-		s[oo].probs = s_probs;
+		if (s_probs[i] < obj_thresh)
+			continue;
+		Bbox a = get_box(boxes, i);
+		candidates.push_back(i);
+		nms_boxes.push_back({ a.x - a.w / 2, a.y - a.h / 2, a.x + a.w / 2, a.y + a.h / 2 });
+		scores.push_back(s_probs[i]);
 	}
-	qsort(s, objs_num, sizeof(sortable_obj_t), nms_comparator);
 
-	std::vector<Bbox> valid_box;
+	std::vector<int> keep;
+	nms_select(nms_boxes, scores, NULL, nms_default_config(nms_thresh), keep);
+
 	std::vector<landmarks_t> valid_landmarks;
-	int iou_cal_times = 0;
-	int i, j, k, obj_index;
-	for (i = 0; i < objs_num; ++i)
+	for (int i : keep)
 	{
-		obj_index = s[i].index;
-		if (s_probs[obj_index] < obj_thresh)
-			continue;
-		Bbox a = get_box(boxes, obj_index);
-		landmarks_t l = get_landmark(landmarks, obj_index);
-		valid_box.push_back(a);
-		valid_landmarks.push_back(l);
-
-		for (j = i + 1; j < objs_num; ++j)
-		{
-			obj_index = s[j].index;
-			if (s_probs[obj_index] < obj_thresh)
-				continue;
-			Bbox b = get_box(boxes, obj_index);
-			iou_cal_times += 1;
-			if (box_iou(a, b) >= nms_thresh)
-				s_probs[obj_index] = 0;
-		}
+		valid_landmarks.push_back(get_landmark(landmarks, candidates[i]));
 	}
 
     *box_cnt = valid_landmarks.size();
@@ -305,6 +278,5 @@ BoxPoint8* licence_det_post_process(float* p_outputs_0,float* p_outputs_1,float*
     free(s_probs);
 	free(boxes);
 	free(landmarks);
-	free(s);
     return boxPoint;
 }
\ No newline at end of file
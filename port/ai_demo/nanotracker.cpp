@@ -31,6 +31,7 @@
 
 #include <stdlib.h>
 #include <iostream>
+#include "profiler.h"
 
 #define OUTPUT_1_SIZE 2  // 两个输出，与points变量联系
 #define WINDOW_INFLUENCE 0.46  // 框作用范围系数
@@ -205,6 +206,7 @@ void track_post_process(float* score, float* box, int cols,int rows, int& box_x,
 
 Tracker_box_center nanotracker_post_process(float* output_0, float* output_1, FrameSize sensor_size, float thresh, float* center_xy_wh, int crop_size, float CONTEXT_AMOUNT)
 {
+    PROF_SCOPE("aidemo.nanotracker_postprocess");
 	center[0] = center_xy_wh[0];
     center[1] = center_xy_wh[1];
     rect_size[0] = center_xy_wh[2];
@@ -27,27 +27,17 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "nms.h"
 
 #include <stdlib.h>
 #include <iostream>
-#include <unistd.h>
+#include <math.h>
+#include <string.h>
+#include "profiler.h"
 
 #define SEGCHANNELS 32
 #define CLASSES_COUNT 80
 
-typedef struct {
-	cv::Rect box;
-	float confidence;
-	int index;
-}BBOX;
-
-struct OutputSeg {
-	int id;             //结果类别id
-	float confidence;   //结果置信度
-	cv::Rect box;       //矩形框
-	cv::Mat boxMask;       //矩形框内mask，节省内存空间和加快速度
-};
-
 const std::vector<cv::Scalar> color_four = {cv::Scalar(127, 220, 20, 60),
        cv::Scalar(127, 119, 11, 32),
        cv::Scalar(127, 0, 0, 142),
@@ -129,90 +119,35 @@ const std::vector<cv::Scalar> color_four = {cv::Scalar(127, 220, 20, 60),
        cv::Scalar(127, 246, 0, 122),
        cv::Scalar(127, 191, 162, 208)};
 
-float get_iou_value(cv::Rect rect1, cv::Rect rect2)
-{
-	int xx1, yy1, xx2, yy2;
- 
-	xx1 = std::max(rect1.x, rect2.x);
-	yy1 = std::max(rect1.y, rect2.y);
-	xx2 = std::min(rect1.x + rect1.width - 1, rect2.x + rect2.width - 1);
-	yy2 = std::min(rect1.y + rect1.height - 1, rect2.y + rect2.height - 1);
- 
-	int insection_width, insection_height;
-	insection_width = std::max(0, xx2 - xx1 + 1);
-	insection_height = std::max(0, yy2 - yy1 + 1);
- 
-	float insection_area, union_area, iou;
-	insection_area = float(insection_width) * insection_height;
-	union_area = float(rect1.width*rect1.height + rect2.width*rect2.height - insection_area);
-	iou = insection_area / union_area;
-
-	return iou;
-}
-
 void nms_boxes(std::vector<cv::Rect> &boxes, std::vector<float> &confidences, float confThreshold, float nmsThreshold, std::vector<int> &indices)
-{	
-	BBOX bbox;
-	std::vector<BBOX> bboxes;
-	int i, j;
-	for (i = 0; i < boxes.size(); i++)
+{
+	int n = boxes.size();
+	std::vector<NmsBox> rects(n);
+	for (int i = 0; i < n; i++)
 	{
-		bbox.box = boxes[i];
-		bbox.confidence = confidences[i];
-		bbox.index = i;
-		bboxes.push_back(bbox);
+		rects[i] = { float(boxes[i].x), float(boxes[i].y), float(boxes[i].x + boxes[i].width), float(boxes[i].y + boxes[i].height) };
 	}
 
-	sort(bboxes.begin(), bboxes.end(), [](BBOX a, BBOX b) { return a.confidence < b.confidence; });
-
-	int updated_size = bboxes.size();
-	for (i = 0; i < updated_size; i++)
-	{
-		if (bboxes[i].confidence < confThreshold)
-			continue;
-		indices.push_back(bboxes[i].index);
-
-		for (j = i + 1; j < updated_size;)
-		{
-			float iou = get_iou_value(bboxes[i].box, bboxes[j].box);
-
-			if (iou > nmsThreshold)
-			{
-				bboxes.erase(bboxes.begin() + j);
-				updated_size = bboxes.size();
-			}
-            else
-            {
-                j++;    
-            }
-		}
-	}
+	NmsConfig cfg = nms_default_config(nmsThreshold);
+	cfg.score_thresh = confThreshold;
+	nms_select(rects, confidences, NULL, cfg, indices);
 }
 
 
 
-void draw_segmentation(cv::Mat& frame,std::vector<OutputSeg>& results)
+// 把display上的一个坐标映射到原型mask(segWidth*segHeight)上，和 roi 裁剪后 INTER_NEAREST 缩放到display一致
+static void seg_build_map(std::vector<int> &map, int display_len, int roi_start, int roi_len)
 {
-
-	for (int i = 0; i < results.size(); i++) {
-		int left, top;
-		left = results[i].box.x;
-		top = results[i].box.y;
-		int color_num = i;
-		rectangle(frame, results[i].box, color_four[results[i].id], 2, 8);
-		
-		frame(results[i].box).setTo(color_four[results[i].id], results[i].boxMask);
-	}
+	map.resize(display_len);
+	double scale = (double)roi_len / display_len;
+	for (int i = 0; i < display_len; i++)
+		map[i] = roi_start + std::min((int)floor(i * scale), roi_len - 1);
 }
 
-
-SegOutputs object_seg_post_process(float *data_0, float *data_1, FrameSize frame_size, FrameSize kmodel_frame_size, FrameSize display_frame_size, float conf_thres, float nms_thres, float mask_thres, int *box_cnt)
+int object_seg_post_process(float *data_0, float *data_1, FrameSize frame_size, FrameSize kmodel_frame_size, FrameSize display_frame_size, float conf_thres, float nms_thres, float mask_thres, uint8_t *osd, SegOutput **seg_outputs)
 {
-	std::vector<OutputSeg> results;
-    float *output_0 = data_0;
-    float *output_1 = data_1;
-
-    int w, h, x, y;
+	PROF_SCOPE("aidemo.segment_postprocess");
+	int w, h, x, y;
 	float r_w = kmodel_frame_size.width / (frame_size.width*1.0);
 	float r_h = kmodel_frame_size.height / (frame_size.height*1.0);
 	if (r_h > r_w) {
@@ -228,115 +163,134 @@ SegOutputs object_seg_post_process(float *data_0, float *data_1, FrameSize frame
 		y = 0;
 	}
 
-    int newh = h, neww = w, padh = y, padw = x;
+	int newh = h, neww = w, padh = y, padw = x;
 	float ratio_h = (float)frame_size.height / newh;
 	float ratio_w = (float)frame_size.width / neww;
 
-    std::vector<int> classIds;//结果id数组
-	std::vector<float> confidences;//结果每个id对应置信度数组
-	std::vector<cv::Rect> boxes;//每个id矩形框
-	std::vector<cv::Mat> picked_proposals;  //后续计算mask
-
-
-	// 处理box
+	// 输出是1*net_length*Num_box，第c行是所有box的第c个属性
 	int Num_box = (kmodel_frame_size.width/8) * (kmodel_frame_size.height/8) + (kmodel_frame_size.width/16) * (kmodel_frame_size.height/16) + (kmodel_frame_size.width/32) * (kmodel_frame_size.height/32);
-	int net_length = CLASSES_COUNT + 4 + SEGCHANNELS;
-	cv::Mat out1 = cv::Mat(net_length, Num_box, CV_32F, output_0);
+	const float *out = data_0;
 
-	for (int i = 0; i < Num_box; i++) {
-		//输出是1*net_length*Num_box;所以每个box的属性是每隔Num_box取一个值，共net_length个值
-		cv::Mat scores = out1(cv::Rect(i, 4, 1, CLASSES_COUNT)).clone();
-		cv::Point classIdPoint;
-		double max_class_socre;
-		minMaxLoc(scores, 0, &max_class_socre, 0, &classIdPoint);
-		max_class_socre = (float)max_class_socre;
-		if (max_class_socre >= conf_thres) {
-			cv::Mat temp_proto = out1(cv::Rect(i, 4 + CLASSES_COUNT, 1, SEGCHANNELS)).clone();
-			picked_proposals.push_back(temp_proto.t());
-			float x = (out1.at<float>(0, i) - padw) * ratio_w * display_frame_size.width / frame_size.width;  //cx
-			float y = (out1.at<float>(1, i) - padh) * ratio_h * display_frame_size.height / frame_size.height;  //cy
-			float w = out1.at<float>(2, i) * ratio_w * display_frame_size.width / frame_size.width;  //w
-			float h = out1.at<float>(3, i) * ratio_h * display_frame_size.height / frame_size.height;  //h
-			int left = MAX((x - 0.5 * w), 0);
-			int top = MAX((y - 0.5 * h), 0);
-			int width = (int)w;
-			int height = (int)h;
-			if (width <= 0 || height <= 0) { continue; }
-
-			classIds.push_back(classIdPoint.y);
-			confidences.push_back(max_class_socre);
-			boxes.push_back(cv::Rect(left, top, width, height));
+	// 按行扫描类别分数求每个box的最大类别，每行连续读取，整个输出头只读一遍
+	std::vector<float> max_score(out + 4 * Num_box, out + 5 * Num_box);
+	std::vector<int> max_id(Num_box, 0);
+	for (int c = 1; c < CLASSES_COUNT; c++)
+	{
+		const float *row = out + (4 + c) * Num_box;
+		for (int i = 0; i < Num_box; i++)
+		{
+			if (row[i] > max_score[i])
+			{
+				max_score[i] = row[i];
+				max_id[i] = c;
+			}
 		}
+	}
 
+	std::vector<int> anchor;            // 候选框在输出中的下标
+	std::vector<int> classIds;          // 结果id数组
+	std::vector<float> confidences;     // 结果每个id对应置信度数组
+	std::vector<cv::Rect> boxes;        // 每个id矩形框
+	for (int i = 0; i < Num_box; i++)
+	{
+		if (max_score[i] < conf_thres)
+			continue;
+		float cx = (out[i] - padw) * ratio_w * display_frame_size.width / frame_size.width;
+		float cy = (out[Num_box + i] - padh) * ratio_h * display_frame_size.height / frame_size.height;
+		float bw = out[2 * Num_box + i] * ratio_w * display_frame_size.width / frame_size.width;
+		float bh = out[3 * Num_box + i] * ratio_h * display_frame_size.height / frame_size.height;
+		int left = MAX((cx - 0.5 * bw), 0);
+		int top = MAX((cy - 0.5 * bh), 0);
+		int width = (int)bw;
+		int height = (int)bh;
+		if (width <= 0 || height <= 0)
+			continue;
+		anchor.push_back(i);
+		classIds.push_back(max_id[i]);
+		confidences.push_back(max_score[i]);
+		boxes.push_back(cv::Rect(left, top, width, height));
 	}
 
 	//执行非最大抑制以消除具有较低置信度的冗余重叠框（NMS）
 	std::vector<int> nms_result;
 	nms_boxes(boxes, confidences, conf_thres, nms_thres, nms_result);
 
-	std::vector<cv::Mat> temp_mask_proposals;
-	std::vector<OutputSeg> output;
+	// 直接画到调用者的OSD缓冲区
+	cv::Mat osd_frame(display_frame_size.height, display_frame_size.width, CV_8UC4, osd);
+	osd_frame.setTo(cv::Scalar(0, 0, 0, 0));
+
+	int box_cnt = nms_result.size();
+	*seg_outputs = (SegOutput *)malloc(box_cnt * sizeof(SegOutput));
+	if (box_cnt == 0)
+		return 0;
+
+	// 原型mask去掉letterbox填充的区域，再最近邻缩放到display，这里只建立坐标映射
+	int segWidth = kmodel_frame_size.width/4;
+	int segHeight = kmodel_frame_size.height/4;
+	cv::Rect roi(int((float)padw / kmodel_frame_size.width * segWidth), int((float)padh / kmodel_frame_size.height * segHeight), int(segWidth - padw / 2), int(segHeight - padh / 2));
+	std::vector<int> map_x, map_y;
+	seg_build_map(map_x, display_frame_size.width, roi.x, roi.width);
+	seg_build_map(map_y, display_frame_size.height, roi.y, roi.height);
+
+	// sigmoid(v) > mask_thres 等价于 v > logit(mask_thres)，不用对每个点求exp
+	float logit_thres;
+	if (mask_thres <= 0.f)
+		logit_thres = -INFINITY;
+	else if (mask_thres >= 1.f)
+		logit_thres = INFINITY;
+	else
+		logit_thres = logf(mask_thres / (1.f - mask_thres));
+
+	std::vector<float> logits(segWidth * segHeight);
+	float coef[SEGCHANNELS];
 	cv::Rect holeImgRect(0, 0, display_frame_size.width, display_frame_size.height);
-	for (int i = 0; i < nms_result.size(); ++i) {
-		int idx = nms_result[i];
-		OutputSeg result;
+	for (int n = 0; n < box_cnt; n++)
+	{
+		int idx = nms_result[n];
+		cv::Rect box = boxes[idx] & holeImgRect;
+		SegOutput &result = (*seg_outputs)[n];
 		result.id = classIds[idx];
 		result.confidence = confidences[idx];
-		result.box = boxes[idx]& holeImgRect;
-		output.push_back(result);
-		temp_mask_proposals.push_back(picked_proposals[idx]);
-	}
+		result.box[0] = box.x;
+		result.box[1] = box.y;
+		result.box[2] = box.width;
+		result.box[3] = box.height;
+
+		const cv::Scalar &color = color_four[result.id];
+		rectangle(osd_frame, box, color, 2, 8);
+		if (box.width <= 0 || box.height <= 0)
+			continue;
 
-	// 处理mask
-	int segWidth = kmodel_frame_size.width/4;
-    int segHeight = kmodel_frame_size.height/4;
-	if(temp_mask_proposals.size() > 0)
-	{	cv::Mat maskProposals;
-		for (int i = 0; i < temp_mask_proposals.size(); ++i)
+		// 框在原型mask上覆盖的范围，只在这个范围内做系数和原型的乘加
+		int px0 = map_x[box.x], px1 = map_x[box.x + box.width - 1];
+		int py0 = map_y[box.y], py1 = map_y[box.y + box.height - 1];
+		int fw = px1 - px0 + 1, fh = py1 - py0 + 1;
+		for (int k = 0; k < SEGCHANNELS; k++)
+			coef[k] = out[(4 + CLASSES_COUNT + k) * Num_box + anchor[idx]];
+		std::fill(logits.begin(), logits.begin() + fw * fh, 0.f);
+		for (int k = 0; k < SEGCHANNELS; k++)
 		{
-			maskProposals.push_back(temp_mask_proposals[i]);
+			const float *proto = data_1 + k * segWidth * segHeight;
+			for (int py = 0; py < fh; py++)
+			{
+				const float *src = proto + (py0 + py) * segWidth + px0;
+				float *dst = logits.data() + py * fw;
+				for (int px = 0; px < fw; px++)
+					dst[px] += coef[k] * src[px];
+			}
 		}
 
-		cv::Mat protos = cv::Mat(SEGCHANNELS, segWidth * segHeight, CV_32FC1, output_1);
-		sync();
-		cv::Mat matmulRes = (maskProposals * protos).t();//n*32 32*25600 A*B是以数学运算中矩阵相乘的方式实现的，要求A的列数等于B的行数时
-		cv::Mat masks = matmulRes.reshape(output.size(), { segWidth,segHeight });//n*160*160
-
-		std::vector<cv::Mat> maskChannels;
-		cv::split(masks, maskChannels);
-		cv::Rect roi(int((float)padw / kmodel_frame_size.width * segWidth), int((float)padh / kmodel_frame_size.height * segHeight), int(segWidth - padw / 2), int(segHeight - padh / 2));
-
-		for (int i = 0; i < output.size(); ++i) {
-			cv::Mat dest, mask;
-			cv::exp(-maskChannels[i], dest);//sigmoid
-			dest = 1.0 / (1.0 + dest);//160*160
-			dest = dest(roi);
-			resize(dest, mask, cv::Size(display_frame_size.width, display_frame_size.height), cv::INTER_NEAREST);
-			//crop----截取box中的mask作为该box对应的mask
-			cv::Rect temp_rect = output[i].box;
-			mask = mask(temp_rect) > mask_thres;
-			output[i].boxMask = mask;
+		uint8_t c[4] = {cv::saturate_cast<uint8_t>(color[0]), cv::saturate_cast<uint8_t>(color[1]), cv::saturate_cast<uint8_t>(color[2]), cv::saturate_cast<uint8_t>(color[3])};
+		for (int dy = box.y; dy < box.y + box.height; dy++)
+		{
+			const float *row = logits.data() + (map_y[dy] - py0) * fw;
+			uint8_t *pixel = osd_frame.ptr<uint8_t>(dy) + box.x * 4;
+			for (int dx = box.x; dx < box.x + box.width; dx++, pixel += 4)
+			{
+				if (row[map_x[dx] - px0] > logit_thres)
+					memcpy(pixel, c, 4);
+			}
 		}
-		results=output;
 	}
-	cv::Mat osd_frame(display_frame_size.height, display_frame_size.width, CV_8UC4, cv::Scalar(0, 0, 0, 0));
-	draw_segmentation(osd_frame, results);
-
-
-	SegOutputs segOutputs;
-	segOutputs.masks_results = (uint8_t *)malloc(display_frame_size.width * display_frame_size.height * 4 * sizeof(uint8_t));
-    memcpy(segOutputs.masks_results, osd_frame.data, sizeof(uint8_t) * display_frame_size.width * display_frame_size.height * 4 );
-	*box_cnt = results.size();
-	segOutputs.segOutput = (SegOutput *)malloc(*box_cnt * sizeof(SegOutput));
-	for (int i = 0; i < *box_cnt; i++)
-	{
-		segOutputs.segOutput[i].confidence = results[i].confidence;
-		segOutputs.segOutput[i].id = results[i].id;
-		segOutputs.segOutput[i].box[0] = results[i].box.x;
-		segOutputs.segOutput[i].box[1] = results[i].box.y;
-		segOutputs.segOutput[i].box[2] = results[i].box.width;
-		segOutputs.segOutput[i].box[3] = results[i].box.height;
-	}
-
-	return segOutputs;
-}
\ No newline at end of file
+	return box_cnt;
+}
@@ -26,6 +26,7 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "profiler.h"
 
 typedef struct BoxPoint
 {
@@ -98,24 +99,32 @@ void find_rectangle_vertices_(const std::vector<cv::Point2f>& points, cv::Point2
 	
 }
 
-void warppersp_(cv::Mat src, cv::Mat& dst, BoxPoint b, std::vector<cv::Point2f>& vtd)
+// 取检测框的最小外接矩形，按左上、右上、右下、左下排列顶点，返回长边w和短边h
+static void rect_vertices_(BoxPoint b, std::vector<cv::Point2f>& vtd, float& w, float& h)
 {
-    cv::Mat rotation;
     std::vector<cv::Point> con;
     for(auto i : b.vertices)
         con.push_back(i);
 
     cv::RotatedRect minrect = minAreaRect(con);
-    std::vector<cv::Point2f> vtx(4),vt(4);
+    std::vector<cv::Point2f> vtx(4);
     minrect.points(vtx.data());
 
     find_rectangle_vertices_(vtx, vtd[0], vtd[1], vtd[2], vtd[3]);
-    
+
     //w,h tmp_w=dist(p1,p0),tmp_h=dist(p1,p2)
     float tmp_w = cv::norm(vtd[1]-vtd[0]);
     float tmp_h = cv::norm(vtd[2]-vtd[1]);
-    float w = std::max(tmp_w,tmp_h);
-    float h = std::min(tmp_w,tmp_h);
+    w = std::max(tmp_w,tmp_h);
+    h = std::min(tmp_w,tmp_h);
+}
+
+void warppersp_(cv::Mat src, cv::Mat& dst, BoxPoint b, std::vector<cv::Point2f>& vtd)
+{
+    cv::Mat rotation;
+    std::vector<cv::Point2f> vt(4);
+    float w, h;
+    rect_vertices_(b, vtd, w, h);
 
     vt[0].x = 0;
     vt[0].y = 0;
@@ -132,6 +141,7 @@ void warppersp_(cv::Mat src, cv::Mat& dst, BoxPoint b, std::vector<cv::Point2f>&
 
 ArrayWrapperMat1* ocr_rec_pre_process(uint8_t* data, FrameSize ori_shape, BoxPoint8* boxpoint8, int box_cnt)
 {
+    PROF_SCOPE("aidemo.ocr_rec_preprocess");
     int matsize = ori_shape.width * ori_shape.height;
     cv::Mat ori_img;
     cv::Mat ori_img_R = cv::Mat(ori_shape.height, ori_shape.width, CV_8UC1, data);
@@ -176,4 +186,51 @@ ArrayWrapperMat1* ocr_rec_pre_process(uint8_t* data, FrameSize ori_shape, BoxPoi
         }
     }
     return arrayWrapperMat1;
-}
\ No newline at end of file
+}
+
+// 为 ai2d 批量仿射生成每个框的变换矩阵，代替 ocr_rec_pre_process 中逐框的 warpPerspective + resize。
+// 最小外接矩形到输出矩形是仿射变换，取三个顶点求矩阵即可；ai2d 输出的是 RGB，
+// 送识别模型前还要用 ocr_rec_gray 转成与 ocr_rec_pre_process 相同的单通道灰度图。
+// matrix 每个框6个值 [a0, a1, b0, a2, a3, b1]，coordinates 每个框8个值，为排序后的四个顶点
+void ocr_rec_affine_matrix(BoxPoint8* boxpoint8, int box_cnt, FrameSize dst_shape, float* matrix, float* coordinates)
+{
+    for(int i = 0; i < box_cnt; i++)
+    {
+        BoxPoint boxpoint;
+        for(int j = 0; j < 4; j++)
+        {
+            boxpoint.vertices[j].x = boxpoint8[i].points8[2 * j + 0];
+            boxpoint.vertices[j].y = boxpoint8[i].points8[2 * j + 1];
+        }
+
+        std::vector<cv::Point2f> vtd(4);
+        float w, h;
+        rect_vertices_(boxpoint, vtd, w, h);
+
+        cv::Point2f src[3] = {vtd[0], vtd[1], vtd[2]};
+        cv::Point2f dst[3] = {cv::Point2f(0, 0), cv::Point2f(dst_shape.width, 0), cv::Point2f(dst_shape.width, dst_shape.height)};
+        cv::Mat m = cv::getAffineTransform(src, dst);
+        for(int j = 0; j < 6; j++)
+            matrix[6 * i + j] = (float)m.at<double>(j / 3, j % 3);
+        for(int j = 0; j < 4; j++)
+        {
+            coordinates[8 * i + 2 * j + 0] = vtd[j].x;
+            coordinates[8 * i + 2 * j + 1] = vtd[j].y;
+        }
+    }
+}
+
+// 把 ai2d 输出的一个 RGB planar 块 [3,h,w] 转成识别模型的单通道灰度输入 [h,w]，
+// 与 ocr_rec_pre_process 中的 cvtColor(COLOR_BGR2GRAY) 相同
+void ocr_rec_gray(const uint8_t* rgb, FrameSize shape, uint8_t* gray)
+{
+    int matsize = shape.width * shape.height;
+    cv::Mat img;
+    std::vector<cv::Mat> planes;
+    planes.push_back(cv::Mat(shape.height, shape.width, CV_8UC1, (void *)(rgb + 2 * matsize)));
+    planes.push_back(cv::Mat(shape.height, shape.width, CV_8UC1, (void *)(rgb + 1 * matsize)));
+    planes.push_back(cv::Mat(shape.height, shape.width, CV_8UC1, (void *)rgb));
+    cv::merge(planes, img);
+    cv::Mat img_gray(shape.height, shape.width, CV_8UC1, gray);
+    cv::cvtColor(img, img_gray, cv::COLOR_BGR2GRAY);
+}
@@ -27,10 +27,12 @@
 #include <opencv2/imgcodecs.hpp>
 #include <opencv2/imgproc.hpp>
 #include "aidemo_wrap.h"
+#include "nms.h"
 
 #include <stdlib.h>
 #include <iostream>
 #include <unistd.h>
+#include "profiler.h"
 
 typedef struct BoxInfo
 {
@@ -56,36 +58,24 @@ struct  OutputPose {
 
 void nms_pose(std::vector<BoxInfo> &input_boxes, float nms_thresh,std::vector<int> &nms_result)
 {
-    std::sort(input_boxes.begin(), input_boxes.end(), [](BoxInfo a, BoxInfo b) { return a.score > b.score; });
-    std::vector<float> vArea(input_boxes.size());
-    for (int i = 0; i < int(input_boxes.size()); ++i)
+    int n = input_boxes.size();
+    std::vector<NmsBox> boxes(n);
+    std::vector<float> scores(n);
+    for (int i = 0; i < n; ++i)
     {
-        vArea[i] = (input_boxes.at(i).x2 - input_boxes.at(i).x1 + 1)
-            * (input_boxes.at(i).y2 - input_boxes.at(i).y1 + 1);
-    }
-    for (int i = 0; i < int(input_boxes.size()); ++i)
-    {
-        for (int j = i + 1; j < int(input_boxes.size());)
-        {
-            float xx1 = std::max(input_boxes[i].x1, input_boxes[j].x1);
-            float yy1 = std::max(input_boxes[i].y1, input_boxes[j].y1);
-            float xx2 = std::min(input_boxes[i].x2, input_boxes[j].x2);
-            float yy2 = std::min(input_boxes[i].y2, input_boxes[j].y2);
-            float w = std::max(float(0), xx2 - xx1 + 1);
-            float h = std::max(float(0), yy2 - yy1 + 1);
-            float inter = w * h;
-            float ovr = inter / (vArea[i] + vArea[j] - inter);
-            if (ovr >= nms_thresh)
-            {
-                input_boxes.erase(input_boxes.begin() + j);
-                vArea.erase(vArea.begin() + j);
-            }
-            else
-            {
-                j++;
-            }
-        }
+        boxes[i] = { input_boxes[i].x1, input_boxes[i].y1, input_boxes[i].x2, input_boxes[i].y2 };
+        scores[i] = input_boxes[i].score;
     }
+
+    NmsConfig cfg = nms_default_config(nms_thresh);
+    cfg.pixel_inclusive = true;
+    nms_select(boxes, scores, NULL, cfg, nms_result);
+
+    std::vector<BoxInfo> kept;
+    kept.reserve(nms_result.size());
+    for (int i : nms_result)
+        kept.push_back(input_boxes[i]);
+    input_boxes.swap(kept);
 }
 
 bool BatchDetect(float* all_data, std::vector<std::vector<OutputPose>>& output,cv::Vec4d params, float obj_thresh, float nms_thresh)
@@ -202,6 +192,7 @@ bool Detect(float* all_data, std::vector<OutputPose> &output,cv::Vec4d params, f
 
 PersonKPOutput* person_kp_postprocess(float *data, FrameSize frame_size, FrameSize kmodel_frame_size, float obj_thresh, float nms_thresh, int *box_cnt)
 {
+    PROF_SCOPE("aidemo.person_kp_postprocess");
     std::vector<OutputPose> output;
     cv::Vec4d params; // 计算 这个padding值
     
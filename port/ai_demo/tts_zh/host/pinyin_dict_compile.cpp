@@ -0,0 +1,63 @@
+// 把 tts_zh 的文本字典编译成 mmap 加载的二进制字典：
+//     pinyin_dict_compile [-p] <input.txt> <output.bin>
+// 默认输入为单字字典 pinyin.txt，-p 表示词组字典。
+// 编译后逐项与文本解析的结果比对，保证运行时查到的拼音不变。
+
+#include <stdio.h>
+#include <string.h>
+#include "pinyin_dict.h"
+
+static int verify(const std::unordered_map<int, std::string>& chars,
+                  const std::map<std::string, std::string>& phrases,
+                  const char* path)
+{
+    PinyinDictFile dict;
+    if (dict.open(path) != 0)
+        return -1;
+    for (auto& kv : chars) {
+        const char* py = dict.find_char(kv.first);
+        if (py == nullptr || kv.second != py) {
+            printf("verify failed at U+%X\n", kv.first);
+            return -1;
+        }
+    }
+    for (auto& kv : phrases) {
+        const char* py = dict.find_phrase(kv.first);
+        if (py == nullptr || kv.second != py) {
+            printf("verify failed at %s\n", kv.first.c_str());
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv)
+{
+    bool phrase = argc == 4 && strcmp(argv[1], "-p") == 0;
+    if (argc != 3 && !phrase) {
+        printf("usage: %s [-p] <input.txt> <output.bin>\n", argv[0]);
+        return 1;
+    }
+    const char* input = argv[argc - 2];
+    const char* output = argv[argc - 1];
+
+    std::unordered_map<int, std::string> chars;
+    std::map<std::string, std::string> phrases;
+    if (phrase)
+        pinyin_phrases_load_text(input, phrases);
+    else
+        pinyin_dict_load_text(input, chars);
+    if (chars.empty() && phrases.empty()) {
+        printf("no entry in %s\n", input);
+        return 1;
+    }
+
+    if (pinyin_dict_compile(chars, phrases, output) != 0 || verify(chars, phrases, output) != 0)
+        return 1;
+
+    PinyinDictFile dict;
+    dict.open(output);
+    printf("%s: %zu chars, %zu phrases, %zu trie units\n", output, chars.size(), phrases.size(),
+           dict.phrase_units());
+    return 0;
+}
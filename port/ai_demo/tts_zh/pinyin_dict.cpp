@@ -0,0 +1,405 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <algorithm>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include "pinyin_utils.h"
+#include "pinyin_dict.h"
+
+using namespace std;
+
+int pinyin_dict_load_text(const std::string& path, std::unordered_map<int, std::string>& dict)
+{
+    std::ifstream infile(path);
+    std::string line;
+    while (std::getline(infile, line))
+    {
+        std::string new_line = line;
+        trim(new_line);
+
+        if (new_line[0] == '#')
+        {
+            continue;
+        }
+        std::vector<std::string> vals, val2;
+        vals = split(new_line, ':');
+        if (vals.size() < 2)
+        {
+            printf("Invalid line:%s\n", new_line.c_str());
+            continue;
+        }
+        std::string utf8_code = vals[0];
+
+        int utf8_code_int;
+        std::stringstream ss;
+        ss << std::hex << utf8_code.substr(2);
+        ss >> utf8_code_int;
+        val2 = split(vals[1], '#');
+        std::string py = val2[0];
+        dict[utf8_code_int] = py;
+    }
+    return 0;
+}
+
+int pinyin_phrases_load_text(const std::string& path, std::map<std::string, std::string>& dict)
+{
+    //记录上一个key，用于判断多音字
+    string last_cnstr="";
+
+    string key;
+    string value;
+
+    std::ifstream infile(path);
+    std::string line;
+    while (std::getline(infile, line))
+    {
+        std::string new_line = line;
+
+        if (new_line[0] == '#')
+        {
+            continue;
+        }
+        std::vector<std::string> vals, val2;
+        vals = split(new_line, ':');
+        if (vals.size() < 2)
+        {
+            printf("Invalid line:%s\n", new_line.c_str());
+            continue;
+        }
+
+        key = vals[0];
+        trim_shouwei(vals[1]);
+        value = vals[1];
+
+        std::string cnstr = key;
+
+        if(cnstr==last_cnstr)//如果存在，说明是多音字
+        {
+            string last_value = dict[cnstr];
+            if(last_value !=value)
+                value = last_value+","+value;
+        }
+
+        last_cnstr = cnstr;
+        dict[key] = value;
+    }
+
+    dict["开户行"]="kai1 hu4 hang2";
+    dict["发卡行"]=  "fa4 ka3 hang2";
+    dict["放款行"]=  "fang4 kuan3 hang2";
+    dict["茧行"]=    "jian3 hang2";
+    dict["行号"]=    "hang2 hao4";
+    dict["各地"]=     "ge4 di4";
+    dict["借还款"]=  "jie4 huan2 kuan3";
+    dict["时间为"]=  "shi2 jian1 wei2";
+    dict["为准"]=    "wei2 zhun3";
+    dict["色差"]=    "se4 cha1";
+    dict["嗲"]=      "dia3";
+    dict["呗"]=      "bei5";
+    dict["不"]=      "bu4";
+    dict["咗"]=      "zuo5";
+    dict["嘞"]=      "lei5";
+    dict["掺和"]=    "chan1 huo5";
+
+    return 1;
+}
+
+namespace {
+
+// 字符串池，相同的拼音只存一份
+struct StringPool {
+    std::vector<char> data;
+    std::unordered_map<std::string, uint32_t> offsets;
+
+    uint32_t intern(const std::string& s) {
+        auto iter = offsets.find(s);
+        if (iter != offsets.end())
+            return iter->second;
+        uint32_t offset = data.size();
+        data.insert(data.end(), s.begin(), s.end());
+        data.push_back('\0');
+        offsets[s] = offset;
+        return offset;
+    }
+};
+
+// 按字节构建双数组 trie，check 为 -1 的单元空闲
+struct TrieBuilder {
+    std::vector<const std::string*> keys;
+    std::vector<uint32_t> values;
+    std::vector<PinyinDictTrieUnit> units;
+    std::vector<bool> used_base;
+    // 查找空闲单元的起点
+    size_t next_free = 1;
+
+    void reserve(size_t size) {
+        if (units.size() >= size)
+            return;
+        size_t n = std::max(size, units.size() * 2);
+        units.resize(n, PinyinDictTrieUnit{0, -1});
+        used_base.resize(n, false);
+    }
+
+    int code(size_t i, size_t depth) const {
+        const std::string& key = *keys[i];
+        return key.size() == depth ? 0 : (uint8_t)key[depth] + 1;
+    }
+
+    void build(size_t s, size_t lo, size_t hi, size_t depth) {
+        // keys 已排序，同一前缀下的子节点连续，结束符 0 排在最前
+        std::vector<int> codes;
+        std::vector<size_t> begins;
+        for (size_t i = lo; i < hi; i++) {
+            int c = code(i, depth);
+            if (codes.empty() || codes.back() != c) {
+                codes.push_back(c);
+                begins.push_back(i);
+            }
+        }
+        begins.push_back(hi);
+
+        while (next_free < units.size() && units[next_free].check != -1)
+            next_free++;
+        size_t base = 0;
+        size_t start = std::max(next_free, (size_t)codes[0] + 1);
+        size_t occupied = 0;
+        for (size_t pos = start;; pos++) {
+            reserve(pos + 1);
+            if (units[pos].check != -1) {
+                occupied++;
+                continue;
+            }
+            size_t b = pos - codes[0];
+            if (used_base[b])
+                continue;
+            reserve(b + codes.back() + 1);
+            bool free = true;
+            for (size_t k = 1; k < codes.size() && free; k++)
+                free = units[b + codes[k]].check == -1;
+            if (free) {
+                base = b;
+                // 扫过的区间已经基本占满时，之后从这里开始找，避免每次都从头扫描
+                if (occupied * 20 >= (pos - start + 1) * 19)
+                    next_free = pos;
+                break;
+            }
+        }
+
+        used_base[base] = true;
+        units[s].base = base;
+        for (int c : codes)
+            units[base + c].check = s;
+        for (size_t k = 0; k < codes.size(); k++) {
+            size_t t = base + codes[k];
+            if (codes[k] == 0)
+                units[t].base = -1 - (int32_t)values[begins[k]];
+            else
+                build(t, begins[k], begins[k + 1], depth + 1);
+        }
+    }
+};
+
+void align4(std::vector<char>& buf)
+{
+    buf.resize((buf.size() + 3) & ~(size_t)3, 0);
+}
+
+template <typename T>
+uint32_t append(std::vector<char>& buf, const T* data, size_t count)
+{
+    align4(buf);
+    uint32_t offset = buf.size();
+    buf.insert(buf.end(), (const char*)data, (const char*)(data + count));
+    return offset;
+}
+
+}
+
+int pinyin_dict_compile(const std::unordered_map<int, std::string>& chars,
+                        const std::map<std::string, std::string>& phrases,
+                        const std::string& out_path)
+{
+    StringPool pool;
+
+    std::vector<PinyinDictChar> char_table;
+    char_table.reserve(chars.size());
+    for (auto& kv : chars)
+        char_table.push_back(PinyinDictChar{(uint32_t)kv.first, 0});
+    std::sort(char_table.begin(), char_table.end(),
+              [](const PinyinDictChar& a, const PinyinDictChar& b) { return a.code < b.code; });
+    for (auto& c : char_table)
+        c.value = pool.intern(chars.at((int)c.code));
+
+    // std::map 按 unsigned char 逐字节排序，正是 trie 需要的顺序
+    TrieBuilder trie;
+    for (auto& kv : phrases) {
+        trie.keys.push_back(&kv.first);
+        trie.values.push_back(pool.intern(kv.second));
+    }
+    if (!trie.keys.empty()) {
+        trie.reserve(256);
+        trie.units[0].check = 0;
+        trie.build(0, 0, trie.keys.size(), 0);
+        size_t size = trie.units.size();
+        while (size > 1 && trie.units[size - 1].check == -1)
+            size--;
+        trie.units.resize(size);
+    }
+    if (pool.data.size() + trie.units.size() * sizeof(PinyinDictTrieUnit) > INT32_MAX) {
+        printf("pinyin dict too large\n");
+        return -1;
+    }
+
+    std::vector<char> buf(sizeof(PinyinDictHeader), 0);
+    PinyinDictHeader header;
+    memcpy(header.magic, PINYIN_DICT_MAGIC, 4);
+    header.version = PINYIN_DICT_VERSION;
+    header.char_count = char_table.size();
+    header.char_offset = append(buf, char_table.data(), char_table.size());
+    header.trie_size = trie.units.size();
+    header.trie_offset = append(buf, trie.units.data(), trie.units.size());
+    header.pool_size = pool.data.size();
+    header.pool_offset = append(buf, pool.data.data(), pool.data.size());
+    align4(buf);
+    header.file_size = buf.size();
+    memcpy(buf.data(), &header, sizeof(header));
+
+    FILE* f = fopen(out_path.c_str(), "wb");
+    if (f == nullptr) {
+        printf("open %s failed\n", out_path.c_str());
+        return -1;
+    }
+    size_t written = fwrite(buf.data(), 1, buf.size(), f);
+    if (fclose(f) != 0 || written != buf.size()) {
+        printf("write %s failed\n", out_path.c_str());
+        return -1;
+    }
+    return 0;
+}
+
+bool pinyin_dict_is_compiled(const std::string& path)
+{
+    char magic[4];
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == nullptr)
+        return false;
+    bool compiled = fread(magic, 1, 4, f) == 4 && memcmp(magic, PINYIN_DICT_MAGIC, 4) == 0;
+    fclose(f);
+    return compiled;
+}
+
+int PinyinDictFile::open(const std::string& path)
+{
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        printf("open %s failed\n", path.c_str());
+        return -1;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(PinyinDictHeader)) {
+        printf("invalid pinyin dict %s\n", path.c_str());
+        ::close(fd);
+        return -1;
+    }
+    size_ = st.st_size;
+    void* addr = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    if (addr != MAP_FAILED) {
+        base_ = addr;
+        mapped_ = true;
+    } else {
+        // 文件系统不支持 mmap 时整个读入
+        base_ = malloc(size_);
+        if (base_ == nullptr || pread(fd, base_, size_, 0) != (ssize_t)size_) {
+            printf("read %s failed\n", path.c_str());
+            ::close(fd);
+            close();
+            return -1;
+        }
+    }
+    ::close(fd);
+
+    const PinyinDictHeader* header = (const PinyinDictHeader*)base_;
+    auto section_ok = [&](uint32_t offset, uint64_t bytes) {
+        return offset % 4 == 0 && offset >= sizeof(PinyinDictHeader) && offset + bytes <= size_;
+    };
+    if (memcmp(header->magic, PINYIN_DICT_MAGIC, 4) != 0 || header->version != PINYIN_DICT_VERSION ||
+        header->file_size != size_ ||
+        !section_ok(header->char_offset, (uint64_t)header->char_count * sizeof(PinyinDictChar)) ||
+        !section_ok(header->trie_offset, (uint64_t)header->trie_size * sizeof(PinyinDictTrieUnit)) ||
+        !section_ok(header->pool_offset, header->pool_size) || header->pool_size == 0 ||
+        ((const char*)base_)[header->pool_offset + header->pool_size - 1] != '\0') {
+        printf("invalid pinyin dict %s\n", path.c_str());
+        close();
+        return -1;
+    }
+
+    const char* data = (const char*)base_;
+    chars_ = (const PinyinDictChar*)(data + header->char_offset);
+    char_count_ = header->char_count;
+    trie_ = (const PinyinDictTrieUnit*)(data + header->trie_offset);
+    trie_size_ = header->trie_size;
+    pool_ = data + header->pool_offset;
+    pool_size_ = header->pool_size;
+    return 0;
+}
+
+void PinyinDictFile::close()
+{
+    if (base_ != nullptr) {
+        if (mapped_)
+            munmap(base_, size_);
+        else
+            free(base_);
+    }
+    base_ = nullptr;
+    size_ = 0;
+    mapped_ = false;
+    chars_ = nullptr;
+    char_count_ = 0;
+    trie_ = nullptr;
+    trie_size_ = 0;
+    pool_ = nullptr;
+    pool_size_ = 0;
+}
+
+const char* PinyinDictFile::value(int32_t offset) const
+{
+    if (offset < 0 || (size_t)offset >= pool_size_)
+        return nullptr;
+    return pool_ + offset;
+}
+
+const char* PinyinDictFile::find_char(int code) const
+{
+    const PinyinDictChar* end = chars_ + char_count_;
+    const PinyinDictChar* iter = std::lower_bound(chars_, end, (uint32_t)code,
+        [](const PinyinDictChar& c, uint32_t code) { return c.code < code; });
+    if (iter == end || iter->code != (uint32_t)code)
+        return nullptr;
+    return value(iter->value);
+}
+
+const char* PinyinDictFile::find_phrase(const char* phrase, size_t len) const
+{
+    if (trie_size_ == 0)
+        return nullptr;
+    size_t s = 0;
+    for (size_t i = 0; i <= len; i++) {
+        int32_t base = trie_[s].base;
+        if (base < 1)
+            return nullptr;
+        size_t t = base + (i < len ? (uint8_t)phrase[i] + 1 : 0);
+        if (t >= trie_size_ || trie_[t].check != (int32_t)s)
+            return nullptr;
+        s = t;
+    }
+    return value(-1 - trie_[s].base);
+}
@@ -27,114 +27,37 @@ using namespace std;
 
 int Pypinyin::load_dict(const std::string& path)
 {
-    if (!PINYIN_DICT.empty())
+    if (pinyin_dict_is_compiled(path))
     {
-        return 0;
+        PINYIN_DICT.clear();
+        return pinyin_bin_.open(path);
     }
-    std::ifstream infile(path);
-    std::string line;
-    while (std::getline(infile, line))
+    if (!PINYIN_DICT.empty())
     {
-        std::string new_line = line;
-        trim(new_line);
-       
-        if (new_line[0] == '#')
-        {
-            continue;
-        }
-        std::vector<std::string> vals, val2;
-        vals = split(new_line, ':');
-        if (vals.size() < 2)
-        {
-            printf("Invalid line:%s\n", new_line.c_str());
-            continue;
-        }
-        std::string utf8_code = vals[0];
-        
-        int utf8_code_int;
-        std::stringstream ss;
-        ss << std::hex << utf8_code.substr(2);
-        ss >> utf8_code_int;
-        val2 = split(vals[1], '#');
-        std::string py = val2[0];       
-        PINYIN_DICT[utf8_code_int] = py;
-       
+        return 0;
     }
-    return 0;
+    pinyin_bin_.close();
+    return pinyin_dict_load_text(path, PINYIN_DICT);
 }
 
 
 
 int Pypinyin::load_phase_dict(const std::string& path)
 {
-    //记录上一个key，用于判断多音字
-    string last_cnstr="";
-   
-    string key;
-    string value;
-
-    std::ifstream infile(path);
-    std::string line;
-    while (std::getline(infile, line))
+    if (pinyin_dict_is_compiled(path))
     {
-        std::string new_line = line;
-       
-        if (new_line[0] == '#')
-        {
-            continue;
-        }
-        std::vector<std::string> vals, val2;
-        vals = split(new_line, ':');
-        if (vals.size() < 2)
-        {
-            printf("Invalid line:%s\n", new_line.c_str());
-            continue;
-        }
-        
-        key = vals[0];
-        trim_shouwei(vals[1]);
-        value = vals[1];        
-
-        std::string cnstr = key;
-       
-        if(cnstr==last_cnstr)//如果存在，说明是多音字
-        {
-            string last_value = PHRASES_DICT[cnstr];
-            if(last_value !=value)
-                value = last_value+","+value;
-        }
-       
-        last_cnstr = cnstr;
-        PHRASES_DICT[key] = value;
-
-       
+        PHRASES_DICT.clear();
+        return phrases_bin_.open(path);
     }
-
-    PHRASES_DICT["开户行"]="kai1 hu4 hang2";
-    PHRASES_DICT["发卡行"]=  "fa4 ka3 hang2";
-    PHRASES_DICT["放款行"]=  "fang4 kuan3 hang2";
-    PHRASES_DICT["茧行"]=    "jian3 hang2";
-    PHRASES_DICT["行号"]=    "hang2 hao4";
-    PHRASES_DICT["各地"]=     "ge4 di4";
-    PHRASES_DICT["借还款"]=  "jie4 huan2 kuan3";
-    PHRASES_DICT["时间为"]=  "shi2 jian1 wei2";
-    PHRASES_DICT["为准"]=    "wei2 zhun3";
-    PHRASES_DICT["色差"]=    "se4 cha1"; 
-    PHRASES_DICT["嗲"]=      "dia3";
-    PHRASES_DICT["呗"]=      "bei5"; 
-    PHRASES_DICT["不"]=      "bu4";
-    PHRASES_DICT["咗"]=      "zuo5"; 
-    PHRASES_DICT["嘞"]=      "lei5";
-    PHRASES_DICT["掺和"]=    "chan1 huo5";
-
-    return 1;
+    phrases_bin_.close();
+    return pinyin_phrases_load_text(path, PHRASES_DICT);
 }
 
 
 
 void Pypinyin::Init(string dict_path,string phase_path){
     
-    //加载字典,加载词典
+    //加载字典,加载词典，文本字典逐行解析，pinyin_dict_compile 编译的二进制字典直接映射
     load_dict(dict_path);
     // cout<<"load_dict success!"<<endl;
     load_phase_dict(phase_path);
@@ -142,6 +65,26 @@ void Pypinyin::Init(string dict_path,string phase_path){
    
 }
 
+const char* Pypinyin::find_pinyin(int code) const
+{
+    if (pinyin_bin_.is_open())
+    {
+        return pinyin_bin_.find_char(code);
+    }
+    auto iter = PINYIN_DICT.find(code);
+    return iter != PINYIN_DICT.end() ? iter->second.c_str() : nullptr;
+}
+
+const char* Pypinyin::find_phrase(const std::string& phrase) const
+{
+    if (phrases_bin_.is_open())
+    {
+        return phrases_bin_.find_phrase(phrase);
+    }
+    auto iter = PHRASES_DICT.find(phrase);
+    return iter != PHRASES_DICT.end() ? iter->second.c_str() : nullptr;
+}
+
 std::wregex re_hans(L"^(?:["
                     L"\u3007"                  // 〇
                     L"\u3400-\u4dbf"           // CJK扩展A:[3400-4DBF]
@@ -175,11 +118,11 @@ std::vector<std::vector<std::string>> Pypinyin::_single_pinyin(string han, Style
     ord(han, codes);
 
     int64_t num = codes[0];
-    auto iter = PINYIN_DICT.find(num);
-    if(iter !=PINYIN_DICT.end() )
+    const char* py = find_pinyin(num);
+    if(py != nullptr)
     {
         
-        pys = split(iter->second,',');
+        pys = split(py,',');
     }
     else//处理没有拼音的字符
     {
@@ -231,13 +174,13 @@ std::vector<std::vector<std::string>> Pypinyin::_phrase_pinyin(const std::string
     vector<int> codes;
     StringArray wphrase = String2StringArray(phrase,codes);
     std::vector<std::vector<std::string>> pinyin_list;
-    auto iter = PHRASES_DICT.find(phrase);
+    const char* phrase_py = find_phrase(phrase);
    
 
 
-    if (iter != PHRASES_DICT.end())
+    if (phrase_py != nullptr)
     {   
-        vector<string> vals = split(iter->second,',');
+        vector<string> vals = split(phrase_py,',');
 
 
         for(string val : vals)
@@ -9,6 +9,7 @@
 #include <cmath>
 #include <cctype>
 #include "VoxCommon.h"
+#include "profiler.h"
 
 
 struct TtsZh{
@@ -63,6 +64,7 @@ int _symbols_to_sequence_zh(string s,map<string,int> symbol_to_id)
 }
 
 TtsZhOutput* tts_zh_frontend_preprocess(TtsZh* ttszh_,const char* text){
+    PROF_SCOPE("aidemo.tts_zh_preprocess");
     // zh_frontend zh;
     std::string text_zh(text);
     std::cout<<text_zh<<std::endl;
@@ -0,0 +1,51 @@
+#ifndef _NMS_H_
+#define _NMS_H_
+
+#include <vector>
+
+/**
+ * @brief 候选框，左上/右下角点坐标
+ */
+typedef struct NmsBox
+{
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+} NmsBox;
+
+typedef enum NmsSoftMode
+{
+    NMS_SOFT_NONE = 0,      // 标准NMS，重叠框直接抑制
+    NMS_SOFT_LINEAR,        // soft-NMS，重叠超过阈值的框得分乘以 (1 - iou)
+    NMS_SOFT_GAUSSIAN,      // soft-NMS，所有框得分乘以 exp(-iou^2 / sigma)
+} NmsSoftMode;
+
+/**
+ * @brief NMS参数，用 nms_default_config() 初始化后按需修改
+ */
+typedef struct NmsConfig
+{
+    float iou_thresh;       // iou >= iou_thresh 的框被抑制
+    float score_thresh;     // 得分低于该值的框不参与NMS（soft-NMS衰减后同样适用）
+    int top_k;              // 只保留得分最高的 top_k 个候选参与NMS，<= 0 表示不限制
+    int max_det;            // 最多输出的框数，<= 0 表示不限制
+    bool batched;           // true: 按类别分别做NMS，不同类别的框互不抑制
+    bool pixel_inclusive;   // true: 宽高按 x2 - x1 + 1 计算（整数像素坐标）
+    NmsSoftMode soft;
+    float sigma;            // NMS_SOFT_GAUSSIAN 的 sigma
+} NmsConfig;
+
+NmsConfig nms_default_config(float iou_thresh);
+
+/**
+ * @brief 对候选框做NMS
+ * @param boxes   候选框
+ * @param scores  候选框得分，soft-NMS时保留框的得分会被更新为衰减后的值
+ * @param labels  候选框类别，仅 batched 时使用，可为 NULL
+ * @param cfg     NMS参数
+ * @param keep    输出，保留框在 boxes 中的索引，按得分从高到低排列
+ */
+void nms_select(const std::vector<NmsBox>& boxes, std::vector<float>& scores, const int* labels, const NmsConfig& cfg, std::vector<int>& keep);
+
+#endif
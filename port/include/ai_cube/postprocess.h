@@ -1,3 +1,5 @@
+#ifndef _POSTPROCESS_H_
+#define _POSTPROCESS_H_
 #include <stdint.h>
 typedef struct ob_det_res
 {
@@ -22,6 +24,14 @@ typedef struct CenterPrior
     int stride;
 }CenterPrior;
 
+// 最近一次检测后处理的耗时，单位us
+typedef struct ob_det_timing
+{
+    uint32_t decode_us[3];  // 每个输出层的解码耗时
+    uint32_t nms_us;
+    int candidates;         // 进入NMS的候选框数量
+}ob_det_timing;
+
 typedef struct ArrayWrapper
 {
     uint8_t* data;         // 指向数组的指针
@@ -36,7 +46,9 @@ extern "C" {
     ob_det_res* anchorbasedet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, float* anchors, bool nms_option, int* results_size);
     ob_det_res* anchorfreedet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, bool nms_option, int* results_size);
     ob_det_res* gfldet_post_process(float* data0, float* data1, float* data2, FrameSize kmodel_frame_size, FrameSize frame_size, int* strides, int num_class, float ob_det_thresh, float ob_nms_thresh, bool nms_option, int* results_size);
-    uint8_t* seg_post_process(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape);
+    void get_ob_det_timing(ob_det_timing* timing);
+    void seg_post_process(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape, uint8_t* dst, int resize, float* conf);
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
+#endif // _POSTPROCESS_H_
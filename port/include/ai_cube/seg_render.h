@@ -0,0 +1,40 @@
+#ifndef _SEG_RENDER_H_
+#define _SEG_RENDER_H_
+
+#include <stdint.h>
+
+#define SEG_RESIZE_NEAREST  0
+#define SEG_RESIZE_BILINEAR 1
+
+// 类别序号按uint8_t暂存
+#define SEG_MAX_CLASS       256
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    /**
+     * @brief 语义分割后处理：逐像素取logit最大的类别，查调色板并缩放到目标大小
+     *
+     * softmax单调，取最大值不需要计算exp。类别结果暂存在logits里，logits会被改写，
+     * 除此之外不申请任何内存。
+     *
+     * @param logits     模型输出，HWC排列，src_h * src_w * num_class
+     * @param num_class  类别数
+     * @param src_w      模型输出宽
+     * @param src_h      模型输出高
+     * @param min_logit  最大logit不超过该值的像素归为类别0
+     * @param palette    每个类别4个字节，按输出像素的字节顺序排列
+     * @param dst        输出缓冲区，每像素4字节
+     * @param dst_w      输出宽
+     * @param dst_h      输出高
+     * @param dst_stride 输出每行字节数
+     * @param resize     SEG_RESIZE_NEAREST 或 SEG_RESIZE_BILINEAR
+     * @param conf       可选，src_h * src_w，输出所选类别的softmax概率，不需要时传NULL
+     */
+    void seg_argmax_render(float* logits, int num_class, int src_w, int src_h, float min_logit, const uint8_t* palette,
+                           uint8_t* dst, int dst_w, int dst_h, int dst_stride, int resize, float* conf);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
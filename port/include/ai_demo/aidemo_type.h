@@ -83,14 +83,6 @@ struct SparseLandmarks
     float points[10]; // 人脸五官点,依次是图片的左眼（x,y）、右眼（x,y）,鼻子（x,y）,左嘴角（x,y）,右嘴角
 };
 
-struct FaceDetectionInfoVector
-{
-    size_t vec_len;
-    Bbox *bbox;                  // 人脸检测框
-    SparseLandmarks *sparse_kps; // 人脸五官关键点
-    float *score;                // 人脸检测框置信度
-};
-
 //*****************************for object segment*****************************
 struct SegOutput {
 	int id;             //结果类别id
@@ -98,11 +90,6 @@ struct SegOutput {
 	int box[4];       //矩形框
 };
 
-struct SegOutputs {
-    SegOutput *segOutput;
-    uint8_t *masks_results;
-};
-
 //*****************************for person keypoint detect**********************
 struct PersonKPOutput {
 	float confidence;   //结果置信度
@@ -41,10 +41,9 @@ typedef struct ArrayWrapperMat1 ArrayWrapperMat1;
 //for face det
 typedef struct Bbox Bbox;
 typedef struct SparseLandmarks SparseLandmarks;
-typedef struct FaceDetectionInfoVector FaceDetectionInfoVector;
+typedef struct FaceDetContext FaceDetContext;
 //for object segment
 typedef struct SegOutput SegOutput;
-typedef struct SegOutputs SegOutputs;
 //for person kp det
 typedef struct PersonKPOutput PersonKPOutput;
 // for kws 
@@ -68,9 +67,18 @@ extern "C" {
     void draw_mesh(cv_and_ndarray_convert_info *in_info, generic_array* p_vertices);
     //for ocr rec
     ArrayWrapperMat1* ocr_rec_pre_process(uint8_t* data, FrameSize ori_shape, BoxPoint8* boxpoint8, int box_cnt);
+    void ocr_rec_affine_matrix(BoxPoint8* boxpoint8, int box_cnt, FrameSize dst_shape, float* matrix, float* coordinates);
+    void ocr_rec_gray(const uint8_t* rgb, FrameSize shape, uint8_t* gray);
 
     //for face det
-    FaceDetectionInfoVector* face_detetion_post_process(float obj_thresh,float nms_thresh,int net_len,float* anchors,FrameSize* frame_size,float** p_outputs);
+    // anchors 在创建时拷贝，失败(anchors个数不够)返回NULL
+    FaceDetContext *face_det_create(int net_len, const float *anchors, size_t anchors_len, int max_faces);
+    void face_det_destroy(FaceDetContext *ctx);
+    int face_det_capacity(FaceDetContext *ctx);
+    // context 是否由同样的 net_len 和 anchors 创建
+    bool face_det_matches(FaceDetContext *ctx, int net_len, const float *anchors, size_t anchors_len);
+    // 结果写入调用者提供的数组(至少 face_det_capacity() 个)，返回人脸个数；可以多线程同时调用
+    int face_det_post_process(FaceDetContext *ctx, float obj_thresh, float nms_thresh, FrameSize *frame_size, float **p_outputs, Bbox *bbox, SparseLandmarks *sparse_kps, float *score);
     //for face parse
     void face_parse_post_process(cv_and_ndarray_convert_info* in_info,FrameSize* ai_img_shape,FrameSize* osd_img_shape,int net_len,Bbox* bbox,CHWSize* model_out_shape,float* p_outputs);
     //for face mesh
@@ -78,7 +86,8 @@ extern "C" {
     //for licence det
     BoxPoint8* licence_det_post_process(float* p_outputs_0,float* p_outputs_1,float* p_outputs_2,float* p_outputs_3,float* p_outputs_4,float* p_outputs_5,float* p_outputs_6,float* p_outputs_7,float* p_outputs_8,FrameSize frame_size,FrameSize kmodel_frame_size,float obj_thresh,float nms_thresh,int* box_cnt);
     //for object segment
-    SegOutputs object_seg_post_process(float *data_0, float *data_1, FrameSize frame_size, FrameSize kmodel_frame_size, FrameSize display_frame_size, float conf_thres, float nms_thres, float mask_thres, int *box_cnt);
+    // 把框和mask直接画到osd(display大小的RGBA缓冲区)，返回框的个数，*seg_outputs 由调用者free
+    int object_seg_post_process(float *data_0, float *data_1, FrameSize frame_size, FrameSize kmodel_frame_size, FrameSize display_frame_size, float conf_thres, float nms_thres, float mask_thres, uint8_t *osd, SegOutput **seg_outputs);
     //for person kp det
     PersonKPOutput* person_kp_postprocess(float *data, FrameSize frame_size, FrameSize kmodel_frame_size, float obj_thresh, float nms_thresh, int *box_cnt);
     //for kws
@@ -98,7 +107,7 @@ extern "C" {
     TtsZhOutput* tts_zh_frontend_preprocess(TtsZh* ttszh_,const char* text);
     void tts_save_wav(float* wav_data,int wav_len,const char* wav_filename,int sample_rate);
     // for body_seg
-    uint8_t* body_seg_postprocess(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape,uint8_t* color);
+    void body_seg_postprocess(float* data, int num_class, FrameSize ori_shape, FrameSize dst_shape, uint8_t* color, uint8_t* dst, int resize, float* conf);
 #ifdef __cplusplus
 }
 #endif
@@ -15,6 +15,7 @@
 #ifndef FRONTEND_FBANK_H_
 #define FRONTEND_FBANK_H_
 
+#include <algorithm>
 #include <cstring>
 #include <limits>
 #include <random>
@@ -28,6 +29,11 @@ namespace wenet {
 
 // This code is based on kaldi Fbank implentation, please see
 // https://github.com/kaldi-asr/kaldi/blob/master/src/feat/feature-fbank.cc
+//
+// Streaming fbank: ComputeFrame() turns one frame of samples into num_bins
+// features using buffers allocated in the constructor, so feature extraction
+// does not touch the heap. The power spectrum comes from a half-length complex
+// fft (rfft_power) and the mel filters are stored as one flat sparse matrix.
 class Fbank {
  public:
   Fbank(int num_bins, int sample_rate, int frame_length, int frame_shift)
@@ -41,12 +47,19 @@ class Fbank {
         distribution_(0, 1.0),
         dither_(0.0) {
     fft_points_ = UpperPowerOfTwo(frame_length_);
-    // generate bit reversal table and trigonometric function table
-    const int fft_points_4 = fft_points_ / 4;
-    bitrev_.resize(fft_points_);
-    sintbl_.resize(fft_points_ + fft_points_4);
-    make_sintbl(fft_points_, sintbl_.data());
-    make_bitrev(fft_points_, bitrev_.data());
+    // tables of the fft_points_ / 2 complex fft used by rfft_power
+    const int half = fft_points_ / 2;
+    bitrev_.resize(half);
+    sintbl_.resize(half + half / 4);
+    twiddle_.resize(fft_points_);
+    make_sintbl(half, sintbl_.data());
+    make_bitrev(half, bitrev_.data());
+    make_rfft_twiddle(fft_points_, twiddle_.data());
+
+    frame_.resize(fft_points_);
+    fft_re_.resize(half);
+    fft_im_.resize(half);
+    power_.resize(half);
 
     int num_fft_bins = fft_points_ / 2;
     float fft_bin_width = static_cast<float>(sample_rate_) / fft_points_;
@@ -54,14 +67,15 @@ class Fbank {
     float mel_low_freq = MelScale(low_freq);
     float mel_high_freq = MelScale(high_freq);
     float mel_freq_delta = (mel_high_freq - mel_low_freq) / (num_bins + 1);
-    bins_.resize(num_bins_);
     center_freqs_.resize(num_bins_);
+    mel_first_.resize(num_bins_);
+    mel_offset_.resize(num_bins_ + 1);
+    mel_offset_[0] = 0;
     for (int bin = 0; bin < num_bins; ++bin) {
       float left_mel = mel_low_freq + bin * mel_freq_delta,
             center_mel = mel_low_freq + (bin + 1) * mel_freq_delta,
             right_mel = mel_low_freq + (bin + 2) * mel_freq_delta;
       center_freqs_[bin] = InverseMelScale(center_mel);
-      std::vector<float> this_bin(num_fft_bins);
       int first_index = -1, last_index = -1;
       for (int i = 0; i < num_fft_bins; ++i) {
         float freq = (fft_bin_width * i);  // Center frequency of this fft
@@ -73,18 +87,17 @@ class Fbank {
             weight = (mel - left_mel) / (center_mel - left_mel);
           else
             weight = (right_mel - mel) / (right_mel - center_mel);
-          this_bin[i] = weight;
           if (first_index == -1) first_index = i;
+          // weights of one bin are contiguous, zeros inside the triangle kept
+          mel_weights_.resize(mel_offset_[bin] + i - first_index + 1, 0.0f);
+          mel_weights_[mel_offset_[bin] + i - first_index] = weight;
           last_index = i;
         }
       }
       CHECK(first_index != -1 && last_index >= first_index);
-      bins_[bin].first = first_index;
-      int size = last_index + 1 - first_index;
-      bins_[bin].second.resize(size);
-      for (int i = 0; i < size; ++i) {
-        bins_[bin].second[i] = this_bin[first_index + i];
-      }
+      mel_first_[bin] = first_index;
+      mel_offset_[bin + 1] = mel_offset_[bin] + last_index + 1 - first_index;
+      mel_weights_.resize(mel_offset_[bin + 1], 0.0f);
     }
 
     // NOTE(cdliang): add hamming window
@@ -105,6 +118,8 @@ class Fbank {
   void set_dither(float dither) { dither_ = dither; }
 
   int num_bins() const { return num_bins_; }
+  int frame_length() const { return frame_length_; }
+  int frame_shift() const { return frame_shift_; }
 
   static inline float InverseMelScale(float mel_freq) {
     return 700.0f * (expf(mel_freq / 1127.0f) - 1.0f);
@@ -119,18 +134,59 @@ class Fbank {
   }
 
   // preemphasis
-  void PreEmphasis(float coeff, std::vector<float>* data) const {
+  void PreEmphasis(float coeff, float* data, int n) const {
     if (coeff == 0.0) return;
-    for (int i = data->size() - 1; i > 0; i--)
-      (*data)[i] -= coeff * (*data)[i - 1];
-    (*data)[0] -= coeff * (*data)[0];
+    for (int i = n - 1; i > 0; i--) data[i] -= coeff * data[i - 1];
+    data[0] -= coeff * data[0];
   }
 
   // add hamming window
-  void Hamming(std::vector<float>* data) const {
-    CHECK(data->size() >= hamming_window_.size());
+  void Hamming(float* data) const {
     for (size_t i = 0; i < hamming_window_.size(); ++i) {
-      (*data)[i] *= hamming_window_[i];
+      data[i] *= hamming_window_[i];
+    }
+  }
+
+  // Compute the fbank feature of frame_length samples into feat[num_bins]
+  void ComputeFrame(const float* samples, float* feat) {
+    float* data = frame_.data();
+    memcpy(data, samples, sizeof(float) * frame_length_);
+    // optional add noise
+    if (dither_ != 0.0) {
+      for (int j = 0; j < frame_length_; ++j)
+        data[j] += dither_ * distribution_(generator_);
+    }
+    // optinal remove dc offset
+    if (remove_dc_offset_) {
+      float mean = 0.0;
+      for (int j = 0; j < frame_length_; ++j) mean += data[j];
+      mean /= frame_length_;
+      for (int j = 0; j < frame_length_; ++j) data[j] -= mean;
+    }
+
+    PreEmphasis(0.97, data, frame_length_);
+    // Povey(&data);
+    Hamming(data);
+    memset(data + frame_length_, 0,
+           sizeof(float) * (fft_points_ - frame_length_));
+    rfft_power(bitrev_.data(), sintbl_.data(), twiddle_.data(), data,
+               fft_re_.data(), fft_im_.data(), power_.data(), fft_points_);
+
+    // cepstral coefficients, triangle filter array
+    const float* weights = mel_weights_.data();
+    for (int j = 0; j < num_bins_; ++j) {
+      const float* p = power_.data() + mel_first_[j];
+      float mel_energy = 0.0;
+      for (int k = mel_offset_[j]; k < mel_offset_[j + 1]; ++k, ++p) {
+        mel_energy += weights[k] * *p;
+      }
+      feat[j] = mel_energy;
+    }
+    // optional use log, in place
+    if (use_log_) {
+      for (int j = 0; j < num_bins_; ++j) {
+        feat[j] = logf(std::max(feat[j], std::numeric_limits<float>::epsilon()));
+      }
     }
   }
 
@@ -141,58 +197,9 @@ class Fbank {
     if (num_samples < frame_length_) return 0;
     int num_frames = 1 + ((num_samples - frame_length_) / frame_shift_);
     feat->resize(num_frames);
-    std::vector<float> fft_real(fft_points_, 0), fft_img(fft_points_, 0);
-    std::vector<float> power(fft_points_ / 2);
     for (int i = 0; i < num_frames; ++i) {
-      std::vector<float> data(wave.data() + i * frame_shift_,
-                              wave.data() + i * frame_shift_ + frame_length_);
-      // optional add noise
-      if (dither_ != 0.0) {
-        for (size_t j = 0; j < data.size(); ++j)
-          data[j] += dither_ * distribution_(generator_);
-      }
-      // optinal remove dc offset
-      if (remove_dc_offset_) {
-        float mean = 0.0;
-        for (size_t j = 0; j < data.size(); ++j) mean += data[j];
-        mean /= data.size();
-        for (size_t j = 0; j < data.size(); ++j) data[j] -= mean;
-      }
-
-      PreEmphasis(0.97, &data);
-      // Povey(&data);
-      Hamming(&data);
-      // copy data to fft_real
-      memset(fft_img.data(), 0, sizeof(float) * fft_points_);
-      memset(fft_real.data() + frame_length_, 0,
-             sizeof(float) * (fft_points_ - frame_length_));
-      memcpy(fft_real.data(), data.data(), sizeof(float) * frame_length_);
-      fft(bitrev_.data(), sintbl_.data(), fft_real.data(), fft_img.data(),
-          fft_points_);
-      // power
-      for (int j = 0; j < fft_points_ / 2; ++j) {
-        power[j] = fft_real[j] * fft_real[j] + fft_img[j] * fft_img[j];
-      }
-
       (*feat)[i].resize(num_bins_);
-      // cepstral coefficients, triangle filter array
-      for (int j = 0; j < num_bins_; ++j) {
-        float mel_energy = 0.0;
-        int s = bins_[j].first;
-        for (size_t k = 0; k < bins_[j].second.size(); ++k) {
-          mel_energy += bins_[j].second[k] * power[s + k];
-        }
-        // optional use log
-        if (use_log_) {
-          if (mel_energy < std::numeric_limits<float>::epsilon())
-            mel_energy = std::numeric_limits<float>::epsilon();
-          mel_energy = logf(mel_energy);
-        }
-
-        (*feat)[i][j] = mel_energy;
-        // printf("%f ", mel_energy);
-      }
-      // printf("\n");
+      ComputeFrame(wave.data() + i * frame_shift_, (*feat)[i].data());
     }
     return num_frames;
   }
@@ -205,7 +212,11 @@ class Fbank {
   bool use_log_;
   bool remove_dc_offset_;
   std::vector<float> center_freqs_;
-  std::vector<std::pair<int, std::vector<float>>> bins_;
+  // sparse mel matrix: bin j covers power[mel_first_[j]...] with the weights
+  // mel_weights_[mel_offset_[j], mel_offset_[j + 1])
+  std::vector<int> mel_first_;
+  std::vector<int> mel_offset_;
+  std::vector<float> mel_weights_;
   std::vector<float> hamming_window_;
   std::default_random_engine generator_;
   std::normal_distribution<float> distribution_;
@@ -215,6 +226,12 @@ class Fbank {
   std::vector<int> bitrev_;
   // trigonometric function table
   std::vector<float> sintbl_;
+  std::vector<float> twiddle_;
+
+  // per frame scratch
+  std::vector<float> frame_;
+  std::vector<float> fft_re_, fft_im_;
+  std::vector<float> power_;
 };
 
 }  // namespace wenet
@@ -15,6 +15,8 @@
 #ifndef FRONTEND_FEATURE_PIPELINE_H_
 #define FRONTEND_FEATURE_PIPELINE_H_
 
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
 #include <queue>
 #include <string>
@@ -22,7 +24,7 @@
 
 #include "fbank.h"
 #include "log.h"
-#include "blocking_queue.h"
+#include "frame_queue.h"
 
 namespace wenet {
 
@@ -49,10 +51,13 @@ struct FeaturePipelineConfig {
 // Typically, FeaturePipeline is used in two threads: one thread A calls
 // AcceptWaveform() to add raw wav data and set_input_finished() to notice
 // the end of input wav, another thread B (decoder thread) calls Read() to
-// consume features.So a BlockingQueue is used to make this class thread safe.
+// consume features. Samples go through a fixed ring buffer and features are
+// written straight into a preallocated lock-free FrameQueue, so steady state
+// streaming neither allocates nor takes a lock.
 
-// The Read() is designed as a blocking method when there is no feature
-// in feature_queue_ and the input is not finished.
+// The Read() is designed as a blocking method when there are not enough
+// features in feature_queue_ and the input is not finished; only then the
+// consumer waits on a condition variable.
 
 class FeaturePipeline {
  public:
@@ -60,8 +65,14 @@ class FeaturePipeline {
   explicit FeaturePipeline();
 
   // The feature extraction is done in AcceptWaveform().
-  void AcceptWaveform(const std::vector<float>& wav);
-  void AcceptWaveform(const std::vector<int16_t>& wav);
+  void AcceptWaveform(const float* wav, size_t num_samples);
+  void AcceptWaveform(const int16_t* wav, size_t num_samples);
+  void AcceptWaveform(const std::vector<float>& wav) {
+    AcceptWaveform(wav.data(), wav.size());
+  }
+  void AcceptWaveform(const std::vector<int16_t>& wav) {
+    AcceptWaveform(wav.data(), wav.size());
+  }
 
   // Current extracted frames number.
   int num_frames() const { return num_frames_; }
@@ -86,6 +97,17 @@ class FeaturePipeline {
   // This function is a blocking method when there is no feature
   // in feature_queue_ and the input is not finished.
   bool Read(int num_frames, std::vector<std::vector<float>>* feats);
+  // Same as above, the frames are copied to feats[num_frames * feature_dim]
+  bool Read(int num_frames, float* feats);
+
+  // The oldest #num_frames (at most max_read_frames()) features as one
+  // contiguous num_frames * feature_dim block inside the queue, e.g. to be
+  // used as model input without a copy. Returns nullptr if less than
+  // #num_frames features are queued and wait is false, or the input is
+  // finished. The block stays valid until Consume(num_frames).
+  const float* Peek(int num_frames, bool wait = true);
+  void Consume(int num_frames) { feature_queue_.Consume(num_frames); }
+  int max_read_frames() const { return feature_queue_.max_batch(); }
 
   void Reset();
   bool IsLastFrame(int frame) const {
@@ -93,24 +115,37 @@ class FeaturePipeline {
   }
 
   int NumQueuedFrames() const { return feature_queue_.Size(); }
+  // Frames dropped because the consumer fell more than the queue capacity
+  // behind
+  int NumDroppedFrames() const { return feature_queue_.dropped(); }
 
  private:
   // const FeaturePipelineConfig& config_;
   int feature_dim_;
   Fbank fbank_;
 
-  BlockingQueue<std::vector<float>> feature_queue_;
-  int num_frames_;
-  bool input_finished_;
+  FrameQueue feature_queue_;
+  std::atomic<int> num_frames_;
+  std::atomic<bool> input_finished_;
 
   // The feature extraction is done in AcceptWaveform().
-  // This wavefrom sample points are consumed by frame size.
-  // The residual wavefrom sample points after framing are
-  // kept to be used in next AcceptWaveform() calling.
-  std::vector<float> remained_wav_;
+  // Sample points wait in a ring buffer until a whole frame is available,
+  // wav_read_/wav_write_ count samples since Reset() and index it modulo
+  // the ring size. The residual sample points after framing stay in the
+  // ring for the next AcceptWaveform() calling.
+  std::vector<float> wav_ring_;
+  size_t wav_read_;
+  size_t wav_write_;
+  // one frame gathered from the ring
+  std::vector<float> frame_;
+
+  // Wake the consumer if it waits in Peek()
+  void Notify();
 
   // Used to block the Read when there is no feature in feature_queue_
-  // and the input is not finished.
+  // and the input is not finished. The producer only takes the mutex when
+  // consumer_waiting_ is set.
+  std::atomic<bool> consumer_waiting_;
   mutable std::mutex mutex_;
   std::condition_variable finish_condition_;
 };
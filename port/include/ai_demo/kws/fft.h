@@ -20,6 +20,16 @@ void make_bitrev(int n, int* bitrev);
 
 int fft(const int* bitrev, const float* sintbl, float* x, float* y, int n);
 
+// Twiddle factors for rfft_power(): cos/sin(2*pi*k/n) for k < n/2, interleaved.
+void make_rfft_twiddle(int n, float* twiddle);
+
+// Power spectrum of n real samples through an n/2-point complex fft, using
+// the packed-complex trick: the even/odd samples are the real/imaginary part
+// of one complex sequence. bitrev/sintbl are the tables for n/2 points,
+// re/im are n/2 scratch buffers and power receives |X[k]|^2 for k < n/2.
+void rfft_power(const int* bitrev, const float* sintbl, const float* twiddle,
+                const float* x, float* re, float* im, float* power, int n);
+
 }  // namespace wenet
 
 #endif  // FRONTEND_FFT_H_
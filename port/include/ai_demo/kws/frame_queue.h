@@ -0,0 +1,117 @@
+#ifndef UTILS_FRAME_QUEUE_H_
+#define UTILS_FRAME_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+
+namespace wenet {
+
+// Lock-free single-producer/single-consumer queue of fixed size feature
+// frames. All frames live in one buffer allocated in the constructor; the
+// producer writes a frame in place between BeginPush() and EndPush(), the
+// consumer reads up to max_batch frames at once through Peek() as one
+// contiguous block and releases them with Consume(). When the queue is full
+// new frames are dropped and counted.
+//
+// The first max_batch slots are mirrored after the last slot, so a batch
+// that wraps around the end of the ring is still contiguous.
+class FrameQueue {
+ public:
+  FrameQueue(int capacity, int dim, int max_batch)
+      : capacity_(capacity),
+        dim_(dim),
+        max_batch_(max_batch),
+        data_((capacity + max_batch) * dim) {}
+
+  int dim() const { return dim_; }
+  int capacity() const { return capacity_; }
+  int max_batch() const { return max_batch_; }
+
+  // Producer: slot for the next frame, nullptr when the queue is full
+  float* BeginPush() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail - head_.load(std::memory_order_acquire) >= (size_t)capacity_) {
+      dropped_.store(dropped_.load(std::memory_order_relaxed) + 1,
+                     std::memory_order_relaxed);
+      return nullptr;
+    }
+    return slot(tail % capacity_);
+  }
+
+  // Producer: publish the frame written to the slot of BeginPush()
+  void EndPush() {
+    size_t tail = tail_.load(std::memory_order_relaxed);
+    size_t index = tail % capacity_;
+    if (index < (size_t)max_batch_) {
+      memcpy(slot(capacity_ + index), slot(index), sizeof(float) * dim_);
+    }
+    // Waking a blocked consumer is ordered by the fences in
+    // FeaturePipeline::Notify()/Peek()
+    tail_.store(tail + 1, std::memory_order_release);
+  }
+
+  // Consumer: the oldest num_frames frames as num_frames * dim contiguous
+  // floats, nullptr when fewer are queued. Valid until Consume().
+  const float* Peek(int num_frames) const {
+    size_t head = head_.load(std::memory_order_relaxed);
+    if (num_frames > max_batch_ ||
+        tail_.load(std::memory_order_acquire) - head < (size_t)num_frames) {
+      return nullptr;
+    }
+    return slot(head % capacity_);
+  }
+
+  // Consumer: release the num_frames oldest frames
+  void Consume(int num_frames) {
+    head_.store(head_.load(std::memory_order_relaxed) + num_frames,
+                std::memory_order_release);
+  }
+
+  // Consumer: copy the oldest frame to feat[dim], false when empty
+  bool Pop(float* feat) {
+    const float* frame = Peek(1);
+    if (frame == nullptr) return false;
+    memcpy(feat, frame, sizeof(float) * dim_);
+    Consume(1);
+    return true;
+  }
+
+  bool Empty() const { return Size() == 0; }
+
+  int Size() const {
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+  }
+
+  int dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  // Consumer: drop all queued frames
+  void Clear() {
+    head_.store(tail_.load(std::memory_order_acquire),
+                std::memory_order_release);
+  }
+
+ private:
+  float* slot(size_t index) { return data_.data() + index * dim_; }
+  const float* slot(size_t index) const { return data_.data() + index * dim_; }
+
+  int capacity_;
+  int dim_;
+  int max_batch_;
+  std::vector<float> data_;
+  // head_ is written by the consumer only, tail_ and dropped_ by the
+  // producer only; kept on separate cache lines
+  alignas(64) std::atomic<size_t> head_{0};
+  alignas(64) std::atomic<size_t> tail_{0};
+  std::atomic<int> dropped_{0};
+
+ public:
+  FrameQueue(const FrameQueue&) = delete;
+  FrameQueue& operator=(const FrameQueue&) = delete;
+};
+
+}  // namespace wenet
+
+#endif  // UTILS_FRAME_QUEUE_H_
@@ -3,6 +3,7 @@
 #include <iostream>
 #include <unordered_map>
 #include "constants.h"
+#include "pinyin_dict.h"
 
 using namespace std;
 class Pypinyin {
@@ -12,6 +13,7 @@ class Pypinyin {
         // }
         void Init(string dict_path,string phase_path);
         vector<vector<string>> lazy_pinyin(const string &words, Style style, bool heteronym, const string &errors, bool strict);
+        // 文本字典，字典文件是 pinyin_dict_compile 编译的二进制时不使用
         std::unordered_map <int, std::string> PINYIN_DICT;
         std::map <std::string, std::string> PHRASES_DICT;
         
@@ -20,6 +22,12 @@ class Pypinyin {
         
         int load_dict(const std::string& path);
         int load_phase_dict(const std::string& path);
+        // 查找拼音，没有时返回 nullptr
+        const char* find_pinyin(int code) const;
+        const char* find_phrase(const std::string& phrase) const;
+        // 编译后的二进制字典，mmap 映射
+        PinyinDictFile pinyin_bin_;
+        PinyinDictFile phrases_bin_;
         std::vector<std::vector<std::string>> handle_nopinyin(string han, Style style, bool heteronym, string errors, bool strict);
         std::vector<std::vector<std::string>> _single_pinyin(string han, Style style, bool heteronym, string errors, bool strict);
         string post_convert_style(string pinyin,Style style);
@@ -0,0 +1,42 @@
+#ifndef _KMODEL_CACHE_H_
+#define _KMODEL_CACHE_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// kmodel 文件缓存默认上限，只统计没有被 kpu 引用的模型
+#define KMODEL_CACHE_DEFAULT_BUDGET (64 * 1024 * 1024)
+
+typedef struct kmodel_blob kmodel_blob;
+
+typedef struct kmodel_cache_info
+{
+    uint32_t hits;
+    uint32_t misses;
+    size_t entries;
+    size_t bytes;
+    size_t budget;
+} kmodel_cache_info;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    // 按 路径+修改时间+大小 查找缓存，没有时只读mmap文件（失败时读到内存）。引用计数加一，失败返回NULL
+    kmodel_blob *kmodel_cache_acquire(const char *path);
+    // 引用计数减一，计数为0后仍保留在缓存中，超出上限时按最久未用淘汰
+    void kmodel_cache_release(kmodel_blob *blob);
+    const void *kmodel_blob_data(kmodel_blob *blob);
+    size_t kmodel_blob_size(kmodel_blob *blob);
+
+    // 在后台线程加载模型到缓存，之后的 load_kmodel 直接命中
+    bool kmodel_cache_prefetch(const char *path);
+    void kmodel_cache_set_budget(size_t bytes);
+    // 丢弃所有没有被引用的模型
+    void kmodel_cache_clear();
+    kmodel_cache_info kmodel_cache_get_info();
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _KMODEL_CACHE_H_
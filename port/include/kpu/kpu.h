@@ -31,5 +31,7 @@
 // This Kpu class is implemented by kpu.c.
 extern const mp_obj_type_t kpu_type;
 extern const mp_obj_type_t rt_type;
+// This graph class is implemented by graph.c.
+extern const mp_obj_type_t graph_type;
 
 #endif // _KPU_H_
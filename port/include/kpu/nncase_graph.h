@@ -0,0 +1,63 @@
+#ifndef _NNCASE_GRAPH_H_
+#define _NNCASE_GRAPH_H_
+
+#include "nncase_wrap.h"
+#include "postprocess.h"
+
+// 推理图：把 ai2d、kpu 和内置后处理节点按名字连起来，整条链在C里执行，
+// 节点之间的 tensor 预先分配、按引用传递，只有最终结果回到 Python
+
+// graph_add_detect() 的检测后处理类型，对应 aicube 的三种检测后处理
+#define GRAPH_DETECT_ANCHORBASE 0
+#define GRAPH_DETECT_ANCHORFREE 1
+#define GRAPH_DETECT_GFL        2
+
+// graph_slot_kind() 返回值
+#define GRAPH_SLOT_NONE         0
+#define GRAPH_SLOT_TENSOR       1
+#define GRAPH_SLOT_BOXES        2
+
+typedef struct nn_graph nn_graph;
+
+typedef struct graph_detect_param
+{
+    int type;
+    FrameSize kmodel_frame_size;
+    FrameSize frame_size;       // 检测框坐标映射到的图像大小，一般和 crop 的输入一致
+    int strides[3];
+    int num_class;
+    float det_thresh;
+    float nms_thresh;
+    float anchors[18];          // 只有 GRAPH_DETECT_ANCHORBASE 使用
+    bool nms_option;
+} graph_detect_param;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    nn_graph *graph_create();
+    void graph_destroy(nn_graph *g);
+    // 最近一次失败的原因
+    const char *graph_error(nn_graph *g);
+
+    // 声明外部输入，每次运行前用 graph_set_input() 绑定
+    bool graph_add_input(nn_graph *g, const char *name);
+    bool graph_set_input(nn_graph *g, const char *name, runtime_tensor *tensor);
+    // 节点按添加顺序执行，输入必须是已经声明的输入或前面节点的输出
+    bool graph_add_ai2d(nn_graph *g, m_builder *builder, const char *input, const char *output);
+    // 输入来自 crop 节点时，对每个ROI各推理一次，输出也按ROI切片
+    bool graph_add_kpu(nn_graph *g, Kpu *kpu, const char **inputs, size_t n_inputs, const char **outputs, size_t n_outputs);
+    bool graph_add_detect(nn_graph *g, const graph_detect_param *param, const char **inputs, const char *output);
+    // 用 builder 的配置对每个检测框做 crop(+resize/pad)，最多 max_boxes 个
+    bool graph_add_crop(nn_graph *g, m_builder *builder, const char *image, const char *boxes, const char *output, int max_boxes);
+    bool graph_run(nn_graph *g);
+
+    int graph_slot_kind(nn_graph *g, const char *name);
+    size_t graph_get_boxes(nn_graph *g, const char *name, const ob_det_res **boxes);
+    // 按ROI切片的输出 count 为本次有效的ROI个数，否则为 -1
+    runtime_tensor *graph_get_tensor(nn_graph *g, const char *name, int *count);
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _NNCASE_GRAPH_H_
@@ -1,6 +1,13 @@
+#ifndef _NNCASE_WRAP_H_
+#define _NNCASE_WRAP_H_
+
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+
+// nncase 后端接口，kpu/ai2d/graph 的绑定和后处理只通过这里的函数使用 nncase。
+// 板上由 nncase_wrap.cpp 调用 K230 nncase runtime 实现；
+// host/nncase_host.cpp 是不依赖 nncase 的CPU参考实现，用于在PC上回放录制的模型输出(见 host/Makefile)
 typedef struct runtime_tensor runtime_tensor;
 typedef struct tensor_desc tensor_desc;
 typedef struct rt_to_ndarray_info rt_to_ndarray_info;
@@ -17,12 +24,140 @@ typedef struct ai2d_affine_param ai2d_affine_param;
 typedef struct finite_data finite_data;
 typedef struct ai2d_builder m_builder;
 
+#define INTERP_METHOD_TF_NEAREST 0
+#define INTERP_METHOD_TF_BILINEAR 1
+#define INTERP_METHOD_CV2_NEAREST 2
+#define INTERP_METHOD_CV2_BILINEAR 3
+
+
+#define INTERP_MODE_NONE 0
+#define INTERP_MODE_ALIGN_CORNER 1
+#define INTERP_MODE_HALF_PIXEL 2
+
+#define AI2D_FORMAT_YUV420_NV12 0
+#define AI2D_FORMAT_YUV420_NV21 1
+#define AI2D_FORMAT_YUV420_I420 2
+#define AI2D_FORMAT_NCHW_FMT 3
+#define AI2D_FORMAT_RGB_packed 4
+#define AI2D_FORMAT_RAW16 5
+
+struct finite_data{
+    float data[8];
+    size_t data_size;
+};
+
+struct infinite_data{
+    uint8_t *data;
+    size_t data_size;
+};
+
+struct ai2d_dtype_param {
+    int src_format ;
+    int dst_format  ;
+    int src_type  ;
+    int dst_type  ;
+};
+struct ai2d_crop_param
+{
+    bool flag ;
+    int32_t start_x  ;
+    int32_t start_y  ;
+    int32_t width  ;
+    int32_t height  ;
+};
+struct ai2d_shift_param {
+    bool flag ;
+    int32_t shift_value  ;
+};
+struct ai2d_pad_param {
+    bool flag ;
+    finite_data paddings;
+    int pad_mode ;
+    finite_data pad_value;
+};
+struct ai2d_resize_param {
+    bool flag;
+    int interp_method;
+    int interp_mode;
+};
+struct ai2d_affine_param {
+    bool flag ;
+    int interp_method ;
+    uint32_t cord_round ;
+    uint32_t bound_ind ;
+    int32_t bound_val ;
+    uint32_t bound_smooth ;
+    finite_data M;
+};
+
+struct tensor_desc
+{
+    int datatype;
+    size_t start;
+    size_t size;
+};
+
+struct rt_to_ndarray_info
+{
+    uint8_t dtype_;
+    uint8_t ndim_;
+    size_t len_;
+    size_t shape_[8];
+    size_t strides_[8];
+    void *data_;
+};
+
+// Kpu_wait() 返回值
+#define KPU_ASYNC_OK        0
+#define KPU_ASYNC_TIMEOUT   1
+#define KPU_ASYNC_FAILED    2
+
+// ai2d schedule 缓存默认容量
+#define AI2D_CACHE_DEFAULT_CAPACITY 16
+
+// ai2d_run_batch() 的单个ROI，affine为true时使用仿射矩阵M，否则使用crop区域
+typedef struct ai2d_batch_roi
+{
+    bool affine;
+    int32_t start_x;
+    int32_t start_y;
+    int32_t width;
+    int32_t height;
+    float M[6];
+} ai2d_batch_roi;
+
+typedef struct ai2d_cache_info
+{
+    uint32_t hits;
+    uint32_t misses;
+    size_t size;
+    size_t capacity;
+} ai2d_cache_info;
+
+// tensor 池空闲链表默认上限，超过后 release 的 tensor 直接释放
+#define TENSOR_POOL_DEFAULT_BUDGET (16 * 1024 * 1024)
+
+typedef struct tensor_pool_info
+{
+    uint32_t allocs;        // 向 MMZ 申请的次数
+    uint32_t reuses;        // 从空闲链表复用的次数
+    size_t in_use;          // 正在使用(含被 kpu 绑定)的 tensor 个数
+    size_t in_use_bytes;
+    size_t peak_bytes;      // in_use_bytes 的峰值
+    size_t free;            // 空闲链表中的 tensor 个数
+    size_t free_bytes;
+    size_t budget;
+} tensor_pool_info;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
     Kpu* Kpu_create();
     void Kpu_destroy(Kpu *p);
     bool Kpu_run(Kpu *p);
+    bool Kpu_run_async(Kpu *p);
+    int Kpu_wait(Kpu *p, int timeout_ms);
+    bool Kpu_busy(Kpu *p);
     bool Kpu_load_kmodel_path(Kpu *p, const char *path);
     bool Kpu_load_kmodel_buffer(Kpu *p, char *buffer, size_t size);
     bool Kpu_set_input_tensor(Kpu *p, size_t index, runtime_tensor *tensor);
@@ -34,11 +169,26 @@ extern "C" {
     tensor_desc Kpu_get_input_desc(Kpu *p, size_t index);
     tensor_desc Kpu_get_output_desc(Kpu *p, size_t index);
     runtime_tensor* from_numpy(int dtype, finite_data shape, void* data, uint64_t phy_addr);
+    // 在 MMZ 上分配未初始化的 tensor，失败返回NULL
+    runtime_tensor* runtime_tensor_create(int dtype, finite_data shape);
     void to_numpy(runtime_tensor* tensor, rt_to_ndarray_info *info);
+    bool runtime_tensor_sync(runtime_tensor* tensor, bool write_back);
+    // batch tensor 中第 index 个 shape 大小的切片，共用内存，失败返回NULL
+    runtime_tensor* runtime_tensor_slice(runtime_tensor* batch, size_t index, finite_data shape);
     ai2d *ai2d_create();
     void ai2d_destroy(ai2d *p);
     m_builder* ai2d_build(ai2d *p, finite_data input_shape, finite_data output_shape);
+    // 复制 builder 的参数和 schedule(共享同一个 schedule，不重新构建)，用 ai2d_release 释放
+    m_builder* ai2d_builder_clone(m_builder *p);
     bool ai2d_run(m_builder *p, runtime_tensor* input_tensor, runtime_tensor* output_tensor);
+    bool ai2d_run_batch(m_builder *p, runtime_tensor* input_tensor, runtime_tensor* output_tensor, const ai2d_batch_roi *rois, int n);
+    runtime_tensor* ai2d_create_output(m_builder *p, size_t batch);
+    finite_data ai2d_input_shape(m_builder *p);
+    void ai2d_update_crop(m_builder *p, ai2d_crop_param crop_params);
+    void ai2d_update_affine(m_builder *p, finite_data M);
+    void ai2d_cache_set_capacity(size_t capacity);
+    void ai2d_cache_clear();
+    ai2d_cache_info ai2d_cache_get_info();
     
     void ai2d_set_dtype(ai2d *p, ai2d_dtype_param dtype);
     void ai2d_set_crop_param(ai2d *p, ai2d_crop_param crop_params);
@@ -50,9 +200,20 @@ extern "C" {
     int mp_dtype_to_nncase(char data_type);
     void runtime_tensor_release(runtime_tensor *tensor);
     void ai2d_release(m_builder *p);
+    // 先丢弃 tensor 池的空闲链表，再整理 nncase 的内存池
     void shrink_memory_pool();
+
+    // from_numpy/runtime_tensor_create/ai2d_create_output 分配的 tensor 按 dtype+shape 放进池里，
+    // release 后留在空闲链表，下次同样 dtype+shape 时直接复用，不再申请 MMZ
+    // 预先分配 count 个，预留的个数不受 budget 限制，失败返回false
+    bool tensor_pool_reserve(int dtype, finite_data shape, size_t count);
+    void tensor_pool_set_budget(size_t bytes);
+    void tensor_pool_clear();
+    tensor_pool_info tensor_pool_get_info();
     
     char* version();
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
+
+#endif // _NNCASE_WRAP_H_
@@ -0,0 +1,103 @@
+#ifndef _PROFILER_H_
+#define _PROFILER_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+// 事件环形缓冲区大小(2的幂)，超出后覆盖最旧的事件
+#define PROF_RING_SIZE  4096
+#define PROF_MAX_STAGES 64
+
+typedef struct prof_stage_stats
+{
+    const char *name;
+    uint32_t count;
+    uint64_t min_ns;
+    uint64_t avg_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    uint64_t bytes;     // 该阶段内 operator new 和 MMZ tensor 分配的字节数总和
+} prof_stage_stats;
+
+typedef struct prof_info
+{
+    bool enabled;
+    uint64_t events;    // start() 之后记录的事件数
+    uint64_t dropped;   // 被覆盖、不参与统计的事件数
+} prof_info;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+    extern bool prof_on;
+
+    // 关闭时插桩点只有这一次读取
+    static inline bool prof_enabled(void)
+    {
+        return __atomic_load_n(&prof_on, __ATOMIC_RELAXED);
+    }
+
+    uint64_t prof_now_ns(void);
+    // 按名字注册阶段，同名返回同一个id，name 必须是常量字符串
+    int prof_stage(const char *name);
+    // 当前线程累计分配的字节数，用于计算阶段内的分配量
+    uint64_t prof_alloc_mark(void);
+    void prof_count_alloc(size_t bytes);
+    void prof_record(int stage, uint64_t start_ns, uint64_t alloc_mark);
+
+    void prof_start(bool reset);
+    void prof_stop(void);
+    void prof_reset(void);
+    // 按阶段汇总环形缓冲区中的事件，返回阶段数
+    size_t prof_dump(prof_stage_stats *stats, size_t max);
+    prof_info prof_get_info(void);
+#ifdef __cplusplus
+}
+
+#include <atomic>
+
+// 作用域计时: PROF_SCOPE("kpu.run"); 在作用域结束时记录一个事件
+class prof_scope
+{
+public:
+    prof_scope(const char *name, std::atomic<int> &id) : name_(name), id_(id), start_(0)
+    {
+        if (prof_enabled())
+        {
+            alloc_ = prof_alloc_mark();
+            start_ = prof_now_ns();
+        }
+    }
+
+    ~prof_scope()
+    {
+        if (!start_)
+            return;
+        int id = id_.load(std::memory_order_relaxed);
+        if (id < 0)
+        {
+            id = prof_stage(name_);
+            id_.store(id, std::memory_order_relaxed);
+        }
+        prof_record(id, start_, alloc_);
+    }
+
+    prof_scope(const prof_scope &) = delete;
+    prof_scope &operator=(const prof_scope &) = delete;
+
+private:
+    const char *name_;
+    std::atomic<int> &id_;
+    uint64_t start_;
+    uint64_t alloc_ = 0;
+};
+
+#define PROF_CONCAT_(a, b) a##b
+#define PROF_CONCAT(a, b) PROF_CONCAT_(a, b)
+#define PROF_SCOPE(name)                                                   \
+    static std::atomic<int> PROF_CONCAT(prof_id_, __LINE__){-1};           \
+    prof_scope PROF_CONCAT(prof_scope_, __LINE__)(name, PROF_CONCAT(prof_id_, __LINE__))
+#endif
+
+#endif // _PROFILER_H_
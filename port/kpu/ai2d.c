@@ -275,31 +275,113 @@ MP_DEFINE_CONST_OBJ_TYPE(
 
 
 
+STATIC builder_obj_t *builder_get(mp_obj_t self_in) {
+    builder_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->builder)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("AI2D builder already released."));
+    return self;
+}
+
 // invoke
 STATIC mp_obj_t mp_ai2d_run(mp_obj_t self_in, mp_obj_t inputs, mp_obj_t outputs) {
-    builder_obj_t *self = MP_OBJ_TO_PTR(self_in);
-    mp_runtime_tensor_obj_t *input_tensor = MP_OBJ_TO_PTR(inputs);
-    mp_runtime_tensor_obj_t *output_tensor = MP_OBJ_TO_PTR(outputs);
-    bool flag = ai2d_run(self->builder, input_tensor->r_tensor, output_tensor->r_tensor);
+    builder_obj_t *self = builder_get(self_in);
+    bool flag = ai2d_run(self->builder, mp_runtime_tensor_get(inputs), mp_runtime_tensor_get(outputs));
     if(!flag)
         mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("AI2D run failed."));
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_3(mp_ai2d_run_obj, mp_ai2d_run);
 
+// run_batch(input, output, rois)
+// rois中每一项为 [x, y, w, h] (crop) 或 [a0, a1, b0, a2, a3, b1] (affine矩阵M)，
+// 第i个ROI的结果写到output的第i个切片，output的shape为 [N, C, H, W]，N >= len(rois)，C/H/W与build时一致
+STATIC mp_obj_t mp_ai2d_run_batch(size_t n_args, const mp_obj_t *args) {
+    builder_obj_t *self = builder_get(args[0]);
+    runtime_tensor *input_tensor = mp_runtime_tensor_get(args[1]);
+    runtime_tensor *output_tensor = mp_runtime_tensor_get(args[2]);
+
+    size_t n;
+    mp_obj_t *items;
+    mp_obj_get_array(args[3], &n, &items);
+    if (n == 0)
+        return mp_const_none;
+
+    ai2d_batch_roi *rois = m_new(ai2d_batch_roi, n);
+    for (size_t i = 0; i < n; i++) {
+        size_t len;
+        mp_obj_t *v;
+        mp_obj_get_array(items[i], &len, &v);
+        ai2d_batch_roi *roi = &rois[i];
+        if (len == 4) {
+            roi->affine = false;
+            roi->start_x = mp_obj_get_int(v[0]);
+            roi->start_y = mp_obj_get_int(v[1]);
+            roi->width = mp_obj_get_int(v[2]);
+            roi->height = mp_obj_get_int(v[3]);
+        } else if (len == 6) {
+            roi->affine = true;
+            for (int j = 0; j < 6; j++)
+                roi->M[j] = mp_obj_get_float(v[j]);
+        } else {
+            m_del(ai2d_batch_roi, rois, n);
+            mp_raise_ValueError(MP_ERROR_TEXT("roi must be [x, y, w, h] or an affine matrix of 6 floats"));
+        }
+    }
+
+    bool flag = ai2d_run_batch(self->builder, input_tensor, output_tensor, rois, n);
+    m_del(ai2d_batch_roi, rois, n);
+    if (!flag)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("AI2D run batch failed."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_ai2d_run_batch_obj, 4, 4, mp_ai2d_run_batch);
+
 static mp_obj_t mp_ai2d_release(mp_obj_t ai2d_builder_obj) {
     builder_obj_t *self = MP_OBJ_TO_PTR(ai2d_builder_obj);
-    ai2d_release(self->builder);
+    // release() 之后 __del__ 还会再调用一次
+    if (self->builder) {
+        ai2d_release(self->builder);
+        self->builder = NULL;
+    }
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_ai2d_release_obj, mp_ai2d_release);
 
+// update_crop(start_x, start_y, width, height)
+// 只更换crop区域，其他参数保持build时的值，参数组合之前出现过时直接复用缓存的schedule
+STATIC mp_obj_t mp_ai2d_update_crop(size_t n_args, const mp_obj_t *args) {
+    builder_obj_t *self = builder_get(args[0]);
+    ai2d_crop_param cp;
+    cp.flag = true;
+    cp.start_x = mp_obj_get_int(args[1]);
+    cp.start_y = mp_obj_get_int(args[2]);
+    cp.width = mp_obj_get_int(args[3]);
+    cp.height = mp_obj_get_int(args[4]);
+    ai2d_update_crop(self->builder, cp);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_ai2d_update_crop_obj, 5, 5, mp_ai2d_update_crop);
+
+// update_affine(M)
+// 只更换仿射矩阵，其他参数保持build时的值
+STATIC mp_obj_t mp_ai2d_update_affine(mp_obj_t self_in, mp_obj_t M_in) {
+    builder_obj_t *self = builder_get(self_in);
+    finite_data M;
+    _kd_mpi_struct_test_f(M_in, M.data, &M.data_size);
+    ai2d_update_affine(self->builder, M);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mp_ai2d_update_affine_obj, mp_ai2d_update_affine);
+
 
 STATIC const mp_rom_map_elem_t mp_ai2d_builder_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_ai2d_builder) },
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mp_ai2d_release_obj) },
     { MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&mp_ai2d_release_obj) },
     { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&mp_ai2d_run_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run_batch), MP_ROM_PTR(&mp_ai2d_run_batch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update_crop), MP_ROM_PTR(&mp_ai2d_update_crop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_update_affine), MP_ROM_PTR(&mp_ai2d_update_affine_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_ai2d_builder_dict, mp_ai2d_builder_dict_table);
@@ -0,0 +1,332 @@
+#include "nncase_wrap.h"
+#include "nncase_type.h"
+#include "nncase_graph.h"
+#include "kpu.h"
+#include "ai2d.h"
+#include "py/obj.h"
+#include "py/runtime.h"
+#include "py/binary.h"
+#include <string.h>
+#include "ndarray.h"
+#include "ulab.h"
+#include "ulab_tools.h"
+
+// nncase_runtime.graph
+// 把 ai2d 预处理、多个 kmodel 和检测后处理/crop 连成一条链，run() 一次执行完，
+// 中间 tensor 在声明节点时预先分配，只有 run() 指定的输出返回给 Python
+typedef struct _graph_obj_t {
+    mp_obj_base_t base;
+    nn_graph *graph;
+    // 节点用到的 kpu 和本次运行的输入，防止被GC回收；ai2d builder 在添加节点时复制
+    mp_obj_t refs;
+    mp_obj_t inputs;
+    // run() 返回过引用 graph 内存的 ndarray 时，release() 推迟到 __del__：
+    // ndarray 通过 ref_obj 引用本对象，__del__ 执行时已经没有 ndarray 引用这些 tensor
+    bool has_views;
+    nn_graph *deferred;
+} graph_obj_t;
+
+STATIC graph_obj_t *graph_get(mp_obj_t self_in) {
+    graph_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->graph)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("graph already released."));
+    return self;
+}
+
+STATIC void graph_check(graph_obj_t *self, bool ok) {
+    if (!ok)
+        mp_raise_msg_varg(&mp_type_RuntimeError, MP_ERROR_TEXT("graph: %s"), graph_error(self->graph));
+}
+
+// 名字列表转成 const char*，names 至少有 max 个元素
+STATIC size_t graph_get_names(mp_obj_t list_in, const char **names, size_t max) {
+    size_t n;
+    mp_obj_t *items;
+    mp_obj_get_array(list_in, &n, &items);
+    if (n == 0 || n > max)
+        mp_raise_ValueError(MP_ERROR_TEXT("wrong number of names"));
+    for (size_t i = 0; i < n; i++)
+        names[i] = mp_obj_str_get_str(items[i]);
+    return n;
+}
+
+STATIC FrameSize graph_get_frame_size(mp_obj_t size_in) {
+    mp_obj_t *items;
+    mp_obj_get_array_fixed_n(size_in, 2, &items);
+    FrameSize size;
+    size.width = mp_obj_get_int(items[0]);
+    size.height = mp_obj_get_int(items[1]);
+    return size;
+}
+
+STATIC mp_obj_t graph_make_new(const mp_obj_type_t *type, size_t n_args, size_t n_kw, const mp_obj_t *args) {
+    mp_arg_check_num(n_args, n_kw, 0, 0, false);
+    graph_obj_t *self = m_new_obj_with_finaliser(graph_obj_t);
+    self->base.type = &graph_type;
+    self->graph = graph_create();
+    self->refs = mp_obj_new_list(0, NULL);
+    self->inputs = mp_obj_new_list(0, NULL);
+    self->has_views = false;
+    self->deferred = NULL;
+    return MP_OBJ_FROM_PTR(self);
+}
+
+// input(name)，声明外部输入，run() 时传入 runtime_tensor
+STATIC mp_obj_t mp_graph_input(mp_obj_t self_in, mp_obj_t name_in) {
+    graph_obj_t *self = graph_get(self_in);
+    graph_check(self, graph_add_input(self->graph, mp_obj_str_get_str(name_in)));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_2(mp_graph_input_obj, mp_graph_input);
+
+// ai2d(output, builder, input)
+STATIC mp_obj_t mp_graph_ai2d(size_t n_args, const mp_obj_t *args) {
+    graph_obj_t *self = graph_get(args[0]);
+    builder_obj_t *builder = MP_OBJ_TO_PTR(args[2]);
+    if (!mp_obj_is_type(args[2], &ai2d_builder_type) || !builder->builder)
+        mp_raise_TypeError(MP_ERROR_TEXT("expected a built ai2d_builder"));
+    graph_check(self, graph_add_ai2d(self->graph, builder->builder, mp_obj_str_get_str(args[3]), mp_obj_str_get_str(args[1])));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_graph_ai2d_obj, 4, 4, mp_graph_ai2d);
+
+// kpu(outputs, kpu, inputs)，outputs/inputs 为名字列表，顺序对应 kmodel 的输出/输入
+STATIC mp_obj_t mp_graph_kpu(size_t n_args, const mp_obj_t *args) {
+    graph_obj_t *self = graph_get(args[0]);
+    if (!mp_obj_is_type(args[2], &kpu_type))
+        mp_raise_TypeError(MP_ERROR_TEXT("expected a kpu"));
+    kpu_obj_t *kpu = MP_OBJ_TO_PTR(args[2]);
+    if (Kpu_busy(kpu->interp))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("KPU is busy, call wait() first."));
+
+    const char *outputs[16];
+    const char *inputs[16];
+    size_t n_out = graph_get_names(args[1], outputs, MP_ARRAY_SIZE(outputs));
+    size_t n_in = graph_get_names(args[3], inputs, MP_ARRAY_SIZE(inputs));
+    graph_check(self, graph_add_kpu(self->graph, kpu->interp, inputs, n_in, outputs, n_out));
+    mp_obj_list_append(self->refs, args[2]);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_graph_kpu_obj, 4, 4, mp_graph_kpu);
+
+// detect(output, inputs, kind, kmodel_frame_size, frame_size, strides, num_class, det_thresh, nms_thresh, anchors=None, nms_option=False)
+// kind 为 "anchorbase"/"anchorfree"/"gfl"，参数含义和 aicube 的同名后处理一致，输入必须是 float32
+STATIC mp_obj_t mp_graph_detect(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_output, ARG_inputs, ARG_kind, ARG_kmodel_frame_size, ARG_frame_size, ARG_strides, ARG_num_class,
+           ARG_det_thresh, ARG_nms_thresh, ARG_anchors, ARG_nms_option };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_output, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_inputs, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_kind, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_kmodel_frame_size, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_frame_size, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_strides, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_num_class, MP_ARG_REQUIRED | MP_ARG_INT, { .u_int = 0 } },
+        { MP_QSTR_det_thresh, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_nms_thresh, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_anchors, MP_ARG_KW_ONLY | MP_ARG_OBJ, { .u_obj = mp_const_none } },
+        { MP_QSTR_nms_option, MP_ARG_KW_ONLY | MP_ARG_BOOL, { .u_bool = false } },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    graph_obj_t *self = graph_get(pos_args[0]);
+
+    graph_detect_param param;
+    memset(&param, 0, sizeof(param));
+    const char *kind = mp_obj_str_get_str(args[ARG_kind].u_obj);
+    if (!strcmp(kind, "anchorbase"))
+        param.type = GRAPH_DETECT_ANCHORBASE;
+    else if (!strcmp(kind, "anchorfree"))
+        param.type = GRAPH_DETECT_ANCHORFREE;
+    else if (!strcmp(kind, "gfl"))
+        param.type = GRAPH_DETECT_GFL;
+    else
+        mp_raise_ValueError(MP_ERROR_TEXT("kind must be 'anchorbase', 'anchorfree' or 'gfl'"));
+
+    param.kmodel_frame_size = graph_get_frame_size(args[ARG_kmodel_frame_size].u_obj);
+    param.frame_size = graph_get_frame_size(args[ARG_frame_size].u_obj);
+    mp_obj_t *items;
+    mp_obj_get_array_fixed_n(args[ARG_strides].u_obj, 3, &items);
+    for (int i = 0; i < 3; i++)
+        param.strides[i] = mp_obj_get_int(items[i]);
+    param.num_class = args[ARG_num_class].u_int;
+    param.det_thresh = mp_obj_get_float(args[ARG_det_thresh].u_obj);
+    param.nms_thresh = mp_obj_get_float(args[ARG_nms_thresh].u_obj);
+    param.nms_option = args[ARG_nms_option].u_bool;
+    if (param.type == GRAPH_DETECT_ANCHORBASE) {
+        if (args[ARG_anchors].u_obj == mp_const_none)
+            mp_raise_ValueError(MP_ERROR_TEXT("anchorbase needs anchors"));
+        mp_obj_get_array_fixed_n(args[ARG_anchors].u_obj, 18, &items);
+        for (int i = 0; i < 18; i++)
+            param.anchors[i] = mp_obj_get_float(items[i]);
+    }
+
+    const char *inputs[3];
+    if (graph_get_names(args[ARG_inputs].u_obj, inputs, 3) != 3)
+        mp_raise_ValueError(MP_ERROR_TEXT("detect needs 3 inputs"));
+    graph_check(self, graph_add_detect(self->graph, &param, inputs, mp_obj_str_get_str(args[ARG_output].u_obj)));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mp_graph_detect_obj, 1, mp_graph_detect);
+
+// crop(output, builder, image, boxes, max_boxes=8)
+// 按 detect 节点的每个检测框从 image 裁剪并用 builder 的配置 resize，输出第0维为ROI，
+// 后面的 kpu 节点对每个ROI推理一次
+STATIC mp_obj_t mp_graph_crop(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_output, ARG_builder, ARG_image, ARG_boxes, ARG_max_boxes };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_output, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_builder, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_image, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_boxes, MP_ARG_REQUIRED | MP_ARG_OBJ, { .u_obj = MP_OBJ_NULL } },
+        { MP_QSTR_max_boxes, MP_ARG_INT, { .u_int = 8 } },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
+    graph_obj_t *self = graph_get(pos_args[0]);
+
+    mp_obj_t builder_in = args[ARG_builder].u_obj;
+    builder_obj_t *builder = MP_OBJ_TO_PTR(builder_in);
+    if (!mp_obj_is_type(builder_in, &ai2d_builder_type) || !builder->builder)
+        mp_raise_TypeError(MP_ERROR_TEXT("expected a built ai2d_builder"));
+    graph_check(self, graph_add_crop(self->graph, builder->builder, mp_obj_str_get_str(args[ARG_image].u_obj),
+                                     mp_obj_str_get_str(args[ARG_boxes].u_obj), mp_obj_str_get_str(args[ARG_output].u_obj),
+                                     args[ARG_max_boxes].u_int));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mp_graph_crop_obj, 1, mp_graph_crop);
+
+STATIC mp_obj_t graph_boxes_to_list(graph_obj_t *self, const char *name) {
+    const ob_det_res *boxes;
+    size_t n = graph_get_boxes(self->graph, name, &boxes);
+    mp_obj_t list = mp_obj_new_list(0, NULL);
+    for (size_t i = 0; i < n; i++) {
+        mp_obj_t item[6] = {
+            mp_obj_new_int(boxes[i].label_index),
+            mp_obj_new_float(boxes[i].score),
+            mp_obj_new_int(boxes[i].x1),
+            mp_obj_new_int(boxes[i].y1),
+            mp_obj_new_int(boxes[i].x2),
+            mp_obj_new_int(boxes[i].y2),
+        };
+        mp_obj_list_append(list, mp_obj_new_list(6, item));
+    }
+    return list;
+}
+
+// 直接引用 graph 内部的 tensor，下一次 run() 会覆盖其内容
+STATIC mp_obj_t graph_tensor_to_ndarray(graph_obj_t *self, const char *name) {
+    int count;
+    runtime_tensor *tensor = graph_get_tensor(self->graph, name, &count);
+    rt_to_ndarray_info info;
+    to_numpy(tensor, &info);
+    if (count >= 0)
+        info.shape_[0] = count;
+
+    size_t mp_shape[ULAB_MAX_DIMS];
+    int32_t mp_stride[ULAB_MAX_DIMS];
+    size_t size_bytes = ulab_binary_get_size(info.dtype_);
+    for (int i = 0; i < info.ndim_; i++) {
+        mp_shape[ULAB_MAX_DIMS - 1 - i] = (size_t)info.shape_[info.ndim_ - 1 - i];
+        mp_stride[ULAB_MAX_DIMS - 1 - i] = (int32_t)info.strides_[info.ndim_ - 1 - i] * size_bytes;
+    }
+    self->has_views = true;
+    return MP_OBJ_FROM_PTR(ndarray_new_ndarray_by_ref(info.ndim_, mp_shape, mp_stride, info.dtype_, 0, info.data_, MP_OBJ_FROM_PTR(self)));
+}
+
+// run(inputs, outputs) -> list
+// inputs 为 {name: runtime_tensor}，outputs 为要返回的名字列表；
+// detect 输出返回 [[label, score, x1, y1, x2, y2], ...]，tensor 输出返回引用内部内存的 ndarray，
+// 按ROI推理的输出第0维为本次检测到的ROI个数
+STATIC mp_obj_t mp_graph_run(mp_obj_t self_in, mp_obj_t inputs_in, mp_obj_t outputs_in) {
+    graph_obj_t *self = graph_get(self_in);
+    mp_map_t *map = mp_obj_dict_get_map(inputs_in);
+
+    mp_obj_list_t *keep = MP_OBJ_TO_PTR(self->inputs);
+    keep->len = 0;
+    for (size_t i = 0; i < map->alloc; i++) {
+        if (!mp_map_slot_is_filled(map, i))
+            continue;
+        if (!mp_obj_is_type(map->table[i].value, &rt_type))
+            mp_raise_TypeError(MP_ERROR_TEXT("inputs must be runtime_tensor"));
+        graph_check(self, graph_set_input(self->graph, mp_obj_str_get_str(map->table[i].key), mp_runtime_tensor_get(map->table[i].value)));
+        mp_obj_list_append(self->inputs, map->table[i].value);
+    }
+
+    size_t n;
+    mp_obj_t *names;
+    mp_obj_get_array(outputs_in, &n, &names);
+    for (size_t i = 0; i < n; i++) {
+        if (graph_slot_kind(self->graph, mp_obj_str_get_str(names[i])) == GRAPH_SLOT_NONE)
+            mp_raise_msg_varg(&mp_type_KeyError, MP_ERROR_TEXT("graph: unknown output %s"), mp_obj_str_get_str(names[i]));
+    }
+
+    graph_check(self, graph_run(self->graph));
+
+    mp_obj_t result = mp_obj_new_list(0, NULL);
+    for (size_t i = 0; i < n; i++) {
+        const char *name = mp_obj_str_get_str(names[i]);
+        if (graph_slot_kind(self->graph, name) == GRAPH_SLOT_BOXES)
+            mp_obj_list_append(result, graph_boxes_to_list(self, name));
+        else
+            mp_obj_list_append(result, graph_tensor_to_ndarray(self, name));
+    }
+    return result;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_3(mp_graph_run_obj, mp_graph_run);
+
+// release() 之后 graph 不能再使用；run() 返回的 ndarray 可能还在引用 graph 的 tensor 时，
+// tensor 和节点引用的 kpu 留到 __del__ 再释放，需要立即释放时先 del 掉这些 ndarray 或拷贝结果
+STATIC mp_obj_t mp_graph_release(mp_obj_t self_in) {
+    graph_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (self->graph) {
+        if (self->has_views) {
+            self->deferred = self->graph;
+            self->graph = NULL;
+            return mp_const_none;
+        }
+        graph_destroy(self->graph);
+        self->graph = NULL;
+    }
+    if (!self->deferred) {
+        self->refs = mp_const_none;
+        self->inputs = mp_const_none;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_graph_release_obj, mp_graph_release);
+
+STATIC mp_obj_t mp_graph_del(mp_obj_t self_in) {
+    graph_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    nn_graph *graph = self->graph ? self->graph : self->deferred;
+    if (graph)
+        graph_destroy(graph);
+    self->graph = NULL;
+    self->deferred = NULL;
+    self->refs = mp_const_none;
+    self->inputs = mp_const_none;
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_graph_del_obj, mp_graph_del);
+
+STATIC const mp_rom_map_elem_t mp_graph_dict_table[] = {
+    { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_graph) },
+    { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mp_graph_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&mp_graph_release_obj) },
+    { MP_ROM_QSTR(MP_QSTR_input), MP_ROM_PTR(&mp_graph_input_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ai2d), MP_ROM_PTR(&mp_graph_ai2d_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kpu), MP_ROM_PTR(&mp_graph_kpu_obj) },
+    { MP_ROM_QSTR(MP_QSTR_detect), MP_ROM_PTR(&mp_graph_detect_obj) },
+    { MP_ROM_QSTR(MP_QSTR_crop), MP_ROM_PTR(&mp_graph_crop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&mp_graph_run_obj) },
+};
+
+STATIC MP_DEFINE_CONST_DICT(mp_graph_dict, mp_graph_dict_table);
+
+MP_DEFINE_CONST_OBJ_TYPE(
+    graph_type,
+    MP_QSTR_graph,
+    MP_TYPE_FLAG_NONE,
+    make_new, graph_make_new,
+    locals_dict, &mp_graph_dict
+);
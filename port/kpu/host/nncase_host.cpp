@@ -0,0 +1,1035 @@
+#include "nncase_wrap.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// nncase_wrap.h 的CPU参考实现，不依赖 nncase 和 K230 硬件
+// tensor 放在普通内存里，sync 不需要做任何事；ai2d 用浮点逐像素计算，结果和硬件接近但不保证逐位一致；
+// kpu 不做推理，按顺序回放录制好的模型输出。
+
+// 和 nncase::typecode_t 的取值一致
+enum host_typecode
+{
+    dt_boolean = 0,
+    dt_int8 = 2,
+    dt_int16 = 3,
+    dt_int32 = 4,
+    dt_int64 = 5,
+    dt_uint8 = 6,
+    dt_uint16 = 7,
+    dt_uint32 = 8,
+    dt_uint64 = 9,
+    dt_float32 = 11,
+    dt_float64 = 12,
+};
+
+// ai2d_pad_mode
+#define AI2D_PAD_CONSTANT   0
+#define AI2D_PAD_COPY       1
+#define AI2D_PAD_MIRROR     2
+
+struct host_buffer
+{
+    uint8_t *data = nullptr;
+    size_t size = 0;
+    bool owned = true;
+
+    ~host_buffer()
+    {
+        if (owned)
+            free(data);
+    }
+};
+
+struct runtime_tensor
+{
+    std::shared_ptr<host_buffer> buffer;
+    size_t offset = 0;
+    int datatype = dt_uint8;
+    std::vector<size_t> shape;
+};
+
+struct interpreter
+{
+    // 回放的输入输出描述和录制的帧，frames[k][i] 为第k帧第i个输出
+    std::vector<runtime_tensor> inputs;
+    std::vector<runtime_tensor> outputs;
+    std::vector<std::vector<std::vector<uint8_t>>> frames;
+    size_t next_frame = 0;
+
+    // run_async() 在主机上同步执行，只保留和板上一致的状态和输出ping-pong
+    std::mutex lock;
+    bool finished = false;
+    bool ok = true;
+    bool own_outputs = true;
+    int slot = 0;
+    std::vector<runtime_tensor> slots[2];
+};
+
+struct ai2d
+{
+    ai2d_dtype_param dtype;
+    ai2d_crop_param crop;
+    ai2d_shift_param shift;
+    ai2d_pad_param pad;
+    ai2d_resize_param resize;
+    ai2d_affine_param affine;
+};
+
+struct ai2d_builder
+{
+    ai2d param;
+    std::vector<size_t> in_shape;
+    std::vector<size_t> out_shape;
+};
+
+// 主机上没有 schedule 可缓存，只保留容量设置让接口行为一致
+static size_t ai2d_cache_capacity = AI2D_CACHE_DEFAULT_CAPACITY;
+
+// utils
+static size_t host_dtype_bytes(int dtype)
+{
+    switch (dtype)
+    {
+    case dt_boolean:
+    case dt_int8:
+    case dt_uint8:
+        return 1;
+    case dt_int16:
+    case dt_uint16:
+        return 2;
+    case dt_int32:
+    case dt_uint32:
+    case dt_float32:
+        return 4;
+    case dt_int64:
+    case dt_uint64:
+    case dt_float64:
+        return 8;
+    default:
+        throw std::runtime_error("Unsupported data type.");
+    }
+}
+
+static char host_dtype_for_mp(int dtype)
+{
+    switch (dtype)
+    {
+    case dt_boolean:
+        return '?';
+    case dt_int8:
+        return 'b';
+    case dt_uint8:
+        return 'B';
+    case dt_int16:
+        return 'h';
+    case dt_uint16:
+        return 'H';
+    case dt_int32:
+        return 'i';
+    case dt_uint32:
+        return 'I';
+    case dt_int64:
+        return 'l';
+    case dt_uint64:
+        return 'L';
+    case dt_float32:
+        return 'f';
+    case dt_float64:
+        return 'd';
+    default:
+        throw std::runtime_error("Unsupported data type.");
+    }
+}
+
+int mp_dtype_to_nncase(char data_type)
+{
+    switch (data_type)
+    {
+    case '?':
+        return dt_boolean;
+    case 'b':
+        return dt_int8;
+    case 'B':
+        return dt_uint8;
+    case 'h':
+        return dt_int16;
+    case 'H':
+        return dt_uint16;
+    case 'i':
+        return dt_int32;
+    case 'I':
+        return dt_uint32;
+    case 'l':
+        return dt_int64;
+    case 'L':
+        return dt_uint64;
+    case 'f':
+        return dt_float32;
+    case 'd':
+        return dt_float64;
+    default:
+        return -1;
+    }
+}
+
+static size_t host_elements(const std::vector<size_t> &shape)
+{
+    size_t n = 1;
+    for (auto d : shape)
+        n *= d;
+    return n;
+}
+
+static size_t host_tensor_bytes(const runtime_tensor &t)
+{
+    return host_elements(t.shape) * host_dtype_bytes(t.datatype);
+}
+
+static uint8_t *host_tensor_data(const runtime_tensor &t)
+{
+    return t.buffer->data + t.offset;
+}
+
+static std::vector<size_t> host_shape(finite_data shape)
+{
+    std::vector<size_t> s(shape.data_size);
+    for (size_t i = 0; i < shape.data_size; i++)
+        s[i] = (size_t)shape.data[i];
+    return s;
+}
+
+// PC 上不做 tensor 复用，只统计申请次数
+static struct
+{
+    uint32_t allocs = 0;
+    size_t budget = TENSOR_POOL_DEFAULT_BUDGET;
+} host_tensor_pool;
+
+// 分配清零的 tensor，失败返回 false
+static bool host_tensor_alloc(runtime_tensor &t, int dtype, const std::vector<size_t> &shape)
+{
+    t.datatype = dtype;
+    t.shape = shape;
+    t.offset = 0;
+    t.buffer = std::make_shared<host_buffer>();
+    t.buffer->size = host_tensor_bytes(t);
+    t.buffer->data = (uint8_t *)calloc(1, std::max(t.buffer->size, (size_t)1));
+    if (!t.buffer->data)
+        return false;
+    prof_count_alloc(t.buffer->size);
+    host_tensor_pool.allocs++;
+    return true;
+}
+
+static runtime_tensor *host_tensor_new(const runtime_tensor &t)
+{
+    return new runtime_tensor(t);
+}
+
+void shrink_memory_pool()
+{
+    tensor_pool_clear();
+}
+
+bool tensor_pool_reserve(int dtype, finite_data shape, size_t count)
+{
+    return dtype != -1;
+}
+
+void tensor_pool_set_budget(size_t bytes)
+{
+    host_tensor_pool.budget = bytes;
+}
+
+void tensor_pool_clear()
+{
+    host_tensor_pool.allocs = 0;
+}
+
+tensor_pool_info tensor_pool_get_info()
+{
+    tensor_pool_info info = {};
+    info.allocs = host_tensor_pool.allocs;
+    info.budget = host_tensor_pool.budget;
+    return info;
+}
+
+
+// 回放的模型
+// load_kmodel(path) 读取 <path>.replay/manifest，每行描述一个输入或输出：
+//     input B 1,3,320,320
+//     output f 1,4200,4
+//     frames 10
+// 类型为 ulab 的 dtype 字符。第k帧第i个输出的原始数据在 <path>.replay/output<i>_<k>.bin，
+// 即板上 kpu.get_output_tensor(i).to_numpy().tobytes() 写出的内容。
+// 每次 run() 依次取下一帧，回放完后从头开始；没有录制帧时输出全为0。
+static bool kpu_parse_shape(const std::string &text, std::vector<size_t> &shape)
+{
+    std::stringstream ss(text);
+    std::string dim;
+    shape.clear();
+    while (std::getline(ss, dim, ','))
+    {
+        char *end;
+        long v = strtol(dim.c_str(), &end, 10);
+        if (end == dim.c_str() || v <= 0)
+            return false;
+        shape.push_back(v);
+    }
+    return !shape.empty() && shape.size() <= 8;
+}
+
+static bool kpu_load_replay(Kpu *p, const std::string &dir)
+{
+    std::ifstream manifest(dir + "/manifest");
+    if (!manifest)
+        return false;
+
+    std::vector<runtime_tensor> inputs, outputs;
+    size_t n_frames = 0;
+    std::string line;
+    while (std::getline(manifest, line))
+    {
+        std::stringstream ss(line);
+        std::string kind, dtype, dims;
+        if (!(ss >> kind) || kind[0] == '#')
+            continue;
+        if (kind == "frames")
+        {
+            if (!(ss >> n_frames))
+                return false;
+            continue;
+        }
+
+        std::vector<size_t> shape;
+        if (!(ss >> dtype >> dims) || dtype.size() != 1 || mp_dtype_to_nncase(dtype[0]) < 0 || !kpu_parse_shape(dims, shape))
+            return false;
+        runtime_tensor t;
+        if (!host_tensor_alloc(t, mp_dtype_to_nncase(dtype[0]), shape))
+            return false;
+        if (kind == "input")
+            inputs.push_back(t);
+        else if (kind == "output")
+            outputs.push_back(t);
+        else
+            return false;
+    }
+    if (inputs.empty() || outputs.empty())
+        return false;
+
+    std::vector<std::vector<std::vector<uint8_t>>> frames(n_frames);
+    for (size_t k = 0; k < n_frames; k++)
+    {
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            std::string name = dir + "/output" + std::to_string(i) + "_" + std::to_string(k) + ".bin";
+            std::ifstream f(name, std::ios::binary);
+            std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+            if (!f.good() && !f.eof())
+                return false;
+            if (data.size() != host_tensor_bytes(outputs[i]))
+                return false;
+            frames[k].push_back(std::move(data));
+        }
+    }
+
+    p->inputs = std::move(inputs);
+    p->outputs = std::move(outputs);
+    p->frames = std::move(frames);
+    p->next_frame = 0;
+    return true;
+}
+
+// func
+Kpu *Kpu_create()
+{
+    return new Kpu;
+}
+
+void Kpu_destroy(Kpu *p)
+{
+    delete p;
+}
+
+bool Kpu_run(Kpu *p)
+{
+    PROF_SCOPE("kpu.run");
+    if (p->outputs.empty())
+        return false;
+    for (auto &in : p->inputs)
+    {
+        if (!in.buffer)
+            return false;
+    }
+
+    const std::vector<std::vector<uint8_t>> *frame = nullptr;
+    if (!p->frames.empty())
+    {
+        frame = &p->frames[p->next_frame];
+        p->next_frame = (p->next_frame + 1) % p->frames.size();
+    }
+    for (size_t i = 0; i < p->outputs.size(); i++)
+    {
+        runtime_tensor &out = p->outputs[i];
+        size_t bytes = host_tensor_bytes(out);
+        if (frame)
+            memcpy(host_tensor_data(out), (*frame)[i].data(), std::min(bytes, (*frame)[i].size()));
+        else
+            memset(host_tensor_data(out), 0, bytes);
+    }
+    return true;
+}
+
+bool Kpu_run_async(Kpu *p)
+{
+    if (p->own_outputs)
+    {
+        // 和板上一样两组输出交替使用，上一帧的输出在下一次 run_async() 之后仍然有效
+        if (p->slots[0].empty())
+        {
+            for (int k = 0; k < 2; k++)
+            {
+                for (auto &o : p->outputs)
+                {
+                    runtime_tensor t;
+                    if (!host_tensor_alloc(t, o.datatype, o.shape))
+                    {
+                        p->slots[0].clear();
+                        p->slots[1].clear();
+                        return false;
+                    }
+                    p->slots[k].push_back(t);
+                }
+            }
+        }
+        p->outputs = p->slots[p->slot];
+        p->slot ^= 1;
+    }
+
+    bool ok;
+    {
+        PROF_SCOPE("kpu.run_async");
+        ok = Kpu_run(p);
+    }
+    std::lock_guard<std::mutex> guard(p->lock);
+    p->ok = ok;
+    p->finished = true;
+    return true;
+}
+
+int Kpu_wait(Kpu *p, int timeout_ms)
+{
+    std::lock_guard<std::mutex> guard(p->lock);
+    bool finished = p->finished;
+    p->finished = false;
+    if (finished && !p->ok)
+        return KPU_ASYNC_FAILED;
+    return KPU_ASYNC_OK;
+}
+
+bool Kpu_busy(Kpu *p)
+{
+    return false;
+}
+
+bool Kpu_load_kmodel_path(Kpu *p, const char *path)
+{
+    p->own_outputs = true;
+    p->slot = 0;
+    p->slots[0].clear();
+    p->slots[1].clear();
+    return kpu_load_replay(p, std::string(path) + ".replay");
+}
+
+// 回放需要 manifest 所在的目录，从内存加载的模型无法回放
+bool Kpu_load_kmodel_buffer(Kpu *p, char *buffer, size_t size)
+{
+    return false;
+}
+
+bool Kpu_set_input_tensor(Kpu *p, size_t index, runtime_tensor *tensor)
+{
+    if (index >= p->inputs.size() || tensor->datatype != p->inputs[index].datatype ||
+        host_tensor_bytes(*tensor) != host_tensor_bytes(p->inputs[index]))
+        return false;
+    p->inputs[index] = *tensor;
+    return true;
+}
+
+runtime_tensor *Kpu_get_input_tensor(Kpu *p, size_t index)
+{
+    if (index >= p->inputs.size())
+        throw std::runtime_error("kpu get input tensor failed.");
+    return host_tensor_new(p->inputs[index]);
+}
+
+bool Kpu_set_output_tensor(Kpu *p, size_t index, runtime_tensor *tensor)
+{
+    // 用户自己管理输出tensor时不再做ping-pong
+    p->own_outputs = false;
+    if (index >= p->outputs.size() || tensor->datatype != p->outputs[index].datatype ||
+        host_tensor_bytes(*tensor) != host_tensor_bytes(p->outputs[index]))
+        return false;
+    p->outputs[index] = *tensor;
+    return true;
+}
+
+runtime_tensor *Kpu_get_output_tensor(Kpu *p, size_t index)
+{
+    if (index >= p->outputs.size())
+        throw std::runtime_error("kpu get output tensor failed.");
+    return host_tensor_new(p->outputs[index]);
+}
+
+size_t Kpu_inputs_size(Kpu *p)
+{
+    return p->inputs.size();
+}
+
+size_t Kpu_outputs_size(Kpu *p)
+{
+    return p->outputs.size();
+}
+
+tensor_desc Kpu_get_input_desc(Kpu *p, size_t index)
+{
+    runtime_tensor &t = p->inputs.at(index);
+    tensor_desc d = {.datatype = t.datatype, .start = 0, .size = host_tensor_bytes(t)};
+    return d;
+}
+
+tensor_desc Kpu_get_output_desc(Kpu *p, size_t index)
+{
+    runtime_tensor &t = p->outputs.at(index);
+    tensor_desc d = {.datatype = t.datatype, .start = 0, .size = host_tensor_bytes(t)};
+    return d;
+}
+
+// phy_addr 不为0时 data 是调用者持有的内存，直接引用，否则拷贝一份
+runtime_tensor *from_numpy(int dtype, finite_data shape, void *data, uint64_t phy_addr)
+{
+    PROF_SCOPE("tensor.from_numpy");
+    if (dtype == -1)
+        throw std::runtime_error("Unsupported data type.");
+    runtime_tensor t;
+    if (phy_addr == 0)
+    {
+        if (!host_tensor_alloc(t, dtype, host_shape(shape)))
+            throw std::runtime_error("cannot create input tensor");
+        memcpy(t.buffer->data, data, t.buffer->size);
+    }
+    else
+    {
+        t.datatype = dtype;
+        t.shape = host_shape(shape);
+        t.buffer = std::make_shared<host_buffer>();
+        t.buffer->data = (uint8_t *)data;
+        t.buffer->size = host_tensor_bytes(t);
+        t.buffer->owned = false;
+    }
+    return host_tensor_new(t);
+}
+
+runtime_tensor *runtime_tensor_create(int dtype, finite_data shape)
+{
+    if (dtype == -1)
+        return nullptr;
+    runtime_tensor t;
+    if (!host_tensor_alloc(t, dtype, host_shape(shape)))
+        return nullptr;
+    return host_tensor_new(t);
+}
+
+void to_numpy(runtime_tensor *tensor, rt_to_ndarray_info *info)
+{
+    PROF_SCOPE("tensor.to_numpy");
+    info->dtype_ = host_dtype_for_mp(tensor->datatype);
+    info->ndim_ = tensor->shape.size();
+    info->len_ = host_elements(tensor->shape);
+    size_t stride = 1;
+    for (int i = info->ndim_ - 1; i >= 0; i--)
+    {
+        info->shape_[i] = tensor->shape[i];
+        info->strides_[i] = stride;
+        stride *= tensor->shape[i];
+    }
+    info->data_ = host_tensor_data(*tensor);
+}
+
+bool runtime_tensor_sync(runtime_tensor *tensor, bool write_back)
+{
+    PROF_SCOPE("tensor.sync");
+    return true;
+}
+
+runtime_tensor *runtime_tensor_slice(runtime_tensor *batch, size_t index, finite_data shape)
+{
+    runtime_tensor t;
+    t.datatype = batch->datatype;
+    t.shape = host_shape(shape);
+    size_t bytes = host_tensor_bytes(t);
+    if (batch->offset + (index + 1) * bytes > batch->buffer->size)
+        return nullptr;
+    t.buffer = batch->buffer;
+    t.offset = batch->offset + index * bytes;
+    return host_tensor_new(t);
+}
+
+
+// ai2d
+// 处理顺序和硬件一致: crop -> shift -> resize 或 affine -> pad -> 输出类型转换。
+// 输入/输出 NCHW_FMT 为 [N,C,H,W]，RGB_packed 为 [N,H,W,C]；
+// YUV420 输入的 shape 为 [N,3,H,W]，数据为 H*W 的Y平面加上 NV12/NV21 的交错UV或 I420 的U、V平面，
+// 按 BT.601 full range 转成 RGB。
+struct ai2d_image
+{
+    const uint8_t *data;
+    int dtype;
+    int format;
+    int c, h, w;
+    int shift;
+};
+
+static float ai2d_load(const uint8_t *p, int dtype, size_t i)
+{
+    switch (dtype)
+    {
+    case dt_int8:
+        return ((const int8_t *)p)[i];
+    case dt_uint8:
+        return p[i];
+    case dt_int16:
+        return ((const int16_t *)p)[i];
+    case dt_uint16:
+        return ((const uint16_t *)p)[i];
+    case dt_float32:
+        return ((const float *)p)[i];
+    default:
+        throw std::runtime_error("ai2d: unsupported data type.");
+    }
+}
+
+static float ai2d_pixel(const ai2d_image &img, int c, int y, int x)
+{
+    size_t plane = (size_t)img.h * img.w;
+    switch (img.format)
+    {
+    case AI2D_FORMAT_YUV420_NV12:
+    case AI2D_FORMAT_YUV420_NV21:
+    case AI2D_FORMAT_YUV420_I420:
+    {
+        float Y = img.data[(size_t)y * img.w + x];
+        float U, V;
+        size_t ci = (size_t)(y / 2) * (img.w / 2) + (x / 2);
+        if (img.format == AI2D_FORMAT_YUV420_I420)
+        {
+            U = img.data[plane + ci];
+            V = img.data[plane + (plane / 4) + ci];
+        }
+        else
+        {
+            const uint8_t *uv = img.data + plane + (size_t)(y / 2) * img.w + (x & ~1);
+            bool nv21 = img.format == AI2D_FORMAT_YUV420_NV21;
+            U = uv[nv21 ? 1 : 0];
+            V = uv[nv21 ? 0 : 1];
+        }
+        U -= 128.f;
+        V -= 128.f;
+        float v = (c == 0) ? Y + 1.402f * V : (c == 1) ? Y - 0.344136f * U - 0.714136f * V : Y + 1.772f * U;
+        return std::clamp(v, 0.f, 255.f);
+    }
+    case AI2D_FORMAT_RGB_packed:
+        return ai2d_load(img.data, img.dtype, ((size_t)y * img.w + x) * img.c + c);
+    default:
+    {
+        float v = ai2d_load(img.data, img.dtype, (size_t)c * plane + (size_t)y * img.w + x);
+        if (img.shift)
+            v = (float)((int32_t)v >> img.shift);
+        return v;
+    }
+    }
+}
+
+static float ai2d_bilinear(const ai2d_image &img, int c, int x0, int y0, int w, int h, float sx, float sy)
+{
+    sx = std::clamp(sx, 0.f, (float)(w - 1));
+    sy = std::clamp(sy, 0.f, (float)(h - 1));
+    int ix = (int)sx, iy = (int)sy;
+    int ix1 = std::min(ix + 1, w - 1), iy1 = std::min(iy + 1, h - 1);
+    float fx = sx - ix, fy = sy - iy;
+    float top = ai2d_pixel(img, c, y0 + iy, x0 + ix) * (1 - fx) + ai2d_pixel(img, c, y0 + iy, x0 + ix1) * fx;
+    float bottom = ai2d_pixel(img, c, y0 + iy1, x0 + ix) * (1 - fx) + ai2d_pixel(img, c, y0 + iy1, x0 + ix1) * fx;
+    return top * (1 - fy) + bottom * fy;
+}
+
+// 输出坐标 d 映射到长度 src 的源坐标，dst 为输出长度
+static float ai2d_map(int d, int src, int dst, int method, int mode)
+{
+    bool cv2 = method == INTERP_METHOD_CV2_NEAREST || method == INTERP_METHOD_CV2_BILINEAR;
+    bool nearest = method == INTERP_METHOD_TF_NEAREST || method == INTERP_METHOD_CV2_NEAREST;
+    if (mode == INTERP_MODE_ALIGN_CORNER && !cv2)
+    {
+        float scale = dst > 1 ? (float)(src - 1) / (dst - 1) : 0.f;
+        return nearest ? roundf(d * scale) : d * scale;
+    }
+    float scale = (float)src / dst;
+    if (nearest)
+        return floorf((cv2 || mode != INTERP_MODE_HALF_PIXEL) ? d * scale : (d + 0.5f) * scale);
+    if (cv2 || mode == INTERP_MODE_HALF_PIXEL)
+        return (d + 0.5f) * scale - 0.5f;
+    return d * scale;
+}
+
+static void ai2d_store(uint8_t *p, int dtype, size_t i, float v)
+{
+    switch (dtype)
+    {
+    case dt_int8:
+        ((int8_t *)p)[i] = (int8_t)std::clamp(lrintf(v), -128l, 127l);
+        break;
+    case dt_uint8:
+        p[i] = (uint8_t)std::clamp(lrintf(v), 0l, 255l);
+        break;
+    case dt_int16:
+        ((int16_t *)p)[i] = (int16_t)std::clamp(lrintf(v), -32768l, 32767l);
+        break;
+    case dt_uint16:
+        ((uint16_t *)p)[i] = (uint16_t)std::clamp(lrintf(v), 0l, 65535l);
+        break;
+    case dt_float32:
+        ((float *)p)[i] = v;
+        break;
+    default:
+        throw std::runtime_error("ai2d: unsupported data type.");
+    }
+}
+
+static int ai2d_reflect(int v, int n, int mode)
+{
+    if (v >= 0 && v < n)
+        return v;
+    if (mode == AI2D_PAD_COPY || n == 1)
+        return std::clamp(v, 0, n - 1);
+    int period = 2 * (n - 1);
+    v = ((v % period) + period) % period;
+    return v < n ? v : period - v;
+}
+
+static bool ai2d_invoke(const ai2d &p, const std::vector<size_t> &in_shape, const std::vector<size_t> &out_shape,
+                        const runtime_tensor &in, uint8_t *out)
+{
+    if (in_shape.size() != 4 || out_shape.size() != 4)
+        return false;
+    bool in_packed = p.dtype.src_format == AI2D_FORMAT_RGB_packed;
+    bool out_packed = p.dtype.dst_format == AI2D_FORMAT_RGB_packed;
+    ai2d_image img;
+    img.data = host_tensor_data(in);
+    img.dtype = p.dtype.src_type;
+    img.format = p.dtype.src_format;
+    img.c = in_packed ? in_shape[3] : in_shape[1];
+    img.h = in_packed ? in_shape[1] : in_shape[2];
+    img.w = in_packed ? in_shape[2] : in_shape[3];
+    img.shift = p.shift.flag ? p.shift.shift_value : 0;
+    if (p.dtype.src_format == AI2D_FORMAT_RAW16)
+        return false;
+
+    int oc = out_packed ? out_shape[3] : out_shape[1];
+    int oh = out_packed ? out_shape[1] : out_shape[2];
+    int ow = out_packed ? out_shape[2] : out_shape[3];
+    if (oc > img.c)
+        return false;
+
+    int cx = 0, cy = 0, cw = img.w, ch = img.h;
+    if (p.crop.flag)
+    {
+        cx = p.crop.start_x;
+        cy = p.crop.start_y;
+        cw = p.crop.width;
+        ch = p.crop.height;
+        if (cx < 0 || cy < 0 || cw <= 0 || ch <= 0 || cx + cw > img.w || cy + ch > img.h)
+            return false;
+    }
+
+    int top = 0, bottom = 0, left = 0, right = 0;
+    if (p.pad.flag)
+    {
+        top = p.pad.paddings.data[4];
+        bottom = p.pad.paddings.data[5];
+        left = p.pad.paddings.data[6];
+        right = p.pad.paddings.data[7];
+    }
+    int iw = ow - left - right, ih = oh - top - bottom;
+    if (iw <= 0 || ih <= 0)
+        return false;
+    bool resize = p.resize.flag && !p.affine.flag;
+    if (!resize && !p.affine.flag && (iw != cw || ih != ch))
+        return false;
+
+    // 仿射矩阵 M 把源坐标映射到输出坐标，逐像素采样时用它的逆
+    float inv[6] = {0};
+    if (p.affine.flag)
+    {
+        if (p.affine.M.data_size < 6)
+            return false;
+        const float *M = p.affine.M.data;
+        float det = M[0] * M[4] - M[1] * M[3];
+        if (det == 0.f)
+            return false;
+        inv[0] = M[4] / det;
+        inv[1] = -M[1] / det;
+        inv[3] = -M[3] / det;
+        inv[4] = M[0] / det;
+        inv[2] = -(inv[0] * M[2] + inv[1] * M[5]);
+        inv[5] = -(inv[3] * M[2] + inv[4] * M[5]);
+    }
+
+    int dtype = p.dtype.dst_type;
+    size_t plane = (size_t)oh * ow;
+    std::vector<float> row(iw);
+    for (int c = 0; c < oc; c++)
+    {
+        float pad_val = (p.pad.flag && (size_t)c < p.pad.pad_value.data_size) ? p.pad.pad_value.data[c] : 0.f;
+        for (int y = 0; y < oh; y++)
+        {
+            int ty = y - top;
+            bool pad_row = ty < 0 || ty >= ih;
+            if (!pad_row || p.pad.pad_mode != AI2D_PAD_CONSTANT)
+            {
+                int ry = ai2d_reflect(ty, ih, p.pad.pad_mode);
+                for (int x = 0; x < iw; x++)
+                {
+                    float v;
+                    if (p.affine.flag)
+                    {
+                        float sx = inv[0] * x + inv[1] * ry + inv[2];
+                        float sy = inv[3] * x + inv[4] * ry + inv[5];
+                        if (sx < 0 || sy < 0 || sx > img.w - 1 || sy > img.h - 1)
+                            v = p.affine.bound_val;
+                        else if (p.affine.interp_method == INTERP_METHOD_TF_BILINEAR || p.affine.interp_method == INTERP_METHOD_CV2_BILINEAR)
+                            v = ai2d_bilinear(img, c, 0, 0, img.w, img.h, sx, sy);
+                        else
+                            v = ai2d_pixel(img, c, std::min((int)roundf(sy), img.h - 1), std::min((int)roundf(sx), img.w - 1));
+                    }
+                    else if (resize)
+                    {
+                        int method = p.resize.interp_method, mode = p.resize.interp_mode;
+                        float sx = ai2d_map(x, cw, iw, method, mode);
+                        float sy = ai2d_map(ry, ch, ih, method, mode);
+                        if (method == INTERP_METHOD_TF_BILINEAR || method == INTERP_METHOD_CV2_BILINEAR)
+                            v = ai2d_bilinear(img, c, cx, cy, cw, ch, sx, sy);
+                        else
+                            v = ai2d_pixel(img, c, cy + std::clamp((int)sy, 0, ch - 1), cx + std::clamp((int)sx, 0, cw - 1));
+                    }
+                    else
+                    {
+                        v = ai2d_pixel(img, c, cy + ry, cx + x);
+                    }
+                    row[x] = v;
+                }
+            }
+
+            for (int x = 0; x < ow; x++)
+            {
+                int tx = x - left;
+                float v;
+                if (pad_row || tx < 0 || tx >= iw)
+                    v = (p.pad.pad_mode == AI2D_PAD_CONSTANT) ? pad_val : row[ai2d_reflect(tx, iw, p.pad.pad_mode)];
+                else
+                    v = row[tx];
+                size_t i = out_packed ? ((size_t)y * ow + x) * oc + c : c * plane + (size_t)y * ow + x;
+                ai2d_store(out, dtype, i, v);
+            }
+        }
+    }
+    return true;
+}
+
+ai2d *ai2d_create()
+{
+    ai2d *p = new ai2d;
+    memset(p, 0, sizeof(ai2d));
+    p->dtype.src_format = AI2D_FORMAT_NCHW_FMT;
+    p->dtype.dst_format = AI2D_FORMAT_NCHW_FMT;
+    p->dtype.src_type = dt_uint8;
+    p->dtype.dst_type = dt_uint8;
+    p->pad.paddings.data_size = 8;
+    p->pad.pad_mode = AI2D_PAD_CONSTANT;
+    p->pad.pad_value.data_size = 3;
+    p->resize.interp_method = INTERP_METHOD_TF_NEAREST;
+    p->resize.interp_mode = INTERP_MODE_NONE;
+    p->affine.interp_method = INTERP_METHOD_TF_NEAREST;
+    p->affine.M.data_size = 6;
+    return p;
+}
+
+void ai2d_destroy(ai2d *p)
+{
+    delete p;
+}
+
+m_builder *ai2d_build(ai2d *p, finite_data input_shape, finite_data output_shape)
+{
+    if (input_shape.data_size != 4 || output_shape.data_size != 4)
+        throw std::runtime_error("ai2d build schedule failed.");
+    m_builder *mbuilder = new m_builder;
+    mbuilder->param = *p;
+    mbuilder->in_shape = host_shape(input_shape);
+    mbuilder->out_shape = host_shape(output_shape);
+    return mbuilder;
+}
+
+m_builder *ai2d_builder_clone(m_builder *p)
+{
+    return new m_builder(*p);
+}
+
+void ai2d_update_crop(m_builder *p, ai2d_crop_param crop_params)
+{
+    ai2d_set_crop_param(&p->param, crop_params);
+}
+
+void ai2d_update_affine(m_builder *p, finite_data M)
+{
+    p->param.affine.M = M;
+}
+
+void ai2d_cache_set_capacity(size_t capacity)
+{
+    ai2d_cache_capacity = capacity;
+}
+
+void ai2d_cache_clear()
+{
+}
+
+ai2d_cache_info ai2d_cache_get_info()
+{
+    ai2d_cache_info info;
+    info.hits = 0;
+    info.misses = 0;
+    info.size = 0;
+    info.capacity = ai2d_cache_capacity;
+    return info;
+}
+
+bool ai2d_run(m_builder *p, runtime_tensor *in_tensor, runtime_tensor *out_tensor)
+{
+    PROF_SCOPE("ai2d.run");
+    if (host_tensor_bytes(*out_tensor) < host_elements(p->out_shape) * host_dtype_bytes(p->param.dtype.dst_type))
+        return false;
+    return ai2d_invoke(p->param, p->in_shape, p->out_shape, *in_tensor, host_tensor_data(*out_tensor));
+}
+
+bool ai2d_run_batch(m_builder *p, runtime_tensor *in_tensor, runtime_tensor *out_tensor, const ai2d_batch_roi *rois, int n)
+{
+    PROF_SCOPE("ai2d.run_batch");
+    auto &out_shape = out_tensor->shape;
+    if (out_shape.size() != p->out_shape.size() || out_shape[0] < (size_t)n)
+        return false;
+    for (size_t i = 1; i < out_shape.size(); i++)
+    {
+        if (out_shape[i] != p->out_shape[i])
+            return false;
+    }
+
+    size_t bytes = host_tensor_bytes(*out_tensor) / out_shape[0];
+    ai2d param = p->param;
+    for (int i = 0; i < n; i++)
+    {
+        if (rois[i].affine)
+        {
+            param.affine.flag = true;
+            param.affine.M.data_size = 6;
+            std::copy(rois[i].M, rois[i].M + 6, param.affine.M.data);
+        }
+        else
+        {
+            param.crop.flag = true;
+            param.crop.start_x = rois[i].start_x;
+            param.crop.start_y = rois[i].start_y;
+            param.crop.width = rois[i].width;
+            param.crop.height = rois[i].height;
+        }
+        if (!ai2d_invoke(param, p->in_shape, p->out_shape, *in_tensor, host_tensor_data(*out_tensor) + i * bytes))
+            return false;
+    }
+    return true;
+}
+
+runtime_tensor *ai2d_create_output(m_builder *p, size_t batch)
+{
+    std::vector<size_t> shape = p->out_shape;
+    if (batch > 0 && !shape.empty())
+        shape[0] = batch;
+    runtime_tensor t;
+    if (!host_tensor_alloc(t, p->param.dtype.dst_type, shape))
+        return nullptr;
+    return host_tensor_new(t);
+}
+
+finite_data ai2d_input_shape(m_builder *p)
+{
+    finite_data shape;
+    shape.data_size = std::min(p->in_shape.size(), (size_t)8);
+    for (size_t i = 0; i < shape.data_size; i++)
+        shape.data[i] = p->in_shape[i];
+    return shape;
+}
+
+// set ai2d args
+void ai2d_set_dtype(ai2d *p, ai2d_dtype_param dtype_param)
+{
+    p->dtype = dtype_param;
+}
+
+void ai2d_set_crop_param(ai2d *p, ai2d_crop_param crop_params)
+{
+    p->crop = crop_params;
+}
+
+void ai2d_set_shift_param(ai2d *p, ai2d_shift_param shift_params)
+{
+    p->shift = shift_params;
+}
+
+void ai2d_set_pad_param(ai2d *p, ai2d_pad_param pad_params)
+{
+    if (pad_params.paddings.data_size != 8)
+        throw std::runtime_error("ai2d pad: paddings must have 8 values.");
+    p->pad = pad_params;
+}
+
+void ai2d_set_resize_param(ai2d *p, ai2d_resize_param resize_params)
+{
+    p->resize = resize_params;
+}
+
+void ai2d_set_affine_param(ai2d *p, ai2d_affine_param affine_params)
+{
+    p->affine = affine_params;
+}
+
+void runtime_tensor_release(runtime_tensor *tensor)
+{
+    delete tensor;
+}
+
+void ai2d_release(m_builder *p)
+{
+    delete p;
+}
+
+char *version()
+{
+    return (char *)"host-replay";
+}
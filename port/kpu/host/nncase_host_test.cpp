@@ -0,0 +1,292 @@
+// nncase 主机后端的回归测试，由 make -C port/kpu/host test 运行：
+// 在临时目录里录制一组模型输出，经 Kpu_run/Kpu_run_async 回放后逐字节比较；
+// ai2d 的 crop、resize、affine 和批量 crop 与手算的结果比较。
+#include "nncase_wrap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+static int failures = 0;
+
+#define CHECK(cond)                                                          \
+    do                                                                       \
+    {                                                                        \
+        if (!(cond))                                                         \
+        {                                                                    \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);           \
+            failures++;                                                      \
+        }                                                                    \
+    } while (0)
+
+static finite_data shape_of(std::initializer_list<float> dims)
+{
+    finite_data shape;
+    memset(&shape, 0, sizeof(shape));
+    for (float d : dims)
+        shape.data[shape.data_size++] = d;
+    return shape;
+}
+
+static void write_file(const std::string &path, const void *data, size_t size)
+{
+    std::ofstream f(path, std::ios::binary);
+    f.write((const char *)data, size);
+}
+
+static const uint8_t *tensor_bytes(runtime_tensor *t)
+{
+    rt_to_ndarray_info info;
+    to_numpy(t, &info);
+    return (const uint8_t *)info.data_;
+}
+
+static bool same_u8(runtime_tensor *t, const std::vector<uint8_t> &expected)
+{
+    const uint8_t *data = tensor_bytes(t);
+    for (size_t i = 0; i < expected.size(); i++)
+    {
+        if (data[i] != expected[i])
+        {
+            printf("    element %zu: expected %d got %d\n", i, expected[i], data[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+// 录制格式见 nncase_host.cpp：<model>.replay/manifest 和 output<i>_<k>.bin
+static void test_replay(const std::string &dir)
+{
+    std::string model = dir + "/det.kmodel";
+    std::string replay = model + ".replay";
+    mkdir(dir.c_str(), 0755);
+    mkdir(replay.c_str(), 0755);
+    std::string manifest = "# recorded by nncase_host_test\n"
+                           "input B 1,3,4,4\n"
+                           "output f 1,2\n"
+                           "output B 1,3\n"
+                           "frames 3\n";
+    write_file(replay + "/manifest", manifest.data(), manifest.size());
+
+    float scores[3][2] = {{0.25f, -1.5f}, {3.0f, 0.0f}, {-0.125f, 1e6f}};
+    uint8_t labels[3][3] = {{1, 2, 3}, {0, 255, 7}, {9, 9, 9}};
+    for (int k = 0; k < 3; k++)
+    {
+        write_file(replay + "/output0_" + std::to_string(k) + ".bin", scores[k], sizeof(scores[k]));
+        write_file(replay + "/output1_" + std::to_string(k) + ".bin", labels[k], sizeof(labels[k]));
+    }
+
+    Kpu *kpu = Kpu_create();
+    CHECK(!Kpu_load_kmodel_path(kpu, (dir + "/missing.kmodel").c_str()));
+    CHECK(Kpu_load_kmodel_path(kpu, model.c_str()));
+    CHECK(Kpu_inputs_size(kpu) == 1);
+    CHECK(Kpu_outputs_size(kpu) == 2);
+    CHECK(Kpu_get_output_desc(kpu, 0).size == sizeof(scores[0]));
+
+    std::vector<uint8_t> frame(3 * 4 * 4, 128);
+    runtime_tensor *input = from_numpy(mp_dtype_to_nncase('B'), shape_of({1, 3, 4, 4}), frame.data(), 0);
+    CHECK(Kpu_set_input_tensor(kpu, 0, input));
+    runtime_tensor *wrong = from_numpy(mp_dtype_to_nncase('B'), shape_of({1, 3, 4, 3}), frame.data(), 0);
+    CHECK(!Kpu_set_input_tensor(kpu, 0, wrong));
+    runtime_tensor_release(wrong);
+
+    // 依次回放录制的帧，回放完后从头开始
+    for (int run = 0; run < 4; run++)
+    {
+        int k = run % 3;
+        CHECK(Kpu_run(kpu));
+        runtime_tensor *out0 = Kpu_get_output_tensor(kpu, 0);
+        runtime_tensor *out1 = Kpu_get_output_tensor(kpu, 1);
+        CHECK(memcmp(tensor_bytes(out0), scores[k], sizeof(scores[k])) == 0);
+        CHECK(memcmp(tensor_bytes(out1), labels[k], sizeof(labels[k])) == 0);
+        runtime_tensor_release(out0);
+        runtime_tensor_release(out1);
+    }
+
+    // run_async() 的输出两组交替，上一帧的输出在下一次 run_async() 之后仍然有效
+    CHECK(Kpu_run_async(kpu));
+    CHECK(Kpu_wait(kpu, -1) == KPU_ASYNC_OK);
+    runtime_tensor *prev = Kpu_get_output_tensor(kpu, 1);
+    CHECK(Kpu_run_async(kpu));
+    CHECK(Kpu_wait(kpu, -1) == KPU_ASYNC_OK);
+    runtime_tensor *next = Kpu_get_output_tensor(kpu, 1);
+    CHECK(memcmp(tensor_bytes(prev), labels[1], sizeof(labels[1])) == 0);
+    CHECK(memcmp(tensor_bytes(next), labels[2], sizeof(labels[2])) == 0);
+    runtime_tensor_release(prev);
+    runtime_tensor_release(next);
+
+    runtime_tensor_release(input);
+    Kpu_destroy(kpu);
+
+    // 录制的输出大小和 manifest 不符时加载失败
+    uint8_t short_labels[2] = {0, 0};
+    write_file(replay + "/output1_2.bin", short_labels, sizeof(short_labels));
+    kpu = Kpu_create();
+    CHECK(!Kpu_load_kmodel_path(kpu, model.c_str()));
+    Kpu_destroy(kpu);
+}
+
+static ai2d *ai2d_u8_nchw()
+{
+    ai2d *p = ai2d_create();
+    ai2d_dtype_param dtype = {AI2D_FORMAT_NCHW_FMT, AI2D_FORMAT_NCHW_FMT, mp_dtype_to_nncase('B'), mp_dtype_to_nncase('B')};
+    ai2d_set_dtype(p, dtype);
+    return p;
+}
+
+// 用 builder 处理 data，返回输出字节
+static std::vector<uint8_t> ai2d_apply(ai2d *p, finite_data in_shape, finite_data out_shape, std::vector<uint8_t> data)
+{
+    m_builder *builder = ai2d_build(p, in_shape, out_shape);
+    runtime_tensor *in = from_numpy(mp_dtype_to_nncase('B'), in_shape, data.data(), 0);
+    runtime_tensor *out = ai2d_create_output(builder, 0);
+    std::vector<uint8_t> result;
+    if (ai2d_run(builder, in, out))
+    {
+        size_t n = 1;
+        for (size_t i = 0; i < out_shape.data_size; i++)
+            n *= (size_t)out_shape.data[i];
+        const uint8_t *bytes = tensor_bytes(out);
+        result.assign(bytes, bytes + n);
+    }
+    runtime_tensor_release(in);
+    runtime_tensor_release(out);
+    ai2d_release(builder);
+    return result;
+}
+
+static void check_golden(const char *name, const std::vector<uint8_t> &got, const std::vector<uint8_t> &expected)
+{
+    if (got != expected)
+    {
+        printf("FAIL ai2d %s:", name);
+        for (auto v : got)
+            printf(" %d", v);
+        printf("\n");
+        failures++;
+    }
+}
+
+static void test_ai2d()
+{
+    // 1x3x4x4，像素值为 c*16 + y*4 + x
+    std::vector<uint8_t> ramp(3 * 4 * 4);
+    for (size_t i = 0; i < ramp.size(); i++)
+        ramp[i] = i;
+
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_crop_param crop = {true, 1, 1, 2, 2};
+        ai2d_set_crop_param(p, crop);
+        check_golden("crop", ai2d_apply(p, shape_of({1, 3, 4, 4}), shape_of({1, 3, 2, 2}), ramp),
+                     {5, 6, 9, 10, 21, 22, 25, 26, 37, 38, 41, 42});
+        ai2d_destroy(p);
+    }
+
+    // 2x2 放大到 4x4，half_pixel 双线性，边缘取边界值
+    std::vector<uint8_t> quad = {0, 100, 200, 40};
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_resize_param resize = {true, INTERP_METHOD_TF_BILINEAR, INTERP_MODE_HALF_PIXEL};
+        ai2d_set_resize_param(p, resize);
+        check_golden("resize bilinear", ai2d_apply(p, shape_of({1, 1, 2, 2}), shape_of({1, 1, 4, 4}), quad),
+                     {0, 25, 75, 100,
+                      50, 59, 76, 85,
+                      150, 126, 79, 55,
+                      200, 160, 80, 40});
+        ai2d_destroy(p);
+    }
+
+    // crop 之后再缩小，nearest 取每个 2x2 块的左上角
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_crop_param crop = {true, 0, 0, 4, 2};
+        ai2d_resize_param resize = {true, INTERP_METHOD_TF_NEAREST, INTERP_MODE_NONE};
+        ai2d_set_crop_param(p, crop);
+        ai2d_set_resize_param(p, resize);
+        check_golden("crop resize nearest", ai2d_apply(p, shape_of({1, 3, 4, 4}), shape_of({1, 3, 1, 2}), ramp),
+                     {0, 2, 16, 18, 32, 34});
+        ai2d_destroy(p);
+    }
+
+    // 平移 x+1，落在源图外的像素填 bound_val
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_affine_param affine;
+        memset(&affine, 0, sizeof(affine));
+        affine.flag = true;
+        affine.interp_method = INTERP_METHOD_TF_NEAREST;
+        affine.bound_val = 7;
+        affine.M = shape_of({1, 0, 1, 0, 1, 0});
+        ai2d_set_affine_param(p, affine);
+        check_golden("affine translate", ai2d_apply(p, shape_of({1, 1, 2, 2}), shape_of({1, 1, 2, 2}), quad),
+                     {7, 0, 7, 200});
+        ai2d_destroy(p);
+    }
+
+    // 放大 2 倍，双线性
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_affine_param affine;
+        memset(&affine, 0, sizeof(affine));
+        affine.flag = true;
+        affine.interp_method = INTERP_METHOD_TF_BILINEAR;
+        affine.M = shape_of({2, 0, 0, 0, 2, 0});
+        ai2d_set_affine_param(p, affine);
+        check_golden("affine scale", ai2d_apply(p, shape_of({1, 1, 2, 2}), shape_of({1, 1, 3, 3}), quad),
+                     {0, 50, 100,
+                      100, 85, 70,
+                      200, 120, 40});
+        ai2d_destroy(p);
+    }
+
+    // 批量 crop：两个 ROI 写到同一个 batch 的两个位置，clone 出的 builder 结果相同
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_crop_param crop = {true, 0, 0, 2, 2};
+        ai2d_set_crop_param(p, crop);
+        m_builder *builder = ai2d_build(p, shape_of({1, 3, 4, 4}), shape_of({1, 3, 2, 2}));
+        m_builder *clone = ai2d_builder_clone(builder);
+        ai2d_release(builder);
+        runtime_tensor *in = from_numpy(mp_dtype_to_nncase('B'), shape_of({1, 3, 4, 4}), ramp.data(), 0);
+        runtime_tensor *out = ai2d_create_output(clone, 2);
+        ai2d_batch_roi rois[2];
+        memset(rois, 0, sizeof(rois));
+        rois[0] = {false, 0, 0, 2, 2, {0}};
+        rois[1] = {false, 2, 2, 2, 2, {0}};
+        CHECK(ai2d_run_batch(clone, in, out, rois, 2));
+        CHECK(same_u8(out, {0, 1, 4, 5, 16, 17, 20, 21, 32, 33, 36, 37,
+                            10, 11, 14, 15, 26, 27, 30, 31, 42, 43, 46, 47}));
+        runtime_tensor_release(in);
+        runtime_tensor_release(out);
+        ai2d_release(clone);
+        ai2d_destroy(p);
+    }
+
+    // crop 超出输入时失败
+    {
+        ai2d *p = ai2d_u8_nchw();
+        ai2d_crop_param crop = {true, 3, 3, 2, 2};
+        ai2d_set_crop_param(p, crop);
+        CHECK(ai2d_apply(p, shape_of({1, 3, 4, 4}), shape_of({1, 3, 2, 2}), ramp).empty());
+        ai2d_destroy(p);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    std::string dir = argc > 1 ? argv[1] : "build/replay";
+    test_replay(dir);
+    test_ai2d();
+    if (failures)
+    {
+        printf("nncase_host_test: %d failures\n", failures);
+        return 1;
+    }
+    printf("nncase_host_test: passed\n");
+    return 0;
+}
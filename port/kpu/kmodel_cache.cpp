@@ -0,0 +1,260 @@
+#include "kmodel_cache.h"
+#include <fcntl.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+
+// kmodel 文件缓存
+// 缓存是进程级的，不在 MicroPython 堆上，脚本停止/重新运行(soft reset)后仍然有效，
+// 重复运行同一个脚本时不用再从文件系统读一遍模型。
+struct kmodel_blob
+{
+    std::string path;
+    time_t mtime;
+    off_t file_size;
+    void *data;
+    size_t size;
+    bool mapped;    // true: mmap 的只读映射，false: 读到 malloc 的内存
+    bool stale;     // 文件已经更新，最后一个引用释放后删除
+    int refs;
+    uint64_t last_use;
+};
+
+static struct
+{
+    std::mutex lock;
+    std::list<kmodel_blob *> entries;
+    size_t budget = KMODEL_CACHE_DEFAULT_BUDGET;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+    uint64_t tick = 0;
+} kmodel_cache;
+
+static kmodel_blob *kmodel_blob_load(const char *path, const struct stat &st)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    size_t size = st.st_size;
+    bool mapped = true;
+    void *data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED)
+    {
+        // 文件系统不支持 mmap 时退回到读文件
+        mapped = false;
+        data = malloc(size);
+        size_t done = 0;
+        while (data && done < size)
+        {
+            ssize_t n = read(fd, (char *)data + done, size - done);
+            if (n <= 0)
+            {
+                free(data);
+                data = nullptr;
+                break;
+            }
+            done += n;
+        }
+    }
+    close(fd);
+    if (!data)
+        return nullptr;
+
+    kmodel_blob *blob = new kmodel_blob;
+    blob->path = path;
+    blob->mtime = st.st_mtime;
+    blob->file_size = st.st_size;
+    blob->data = data;
+    blob->size = size;
+    blob->mapped = mapped;
+    blob->stale = false;
+    blob->refs = 0;
+    blob->last_use = 0;
+    return blob;
+}
+
+static void kmodel_blob_free(kmodel_blob *blob)
+{
+    if (blob->mapped)
+        munmap(blob->data, blob->size);
+    else
+        free(blob->data);
+    delete blob;
+}
+
+// 没有引用的模型超出上限时，从最久未用的开始删除，调用时需持有锁
+static void kmodel_cache_trim()
+{
+    size_t idle = 0;
+    for (auto blob : kmodel_cache.entries)
+    {
+        if (blob->refs == 0)
+            idle += blob->size;
+    }
+
+    while (idle > kmodel_cache.budget)
+    {
+        auto victim = kmodel_cache.entries.end();
+        for (auto it = kmodel_cache.entries.begin(); it != kmodel_cache.entries.end(); ++it)
+        {
+            if ((*it)->refs == 0 && (victim == kmodel_cache.entries.end() || (*it)->last_use < (*victim)->last_use))
+                victim = it;
+        }
+        if (victim == kmodel_cache.entries.end())
+            break;
+        idle -= (*victim)->size;
+        kmodel_blob_free(*victim);
+        kmodel_cache.entries.erase(victim);
+    }
+}
+
+// 查找路径对应的缓存，文件已经更新的旧缓存移出列表，调用时需持有锁
+static kmodel_blob *kmodel_cache_find(const char *path, const struct stat &st)
+{
+    for (auto it = kmodel_cache.entries.begin(); it != kmodel_cache.entries.end(); ++it)
+    {
+        kmodel_blob *blob = *it;
+        if (blob->path != path)
+            continue;
+        if (blob->mtime == st.st_mtime && blob->file_size == st.st_size)
+            return blob;
+
+        kmodel_cache.entries.erase(it);
+        if (blob->refs == 0)
+            kmodel_blob_free(blob);
+        else
+            blob->stale = true;
+        return nullptr;
+    }
+    return nullptr;
+}
+
+kmodel_blob *kmodel_cache_acquire(const char *path)
+{
+    struct stat st;
+    if (stat(path, &st) != 0 || st.st_size <= 0)
+        return nullptr;
+
+    {
+        std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+        kmodel_blob *blob = kmodel_cache_find(path, st);
+        if (blob)
+        {
+            kmodel_cache.hits++;
+            blob->refs++;
+            blob->last_use = ++kmodel_cache.tick;
+            return blob;
+        }
+        kmodel_cache.misses++;
+    }
+
+    // 读文件时不持有锁，不会阻塞其他模型的加载
+    kmodel_blob *loaded = kmodel_blob_load(path, st);
+    if (!loaded)
+        return nullptr;
+
+    std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+    // 可能已经被另一个线程(prefetch)放进缓存
+    kmodel_blob *blob = kmodel_cache_find(path, st);
+    if (blob)
+    {
+        kmodel_blob_free(loaded);
+    }
+    else
+    {
+        blob = loaded;
+        kmodel_cache.entries.push_back(blob);
+    }
+    blob->refs++;
+    blob->last_use = ++kmodel_cache.tick;
+    return blob;
+}
+
+void kmodel_cache_release(kmodel_blob *blob)
+{
+    if (!blob)
+        return;
+    std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+    if (--blob->refs > 0)
+        return;
+    if (blob->stale)
+        kmodel_blob_free(blob);
+    else
+        kmodel_cache_trim();
+}
+
+const void *kmodel_blob_data(kmodel_blob *blob)
+{
+    return blob->data;
+}
+
+size_t kmodel_blob_size(kmodel_blob *blob)
+{
+    return blob->size;
+}
+
+bool kmodel_cache_prefetch(const char *path)
+{
+    if (access(path, R_OK) != 0)
+        return false;
+
+    std::thread([p = std::string(path)] {
+        kmodel_blob *blob = kmodel_cache_acquire(p.c_str());
+        if (!blob)
+            return;
+        // mmap 只建立映射，逐页读一次，让文件内容提前进入内存
+        if (blob->mapped)
+        {
+            long page = sysconf(_SC_PAGESIZE);
+            const volatile char *data = (const volatile char *)blob->data;
+            for (size_t i = 0; i < blob->size; i += page)
+                (void)data[i];
+        }
+        kmodel_cache_release(blob);
+    }).detach();
+    return true;
+}
+
+void kmodel_cache_set_budget(size_t bytes)
+{
+    std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+    kmodel_cache.budget = bytes;
+    kmodel_cache_trim();
+}
+
+void kmodel_cache_clear()
+{
+    std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+    for (auto it = kmodel_cache.entries.begin(); it != kmodel_cache.entries.end();)
+    {
+        if ((*it)->refs == 0)
+        {
+            kmodel_blob_free(*it);
+            it = kmodel_cache.entries.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+kmodel_cache_info kmodel_cache_get_info()
+{
+    std::lock_guard<std::mutex> guard(kmodel_cache.lock);
+    kmodel_cache_info info;
+    info.hits = kmodel_cache.hits;
+    info.misses = kmodel_cache.misses;
+    info.entries = kmodel_cache.entries.size();
+    info.bytes = 0;
+    for (auto blob : kmodel_cache.entries)
+        info.bytes += blob->size;
+    info.budget = kmodel_cache.budget;
+    return info;
+}
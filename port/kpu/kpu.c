@@ -5,6 +5,7 @@
 #include "py/runtime.h"
 #include "py/stream.h"
 #include "py/builtin.h"
+#include "py/mphal.h"
 #include <stdio.h>
 #include <string.h>
 #include "ndarray.h"
@@ -98,6 +99,12 @@ MP_DEFINE_CONST_OBJ_TYPE(
 );
 // 实现各个功能函数
 
+// run_async() 的推理还没结束时，不能再访问 interp
+STATIC void kpu_check_idle(kpu_obj_t *self) {
+    if (Kpu_busy(self->interp))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("KPU is busy, call wait() first."));
+}
+
 // init
 STATIC mp_obj_t mp_kpu_create() {
     kpu_obj_t *self = m_new_obj_with_finaliser(kpu_obj_t);
@@ -116,7 +123,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(kpu_destroy_obj, mp_kpu_destroy);
 
 // load model
 STATIC mp_obj_t mp_kpu_load_kmodel(mp_obj_t self_in, mp_obj_t filename_in) {
-    
+    kpu_check_idle(MP_OBJ_TO_PTR(self_in));
     if (!mp_obj_is_str(filename_in)) {
         mp_buffer_info_t bufferinfo;
         mp_get_buffer_raise(filename_in, &bufferinfo, MP_BUFFER_READ);
@@ -145,20 +152,77 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_2(kpu_load_kmodel_obj, mp_kpu_load_kmodel);
 // kmodel run
 STATIC mp_obj_t mp_kpu_run(mp_obj_t self_in) {
     kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    kpu_check_idle(self);
+    // 推理期间释放GIL，其他线程可以继续运行
+    MP_THREAD_GIL_EXIT();
     bool flag = Kpu_run(self->interp);
+    MP_THREAD_GIL_ENTER();
     if(!flag)
         mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("KPU run failed."));
     return mp_const_none;
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(kpu_run_obj, mp_kpu_run);
 
+// kmodel run async
+// 在后台线程里推理，立即返回。输出tensor两组交替使用，wait()之后拿到的输出在下一次
+// run_async()期间仍然有效，可以和下一帧的推理并行做后处理。输入在返回前复制，之后就可以
+// 改写输入tensor(比如用ai2d准备下一帧)。推理期间调用set_input_tensor()设置的输入在下一次run_async()时生效。
+STATIC mp_obj_t mp_kpu_run_async(mp_obj_t self_in) {
+    kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    kpu_check_idle(self);
+    if (!Kpu_run_async(self->interp))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("KPU run async failed."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(kpu_run_async_obj, mp_kpu_run_async);
+
+// wait(timeout=-1)
+// 等待run_async()结束，timeout单位ms，小于0一直等。完成返回True，超时返回False，推理失败抛出RuntimeError
+STATIC mp_obj_t mp_kpu_wait(size_t n_args, const mp_obj_t *args) {
+    kpu_obj_t *self = MP_OBJ_TO_PTR(args[0]);
+    mp_int_t timeout = -1;
+    if (n_args > 1 && args[1] != mp_const_none)
+        timeout = mp_obj_get_int(args[1]);
+
+    mp_uint_t start = mp_hal_ticks_ms();
+    int state;
+    for (;;) {
+        // 分段等待，中间处理pending事件，保证Ctrl-C可以打断
+        mp_int_t slice = 10;
+        if (timeout >= 0) {
+            mp_int_t left = timeout - (mp_int_t)(mp_hal_ticks_ms() - start);
+            slice = left < 0 ? 0 : (left < slice ? left : slice);
+        }
+        MP_THREAD_GIL_EXIT();
+        state = Kpu_wait(self->interp, slice);
+        MP_THREAD_GIL_ENTER();
+        if (state != KPU_ASYNC_TIMEOUT)
+            break;
+        if (timeout >= 0 && (mp_int_t)(mp_hal_ticks_ms() - start) >= timeout)
+            break;
+        mp_thread_exitpoint(EXITPOINT_ENABLE_SLEEP);
+        mp_handle_pending(true);
+    }
+
+    if (state == KPU_ASYNC_FAILED)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("KPU run failed."));
+    return mp_obj_new_bool(state == KPU_ASYNC_OK);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(kpu_wait_obj, 1, 2, mp_kpu_wait);
+
+// done() 没有推理在执行时返回True，不会取走结果，失败仍由wait()抛出
+STATIC mp_obj_t mp_kpu_done(mp_obj_t self_in) {
+    kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    return mp_obj_new_bool(!Kpu_busy(self->interp));
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(kpu_done_obj, mp_kpu_done);
+
 
 // set input tensor
 STATIC mp_obj_t mp_kpu_set_input_tensor(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t tensor_in) {
     kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
     size_t index = mp_obj_get_int(index_in);
-    mp_runtime_tensor_obj_t *tensor = MP_OBJ_TO_PTR(tensor_in);
-    bool flag = Kpu_set_input_tensor(self->interp, index, tensor->r_tensor);
+    bool flag = Kpu_set_input_tensor(self->interp, index, mp_runtime_tensor_get(tensor_in));
     if(!flag)
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("KPU set input tensor failed."));
     return mp_const_none;
@@ -167,9 +231,12 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_3(kpu_set_input_tensor_obj, mp_kpu_set_input_tens
 
 STATIC mp_obj_t mp_kpu_get_input_tensor(mp_obj_t self_in, mp_obj_t index_in) {
     kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    kpu_check_idle(self);
     size_t index = mp_obj_get_int(index_in);
     mp_runtime_tensor_obj_t *tensor = m_new_obj_with_finaliser(mp_runtime_tensor_obj_t);
     tensor->r_tensor = Kpu_get_input_tensor(self->interp, index);
+    tensor->has_views = false;
+    tensor->deferred = NULL;
     tensor->base.type = &rt_type;
     return MP_OBJ_TO_PTR(tensor);
 }
@@ -178,9 +245,9 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_2(kpu_get_input_tensor_obj, mp_kpu_get_input_tens
 // set output tensor
 STATIC mp_obj_t mp_kpu_set_output_tensor(mp_obj_t self_in, mp_obj_t index_in, mp_obj_t tensor_in) {
     kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    kpu_check_idle(self);
     size_t index = mp_obj_get_int(index_in);
-    mp_runtime_tensor_obj_t *tensor = MP_OBJ_TO_PTR(tensor_in);
-    bool flag = Kpu_set_output_tensor(self->interp, index, tensor->r_tensor);
+    bool flag = Kpu_set_output_tensor(self->interp, index, mp_runtime_tensor_get(tensor_in));
     if(!flag)
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("KPU set output tensor failed."));
     return mp_const_none;
@@ -190,9 +257,12 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_3(kpu_set_output_tensor_obj, mp_kpu_set_output_te
 // get output tensor
 STATIC mp_obj_t mp_kpu_get_output_tensor(mp_obj_t self_in, mp_obj_t index_in) {
     kpu_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    kpu_check_idle(self);
     size_t index = mp_obj_get_int(index_in);
     mp_runtime_tensor_obj_t *tensor = m_new_obj_with_finaliser(mp_runtime_tensor_obj_t);
     tensor->r_tensor = Kpu_get_output_tensor(self->interp, index);
+    tensor->has_views = false;
+    tensor->deferred = NULL;
     tensor->base.type = &rt_type;
     return MP_OBJ_TO_PTR(tensor);
 }
@@ -252,6 +322,9 @@ STATIC const mp_rom_map_elem_t kpu_locals_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&kpu_destroy_obj) },
     { MP_ROM_QSTR(MP_QSTR_load_kmodel), MP_ROM_PTR(&kpu_load_kmodel_obj) },
     { MP_ROM_QSTR(MP_QSTR_run), MP_ROM_PTR(&kpu_run_obj) },
+    { MP_ROM_QSTR(MP_QSTR_run_async), MP_ROM_PTR(&kpu_run_async_obj) },
+    { MP_ROM_QSTR(MP_QSTR_wait), MP_ROM_PTR(&kpu_wait_obj) },
+    { MP_ROM_QSTR(MP_QSTR_done), MP_ROM_PTR(&kpu_done_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_input_tensor), MP_ROM_PTR(&kpu_get_input_tensor_obj) },
     { MP_ROM_QSTR(MP_QSTR_set_input_tensor), MP_ROM_PTR(&kpu_set_input_tensor_obj) },
     { MP_ROM_QSTR(MP_QSTR_get_output_tensor), MP_ROM_PTR(&kpu_get_output_tensor_obj) },
@@ -279,40 +352,97 @@ MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 
-STATIC mp_obj_t mp_to_numpy(mp_obj_t self_in) {
+// to_numpy(copy=False)
+// 默认返回直接引用tensor内存的ndarray，ndarray通过ref_obj保持tensor存活。
+// 下一次kpu.run()/ai2d.run()会覆盖其内容，需要保留结果时传copy=True。
+// 每次调用都会让cache失效；通过ndarray写入数据后，交给KPU/ai2d之前需要调用write_back()。
+STATIC mp_obj_t mp_to_numpy(size_t n_args, const mp_obj_t *pos_args, mp_map_t *kw_args) {
+    enum { ARG_copy };
+    static const mp_arg_t allowed_args[] = {
+        { MP_QSTR_copy, MP_ARG_BOOL, { .u_bool = false } },
+    };
+    mp_arg_val_t args[MP_ARRAY_SIZE(allowed_args)];
+    mp_arg_parse_all(n_args - 1, pos_args + 1, kw_args, MP_ARRAY_SIZE(allowed_args), allowed_args, args);
 
-    mp_runtime_tensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
     rt_to_ndarray_info info;
-    to_numpy(self->r_tensor, &info);
-    size_t *mp_shape = m_new(size_t, ULAB_MAX_DIMS);
-    int32_t *mp_stride = m_new(int32_t, ULAB_MAX_DIMS);
+    to_numpy(mp_runtime_tensor_get(pos_args[0]), &info);
+    size_t mp_shape[ULAB_MAX_DIMS];
+    int32_t mp_stride[ULAB_MAX_DIMS];
     size_t size_bytes = ulab_binary_get_size(info.dtype_);
     for(int i=0; i<info.ndim_; i++) {
         mp_shape[ULAB_MAX_DIMS - 1-i] = (size_t)info.shape_[info.ndim_ - 1 - i];
         mp_stride[ULAB_MAX_DIMS - 1-i] = (int32_t)info.strides_[info.ndim_ - 1 - i]*size_bytes;
     }
-    ndarray_obj_t *result = ndarray_new_ndarray(info.ndim_, mp_shape, mp_stride, info.dtype_);
-    memcpy((void *)result->origin, (void *)info.data_, result->len * result->itemsize);
-    
-    free(info.data_);
-    info.data_ = NULL;
-    m_del(size_t, mp_shape, ULAB_MAX_DIMS);
-    m_del(int32_t, mp_stride, ULAB_MAX_DIMS);
+
+    ndarray_obj_t *result;
+    if (args[ARG_copy].u_bool) {
+        result = ndarray_new_ndarray(info.ndim_, mp_shape, mp_stride, info.dtype_);
+        memcpy((void *)result->origin, (void *)info.data_, result->len * result->itemsize);
+    } else {
+        result = ndarray_new_ndarray_by_ref(info.ndim_, mp_shape, mp_stride, info.dtype_, 0, info.data_, pos_args[0]);
+        ((mp_runtime_tensor_obj_t *)MP_OBJ_TO_PTR(pos_args[0]))->has_views = true;
+    }
     return MP_OBJ_FROM_PTR(result);
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_to_numpy_obj, mp_to_numpy);
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(mp_to_numpy_obj, 1, mp_to_numpy);
+
+// CPU读之前让cache失效，KPU/ai2d写完输出后调用
+STATIC mp_obj_t mp_runtime_tensor_invalidate(mp_obj_t self_in) {
+    if (!runtime_tensor_sync(mp_runtime_tensor_get(self_in), false))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("tensor sync invalidate failed."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_runtime_tensor_invalidate_obj, mp_runtime_tensor_invalidate);
+
+// 把CPU写入的数据刷回内存，交给KPU/ai2d之前调用
+STATIC mp_obj_t mp_runtime_tensor_write_back(mp_obj_t self_in) {
+    if (!runtime_tensor_sync(mp_runtime_tensor_get(self_in), true))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("tensor sync write back failed."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_runtime_tensor_write_back_obj, mp_runtime_tensor_write_back);
+
+runtime_tensor *mp_runtime_tensor_get(mp_obj_t self_in) {
+    mp_runtime_tensor_obj_t *self = MP_OBJ_TO_PTR(self_in);
+    if (!self->r_tensor)
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("runtime_tensor already released."));
+    return self->r_tensor;
+}
+
+// release() 立即把 tensor 还给 tensor 池，不用等 gc；之后再使用会抛出异常。
+// to_numpy() 返回过引用内存的 ndarray 时，ndarray 可能还在读写这块内存，
+// 真正的释放推迟到 __del__(所有 ndarray 都不再引用之后)，需要立即回收时用 to_numpy(copy=True)
+STATIC mp_obj_t mp_runtime_tensor_release(mp_obj_t runtime_tensor_obj) {
+    mp_runtime_tensor_obj_t *self = MP_OBJ_TO_PTR(runtime_tensor_obj);
+    if (self->r_tensor) {
+        if (self->has_views)
+            self->deferred = self->r_tensor;
+        else
+            runtime_tensor_release(self->r_tensor);
+        self->r_tensor = NULL;
+    }
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_runtime_tensor_release_obj, mp_runtime_tensor_release);
 
-static mp_obj_t mp_runtime_tensor_release(mp_obj_t runtime_tensor_obj) {
+STATIC mp_obj_t mp_runtime_tensor_del(mp_obj_t runtime_tensor_obj) {
     mp_runtime_tensor_obj_t *self = MP_OBJ_TO_PTR(runtime_tensor_obj);
-    runtime_tensor_release(self->r_tensor);
+    runtime_tensor *tensor = self->r_tensor ? self->r_tensor : self->deferred;
+    if (tensor)
+        runtime_tensor_release(tensor);
+    self->r_tensor = NULL;
+    self->deferred = NULL;
     return mp_const_none;
 }
-STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_runtime_tensor_del_obj, mp_runtime_tensor_release);
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_runtime_tensor_del_obj, mp_runtime_tensor_del);
 
 STATIC const mp_rom_map_elem_t mp_rt_dict_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_runtime_tensor) },
     { MP_ROM_QSTR(MP_QSTR___del__), MP_ROM_PTR(&mp_runtime_tensor_del_obj) },
+    { MP_ROM_QSTR(MP_QSTR_release), MP_ROM_PTR(&mp_runtime_tensor_release_obj) },
     { MP_ROM_QSTR(MP_QSTR_to_numpy), MP_ROM_PTR(&mp_to_numpy_obj) },
+    { MP_ROM_QSTR(MP_QSTR_invalidate), MP_ROM_PTR(&mp_runtime_tensor_invalidate_obj) },
+    { MP_ROM_QSTR(MP_QSTR_write_back), MP_ROM_PTR(&mp_runtime_tensor_write_back_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(mp_rt_dict, mp_rt_dict_table);
@@ -33,6 +33,8 @@
 #include "py/obj.h"
 #include "nncase_type.h"
 #include "nncase_wrap.h"
+#include "kmodel_cache.h"
+#include "profiler.h"
 #include "kpu.h"
 #include "ai2d.h"
 #include "ndarray.h"
@@ -58,6 +60,8 @@ STATIC mp_obj_t mp_from_numpy(mp_obj_t ndarray)
     
     int dtype = mp_dtype_to_nncase((char)self->dtype);
     tensor->r_tensor = from_numpy(dtype, shape, self->array, self->phy_addr);
+    tensor->has_views = false;
+    tensor->deferred = NULL;
     tensor->base.type = &rt_type;
     return MP_OBJ_TO_PTR(tensor);
 }
@@ -70,6 +74,191 @@ STATIC mp_obj_t mp_shrink_memory_pool()
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_shrink_memory_pool_obj, mp_shrink_memory_pool);
 
+// ai2d_cache_info() -> dict(hits, misses, size, capacity)
+STATIC mp_obj_t mp_ai2d_cache_info()
+{
+    ai2d_cache_info info = ai2d_cache_get_info();
+    mp_obj_t dict = mp_obj_new_dict(4);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_hits), mp_obj_new_int_from_uint(info.hits));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_misses), mp_obj_new_int_from_uint(info.misses));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_size), mp_obj_new_int(info.size));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_capacity), mp_obj_new_int(info.capacity));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_ai2d_cache_info_obj, mp_ai2d_cache_info);
+
+// ai2d_cache_config(capacity)，capacity为0时关闭缓存
+STATIC mp_obj_t mp_ai2d_cache_config(mp_obj_t capacity_in)
+{
+    mp_int_t capacity = mp_obj_get_int(capacity_in);
+    if (capacity < 0)
+        mp_raise_ValueError(MP_ERROR_TEXT("capacity must be >= 0"));
+    ai2d_cache_set_capacity(capacity);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_ai2d_cache_config_obj, mp_ai2d_cache_config);
+
+STATIC mp_obj_t mp_ai2d_cache_clear()
+{
+    ai2d_cache_clear();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_ai2d_cache_clear_obj, mp_ai2d_cache_clear);
+
+// kmodel_prefetch(path)，在后台把模型文件加载到缓存，之后 kpu.load_kmodel(path) 直接命中
+STATIC mp_obj_t mp_kmodel_prefetch(mp_obj_t path_in)
+{
+    const char *path = mp_obj_str_get_str(path_in);
+    if (!kmodel_cache_prefetch(path))
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Kmodel file not exist."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_kmodel_prefetch_obj, mp_kmodel_prefetch);
+
+// kmodel_cache_info() -> dict(hits, misses, entries, bytes, budget)
+STATIC mp_obj_t mp_kmodel_cache_info()
+{
+    kmodel_cache_info info = kmodel_cache_get_info();
+    mp_obj_t dict = mp_obj_new_dict(5);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_hits), mp_obj_new_int_from_uint(info.hits));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_misses), mp_obj_new_int_from_uint(info.misses));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_entries), mp_obj_new_int(info.entries));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes), mp_obj_new_int_from_uint(info.bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_budget), mp_obj_new_int_from_uint(info.budget));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_kmodel_cache_info_obj, mp_kmodel_cache_info);
+
+// kmodel_cache_config(budget)，没有被kpu引用的模型最多保留budget字节，0表示不保留
+STATIC mp_obj_t mp_kmodel_cache_config(mp_obj_t budget_in)
+{
+    mp_int_t budget = mp_obj_get_int(budget_in);
+    if (budget < 0)
+        mp_raise_ValueError(MP_ERROR_TEXT("budget must be >= 0"));
+    kmodel_cache_set_budget(budget);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_kmodel_cache_config_obj, mp_kmodel_cache_config);
+
+STATIC mp_obj_t mp_kmodel_cache_clear()
+{
+    kmodel_cache_clear();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_kmodel_cache_clear_obj, mp_kmodel_cache_clear);
+
+// tensor_pool_reserve(shape, dtype, count=1)，预先申请count个该shape和dtype的tensor放进池里，
+// 之后 from_numpy/ai2d 输出第一次使用时也不用再申请内存
+STATIC mp_obj_t mp_tensor_pool_reserve(size_t n_args, const mp_obj_t *args)
+{
+    size_t len;
+    mp_obj_t *items;
+    mp_obj_get_array(args[0], &len, &items);
+    if (len == 0 || len > 8)
+        mp_raise_ValueError(MP_ERROR_TEXT("shape must have 1 to 8 dims"));
+    finite_data shape = {.data_size = len};
+    for (size_t i = 0; i < len; i++)
+        shape.data[i] = mp_obj_get_int(items[i]);
+    int dtype = mp_dtype_to_nncase((char)mp_obj_get_int(args[1]));
+    mp_int_t count = n_args > 2 ? mp_obj_get_int(args[2]) : 1;
+    if (count < 0)
+        mp_raise_ValueError(MP_ERROR_TEXT("count must be >= 0"));
+    if (!tensor_pool_reserve(dtype, shape, count))
+        mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("tensor pool reserve failed."));
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_tensor_pool_reserve_obj, 2, 3, mp_tensor_pool_reserve);
+
+// tensor_pool_info() -> dict(allocs, reuses, in_use, in_use_bytes, peak_bytes, free, free_bytes, budget)
+STATIC mp_obj_t mp_tensor_pool_info()
+{
+    tensor_pool_info info = tensor_pool_get_info();
+    mp_obj_t dict = mp_obj_new_dict(8);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_allocs), mp_obj_new_int_from_uint(info.allocs));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_reuses), mp_obj_new_int_from_uint(info.reuses));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_in_use), mp_obj_new_int_from_uint(info.in_use));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_in_use_bytes), mp_obj_new_int_from_uint(info.in_use_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_peak_bytes), mp_obj_new_int_from_uint(info.peak_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_free), mp_obj_new_int_from_uint(info.free));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_free_bytes), mp_obj_new_int_from_uint(info.free_bytes));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_budget), mp_obj_new_int_from_uint(info.budget));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_tensor_pool_info_obj, mp_tensor_pool_info);
+
+// tensor_pool_config(budget)，空闲链表最多保留budget字节，预留的tensor不计入
+STATIC mp_obj_t mp_tensor_pool_config(mp_obj_t budget_in)
+{
+    mp_int_t budget = mp_obj_get_int(budget_in);
+    if (budget < 0)
+        mp_raise_ValueError(MP_ERROR_TEXT("budget must be >= 0"));
+    tensor_pool_set_budget(budget);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(mp_tensor_pool_config_obj, mp_tensor_pool_config);
+
+STATIC mp_obj_t mp_tensor_pool_clear()
+{
+    tensor_pool_clear();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_tensor_pool_clear_obj, mp_tensor_pool_clear);
+
+// profiler_start(reset=True)，开始记录 ai2d/kpu/tensor/后处理各阶段的耗时
+STATIC mp_obj_t mp_profiler_start(size_t n_args, const mp_obj_t *args)
+{
+    prof_start(n_args > 0 ? mp_obj_is_true(args[0]) : true);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_VAR_BETWEEN(mp_profiler_start_obj, 0, 1, mp_profiler_start);
+
+STATIC mp_obj_t mp_profiler_stop()
+{
+    prof_stop();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_profiler_stop_obj, mp_profiler_stop);
+
+STATIC mp_obj_t mp_profiler_reset()
+{
+    prof_reset();
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_profiler_reset_obj, mp_profiler_reset);
+
+// profiler_dump() -> {stage: dict(count, min_us, avg_us, p99_us, max_us, bytes)}
+STATIC mp_obj_t mp_profiler_dump()
+{
+    prof_stage_stats stats[PROF_MAX_STAGES];
+    size_t n = prof_dump(stats, PROF_MAX_STAGES);
+    mp_obj_t result = mp_obj_new_dict(n);
+    for (size_t i = 0; i < n; i++)
+    {
+        mp_obj_t dict = mp_obj_new_dict(6);
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_count), mp_obj_new_int_from_uint(stats[i].count));
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_min_us), mp_obj_new_float(stats[i].min_ns / 1000.0f));
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_avg_us), mp_obj_new_float(stats[i].avg_ns / 1000.0f));
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_p99_us), mp_obj_new_float(stats[i].p99_ns / 1000.0f));
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_max_us), mp_obj_new_float(stats[i].max_ns / 1000.0f));
+        mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_bytes), mp_obj_new_int_from_ull(stats[i].bytes));
+        mp_obj_dict_store(result, mp_obj_new_str(stats[i].name, strlen(stats[i].name)), dict);
+    }
+    return result;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_profiler_dump_obj, mp_profiler_dump);
+
+// profiler_info() -> dict(enabled, events, dropped)，dropped为环形缓冲区溢出后被覆盖的事件数
+STATIC mp_obj_t mp_profiler_info()
+{
+    prof_info info = prof_get_info();
+    mp_obj_t dict = mp_obj_new_dict(3);
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_enabled), mp_obj_new_bool(info.enabled));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_events), mp_obj_new_int_from_ull(info.events));
+    mp_obj_dict_store(dict, MP_OBJ_NEW_QSTR(MP_QSTR_dropped), mp_obj_new_int_from_ull(info.dropped));
+    return dict;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(mp_profiler_info_obj, mp_profiler_info);
+
 STATIC mp_obj_t mp_version()
 {
     char* v = version();
@@ -83,12 +272,29 @@ STATIC const mp_rom_map_elem_t nncase_runtime_module_globals_table[] = {
     { MP_ROM_QSTR(MP_QSTR___name__), MP_ROM_QSTR(MP_QSTR_nncase_runtime) },
     { MP_ROM_QSTR(MP_QSTR_kpu), MP_ROM_PTR(&kpu_type) },
     { MP_ROM_QSTR(MP_QSTR_ai2d), MP_ROM_PTR(&ai2d_type) },
+    { MP_ROM_QSTR(MP_QSTR_graph), MP_ROM_PTR(&graph_type) },
     { MP_ROM_QSTR(MP_QSTR_interp_method), MP_ROM_PTR(&interp_method_type) },
     { MP_ROM_QSTR(MP_QSTR_interp_mode), MP_ROM_PTR(&interp_mode_type) },
     { MP_ROM_QSTR(MP_QSTR_ai2d_format), MP_ROM_PTR(&ai2d_format_type) },
     { MP_ROM_QSTR(MP_QSTR_from_numpy), MP_ROM_PTR(&mp_from_numpy_obj) },
     { MP_ROM_QSTR(MP_QSTR_shrink_memory_pool), MP_ROM_PTR(&mp_shrink_memory_pool_obj) },
     { MP_ROM_QSTR(MP_QSTR_version), MP_ROM_PTR(&mp_version_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ai2d_cache_info), MP_ROM_PTR(&mp_ai2d_cache_info_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ai2d_cache_config), MP_ROM_PTR(&mp_ai2d_cache_config_obj) },
+    { MP_ROM_QSTR(MP_QSTR_ai2d_cache_clear), MP_ROM_PTR(&mp_ai2d_cache_clear_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kmodel_prefetch), MP_ROM_PTR(&mp_kmodel_prefetch_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kmodel_cache_info), MP_ROM_PTR(&mp_kmodel_cache_info_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kmodel_cache_config), MP_ROM_PTR(&mp_kmodel_cache_config_obj) },
+    { MP_ROM_QSTR(MP_QSTR_kmodel_cache_clear), MP_ROM_PTR(&mp_kmodel_cache_clear_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tensor_pool_reserve), MP_ROM_PTR(&mp_tensor_pool_reserve_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tensor_pool_info), MP_ROM_PTR(&mp_tensor_pool_info_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tensor_pool_config), MP_ROM_PTR(&mp_tensor_pool_config_obj) },
+    { MP_ROM_QSTR(MP_QSTR_tensor_pool_clear), MP_ROM_PTR(&mp_tensor_pool_clear_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profiler_start), MP_ROM_PTR(&mp_profiler_start_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profiler_stop), MP_ROM_PTR(&mp_profiler_stop_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profiler_reset), MP_ROM_PTR(&mp_profiler_reset_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profiler_dump), MP_ROM_PTR(&mp_profiler_dump_obj) },
+    { MP_ROM_QSTR(MP_QSTR_profiler_info), MP_ROM_PTR(&mp_profiler_info_obj) },
 };
 
 STATIC MP_DEFINE_CONST_DICT(nncase_runtime_module_globals, nncase_runtime_module_globals_table);
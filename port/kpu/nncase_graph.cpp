@@ -0,0 +1,494 @@
+#include "nncase_graph.h"
+#include "profiler.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+enum graph_node_type
+{
+    GRAPH_NODE_AI2D,
+    GRAPH_NODE_KPU,
+    GRAPH_NODE_DETECT,
+    GRAPH_NODE_CROP,
+};
+
+struct graph_slot
+{
+    std::string name;
+    int kind = GRAPH_SLOT_NONE;
+    bool is_input = false;
+    runtime_tensor *tensor = nullptr;
+    bool owned = false;
+    // batched 时 tensor 的第0维按ROI切片，items 是预先建好的各个切片，count 为本次有效的个数
+    bool batched = false;
+    std::vector<runtime_tensor *> items;
+    size_t count = 0;
+    std::vector<ob_det_res> boxes;
+};
+
+struct graph_node
+{
+    graph_node_type type;
+    // 添加节点时复制的 builder，由 graph 释放，Python 侧的 ai2d_builder 可以先释放
+    m_builder *builder = nullptr;
+    Kpu *kpu = nullptr;
+    graph_detect_param detect;
+    int max_boxes = 0;
+    std::vector<int> inputs;
+    std::vector<int> outputs;
+    std::vector<ai2d_batch_roi> rois;
+};
+
+struct nn_graph
+{
+    std::vector<graph_slot> slots;
+    std::vector<graph_node> nodes;
+    std::string error;
+};
+
+static bool graph_fail(nn_graph *g, const std::string &msg)
+{
+    g->error = msg;
+    return false;
+}
+
+static int graph_find(nn_graph *g, const char *name)
+{
+    for (size_t i = 0; i < g->slots.size(); i++)
+    {
+        if (g->slots[i].name == name)
+            return i;
+    }
+    return -1;
+}
+
+static int graph_new_slot(nn_graph *g, const char *name, int kind)
+{
+    if (graph_find(g, name) >= 0)
+    {
+        graph_fail(g, std::string("duplicate name: ") + name);
+        return -1;
+    }
+    g->slots.emplace_back();
+    g->slots.back().name = name;
+    g->slots.back().kind = kind;
+    return g->slots.size() - 1;
+}
+
+static int graph_find_tensor(nn_graph *g, const char *name)
+{
+    int i = graph_find(g, name);
+    if (i < 0)
+        graph_fail(g, std::string("unknown input: ") + name);
+    else if (g->slots[i].kind != GRAPH_SLOT_TENSOR)
+        graph_fail(g, std::string("not a tensor: ") + name);
+    else
+        return i;
+    return -1;
+}
+
+static void graph_slot_release(graph_slot &slot)
+{
+    for (auto item : slot.items)
+        runtime_tensor_release(item);
+    slot.items.clear();
+    if (slot.owned && slot.tensor)
+        runtime_tensor_release(slot.tensor);
+    slot.tensor = nullptr;
+}
+
+static finite_data graph_shape(const rt_to_ndarray_info &info)
+{
+    finite_data shape;
+    shape.data_size = info.ndim_;
+    for (size_t i = 0; i < info.ndim_; i++)
+        shape.data[i] = info.shape_[i];
+    return shape;
+}
+
+// 给 batch tensor 的每个ROI建一个 item_shape 大小的切片
+static bool graph_make_items(nn_graph *g, graph_slot &slot, size_t n, finite_data item_shape)
+{
+    slot.batched = true;
+    for (size_t i = 0; i < n; i++)
+    {
+        runtime_tensor *item = runtime_tensor_slice(slot.tensor, i, item_shape);
+        if (!item)
+            return graph_fail(g, "cannot slice " + slot.name);
+        slot.items.push_back(item);
+    }
+    return true;
+}
+
+nn_graph *graph_create()
+{
+    return new nn_graph;
+}
+
+void graph_destroy(nn_graph *g)
+{
+    for (auto &slot : g->slots)
+        graph_slot_release(slot);
+    for (auto &node : g->nodes)
+    {
+        if (node.builder)
+            ai2d_release(node.builder);
+    }
+    delete g;
+}
+
+const char *graph_error(nn_graph *g)
+{
+    return g->error.c_str();
+}
+
+bool graph_add_input(nn_graph *g, const char *name)
+{
+    int i = graph_new_slot(g, name, GRAPH_SLOT_TENSOR);
+    if (i < 0)
+        return false;
+    g->slots[i].is_input = true;
+    return true;
+}
+
+bool graph_set_input(nn_graph *g, const char *name, runtime_tensor *tensor)
+{
+    int i = graph_find(g, name);
+    if (i < 0 || !g->slots[i].is_input)
+        return graph_fail(g, std::string("not an input: ") + name);
+    g->slots[i].tensor = tensor;
+    return true;
+}
+
+bool graph_add_ai2d(nn_graph *g, m_builder *builder, const char *input, const char *output)
+{
+    int in = graph_find_tensor(g, input);
+    if (in < 0)
+        return false;
+    if (g->slots[in].batched)
+        return graph_fail(g, std::string("ai2d input can not be per-ROI: ") + input);
+    int out = graph_new_slot(g, output, GRAPH_SLOT_TENSOR);
+    if (out < 0)
+        return false;
+
+    graph_slot &slot = g->slots[out];
+    slot.tensor = ai2d_create_output(builder, 0);
+    slot.owned = true;
+    if (!slot.tensor)
+        return graph_fail(g, std::string("cannot allocate ") + output);
+
+    graph_node node;
+    node.type = GRAPH_NODE_AI2D;
+    node.builder = ai2d_builder_clone(builder);
+    node.inputs.push_back(in);
+    node.outputs.push_back(out);
+    g->nodes.push_back(node);
+    return true;
+}
+
+bool graph_add_kpu(nn_graph *g, Kpu *kpu, const char **inputs, size_t n_inputs, const char **outputs, size_t n_outputs)
+{
+    if (n_inputs != Kpu_inputs_size(kpu) || n_outputs != Kpu_outputs_size(kpu))
+        return graph_fail(g, "inputs/outputs count mismatch with kmodel");
+
+    graph_node node;
+    node.type = GRAPH_NODE_KPU;
+    node.kpu = kpu;
+
+    // 任一输入来自 crop 时按ROI逐个推理，批大小取该输入的切片数
+    size_t batch = 0;
+    for (size_t i = 0; i < n_inputs; i++)
+    {
+        int in = graph_find_tensor(g, inputs[i]);
+        if (in < 0)
+            return false;
+        if (g->slots[in].batched)
+        {
+            if (batch && batch != g->slots[in].items.size())
+                return graph_fail(g, "per-ROI inputs have different sizes");
+            batch = g->slots[in].items.size();
+        }
+        node.inputs.push_back(in);
+    }
+
+    for (size_t i = 0; i < n_outputs; i++)
+    {
+        int out = graph_new_slot(g, outputs[i], GRAPH_SLOT_TENSOR);
+        if (out < 0)
+            return false;
+        node.outputs.push_back(out);
+
+        // 以模型加载时分配的输出为模板
+        rt_to_ndarray_info info;
+        runtime_tensor *templ = Kpu_get_output_tensor(kpu, i);
+        to_numpy(templ, &info);
+        runtime_tensor_release(templ);
+
+        finite_data item_shape = graph_shape(info);
+        finite_data shape = item_shape;
+        if (batch)
+        {
+            // [1, ...] 的第0维换成 batch，否则在最前面加一维
+            if (shape.data_size > 0 && shape.data[0] == 1)
+            {
+                shape.data[0] = batch;
+            }
+            else
+            {
+                if (shape.data_size == 8)
+                    return graph_fail(g, std::string("too many dims: ") + outputs[i]);
+                std::copy_backward(shape.data, shape.data + shape.data_size, shape.data + shape.data_size + 1);
+                shape.data[0] = batch;
+                shape.data_size++;
+            }
+        }
+
+        graph_slot &slot = g->slots[out];
+        slot.tensor = runtime_tensor_create(mp_dtype_to_nncase(info.dtype_), shape);
+        slot.owned = true;
+        if (!slot.tensor)
+            return graph_fail(g, std::string("cannot allocate ") + outputs[i]);
+        if (batch && !graph_make_items(g, slot, batch, item_shape))
+            return false;
+    }
+
+    g->nodes.push_back(node);
+    return true;
+}
+
+bool graph_add_detect(nn_graph *g, const graph_detect_param *param, const char **inputs, const char *output)
+{
+    if (param->type < GRAPH_DETECT_ANCHORBASE || param->type > GRAPH_DETECT_GFL)
+        return graph_fail(g, "unknown detect type");
+
+    graph_node node;
+    node.type = GRAPH_NODE_DETECT;
+    node.detect = *param;
+    for (int i = 0; i < 3; i++)
+    {
+        int in = graph_find_tensor(g, inputs[i]);
+        if (in < 0)
+            return false;
+        if (g->slots[in].batched)
+            return graph_fail(g, std::string("detect input can not be per-ROI: ") + inputs[i]);
+        node.inputs.push_back(in);
+    }
+
+    int out = graph_new_slot(g, output, GRAPH_SLOT_BOXES);
+    if (out < 0)
+        return false;
+    node.outputs.push_back(out);
+    g->nodes.push_back(node);
+    return true;
+}
+
+bool graph_add_crop(nn_graph *g, m_builder *builder, const char *image, const char *boxes, const char *output, int max_boxes)
+{
+    if (max_boxes <= 0)
+        return graph_fail(g, "max_boxes must be > 0");
+    int in = graph_find_tensor(g, image);
+    if (in < 0)
+        return false;
+    int box = graph_find(g, boxes);
+    if (box < 0 || g->slots[box].kind != GRAPH_SLOT_BOXES)
+        return graph_fail(g, std::string("not a detect output: ") + boxes);
+    int out = graph_new_slot(g, output, GRAPH_SLOT_TENSOR);
+    if (out < 0)
+        return false;
+
+    graph_slot &slot = g->slots[out];
+    slot.tensor = ai2d_create_output(builder, max_boxes);
+    slot.owned = true;
+    if (!slot.tensor)
+        return graph_fail(g, std::string("cannot allocate ") + output);
+
+    rt_to_ndarray_info info;
+    to_numpy(slot.tensor, &info);
+    finite_data item_shape = graph_shape(info);
+    item_shape.data[0] = 1;
+    if (!graph_make_items(g, slot, max_boxes, item_shape))
+        return false;
+
+    graph_node node;
+    node.type = GRAPH_NODE_CROP;
+    node.builder = ai2d_builder_clone(builder);
+    node.max_boxes = max_boxes;
+    node.inputs.push_back(in);
+    node.inputs.push_back(box);
+    node.outputs.push_back(out);
+    node.rois.resize(max_boxes);
+    g->nodes.push_back(node);
+    return true;
+}
+
+static bool graph_run_kpu(nn_graph *g, graph_node &node)
+{
+    if (Kpu_busy(node.kpu))
+        return graph_fail(g, "KPU is busy");
+
+    size_t batch = 0;
+    bool batched = false;
+    for (int in : node.inputs)
+    {
+        if (g->slots[in].batched)
+        {
+            batched = true;
+            batch = g->slots[in].count;
+        }
+    }
+    if (!batched)
+        batch = 1;
+
+    for (size_t b = 0; b < batch; b++)
+    {
+        for (size_t i = 0; i < node.inputs.size(); i++)
+        {
+            graph_slot &slot = g->slots[node.inputs[i]];
+            if (!Kpu_set_input_tensor(node.kpu, i, slot.batched ? slot.items[b] : slot.tensor))
+                return graph_fail(g, "kpu set input failed: " + slot.name);
+        }
+        for (size_t i = 0; i < node.outputs.size(); i++)
+        {
+            graph_slot &slot = g->slots[node.outputs[i]];
+            if (!Kpu_set_output_tensor(node.kpu, i, slot.batched ? slot.items[b] : slot.tensor))
+                return graph_fail(g, "kpu set output failed: " + slot.name);
+        }
+        if (!Kpu_run(node.kpu))
+            return graph_fail(g, "kpu run failed");
+    }
+
+    for (int out : node.outputs)
+        g->slots[out].count = batched ? batch : 1;
+    return true;
+}
+
+static bool graph_run_detect(nn_graph *g, graph_node &node)
+{
+    float *data[3];
+    for (int i = 0; i < 3; i++)
+    {
+        graph_slot &slot = g->slots[node.inputs[i]];
+        rt_to_ndarray_info info;
+        to_numpy(slot.tensor, &info);
+        if (info.dtype_ != 'f')
+            return graph_fail(g, "detect input must be float32: " + slot.name);
+        data[i] = (float *)info.data_;
+    }
+
+    graph_detect_param &p = node.detect;
+    int n = 0;
+    ob_det_res *res = nullptr;
+    if (p.type == GRAPH_DETECT_ANCHORBASE)
+        res = anchorbasedet_post_process(data[0], data[1], data[2], p.kmodel_frame_size, p.frame_size, p.strides, p.num_class,
+                                         p.det_thresh, p.nms_thresh, p.anchors, p.nms_option, &n);
+    else if (p.type == GRAPH_DETECT_ANCHORFREE)
+        res = anchorfreedet_post_process(data[0], data[1], data[2], p.kmodel_frame_size, p.frame_size, p.strides, p.num_class,
+                                         p.det_thresh, p.nms_thresh, p.nms_option, &n);
+    else
+        res = gfldet_post_process(data[0], data[1], data[2], p.kmodel_frame_size, p.frame_size, p.strides, p.num_class,
+                                  p.det_thresh, p.nms_thresh, p.nms_option, &n);
+
+    graph_slot &out = g->slots[node.outputs[0]];
+    out.boxes.assign(res, res + n);
+    free(res);
+    return true;
+}
+
+static bool graph_run_crop(nn_graph *g, graph_node &node)
+{
+    graph_slot &image = g->slots[node.inputs[0]];
+    graph_slot &boxes = g->slots[node.inputs[1]];
+    graph_slot &out = g->slots[node.outputs[0]];
+
+    // NCHW 或 NHWC 的输入图像大小，检测框裁剪到图像范围内
+    finite_data shape = ai2d_input_shape(node.builder);
+    if (shape.data_size != 4)
+        return graph_fail(g, "crop input must be 4-D");
+    bool nhwc = shape.data[3] <= 4 && shape.data[1] > 4;
+    int w = nhwc ? shape.data[2] : shape.data[3];
+    int h = nhwc ? shape.data[1] : shape.data[2];
+
+    size_t n = std::min(boxes.boxes.size(), (size_t)node.max_boxes);
+    for (size_t i = 0; i < n; i++)
+    {
+        const ob_det_res &b = boxes.boxes[i];
+        int x1 = std::clamp((int)b.x1, 0, w - 1);
+        int y1 = std::clamp((int)b.y1, 0, h - 1);
+        int x2 = std::clamp((int)b.x2, x1 + 1, w);
+        int y2 = std::clamp((int)b.y2, y1 + 1, h);
+        ai2d_batch_roi &roi = node.rois[i];
+        roi.affine = false;
+        roi.start_x = x1;
+        roi.start_y = y1;
+        roi.width = x2 - x1;
+        roi.height = y2 - y1;
+    }
+
+    if (n > 0 && !ai2d_run_batch(node.builder, image.tensor, out.tensor, node.rois.data(), n))
+        return graph_fail(g, "ai2d crop failed");
+    out.count = n;
+    return true;
+}
+
+bool graph_run(nn_graph *g)
+{
+    PROF_SCOPE("graph.run");
+    for (auto &slot : g->slots)
+    {
+        if (slot.is_input && !slot.tensor)
+            return graph_fail(g, "input not set: " + slot.name);
+    }
+
+    try
+    {
+        for (auto &node : g->nodes)
+        {
+            bool ok = true;
+            switch (node.type)
+            {
+            case GRAPH_NODE_AI2D:
+                ok = ai2d_run(node.builder, g->slots[node.inputs[0]].tensor, g->slots[node.outputs[0]].tensor);
+                if (!ok)
+                    graph_fail(g, "ai2d run failed");
+                break;
+            case GRAPH_NODE_KPU:
+                ok = graph_run_kpu(g, node);
+                break;
+            case GRAPH_NODE_DETECT:
+                ok = graph_run_detect(g, node);
+                break;
+            case GRAPH_NODE_CROP:
+                ok = graph_run_crop(g, node);
+                break;
+            }
+            if (!ok)
+                return false;
+        }
+    }
+    catch (std::exception &e)
+    {
+        return graph_fail(g, e.what());
+    }
+    return true;
+}
+
+int graph_slot_kind(nn_graph *g, const char *name)
+{
+    int i = graph_find(g, name);
+    return i < 0 ? GRAPH_SLOT_NONE : g->slots[i].kind;
+}
+
+size_t graph_get_boxes(nn_graph *g, const char *name, const ob_det_res **boxes)
+{
+    graph_slot &slot = g->slots[graph_find(g, name)];
+    *boxes = slot.boxes.data();
+    return slot.boxes.size();
+}
+
+runtime_tensor *graph_get_tensor(nn_graph *g, const char *name, int *count)
+{
+    graph_slot &slot = g->slots[graph_find(g, name)];
+    *count = slot.batched ? (int)slot.count : -1;
+    return slot.tensor;
+}
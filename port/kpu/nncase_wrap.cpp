@@ -1,7 +1,10 @@
 #include "nncase_wrap.h"
 #include "nncase_type.h"
+#include "kmodel_cache.h"
+#include "profiler.h"
 #include "nncase/runtime/interpreter.h"
 #include "nncase/runtime/runtime_tensor.h"
+#include "nncase/runtime/host_buffer.h"
 #include "nncase/functional/ai2d/ai2d_builder.h"
 #include "nncase/runtime/k230/gnne_tile_utils.h"
 #include "nncase/runtime/util.h"
@@ -10,19 +13,89 @@
 #include <fstream>
 #include <iostream>
 #include <iterator>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <cstring>
 
 // define C struct of c++ class
 
 
+struct tensor_pool_key
+{
+    nncase::typecode_t dtype;
+    size_t ndim;
+    size_t dims[8];
+
+    bool operator==(const tensor_pool_key &o) const
+    {
+        return dtype == o.dtype && ndim == o.ndim && std::equal(dims, dims + ndim, o.dims);
+    }
+};
+
+// run_async() 期间设置的输入，owner 为对应的 runtime_tensor，用于 tensor 池的绑定计数
+struct kpu_staged_input
+{
+    size_t index;
+    nncase::runtime::runtime_tensor tensor;
+    runtime_tensor *owner;
+};
+
 // kpu class
 struct interpreter
 {
     nncase::runtime::interpreter *interp;
+    // load_kmodel(path) 加载的模型文件，interp 直接引用这块内存，释放 interp 后才能释放
+    kmodel_blob *blob = nullptr;
+
+    // run_async() 在后台线程里执行推理，interp 只在 busy == false 时由调用者访问
+    std::thread *worker = nullptr;
+    std::mutex lock;
+    std::condition_variable cond;
+    bool busy = false;      // 有推理正在执行或排队
+    bool pending = false;   // 后台线程待取的推理请求
+    bool finished = false;  // 有已完成但还没被 wait() 取走的结果
+    bool ok = true;
+    bool quit = false;
+
+    // 输出ping-pong: 两组输出tensor交替绑定，上一帧的输出在下一帧推理期间保持有效
+    bool own_outputs = true;
+    int slot = 0;
+    std::vector<nncase::runtime::runtime_tensor> outputs[2];
+    // run_async() 把输入复制到 kpu 自己的一组tensor再推理，和调用者的输入构成ping-pong：
+    // 返回后调用者就可以改写输入(比如 ai2d 直接写下一帧)，复制只在上一帧推理结束后进行，一组就够；
+    // user_inputs 是调用者设置的输入，同步 run() 等访问前重新绑定
+    std::vector<nncase::runtime::runtime_tensor> inputs;
+    std::vector<nncase::runtime::runtime_tensor> user_inputs;
+    bool inputs_copied = false;
+    // load_kmodel 时记下，推理期间不能访问 interp
+    size_t inputs_count = 0;
+    // 推理期间设置的输入，下一次 run_async() 时再绑定
+    std::vector<kpu_staged_input> staged_inputs;
+    // 当前绑定的输入/输出，其中来自 tensor 池的在解除绑定之前不会被复用
+    std::vector<runtime_tensor *> bound_inputs;
+    std::vector<runtime_tensor *> bound_outputs;
 };
 
 struct runtime_tensor
 {
     nncase::runtime::runtime_tensor *r_tensor;
+    // to_numpy()建立的常驻映射，直到tensor释放才解除，ndarray可以直接引用这块内存
+    nncase::runtime::host_runtime_tensor::mapped_buffer *mapped = nullptr;
+
+    // tensor 池分配的 tensor release 后放回空闲链表；被 kpu 绑定时(binds > 0)等解除绑定后再放回
+    bool pooled = false;
+    bool released = false;
+    int binds = 0;
+    tensor_pool_key key;
+    size_t bytes = 0;
 };
 
 
@@ -49,9 +122,232 @@ struct ai2d
 
 struct ai2d_builder
 {
-    nncase::F::k230::ai2d_builder *builder;
+    std::shared_ptr<nncase::F::k230::ai2d_builder> builder;
+    // 构建时的参数，update_crop/update_affine 在此基础上修改后重新查缓存
+    ai2d param;
+    nncase::dims_t in_shape;
+    nncase::dims_t out_shape;
+};
+
+// ai2d schedule 缓存
+// build_schedule() 开销较大，参数完全相同时直接复用已经构建好的 builder。
+// 按最近使用排序，超过容量时淘汰最久未用的；被淘汰的 builder 仍由持有它的 ai2d_builder 对象引用
+struct ai2d_cache_entry
+{
+    std::string key;
+    std::shared_ptr<nncase::F::k230::ai2d_builder> builder;
 };
 
+static struct
+{
+    std::list<ai2d_cache_entry> lru;
+    std::unordered_map<std::string, std::list<ai2d_cache_entry>::iterator> index;
+    size_t capacity = AI2D_CACHE_DEFAULT_CAPACITY;
+    uint32_t hits = 0;
+    uint32_t misses = 0;
+} ai2d_cache;
+
+// tensor 池
+// 按 dtype+shape 分桶的空闲链表，命中时连 runtime_tensor 包装和常驻映射一起复用，
+// 预热之后 from_numpy 不再向 MMZ 或系统申请内存
+struct tensor_pool_bucket
+{
+    tensor_pool_key key;
+    std::vector<runtime_tensor *> free;
+    size_t reserved = 0;    // tensor_pool_reserve() 预留的个数，这部分不受 budget 限制
+};
+
+static struct
+{
+    std::mutex lock;
+    std::vector<tensor_pool_bucket> buckets;
+    size_t budget = TENSOR_POOL_DEFAULT_BUDGET;
+    uint32_t allocs = 0;
+    uint32_t reuses = 0;
+    size_t in_use = 0;
+    size_t in_use_bytes = 0;
+    size_t peak_bytes = 0;
+    size_t free = 0;
+    size_t free_bytes = 0;
+} tensor_pool;
+
+static tensor_pool_key tensor_pool_make_key(nncase::typecode_t dtype, const nncase::dims_t &shape)
+{
+    tensor_pool_key key;
+    key.dtype = dtype;
+    key.ndim = std::min(shape.size(), (size_t)8);
+    std::copy(shape.begin(), shape.begin() + key.ndim, key.dims);
+    return key;
+}
+
+// 调用时持有 tensor_pool.lock
+static tensor_pool_bucket &tensor_pool_bucket_of(const tensor_pool_key &key)
+{
+    for (auto &b : tensor_pool.buckets)
+    {
+        if (b.key == key)
+            return b;
+    }
+    tensor_pool.buckets.emplace_back();
+    tensor_pool.buckets.back().key = key;
+    return tensor_pool.buckets.back();
+}
+
+static void tensor_pool_destroy(runtime_tensor *tensor)
+{
+    delete tensor->mapped;
+    delete tensor->r_tensor;
+    delete tensor;
+}
+
+static void tensor_pool_mark_in_use(size_t bytes)
+{
+    tensor_pool.in_use++;
+    tensor_pool.in_use_bytes += bytes;
+    tensor_pool.peak_bytes = std::max(tensor_pool.peak_bytes, tensor_pool.in_use_bytes);
+}
+
+// 新申请一个池内 tensor，不经过空闲链表，失败返回NULL
+static runtime_tensor *tensor_pool_new(nncase::typecode_t dtype, const nncase::dims_t &shape)
+{
+    auto local_data = nncase::runtime::host_runtime_tensor::create(dtype, shape, nncase::runtime::host_runtime_tensor::pool_shared);
+    if (!local_data.is_ok())
+        return nullptr;
+    runtime_tensor *tensor = new runtime_tensor;
+    tensor->r_tensor = new nncase::runtime::runtime_tensor(local_data.unwrap().impl());
+    tensor->pooled = true;
+    tensor->key = tensor_pool_make_key(dtype, shape);
+    tensor->bytes = local_data.unwrap().impl()->buffer().size_bytes();
+    prof_count_alloc(tensor->bytes);
+    return tensor;
+}
+
+static runtime_tensor *tensor_pool_alloc(nncase::typecode_t dtype, const nncase::dims_t &shape)
+{
+    tensor_pool_key key = tensor_pool_make_key(dtype, shape);
+    {
+        std::lock_guard<std::mutex> guard(tensor_pool.lock);
+        auto &bucket = tensor_pool_bucket_of(key);
+        if (!bucket.free.empty())
+        {
+            runtime_tensor *tensor = bucket.free.back();
+            bucket.free.pop_back();
+            tensor->released = false;
+            tensor_pool.free--;
+            tensor_pool.free_bytes -= tensor->bytes;
+            tensor_pool.reuses++;
+            tensor_pool_mark_in_use(tensor->bytes);
+            return tensor;
+        }
+    }
+
+    runtime_tensor *tensor = tensor_pool_new(dtype, shape);
+    if (!tensor)
+        return nullptr;
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    tensor_pool.allocs++;
+    tensor_pool_mark_in_use(tensor->bytes);
+    return tensor;
+}
+
+// 已经 release 且没有被绑定的 tensor 放回空闲链表，超过 budget 时直接释放。调用时持有 tensor_pool.lock
+static void tensor_pool_recycle(runtime_tensor *tensor)
+{
+    tensor_pool.in_use--;
+    tensor_pool.in_use_bytes -= tensor->bytes;
+    auto &bucket = tensor_pool_bucket_of(tensor->key);
+    if (bucket.free.size() < bucket.reserved || tensor_pool.free_bytes + tensor->bytes <= tensor_pool.budget)
+    {
+        bucket.free.push_back(tensor);
+        tensor_pool.free++;
+        tensor_pool.free_bytes += tensor->bytes;
+    }
+    else
+    {
+        tensor_pool_destroy(tensor);
+    }
+}
+
+static void tensor_pool_bind(runtime_tensor *tensor)
+{
+    if (!tensor || !tensor->pooled)
+        return;
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    tensor->binds++;
+}
+
+static void tensor_pool_unbind(runtime_tensor *tensor)
+{
+    if (!tensor || !tensor->pooled)
+        return;
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    if (--tensor->binds == 0 && tensor->released)
+        tensor_pool_recycle(tensor);
+}
+
+bool tensor_pool_reserve(int dtype, finite_data shape, size_t count)
+{
+    if (dtype == -1)
+        return false;
+    nncase::dims_t shape_;
+    for (size_t i = 0; i < shape.data_size; i++)
+        shape_.push_back((size_t)shape.data[i]);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        runtime_tensor *tensor = tensor_pool_new((nncase::typecode_t)dtype, shape_);
+        if (!tensor)
+            return false;
+        std::lock_guard<std::mutex> guard(tensor_pool.lock);
+        auto &bucket = tensor_pool_bucket_of(tensor->key);
+        bucket.reserved++;
+        bucket.free.push_back(tensor);
+        tensor_pool.allocs++;
+        tensor_pool.free++;
+        tensor_pool.free_bytes += tensor->bytes;
+    }
+    return true;
+}
+
+void tensor_pool_set_budget(size_t bytes)
+{
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    tensor_pool.budget = bytes;
+}
+
+// 释放空闲链表中的 tensor 和预留，正在使用的不受影响
+void tensor_pool_clear()
+{
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    for (auto &b : tensor_pool.buckets)
+    {
+        for (auto tensor : b.free)
+            tensor_pool_destroy(tensor);
+        b.free.clear();
+        b.reserved = 0;
+    }
+    tensor_pool.free = 0;
+    tensor_pool.free_bytes = 0;
+    tensor_pool.allocs = 0;
+    tensor_pool.reuses = 0;
+    tensor_pool.peak_bytes = tensor_pool.in_use_bytes;
+}
+
+tensor_pool_info tensor_pool_get_info()
+{
+    std::lock_guard<std::mutex> guard(tensor_pool.lock);
+    tensor_pool_info info;
+    info.allocs = tensor_pool.allocs;
+    info.reuses = tensor_pool.reuses;
+    info.in_use = tensor_pool.in_use;
+    info.in_use_bytes = tensor_pool.in_use_bytes;
+    info.peak_bytes = tensor_pool.peak_bytes;
+    info.free = tensor_pool.free;
+    info.free_bytes = tensor_pool.free_bytes;
+    info.budget = tensor_pool.budget;
+    return info;
+}
+
 // utils
 tensor_desc get_tensor_desc_info(tensor_desc *data)
 {
@@ -122,10 +418,34 @@ int mp_dtype_to_nncase(char data_type)
 
 void shrink_memory_pool()
 {
+    tensor_pool_clear();
     nncase::runtime::shrink_memory_pool();
 }
 
 
+// 记录 kpu 第 index 个输入/输出绑定的 tensor，旧的解除绑定
+static void kpu_track(std::vector<runtime_tensor *> &bound, size_t index, runtime_tensor *tensor)
+{
+    if (bound.size() <= index)
+        bound.resize(index + 1, nullptr);
+    tensor_pool_bind(tensor);
+    tensor_pool_unbind(bound[index]);
+    bound[index] = tensor;
+}
+
+static void kpu_untrack_all(Kpu *p)
+{
+    for (auto t : p->bound_inputs)
+        tensor_pool_unbind(t);
+    for (auto t : p->bound_outputs)
+        tensor_pool_unbind(t);
+    for (auto &in : p->staged_inputs)
+        tensor_pool_unbind(in.owner);
+    p->bound_inputs.clear();
+    p->bound_outputs.clear();
+    p->staged_inputs.clear();
+}
+
 // func 
 Kpu *Kpu_create()
 {
@@ -135,40 +455,298 @@ Kpu *Kpu_create()
 }
 
 void Kpu_destroy(Kpu* p) {
+    if (p->worker)
+    {
+        {
+            std::lock_guard<std::mutex> guard(p->lock);
+            p->quit = true;
+        }
+        p->cond.notify_all();
+        p->worker->join();
+        delete p->worker;
+        p->worker = nullptr;
+    }
+    kpu_untrack_all(p);
     delete p->interp;
     p->interp = nullptr;
+    kmodel_cache_release(p->blob);
+    p->blob = nullptr;
     delete p;
     p = nullptr;
 }
 
+// 把推理期间暂存的输入绑定到 interp，调用时不能有推理在执行
+static bool kpu_bind_staged_inputs(Kpu *p)
+{
+    bool ok = true;
+    for (auto &in : p->staged_inputs)
+    {
+        ok = ok && p->interp->input_tensor(in.index, in.tensor).is_ok();
+        if (ok)
+            kpu_track(p->bound_inputs, in.index, in.owner);
+        tensor_pool_unbind(in.owner);
+    }
+    p->staged_inputs.clear();
+    return ok;
+}
+
+// run_async() 绑定的是输入的副本，换回调用者设置的输入，调用时不能有推理在执行
+static bool kpu_restore_inputs(Kpu *p)
+{
+    if (!p->inputs_copied)
+        return true;
+    p->inputs_copied = false;
+    for (size_t i = 0; i < p->user_inputs.size(); i++)
+    {
+        if (!p->interp->input_tensor(i, p->user_inputs[i]).is_ok())
+            return false;
+    }
+    p->user_inputs.clear();
+    return true;
+}
+
 bool Kpu_run(Kpu* p){
+    PROF_SCOPE("kpu.run");
+    if (!kpu_restore_inputs(p) || !kpu_bind_staged_inputs(p))
+        return false;
     auto state = p->interp->run();
     return state.is_ok();
 }
 
+static void kpu_async_worker(Kpu *p)
+{
+    std::unique_lock<std::mutex> guard(p->lock);
+    for (;;)
+    {
+        p->cond.wait(guard, [p] { return p->pending || p->quit; });
+        if (p->quit)
+            break;
+        p->pending = false;
+        guard.unlock();
+
+        bool ok;
+        try
+        {
+            PROF_SCOPE("kpu.run_async");
+            ok = p->interp->run().is_ok();
+        }
+        catch (...)
+        {
+            ok = false;
+        }
+
+        guard.lock();
+        p->ok = ok;
+        p->finished = true;
+        p->busy = false;
+        p->cond.notify_all();
+    }
+}
+
+// 为每个输出准备两组tensor，供 run_async() 交替使用
+static bool kpu_alloc_output_slots(Kpu *p)
+{
+    size_t n = p->interp->outputs_size();
+    for (int k = 0; k < 2; k++)
+    {
+        p->outputs[k].clear();
+        for (size_t i = 0; i < n; i++)
+        {
+            auto desc = p->interp->output_desc(i);
+            auto shape = p->interp->output_shape(i);
+            auto tensor = nncase::runtime::host_runtime_tensor::create(desc.datatype, shape, nncase::runtime::host_runtime_tensor::pool_shared);
+            if (!tensor.is_ok())
+            {
+                p->outputs[0].clear();
+                p->outputs[1].clear();
+                return false;
+            }
+            prof_count_alloc(tensor.unwrap().impl()->buffer().size_bytes());
+            p->outputs[k].emplace_back(std::move(tensor.unwrap()));
+        }
+    }
+    return true;
+}
+
+// 为每个输入准备一个副本，供 run_async() 使用
+static bool kpu_alloc_input_copies(Kpu *p)
+{
+    p->inputs.clear();
+    for (size_t i = 0; i < p->inputs_count; i++)
+    {
+        auto desc = p->interp->input_desc(i);
+        auto shape = p->interp->input_shape(i);
+        auto tensor = nncase::runtime::host_runtime_tensor::create(desc.datatype, shape, nncase::runtime::host_runtime_tensor::pool_shared);
+        if (!tensor.is_ok())
+        {
+            p->inputs.clear();
+            return false;
+        }
+        prof_count_alloc(tensor.unwrap().impl()->buffer().size_bytes());
+        p->inputs.emplace_back(std::move(tensor.unwrap()));
+    }
+    return true;
+}
+
+// 把调用者的输入复制到副本并绑定，推理期间调用者改写输入不影响 KPU
+static bool kpu_copy_inputs(Kpu *p)
+{
+    PROF_SCOPE("kpu.copy_inputs");
+    if (p->inputs.empty() && !kpu_alloc_input_copies(p))
+        return false;
+    p->user_inputs.clear();
+    auto &inputs = p->inputs;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        auto user = p->interp->input_tensor(i);
+        if (!user.is_ok())
+            return false;
+        p->user_inputs.emplace_back(std::move(user.unwrap()));
+        if (!p->user_inputs[i].copy_to(inputs[i]).is_ok())
+            return false;
+    }
+    p->inputs_copied = true;
+    for (size_t i = 0; i < inputs.size(); i++)
+    {
+        if (!p->interp->input_tensor(i, inputs[i]).is_ok())
+            return false;
+    }
+    return true;
+}
+
+bool Kpu_run_async(Kpu* p)
+{
+    if (Kpu_busy(p))
+        return false;
+
+    if (!kpu_restore_inputs(p) || !kpu_bind_staged_inputs(p) || !kpu_copy_inputs(p))
+        return false;
+
+    if (p->own_outputs)
+    {
+        if (p->outputs[0].empty() && !kpu_alloc_output_slots(p))
+            return false;
+        auto &outputs = p->outputs[p->slot];
+        for (size_t i = 0; i < outputs.size(); i++)
+        {
+            if (!p->interp->output_tensor(i, outputs[i]).is_ok())
+                return false;
+        }
+        p->slot ^= 1;
+    }
+
+    if (!p->worker)
+        p->worker = new std::thread(kpu_async_worker, p);
+
+    {
+        std::lock_guard<std::mutex> guard(p->lock);
+        p->busy = true;
+        p->pending = true;
+        p->finished = false;
+    }
+    p->cond.notify_all();
+    return true;
+}
+
+int Kpu_wait(Kpu* p, int timeout_ms)
+{
+    std::unique_lock<std::mutex> guard(p->lock);
+    auto idle = [p] { return !p->busy; };
+    if (timeout_ms < 0)
+        p->cond.wait(guard, idle);
+    else if (!p->cond.wait_for(guard, std::chrono::milliseconds(timeout_ms), idle))
+        return KPU_ASYNC_TIMEOUT;
+
+    bool finished = p->finished;
+    p->finished = false;
+    if (finished && !p->ok)
+        return KPU_ASYNC_FAILED;
+    return KPU_ASYNC_OK;
+}
+
+bool Kpu_busy(Kpu* p)
+{
+    std::lock_guard<std::mutex> guard(p->lock);
+    return p->busy;
+}
+
+// 换模型后输出形状会变，旧的ping-pong tensor作废
+static void kpu_reset_slots(Kpu *p)
+{
+    p->own_outputs = true;
+    p->slot = 0;
+    p->outputs[0].clear();
+    p->outputs[1].clear();
+    p->inputs.clear();
+    p->user_inputs.clear();
+    p->inputs_copied = false;
+    p->inputs_count = 0;
+    kpu_untrack_all(p);
+}
+
 bool Kpu_load_kmodel_path(Kpu* p, const char* path)
 {
-    std::ifstream ifs(path, std::ios::binary);
-    auto state = p->interp->load_model(ifs);
-    return state.is_ok();
+    kpu_reset_slots(p);
+    // 模型文件通过缓存只读映射，不再经过 ifstream 拷贝，interp 直接从映射的内存解析
+    kmodel_blob *blob = kmodel_cache_acquire(path);
+    if (!blob)
+        return false;
+    gsl::span<const gsl::byte> span((const gsl::byte*)kmodel_blob_data(blob), kmodel_blob_size(blob));
+    auto state = p->interp->load_model(span);
+    if (!state.is_ok())
+    {
+        kmodel_cache_release(blob);
+        return false;
+    }
+    kmodel_cache_release(p->blob);
+    p->blob = blob;
+    p->inputs_count = p->interp->inputs_size();
+    return true;
 }
 
 bool Kpu_load_kmodel_buffer(Kpu* p, char* buffer, size_t size)
 {
+    kpu_reset_slots(p);
     gsl::span<const gsl::byte> span((gsl::byte*)buffer, size);
     auto state = p->interp->load_model(span);
-    return state.is_ok();
+    if (!state.is_ok())
+        return false;
+    kmodel_cache_release(p->blob);
+    p->blob = nullptr;
+    p->inputs_count = p->interp->inputs_size();
+    return true;
 }
 
 bool Kpu_set_input_tensor(Kpu* p, size_t index, runtime_tensor *tensor)
 {
+    if (Kpu_busy(p))
+    {
+        // 推理进行中不能改 interp 的绑定，先记下，下一次 run_async() 时生效
+        if (index >= p->inputs_count)
+            return false;
+        // 暂存期间也算绑定，防止 release 后被 tensor 池复用
+        tensor_pool_bind(tensor);
+        p->staged_inputs.push_back({index, *tensor->r_tensor, tensor});
+        return true;
+    }
+    if (!kpu_restore_inputs(p) || !kpu_bind_staged_inputs(p))
+        return false;
     auto state = p->interp->input_tensor(index, *tensor->r_tensor); //.expect("kpu set input tensor failed.");
-    return state.is_ok();
+    if (!state.is_ok())
+        return false;
+    kpu_track(p->bound_inputs, index, tensor);
+    return true;
 }
 
 runtime_tensor* Kpu_get_input_tensor(Kpu* p, size_t index)
 {
     runtime_tensor *tensor = new runtime_tensor();
+    // run_async() 之后 interp 绑定的是副本，返回调用者设置的输入
+    if (p->inputs_copied && index < p->user_inputs.size())
+    {
+        tensor->r_tensor = new nncase::runtime::runtime_tensor(p->user_inputs[index]);
+        return tensor;
+    }
     auto data = p->interp->input_tensor(index).expect("kpu get input tensor failed.");
     tensor->r_tensor = new nncase::runtime::runtime_tensor(data.impl());
     return tensor;
@@ -176,8 +754,13 @@ runtime_tensor* Kpu_get_input_tensor(Kpu* p, size_t index)
 
 bool Kpu_set_output_tensor(Kpu* p, size_t index, runtime_tensor *tensor)
 {
+    // 用户自己管理输出tensor时不再做ping-pong
+    p->own_outputs = false;
     auto state = p->interp->output_tensor(index, *tensor->r_tensor); //.expect("kpu set output tensor failed.");
-    return state.is_ok();
+    if (!state.is_ok())
+        return false;
+    kpu_track(p->bound_outputs, index, tensor);
+    return true;
 }
 
 runtime_tensor* Kpu_get_output_tensor(Kpu* p, size_t index)
@@ -190,7 +773,7 @@ runtime_tensor* Kpu_get_output_tensor(Kpu* p, size_t index)
 
 size_t Kpu_inputs_size(Kpu* p)
 {
-    return p->interp->inputs_size();
+    return p->inputs_count;
 }
 
 size_t Kpu_outputs_size(Kpu* p)
@@ -214,34 +797,59 @@ tensor_desc Kpu_get_output_desc(Kpu* p, size_t index)
 
 runtime_tensor* from_numpy(int dtype, finite_data shape, void* data, uint64_t phy_addr)
 {
+    PROF_SCOPE("tensor.from_numpy");
     if(dtype == -1)
         throw std::runtime_error("Unsupported data type.");
-    runtime_tensor *tensor = new runtime_tensor;
-    std::vector<int32_t> shape_data(shape.data_size, 0);
-
-    for (int i = 0; i < shape.data_size; i++)
+    nncase::dims_t shape_;
+    size_t elements = 1;
+    for (size_t i = 0; i < shape.data_size; i++)
     {
-        shape_data[i] = (int)shape.data[i];
+        shape_.push_back((size_t)shape.data[i]);
+        elements *= (size_t)shape.data[i];
     }
+    size_t data_bytes = elements * typecode_bytes((nncase::typecode_t)dtype);
 
-    size_t data_bytes = std::accumulate(shape_data.begin(), shape_data.end(), 1, std::multiplies<int32_t>()) * typecode_bytes((nncase::typecode_t)dtype);
-    nncase::dims_t shape_(shape_data.begin(), shape_data.end());
-    
-    bool copy_flag = false;
     if (phy_addr == 0)
-        copy_flag = true;
-        
+    {
+        // 数据要拷贝到 MMZ，从 tensor 池取同样 dtype+shape 的 tensor，映射常驻，不用每次重新申请和映射
+        runtime_tensor *tensor = tensor_pool_alloc((nncase::typecode_t)dtype, shape_);
+        if (!tensor)
+            throw std::runtime_error("cannot create input tensor");
+        if (!tensor->mapped)
+        {
+            auto mapped = nncase::runtime::host_runtime_tensor::map(*tensor->r_tensor, nncase::runtime::map_access_t::map_read_write).expect("map tensor failed");
+            tensor->mapped = new nncase::runtime::host_runtime_tensor::mapped_buffer(std::move(mapped));
+        }
+        memcpy(tensor->mapped->buffer().data(), data, data_bytes);
+        runtime_tensor_sync(tensor, true);
+        return tensor;
+    }
+
+    runtime_tensor *tensor = new runtime_tensor;
     auto local_data = nncase::runtime::host_runtime_tensor::create(
                           (nncase::typecode_t)dtype, shape_, {(gsl::byte *)data, data_bytes},
-                          copy_flag, nncase::runtime::host_runtime_tensor::pool_shared, phy_addr)
+                          false, nncase::runtime::host_runtime_tensor::pool_shared, phy_addr)
                           .expect("cannot create input tensor");
     nncase::runtime::host_runtime_tensor::sync(local_data, nncase::runtime::sync_op_t::sync_write_back, true).expect("sync write_back failed");
     tensor->r_tensor = new nncase::runtime::runtime_tensor(local_data.impl());
     return tensor;
 }
 
+runtime_tensor* runtime_tensor_create(int dtype, finite_data shape)
+{
+    if(dtype == -1)
+        return nullptr;
+    nncase::dims_t shape_;
+    for (size_t i = 0; i < shape.data_size; i++)
+        shape_.push_back((size_t)shape.data[i]);
+
+    // 在 MMZ 上分配或从 tensor 池复用，内容未初始化
+    return tensor_pool_alloc((nncase::typecode_t)dtype, shape_);
+}
+
 void to_numpy(runtime_tensor * tensor, rt_to_ndarray_info *info)
 {
+    PROF_SCOPE("tensor.to_numpy");
     info->dtype_ = get_dtype_for_mp(tensor->r_tensor->datatype());
     auto shape = tensor->r_tensor->shape();
     info->ndim_ = shape.size();
@@ -253,8 +861,23 @@ void to_numpy(runtime_tensor * tensor, rt_to_ndarray_info *info)
         info->strides_[i] = tensor->r_tensor->strides()[i];
     }
 
-    info->data_ =std::move((void *)nncase::runtime::host_runtime_tensor::map(*tensor->r_tensor, nncase::runtime::map_access_t::map_read).unwrap().buffer().data());
+    if (!tensor->mapped)
+    {
+        PROF_SCOPE("tensor.map");
+        auto mapped = nncase::runtime::host_runtime_tensor::map(*tensor->r_tensor, nncase::runtime::map_access_t::map_read_write).expect("map tensor failed");
+        tensor->mapped = new nncase::runtime::host_runtime_tensor::mapped_buffer(std::move(mapped));
+    }
+    // KPU/ai2d通过DMA写输出，CPU读之前先让cache失效
+    runtime_tensor_sync(tensor, false);
+    info->data_ = tensor->mapped->buffer().data();
+}
 
+bool runtime_tensor_sync(runtime_tensor *tensor, bool write_back)
+{
+    PROF_SCOPE("tensor.sync");
+    auto op = write_back ? nncase::runtime::sync_op_t::sync_write_back : nncase::runtime::sync_op_t::sync_invalidate;
+    auto state = nncase::runtime::host_runtime_tensor::sync(*tensor->r_tensor, op, true);
+    return state.is_ok();
 }
 
 
@@ -301,6 +924,111 @@ void ai2d_destroy(ai2d *p)
     p = nullptr;
 }
 
+template <typename T>
+static void ai2d_key_push(std::string &key, const T &v)
+{
+    key.append((const char *)&v, sizeof(v));
+}
+
+template <typename T>
+static void ai2d_key_push_vec(std::string &key, const T &v)
+{
+    ai2d_key_push(key, (uint32_t)v.size());
+    for (auto &e : v)
+        ai2d_key_push(key, e);
+}
+
+// 把构建 schedule 用到的全部参数按字节拼成缓存的 key
+static std::string ai2d_cache_key(const ai2d &p, const nncase::dims_t &in_shape, const nncase::dims_t &out_shape)
+{
+    std::string key;
+    key.reserve(256);
+    ai2d_key_push_vec(key, in_shape);
+    ai2d_key_push_vec(key, out_shape);
+
+    ai2d_key_push(key, p.ai2d_datatype.src_format);
+    ai2d_key_push(key, p.ai2d_datatype.dst_format);
+    ai2d_key_push(key, p.ai2d_datatype.src_type);
+    ai2d_key_push(key, p.ai2d_datatype.dst_type);
+
+    ai2d_key_push(key, p.ai2d_crop_param.crop_flag);
+    ai2d_key_push(key, p.ai2d_crop_param.start_x);
+    ai2d_key_push(key, p.ai2d_crop_param.start_y);
+    ai2d_key_push(key, p.ai2d_crop_param.width);
+    ai2d_key_push(key, p.ai2d_crop_param.height);
+
+    ai2d_key_push(key, p.ai2d_shift_param.shift_flag);
+    ai2d_key_push(key, p.ai2d_shift_param.shift_val);
+
+    ai2d_key_push(key, p.ai2d_pad_param.pad_flag);
+    ai2d_key_push(key, (uint32_t)p.ai2d_pad_param.paddings.size());
+    for (auto &pad : p.ai2d_pad_param.paddings)
+    {
+        ai2d_key_push(key, pad.before);
+        ai2d_key_push(key, pad.after);
+    }
+    ai2d_key_push(key, p.ai2d_pad_param.pad_mode);
+    ai2d_key_push_vec(key, p.ai2d_pad_param.pad_val);
+
+    ai2d_key_push(key, p.ai2d_resize_param.resize_flag);
+    ai2d_key_push(key, p.ai2d_resize_param.interp_method);
+    ai2d_key_push(key, p.ai2d_resize_param.interp_mode);
+
+    ai2d_key_push(key, p.ai2d_affine_param.affine_flag);
+    ai2d_key_push(key, p.ai2d_affine_param.interp_method);
+    ai2d_key_push(key, p.ai2d_affine_param.cord_round);
+    ai2d_key_push(key, p.ai2d_affine_param.bound_ind);
+    ai2d_key_push(key, p.ai2d_affine_param.bound_val);
+    ai2d_key_push(key, p.ai2d_affine_param.bound_smooth);
+    ai2d_key_push_vec(key, p.ai2d_affine_param.M);
+    return key;
+}
+
+static void ai2d_cache_trim(size_t capacity)
+{
+    while (ai2d_cache.lru.size() > capacity)
+    {
+        ai2d_cache.index.erase(ai2d_cache.lru.back().key);
+        ai2d_cache.lru.pop_back();
+    }
+}
+
+// 查缓存，没有命中时构建新的 schedule 并放入缓存
+static std::shared_ptr<nncase::F::k230::ai2d_builder> ai2d_cache_get(const ai2d &p, const nncase::dims_t &in_shape, const nncase::dims_t &out_shape)
+{
+    if(in_shape[3]<=32 && p.ai2d_pad_param.paddings[3].before>0)
+        throw std::runtime_error("[ERROR] ai2d pad: input width is <=32, the left pad should not be set. You can set the right pad first, then set the left pad.");
+
+    std::string key = ai2d_cache_key(p, in_shape, out_shape);
+    auto it = ai2d_cache.index.find(key);
+    if (it != ai2d_cache.index.end())
+    {
+        ai2d_cache.hits++;
+        ai2d_cache.lru.splice(ai2d_cache.lru.begin(), ai2d_cache.lru, it->second);
+        return it->second->builder;
+    }
+
+    ai2d_cache.misses++;
+    PROF_SCOPE("ai2d.build_schedule");
+    auto builder = std::make_shared<nncase::F::k230::ai2d_builder>(in_shape,
+                                                                   out_shape,
+                                                                   p.ai2d_datatype,
+                                                                   p.ai2d_crop_param,
+                                                                   p.ai2d_shift_param,
+                                                                   p.ai2d_pad_param,
+                                                                   p.ai2d_resize_param,
+                                                                   p.ai2d_affine_param);
+    builder->build_schedule().expect("ai2d build schedule failed.");
+
+    if (ai2d_cache.capacity > 0)
+    {
+        ai2d_cache.lru.push_front({key, builder});
+        ai2d_cache.index[std::move(key)] = ai2d_cache.lru.begin();
+        ai2d_cache_trim(ai2d_cache.capacity);
+    }
+    return builder;
+}
+
 m_builder* ai2d_build(ai2d *p, finite_data input_shape, finite_data output_shape)
 {
     std::vector<size_t> in_shape_(input_shape.data_size,0);
@@ -315,31 +1043,176 @@ m_builder* ai2d_build(ai2d *p, finite_data input_shape, finite_data output_shape
         out_shape_[i] = (size_t)output_shape.data[i];
     }
 
-    nncase::dims_t in_shape(in_shape_.begin(), in_shape_.end());
-    nncase::dims_t out_shape(out_shape_.begin(), out_shape_.end());
-
-    if(in_shape_[3]<=32 && p->ai2d_pad_param.paddings[3].before>0)
-        throw std::runtime_error("[ERROR] ai2d pad: input width is <=32, the left pad should not be set. You can set the right pad first, then set the left pad.");
     m_builder *mbuilder = new m_builder;
-    mbuilder->builder = new nncase::F::k230::ai2d_builder(in_shape,
-                                                          out_shape,
-                                                          p->ai2d_datatype,
-                                                          p->ai2d_crop_param,
-                                                          p->ai2d_shift_param,
-                                                          p->ai2d_pad_param,
-                                                          p->ai2d_resize_param,
-                                                          p->ai2d_affine_param);
-
-    mbuilder->builder->build_schedule().expect("ai2d build schedule failed.");
+    mbuilder->param = *p;
+    mbuilder->in_shape = nncase::dims_t(in_shape_.begin(), in_shape_.end());
+    mbuilder->out_shape = nncase::dims_t(out_shape_.begin(), out_shape_.end());
+    try
+    {
+        mbuilder->builder = ai2d_cache_get(mbuilder->param, mbuilder->in_shape, mbuilder->out_shape);
+    }
+    catch (...)
+    {
+        delete mbuilder;
+        throw;
+    }
     return mbuilder;
 }
 
+m_builder* ai2d_builder_clone(m_builder *p)
+{
+    return new m_builder(*p);
+}
+
+// 只修改crop区域，其他参数不变。参数组合之前出现过时直接复用缓存，不重新构建
+void ai2d_update_crop(m_builder *p, ai2d_crop_param crop_params)
+{
+    ai2d_set_crop_param(&p->param, crop_params);
+    p->builder = ai2d_cache_get(p->param, p->in_shape, p->out_shape);
+}
+
+// 只修改仿射矩阵，其他参数不变
+void ai2d_update_affine(m_builder *p, finite_data M)
+{
+    p->param.ai2d_affine_param.M = std::vector<float>(M.data, M.data + M.data_size);
+    p->builder = ai2d_cache_get(p->param, p->in_shape, p->out_shape);
+}
+
+void ai2d_cache_set_capacity(size_t capacity)
+{
+    ai2d_cache.capacity = capacity;
+    ai2d_cache_trim(capacity);
+}
+
+void ai2d_cache_clear()
+{
+    ai2d_cache.lru.clear();
+    ai2d_cache.index.clear();
+    ai2d_cache.hits = 0;
+    ai2d_cache.misses = 0;
+}
+
+ai2d_cache_info ai2d_cache_get_info()
+{
+    ai2d_cache_info info;
+    info.hits = ai2d_cache.hits;
+    info.misses = ai2d_cache.misses;
+    info.size = ai2d_cache.lru.size();
+    info.capacity = ai2d_cache.capacity;
+    return info;
+}
+
 bool ai2d_run(m_builder* p, runtime_tensor *in_tensor, runtime_tensor *out_tensor)
 {
+    PROF_SCOPE("ai2d.run");
     auto state = p->builder->invoke(*in_tensor->r_tensor, *out_tensor->r_tensor);
     return state.is_ok();
 }
 
+// 在batch输出tensor中取第index个 1xCxHxW 切片，和原tensor共用同一块内存
+static nncase::runtime::runtime_tensor ai2d_batch_slice(nncase::runtime::runtime_tensor &out, gsl::span<gsl::byte> mapped, uintptr_t phy_addr,
+                                                       const nncase::dims_t &shape, size_t index)
+{
+    size_t bytes = mapped.size() / out.shape()[0];
+    size_t offset = index * bytes;
+    return nncase::runtime::host_runtime_tensor::create(out.datatype(), shape, mapped.subspan(offset, bytes),
+                                                        false, nncase::runtime::host_runtime_tensor::pool_shared, phy_addr + offset)
+        .expect("ai2d batch: cannot create output slice");
+}
+
+// 用同一个build好的模板对n个ROI依次处理，结果写到 NxCxHxW 输出tensor的第i个切片。
+// 每个ROI只替换crop区域或仿射矩阵，其余参数沿用模板，schedule通过缓存复用
+bool ai2d_run_batch(m_builder *p, runtime_tensor *in_tensor, runtime_tensor *out_tensor, const ai2d_batch_roi *rois, int n)
+{
+    PROF_SCOPE("ai2d.run_batch");
+    auto &out = *out_tensor->r_tensor;
+    auto out_shape = out.shape();
+    if (out_shape.size() != p->out_shape.size() || out_shape[0] < (size_t)n)
+        return false;
+    for (size_t i = 1; i < out_shape.size(); i++)
+    {
+        if (out_shape[i] != p->out_shape[i])
+            return false;
+    }
+
+    auto hbuf = out.impl()->buffer().buffer().as<nncase::runtime::host_buffer_t>().expect("ai2d batch: output is not a host tensor");
+    uintptr_t phy_addr = hbuf->physical_address().expect("ai2d batch: output has no physical address") + out.impl()->buffer().start();
+    auto mapped = nncase::runtime::host_runtime_tensor::map(out, nncase::runtime::map_access_t::map_read_write).expect("ai2d batch: map output failed");
+
+    ai2d param = p->param;
+    for (int i = 0; i < n; i++)
+    {
+        if (rois[i].affine)
+        {
+            param.ai2d_affine_param.affine_flag = true;
+            param.ai2d_affine_param.M = std::vector<float>(rois[i].M, rois[i].M + 6);
+        }
+        else
+        {
+            param.ai2d_crop_param.crop_flag = true;
+            param.ai2d_crop_param.start_x = rois[i].start_x;
+            param.ai2d_crop_param.start_y = rois[i].start_y;
+            param.ai2d_crop_param.width = rois[i].width;
+            param.ai2d_crop_param.height = rois[i].height;
+        }
+        auto builder = ai2d_cache_get(param, p->in_shape, p->out_shape);
+        auto slice = ai2d_batch_slice(out, mapped.buffer(), phy_addr, p->out_shape, i);
+        if (!builder->invoke(*in_tensor->r_tensor, slice).is_ok())
+            return false;
+    }
+    return true;
+}
+
+// 按builder的输出shape和类型分配tensor，batch>0时第0维改为batch
+runtime_tensor* ai2d_create_output(m_builder *p, size_t batch)
+{
+    nncase::dims_t shape = p->out_shape;
+    if (batch > 0 && !shape.empty())
+        shape[0] = batch;
+    return tensor_pool_alloc(p->param.ai2d_datatype.dst_type, shape);
+}
+
+finite_data ai2d_input_shape(m_builder *p)
+{
+    finite_data shape;
+    shape.data_size = std::min(p->in_shape.size(), (size_t)8);
+    for (size_t i = 0; i < shape.data_size; i++)
+        shape.data[i] = p->in_shape[i];
+    return shape;
+}
+
+// batch tensor中第index个shape大小的切片，和原tensor共用内存，不拷贝
+runtime_tensor* runtime_tensor_slice(runtime_tensor *batch, size_t index, finite_data shape)
+{
+    auto &t = *batch->r_tensor;
+    nncase::dims_t shape_;
+    size_t elements = 1;
+    for (size_t i = 0; i < shape.data_size; i++)
+    {
+        shape_.push_back((size_t)shape.data[i]);
+        elements *= (size_t)shape.data[i];
+    }
+    size_t bytes = elements * typecode_bytes(t.datatype());
+
+    auto hbuf = t.impl()->buffer().buffer().as<nncase::runtime::host_buffer_t>();
+    if (!hbuf.is_ok())
+        return nullptr;
+    auto phy_addr = hbuf.unwrap()->physical_address();
+    auto mapped = nncase::runtime::host_runtime_tensor::map(t, nncase::runtime::map_access_t::map_read_write);
+    if (!phy_addr.is_ok() || !mapped.is_ok() || (index + 1) * bytes > mapped.unwrap().buffer().size())
+        return nullptr;
+
+    size_t offset = index * bytes;
+    auto slice = nncase::runtime::host_runtime_tensor::create(t.datatype(), shape_, mapped.unwrap().buffer().subspan(offset, bytes), false,
+                                                              nncase::runtime::host_runtime_tensor::pool_shared,
+                                                              phy_addr.unwrap() + t.impl()->buffer().start() + offset);
+    if (!slice.is_ok())
+        return nullptr;
+    runtime_tensor *tensor = new runtime_tensor;
+    tensor->r_tensor = new nncase::runtime::runtime_tensor(slice.unwrap().impl());
+    return tensor;
+}
+
 // set ai2d args
 void ai2d_set_dtype(ai2d *p, ai2d_dtype_param dtype_param)
 {
@@ -397,6 +1270,16 @@ void ai2d_set_affine_param(ai2d *p, ai2d_affine_param affine_params)
 
 void runtime_tensor_release(runtime_tensor *tensor)
 {
+    if (tensor->pooled)
+    {
+        std::lock_guard<std::mutex> guard(tensor_pool.lock);
+        tensor->released = true;
+        if (tensor->binds == 0)
+            tensor_pool_recycle(tensor);
+        return;
+    }
+    delete tensor->mapped;
+    tensor->mapped = nullptr;
     delete tensor->r_tensor;
     tensor->r_tensor = nullptr;
     delete tensor;
@@ -405,8 +1288,7 @@ void runtime_tensor_release(runtime_tensor *tensor)
 
 void ai2d_release(m_builder *p)
 {
-    delete p->builder;
-    p->builder = nullptr;
+    p->builder.reset();
     delete p;
     p = nullptr;
 }
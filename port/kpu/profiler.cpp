@@ -0,0 +1,178 @@
+#include "profiler.h"
+#include <stdlib.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string.h>
+#include <vector>
+
+// 推理流水线分阶段计时
+// 每个事件写入固定大小的环形缓冲区，写入只有一次 fetch_add，不加锁；
+// 每个槽位带序号(seqlock)，dump() 读到正在被改写的槽位时直接跳过。
+bool prof_on = false;
+
+struct prof_event
+{
+    std::atomic<uint64_t> seq;  // 写完后为 index + 1，写入过程中为 0
+    std::atomic<uint32_t> stage;
+    std::atomic<uint64_t> duration_ns;
+    std::atomic<uint64_t> bytes;
+};
+
+static prof_event prof_ring[PROF_RING_SIZE];
+static std::atomic<uint64_t> prof_head{0};
+static std::atomic<uint64_t> prof_base{0};  // reset 时的 head，之前的事件不再统计
+
+static std::mutex prof_stage_lock;
+static std::atomic<int> prof_stage_count{0};
+static const char *prof_stage_names[PROF_MAX_STAGES];
+
+static thread_local uint64_t prof_alloc_bytes = 0;
+
+uint64_t prof_now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+}
+
+int prof_stage(const char *name)
+{
+    std::lock_guard<std::mutex> guard(prof_stage_lock);
+    int n = prof_stage_count.load(std::memory_order_relaxed);
+    for (int i = 0; i < n; i++)
+    {
+        if (!strcmp(prof_stage_names[i], name))
+            return i;
+    }
+    if (n == PROF_MAX_STAGES)
+        return PROF_MAX_STAGES - 1;
+    prof_stage_names[n] = name;
+    prof_stage_count.store(n + 1, std::memory_order_release);
+    return n;
+}
+
+uint64_t prof_alloc_mark(void)
+{
+    return prof_alloc_bytes;
+}
+
+void prof_count_alloc(size_t bytes)
+{
+    if (prof_enabled())
+        prof_alloc_bytes += bytes;
+}
+
+void prof_record(int stage, uint64_t start_ns, uint64_t alloc_mark)
+{
+    uint64_t duration = prof_now_ns() - start_ns;
+    uint64_t index = prof_head.fetch_add(1, std::memory_order_relaxed);
+    prof_event &e = prof_ring[index & (PROF_RING_SIZE - 1)];
+
+    e.seq.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    e.stage.store(stage, std::memory_order_relaxed);
+    e.duration_ns.store(duration, std::memory_order_relaxed);
+    e.bytes.store(prof_alloc_bytes - alloc_mark, std::memory_order_relaxed);
+    e.seq.store(index + 1, std::memory_order_release);
+}
+
+void prof_start(bool reset)
+{
+    if (reset)
+        prof_reset();
+    __atomic_store_n(&prof_on, true, __ATOMIC_RELAXED);
+}
+
+void prof_stop(void)
+{
+    __atomic_store_n(&prof_on, false, __ATOMIC_RELAXED);
+}
+
+void prof_reset(void)
+{
+    prof_base.store(prof_head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+size_t prof_dump(prof_stage_stats *stats, size_t max)
+{
+    int n_stages = prof_stage_count.load(std::memory_order_acquire);
+    std::vector<std::vector<uint64_t>> durations(n_stages);
+    std::vector<uint64_t> bytes(n_stages, 0);
+
+    uint64_t head = prof_head.load(std::memory_order_relaxed);
+    uint64_t begin = std::max(prof_base.load(std::memory_order_relaxed),
+                              head > PROF_RING_SIZE ? head - PROF_RING_SIZE : 0);
+    for (uint64_t i = begin; i < head; i++)
+    {
+        prof_event &e = prof_ring[i & (PROF_RING_SIZE - 1)];
+        if (e.seq.load(std::memory_order_acquire) != i + 1)
+            continue;
+        uint32_t stage = e.stage.load(std::memory_order_relaxed);
+        uint64_t duration = e.duration_ns.load(std::memory_order_relaxed);
+        uint64_t size = e.bytes.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (e.seq.load(std::memory_order_relaxed) != i + 1 || stage >= (uint32_t)n_stages)
+            continue;
+        durations[stage].push_back(duration);
+        bytes[stage] += size;
+    }
+
+    size_t count = 0;
+    for (int s = 0; s < n_stages && count < max; s++)
+    {
+        std::vector<uint64_t> &d = durations[s];
+        if (d.empty())
+            continue;
+        std::sort(d.begin(), d.end());
+        uint64_t total = 0;
+        for (auto v : d)
+            total += v;
+
+        prof_stage_stats &st = stats[count++];
+        st.name = prof_stage_names[s];
+        st.count = d.size();
+        st.min_ns = d.front();
+        st.max_ns = d.back();
+        st.avg_ns = total / d.size();
+        // 最近秩法: 第 ceil(0.99 * n) 个
+        st.p99_ns = d[(d.size() * 99 + 99) / 100 - 1];
+        st.bytes = bytes[s];
+    }
+    return count;
+}
+
+prof_info prof_get_info(void)
+{
+    prof_info info;
+    uint64_t head = prof_head.load(std::memory_order_relaxed);
+    uint64_t base = prof_base.load(std::memory_order_relaxed);
+    info.enabled = prof_enabled();
+    info.events = head - base;
+    info.dropped = info.events > PROF_RING_SIZE ? info.events - PROF_RING_SIZE : 0;
+    return info;
+}
+
+// 替换全局 operator new，统计开启时把分配量计入当前线程，
+// nncase/opencv/后处理里 std::vector 等的分配都会被计入对应阶段
+void *operator new(std::size_t size)
+{
+    if (prof_enabled())
+        prof_alloc_bytes += size;
+    void *p = malloc(size ? size : 1);
+    if (!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    free(p);
+}
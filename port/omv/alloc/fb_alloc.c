@@ -22,8 +22,15 @@ static struct {
     uint32_t alloc_buffer_peak;
     uint32_t alloc_bytes;
     uint32_t alloc_bytes_peak;
+    uint32_t alloc_count;
 } fb_alloc_mgt;
 
+// The frame buffer stack is one contiguous region reserved on first use and
+// never returned to the system. fb_alloc() bumps alloc_bytes, freeing resets
+// it to the offset recorded in the popped entry, so buf[].ptr always holds the
+// stack top from before that allocation was made (NULL for marks).
+static char *fb_alloc_region;
+
 #define FB_MARK_FLAG        0x1
 #define FB_PERMANENT_FLAG   0x2
 
@@ -37,6 +44,13 @@ static void fb_alloc_buffer_fail() {
     mp_raise_msg(&mp_type_MemoryError, MP_ERROR_TEXT("Out of fast frame buffer stack index"));
 }
 
+// returns null pointer without error if the region can't be reserved
+static char *fb_alloc_get_region() {
+    if (fb_alloc_region == NULL)
+        fb_alloc_region = aligned_alloc(FB_ALLOC_ALIGNMENT, OMV_FB_ALLOC_SIZE);
+    return fb_alloc_region;
+}
+
 void fb_alloc_init0() {
     memset(&fb_alloc_mgt, 0, sizeof(fb_alloc_mgt));
 }
@@ -45,31 +59,43 @@ uint32_t fb_avail() {
     return OMV_FB_ALLOC_SIZE - fb_alloc_mgt.alloc_bytes;
 }
 
-void fb_alloc_mark() {
-    if (fb_alloc_mgt.alloc_buffer >= OMV_FB_ALLOC_BUFFER_COUNT)
-        fb_alloc_buffer_fail();
-
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = FB_MARK_FLAG;
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = NULL;
+static void fb_alloc_push(uint32_t size, void *ptr) {
+    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = size;
+    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = ptr;
 
     fb_alloc_mgt.alloc_buffer++;
     if (fb_alloc_mgt.alloc_buffer > fb_alloc_mgt.alloc_buffer_peak)
         fb_alloc_mgt.alloc_buffer_peak = fb_alloc_mgt.alloc_buffer;
 }
 
+// Pops the top entry and rewinds the stack top to where it was before it.
+static uint32_t fb_alloc_pop() {
+    uint32_t size;
+
+    fb_alloc_mgt.alloc_buffer--;
+    size = fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size;
+    if (size & (~7UL))
+        fb_alloc_mgt.alloc_bytes = (char *) fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr - fb_alloc_region;
+    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = 0;
+    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = NULL;
+
+    return size;
+}
+
+void fb_alloc_mark() {
+    if (fb_alloc_mgt.alloc_buffer >= OMV_FB_ALLOC_BUFFER_COUNT)
+        fb_alloc_buffer_fail();
+
+    fb_alloc_push(FB_MARK_FLAG, NULL);
+}
+
 static void int_fb_alloc_free_till_mark(bool free_permanent) {
     while (fb_alloc_mgt.alloc_buffer) {
         uint32_t size;
         size = fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer - 1].size;
         if ((!free_permanent) && (size & FB_PERMANENT_FLAG))
             return;
-        fb_alloc_mgt.alloc_buffer--;
-        fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = 0;
-        if (size & (~7UL)) {
-            free(fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr);
-            fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = NULL;
-            fb_alloc_mgt.alloc_bytes -= (size & (~7UL));
-        }
+        fb_alloc_pop();
         if (size & FB_MARK_FLAG)
             break;
     }
@@ -87,38 +113,50 @@ void fb_alloc_free_till_mark_past_mark_permanent() {
     int_fb_alloc_free_till_mark(true);
 }
 
+// Reserves size bytes (already rounded to 8) at the stack top. Returns NULL
+// if the region can't hold it, leaving the stack untouched.
+static void *int_fb_alloc(uint32_t size, int hints) {
+    uint32_t align, start, end;
+
+    align = hints & FB_ALLOC_CACHE_ALIGN ? FB_ALLOC_ALIGNMENT : 8;
+    start = (fb_alloc_mgt.alloc_bytes + align - 1) & ~(align - 1);
+    end = start + size;
+    if (hints & FB_ALLOC_CACHE_ALIGN)
+        end = (end + FB_ALLOC_ALIGNMENT - 1) & ~(FB_ALLOC_ALIGNMENT - 1);
+
+    if ((start < fb_alloc_mgt.alloc_bytes) || (end < start) || (end > OMV_FB_ALLOC_SIZE))
+        return NULL;
+
+    // Record the consumed span (padding included) so the low flag bits stay free.
+    fb_alloc_push(end - fb_alloc_mgt.alloc_bytes, fb_alloc_region + fb_alloc_mgt.alloc_bytes);
+
+    fb_alloc_mgt.alloc_bytes = end;
+    if (fb_alloc_mgt.alloc_bytes > fb_alloc_mgt.alloc_bytes_peak)
+        fb_alloc_mgt.alloc_bytes_peak = fb_alloc_mgt.alloc_bytes;
+    fb_alloc_mgt.alloc_count++;
+
+    return fb_alloc_region + start;
+}
+
 // returns null pointer without error if size==0
 void *fb_alloc(uint32_t size, int hints) {
-    uint32_t align;
     void *ptr;
 
     if (!size)
         return NULL;
 
-    align = hints & FB_ALLOC_CACHE_ALIGN ? FB_ALLOC_ALIGNMENT : 8;
     size = (size + 7) & (~7UL);
 
     if (fb_alloc_mgt.alloc_buffer >= OMV_FB_ALLOC_BUFFER_COUNT)
         fb_alloc_buffer_fail();
 
-    if (size > fb_avail())
+    if (fb_alloc_get_region() == NULL)
         fb_alloc_fail();
 
-    ptr = aligned_alloc(align, size);
+    ptr = int_fb_alloc(size, hints);
     if (ptr == NULL)
         fb_alloc_fail();
 
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = size;
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = ptr;
-
-    fb_alloc_mgt.alloc_buffer++;
-    if (fb_alloc_mgt.alloc_buffer > fb_alloc_mgt.alloc_buffer_peak)
-        fb_alloc_mgt.alloc_buffer_peak = fb_alloc_mgt.alloc_buffer;
-
-    fb_alloc_mgt.alloc_bytes += size;
-    if (fb_alloc_mgt.alloc_bytes > fb_alloc_mgt.alloc_bytes_peak)
-        fb_alloc_mgt.alloc_bytes_peak = fb_alloc_mgt.alloc_bytes;
-
     return ptr;
 }
 
@@ -130,30 +168,27 @@ void *fb_alloc0(uint32_t size, int hints) {
 }
 
 void *fb_alloc_all(uint32_t *size, int hints) {
-    uint32_t align, avail;
+    uint32_t align, start, avail;
     void *ptr;
 
-    align = hints & FB_ALLOC_CACHE_ALIGN ? FB_ALLOC_ALIGNMENT : 8;
-    avail = fb_avail();
-    avail &= (~7UL);
-
-    if (avail < 8 || fb_alloc_mgt.alloc_buffer >= OMV_FB_ALLOC_BUFFER_COUNT)
+    if (fb_alloc_mgt.alloc_buffer >= OMV_FB_ALLOC_BUFFER_COUNT)
         return NULL;
 
-    ptr = aligned_alloc(align, avail);
-    if (ptr == NULL)
+    if (fb_alloc_get_region() == NULL)
         return NULL;
 
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = avail;
-    fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = ptr;
+    align = hints & FB_ALLOC_CACHE_ALIGN ? FB_ALLOC_ALIGNMENT : 8;
+    start = (fb_alloc_mgt.alloc_bytes + align - 1) & ~(align - 1);
+    if (start >= OMV_FB_ALLOC_SIZE)
+        return NULL;
 
-    fb_alloc_mgt.alloc_buffer++;
-    if (fb_alloc_mgt.alloc_buffer > fb_alloc_mgt.alloc_buffer_peak)
-        fb_alloc_mgt.alloc_buffer_peak = fb_alloc_mgt.alloc_buffer;
+    avail = (OMV_FB_ALLOC_SIZE - start) & ~(align - 1);
+    if (avail < 8)
+        return NULL;
 
-    fb_alloc_mgt.alloc_bytes += avail;
-    if (fb_alloc_mgt.alloc_bytes > fb_alloc_mgt.alloc_bytes_peak)
-        fb_alloc_mgt.alloc_bytes_peak = fb_alloc_mgt.alloc_bytes;
+    ptr = int_fb_alloc(avail, hints);
+    if (ptr == NULL)
+        return NULL;
 
     *size = avail;
 
@@ -168,17 +203,8 @@ void *fb_alloc0_all(uint32_t *size, int hints) {
 }
 
 void fb_free() {
-    if (fb_alloc_mgt.alloc_buffer) {
-        uint32_t size;
-        fb_alloc_mgt.alloc_buffer--;
-        size = fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size & (~7UL);
-        fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].size = 0;
-        if (size) {
-            free(fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr);
-            fb_alloc_mgt.buf[fb_alloc_mgt.alloc_buffer].ptr = NULL;
-            fb_alloc_mgt.alloc_bytes -= size;
-        }
-    }
+    if (fb_alloc_mgt.alloc_buffer)
+        fb_alloc_pop();
 }
 
 void fb_free_all() {
@@ -193,21 +219,25 @@ mp_obj_t fb_stat(int cmd)
 
     vstr_init(&vstr, 256);
     vstr_printf(&vstr, "fb stat:\n"
-    "total_buffer: %d, total_bytes: %d\n"
+    "total_bytes: %d, total_buffer: %d\n"
     "alloc_buffer: %d, alloc_buffer_peak: %d\n"
-    "alloc_bytes: %d, alloc_bytes_peak: %d"
+    "alloc_bytes: %d, alloc_bytes_peak: %d\n"
+    "alloc_count: %d, region: %p"
     , OMV_FB_ALLOC_SIZE, OMV_FB_ALLOC_BUFFER_COUNT,
     fb_alloc_mgt.alloc_buffer, fb_alloc_mgt.alloc_buffer_peak,
-    fb_alloc_mgt.alloc_bytes, fb_alloc_mgt.alloc_bytes_peak
+    fb_alloc_mgt.alloc_bytes, fb_alloc_mgt.alloc_bytes_peak,
+    fb_alloc_mgt.alloc_count, fb_alloc_region
     );
 
     if (cmd == 1) {
         fb_alloc_mgt.alloc_buffer_peak = fb_alloc_mgt.alloc_buffer;
         fb_alloc_mgt.alloc_bytes_peak = fb_alloc_mgt.alloc_bytes;
+        fb_alloc_mgt.alloc_count = 0;
     } else if (cmd == 2) {
         fb_free_all();
         fb_alloc_mgt.alloc_buffer_peak = 0;
         fb_alloc_mgt.alloc_bytes_peak = 0;
+        fb_alloc_mgt.alloc_count = 0;
     }
 
     return mp_obj_new_str_from_vstr(&vstr);
@@ -7,6 +7,9 @@
  *
  * Theory of operation:
  *
+ * The stack lives in a single OMV_FB_ALLOC_SIZE region reserved on first use. Allocating bumps the
+ * stack top and freeing rewinds it, so neither touches the system allocator after the first call.
+ *
  * The frame buffer stack may be used to allocate large areas of RAM very quickly. You can allocate
  * memory using fb_alloc() which returns a poiner to an allocated region of memory equal in size to
  * the amount requested. If the memory is not avaiable fb_alloc() will generate an exception.
@@ -152,6 +152,11 @@
 // Enable STM32 DMA2D
 // #define IMLIB_ENABLE_DMA2D
 
+// Enable RISC-V Vector (RVV 1.0) row kernels when the compiler provides the intrinsics
+#if defined(__riscv_vector) && defined(__riscv_v_intrinsic) && (__riscv_v_intrinsic >= 12000)
+#define IMLIB_ENABLE_RVV
+#endif
+
 // Enable PNG encoder/decoder
 #define IMLIB_ENABLE_PNG_ENCODER
 #define IMLIB_ENABLE_PNG_DECODER
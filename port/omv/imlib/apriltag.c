@@ -11982,7 +11982,7 @@ void imlib_find_apriltags(list_t *out, image_t *ptr, rectangle_t *roi, apriltag_
         apriltag_detector_add_family(td, (apriltag_family_t *) &artoolkit);
     }
 
-    image_t img;
+    image_t img = {};
     img.w = roi->w;
     img.h = roi->h;
     img.pixfmt = PIXFORMAT_GRAYSCALE;
@@ -12086,7 +12086,7 @@ void imlib_find_rects(list_t *out, image_t *ptr, rectangle_t *roi, uint32_t thre
     umm_init_x(((fb_avail() - fb_alloc_need) / resolution) * resolution);
     apriltag_detector_t *td = apriltag_detector_create();
 
-    image_t img;
+    image_t img = {};
     img.w = roi->w;
     img.h = roi->h;
     img.pixfmt = PIXFORMAT_GRAYSCALE;
@@ -12276,6 +12276,7 @@ void imlib_rotation_corr(image_t *img, float x_rotation, float y_rotation, float
                          float x_translation, float y_translation,
                          float zoom, float fov, float *corners)
 {
+    image_assert_packed(img);
     // Create a tmp copy of the image to pull pixels from.
     size_t size = image_size(img);
     void *data = fb_alloc(size, FB_ALLOC_NO_HINT);
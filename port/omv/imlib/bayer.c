@@ -462,13 +462,19 @@ void imlib_debayer_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pi
     }
 }
 
-// Does no bounds checking on the destination. Destination must be mutable.
-void imlib_debayer_image(image_t *dst, image_t *src) {
+typedef struct imlib_debayer_band {
+    image_t *dst, *src;
+} imlib_debayer_band_t;
+
+// Bands are counted in row pairs so that every band starts on an even row.
+static void imlib_debayer_band(void *arg, int band, int y_start, int y_end) {
+    image_t *dst = ((imlib_debayer_band_t *) arg)->dst;
+    image_t *src = ((imlib_debayer_band_t *) arg)->src;
     int src_w = src->w, w_limit = src_w - 1, w_limit_m_1 = w_limit - 1;
     int src_h = src->h, h_limit = src_h - 1, h_limit_m_1 = h_limit - 1;
 
     // If the image is an odd height this will go for the last loop and we drop the last row.
-    for (int y = 0; y < src_h; y += 2) {
+    for (int y = y_start * 2, yy = IM_MIN(y_end * 2, src_h); y < yy; y += 2) {
         void *row_ptr_e = NULL, *row_ptr_o = NULL;
 
         switch (dst->pixfmt) {
@@ -888,3 +894,12 @@ void imlib_debayer_image(image_t *dst, image_t *src) {
         }
     }
 }
+
+// Does no bounds checking on the destination. Destination must be mutable.
+void imlib_debayer_image(image_t *dst, image_t *src) {
+    imlib_debayer_band_t state = { .dst = dst, .src = src };
+    int pairs = (src->h + 1) / 2;
+    // In place conversions read rows that other bands have already written.
+    int bands = image_overlaps(dst, src) ? 1 : imlib_parallel_bands(pairs, 4);
+    imlib_parallel_for(pairs, bands, imlib_debayer_band, &state);
+}
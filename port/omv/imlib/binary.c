@@ -11,21 +11,26 @@
 #include "imlib.h"
 
 #ifdef IMLIB_ENABLE_BINARY_OPS
-void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, bool zero, image_t *mask) {
-    image_t bmp;
-    bmp.w = img->w;
-    bmp.h = img->h;
-    bmp.pixfmt = PIXFORMAT_BINARY;
-    bmp.data = fb_alloc0(image_size(&bmp), FB_ALLOC_NO_HINT);
+typedef struct imlib_binary_band {
+    image_t *out, *img, *bmp, *mask;
+    list_t *thresholds;
+    bool invert, zero;
+} imlib_binary_band_t;
+
+static void imlib_binary_band(void *arg, int band, int y_start, int y_end) {
+    imlib_binary_band_t *state = (imlib_binary_band_t *) arg;
+    image_t *out = state->out, *img = state->img, *bmp = state->bmp, *mask = state->mask;
+    list_t *thresholds = state->thresholds;
+    bool invert = state->invert, zero = state->zero;
 
     for (list_lnk_t *it = iterator_start_from_head(thresholds); it; it = iterator_next(it)) {
         color_thresholds_list_lnk_data_t lnk_data;
         iterator_get(thresholds, it, &lnk_data);
         switch (img->pixfmt) {
             case PIXFORMAT_BINARY: {
-                for (int y = 0, yy = img->h; y < yy; y++) {
+                for (int y = y_start; y < y_end; y++) {
                     uint32_t *old_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                     for (int x = 0, xx = img->w; x < xx; x++) {
                         if (COLOR_THRESHOLD_BINARY(IMAGE_GET_BINARY_PIXEL_FAST(old_row_ptr, x), &lnk_data, invert)) {
                             IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
@@ -35,9 +40,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 break;
             }
             case PIXFORMAT_GRAYSCALE: {
-                for (int y = 0, yy = img->h; y < yy; y++) {
+                for (int y = y_start; y < y_end; y++) {
                     uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                     for (int x = 0, xx = img->w; x < xx; x++) {
                         if (COLOR_THRESHOLD_GRAYSCALE(IMAGE_GET_GRAYSCALE_PIXEL_FAST(old_row_ptr, x), &lnk_data, invert)) {
                             IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
@@ -47,9 +52,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 break;
             }
             case PIXFORMAT_RGB565: {
-                for (int y = 0, yy = img->h; y < yy; y++) {
+                for (int y = y_start; y < y_end; y++) {
                     uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                     for (int x = 0, xx = img->w; x < xx; x++) {
                         if (COLOR_THRESHOLD_RGB565(IMAGE_GET_RGB565_PIXEL_FAST(old_row_ptr, x), &lnk_data, invert)) {
                             IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
@@ -58,6 +63,18 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 }
                 break;
             }
+            case PIXFORMAT_RGB888: {
+                for (int y = y_start; y < y_end; y++) {
+                    uint8_t *old_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
+                    for (int x = 0, xx = img->w; x < xx; x++) {
+                        if (COLOR_THRESHOLD_RGB888(IMAGE_GET_RGB888_PIXEL_FAST(old_row_ptr, x), &lnk_data, invert)) {
+                            IMAGE_SET_BINARY_PIXEL_FAST(bmp_row_ptr, x);
+                        }
+                    }
+                }
+                break;
+            }
             default: {
                 break;
             }
@@ -67,9 +84,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
             if (!zero) {
-                for (int y = 0, yy = img->h; y < yy; y++) {
+                for (int y = y_start; y < y_end; y++) {
                     uint32_t *old_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                     uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                     for (int x = 0, xx = img->w; x < xx; x++) {
                         int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
@@ -79,9 +96,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                     }
                 }
             } else {
-                for (int y = 0, yy = img->h; y < yy; y++) {
+                for (int y = y_start; y < y_end; y++) {
                     uint32_t *old_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                    uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                     uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                     for (int x = 0, xx = img->w; x < xx; x++) {
                         int pixel = IMAGE_GET_BINARY_PIXEL_FAST(old_row_ptr, x);
@@ -98,9 +115,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
         case PIXFORMAT_GRAYSCALE: {
             if (out->pixfmt == PIXFORMAT_BINARY) {
                 if (!zero) {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
@@ -110,9 +127,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                         }
                     }
                 } else {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = COLOR_GRAYSCALE_TO_BINARY(IMAGE_GET_GRAYSCALE_PIXEL_FAST(old_row_ptr, x));
@@ -126,9 +143,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 }
             } else {
                 if (!zero) {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint8_t *out_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
@@ -138,9 +155,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                         }
                     }
                 } else {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint8_t *old_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint8_t *out_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(old_row_ptr, x);
@@ -158,9 +175,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
         case PIXFORMAT_RGB565: {
             if (out->pixfmt == PIXFORMAT_BINARY) {
                 if (!zero) {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
@@ -170,9 +187,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                         }
                     }
                 } else {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = COLOR_RGB565_TO_BINARY(IMAGE_GET_RGB565_PIXEL_FAST(old_row_ptr, x));
@@ -186,9 +203,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                 }
             } else {
                 if (!zero) {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint16_t *out_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
@@ -198,9 +215,9 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
                         }
                     }
                 } else {
-                    for (int y = 0, yy = img->h; y < yy; y++) {
+                    for (int y = y_start; y < y_end; y++) {
                         uint16_t *old_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&bmp, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
                         uint16_t *out_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(out, y);
                         for (int x = 0, xx = img->w; x < xx; x++) {
                             int pixel = IMAGE_GET_RGB565_PIXEL_FAST(old_row_ptr, x);
@@ -215,46 +232,136 @@ void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, b
             }
             break;
         }
+        case PIXFORMAT_RGB888: {
+            if (out->pixfmt == PIXFORMAT_BINARY) {
+                if (!zero) {
+                    for (int y = y_start; y < y_end; y++) {
+                        uint8_t *old_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
+                        uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
+                        for (int x = 0, xx = img->w; x < xx; x++) {
+                            int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
+                                ? IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x)
+                                : COLOR_RGB888_TO_BINARY(IMAGE_GET_RGB888_PIXEL_FAST(old_row_ptr, x));
+                            IMAGE_PUT_BINARY_PIXEL_FAST(out_row_ptr, x, pixel);
+                        }
+                    }
+                } else {
+                    for (int y = y_start; y < y_end; y++) {
+                        uint8_t *old_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
+                        uint32_t *out_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(out, y);
+                        for (int x = 0, xx = img->w; x < xx; x++) {
+                            int pixel = COLOR_RGB888_TO_BINARY(IMAGE_GET_RGB888_PIXEL_FAST(old_row_ptr, x));
+                            if (((!mask) || image_get_mask_pixel(mask, x, y))
+                                && IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x)) {
+                                pixel = 0;
+                            }
+                            IMAGE_PUT_BINARY_PIXEL_FAST(out_row_ptr, x, pixel);
+                        }
+                    }
+                }
+            } else {
+                if (!zero) {
+                    for (int y = y_start; y < y_end; y++) {
+                        uint8_t *old_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
+                        uint8_t *out_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(out, y);
+                        for (int x = 0, xx = img->w; x < xx; x++) {
+                            int pixel = ((!mask) || image_get_mask_pixel(mask, x, y))
+                                ? COLOR_BINARY_TO_RGB888(IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x))
+                                : IMAGE_GET_RGB888_PIXEL_FAST(old_row_ptr, x);
+                            IMAGE_PUT_RGB888_PIXEL_FAST(out_row_ptr, x, pixel);
+                        }
+                    }
+                } else {
+                    for (int y = y_start; y < y_end; y++) {
+                        uint8_t *old_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+                        uint32_t *bmp_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(bmp, y);
+                        uint8_t *out_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(out, y);
+                        for (int x = 0, xx = img->w; x < xx; x++) {
+                            int pixel = IMAGE_GET_RGB888_PIXEL_FAST(old_row_ptr, x);
+                            if (((!mask) || image_get_mask_pixel(mask, x, y))
+                                && IMAGE_GET_BINARY_PIXEL_FAST(bmp_row_ptr, x)) {
+                                pixel = 0;
+                            }
+                            IMAGE_PUT_RGB888_PIXEL_FAST(out_row_ptr, x, pixel);
+                        }
+                    }
+                }
+            }
+            break;
+        }
         default: {
             break;
         }
     }
 
+}
+
+void imlib_binary(image_t *out, image_t *img, list_t *thresholds, bool invert, bool zero, image_t *mask) {
+    image_t bmp = {};
+    bmp.w = img->w;
+    bmp.h = img->h;
+    bmp.pixfmt = PIXFORMAT_BINARY;
+    bmp.data = fb_alloc0(image_size(&bmp), FB_ALLOC_NO_HINT);
+
+    imlib_binary_band_t state = {
+        .out = out,
+        .img = img,
+        .bmp = &bmp,
+        .mask = mask,
+        .thresholds = thresholds,
+        .invert = invert,
+        .zero = zero
+    };
+
+    // Converting in place to a smaller format writes rows owned by other bands.
+    int bands = ((out->data == img->data) && (out->pixfmt != img->pixfmt)) ? 1 : imlib_parallel_bands(img->h, 8);
+    imlib_parallel_for(img->h, bands, imlib_binary_band, &state);
     fb_free();
 }
 
-void imlib_invert(image_t *img) {
-    switch (img->pixfmt) {
-        case PIXFORMAT_BINARY: {
-            for (uint32_t *start = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, 0),
-                 *end = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, img->h);
-                 start < end; start++) {
-                *start = ~*start;
+static void imlib_invert_band(void *arg, int band, int y_start, int y_end) {
+    image_t *img = (image_t *) arg;
+
+    for (int y = y_start; y < y_end; y++) {
+        switch (img->pixfmt) {
+            case PIXFORMAT_BINARY: {
+                for (uint32_t *start = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y),
+                     *end = start + IMAGE_BINARY_LINE_LEN(img);
+                     start < end; start++) {
+                    *start = ~*start;
+                }
+                break;
             }
-            break;
-        }
-        case PIXFORMAT_GRAYSCALE: {
-            for (uint8_t *start = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, 0),
-                 *end = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, img->h);
-                 start < end; start++) {
-                *start = ~*start;
+            case PIXFORMAT_GRAYSCALE: {
+                for (uint8_t *start = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y),
+                     *end = start + img->w;
+                     start < end; start++) {
+                    *start = ~*start;
+                }
+                break;
             }
-            break;
-        }
-        case PIXFORMAT_RGB565: {
-            for (uint16_t *start = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, 0),
-                 *end = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, img->h);
-                 start < end; start++) {
-                *start = ~*start;
+            case PIXFORMAT_RGB565: {
+                for (uint16_t *start = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y),
+                     *end = start + img->w;
+                     start < end; start++) {
+                    *start = ~*start;
+                }
+                break;
+            }
+            default: {
+                return;
             }
-            break;
-        }
-        default: {
-            break;
         }
     }
 }
 
+void imlib_invert(image_t *img) {
+    imlib_parallel_for(img->h, imlib_parallel_bands(img->h, 8), imlib_invert_band, img);
+}
+
 static void imlib_b_and_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
     image_t *mask = (image_t *) data;
 
@@ -320,7 +427,7 @@ static void imlib_b_and_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_b_and(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_and_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_and_line_op, mask);
 }
 
 static void imlib_b_nand_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -388,7 +495,7 @@ static void imlib_b_nand_line_op(image_t *img, int line, void *other, void *data
 }
 
 void imlib_b_nand(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_nand_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_nand_line_op, mask);
 }
 
 static void imlib_b_or_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -456,7 +563,7 @@ static void imlib_b_or_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_b_or(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_or_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_or_line_op, mask);
 }
 
 static void imlib_b_nor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -524,7 +631,7 @@ static void imlib_b_nor_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_b_nor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_nor_line_op,  mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_nor_line_op,  mask);
 }
 
 static void imlib_b_xor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -592,7 +699,7 @@ static void imlib_b_xor_line_op(image_t *img, int line, void *other, void *data,
 }
 
 void imlib_b_xor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_xor_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_xor_line_op, mask);
 }
 
 static void imlib_b_xnor_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -660,12 +767,12 @@ static void imlib_b_xnor_line_op(image_t *img, int line, void *other, void *data
 }
 
 void imlib_b_xnor(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_b_xnor_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_b_xnor_line_op, mask);
 }
 
 static void imlib_erode_dilate(image_t *img, int ksize, int threshold, int e_or_d, image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -916,24 +1023,24 @@ void imlib_close(image_t *img, int ksize, int threshold, image_t *mask) {
 }
 
 void imlib_top_hat(image_t *img, int ksize, int threshold, image_t *mask) {
-    image_t temp;
+    image_t temp = {};
     temp.w = img->w;
     temp.h = img->h;
     temp.pixfmt = img->pixfmt;
     temp.data = fb_alloc(image_size(img), FB_ALLOC_NO_HINT);
-    memcpy(temp.data, img->data, image_size(img));
+    image_copy_pixels(temp.data, img);
     imlib_open(&temp, ksize, threshold, mask);
     imlib_difference(img, NULL, &temp, 0, mask);
     fb_free();
 }
 
 void imlib_black_hat(image_t *img, int ksize, int threshold, image_t *mask) {
-    image_t temp;
+    image_t temp = {};
     temp.w = img->w;
     temp.h = img->h;
     temp.pixfmt = img->pixfmt;
     temp.data = fb_alloc(image_size(img), FB_ALLOC_NO_HINT);
-    memcpy(temp.data, img->data, image_size(img));
+    image_copy_pixels(temp.data, img);
     imlib_close(&temp, ksize, threshold, mask);
     imlib_difference(img, NULL, &temp, 0, mask);
     fb_free();
@@ -273,6 +273,7 @@ void bmp_read(image_t *img, const char *path) {
 }
 
 void bmp_write_subimg(image_t *img, const char *path, rectangle_t *r) {
+    image_assert_packed(img);
     rectangle_t rect;
     if (!rectangle_subimg(img, r, &rect)) {
         mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("No intersection!"));
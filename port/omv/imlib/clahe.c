@@ -361,7 +361,7 @@ void imlib_clahe_histeq(image_t *img, float clip_limit, image_t *mask) {
     int xOffset = (pImageW - img->w) / 2;
     int yOffset = (pImageH - img->h) / 2;
 
-    image_t temp;
+    image_t temp = {};
     temp.w = img->w;
     temp.h = img->h;
     temp.pixfmt = img->pixfmt;
@@ -28,6 +28,16 @@ void *imlib_compute_row_ptr(const image_t *img, int y) {
         case PIXFORMAT_RGB565: {
             return IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
         }
+        case PIXFORMAT_RGB888:
+        case PIXFORMAT_BGR888: {
+            return IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+        }
+        case PIXFORMAT_ARGB8888:
+        case PIXFORMAT_ABGR8888:
+        case PIXFORMAT_RGBA8888:
+        case PIXFORMAT_BGRA8888: {
+            return IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y);
+        }
         default: {
             // This shouldn't happen, at least we return a valid memory block
             return img->data;
@@ -525,7 +535,7 @@ void imlib_draw_string(image_t *img,
 }
 
 void imlib_draw_row_setup(imlib_draw_row_data_t *data) {
-    image_t temp;
+    image_t temp = {};
     temp.w = data->dst_img->w;
     temp.h = data->dst_img->h;
     temp.pixfmt = data->src_img_pixfmt;
@@ -1771,10 +1781,7 @@ void imlib_draw_row(int x_start, int x_end, int y_row, imlib_draw_row_data_t *da
                             }
                         } else if (data->alpha == 256) {
                             if (!data->color_palette) {
-                                for (int x = x_start; x < x_end; x++) {
-                                    int pixel = *src16++;
-                                    *dst8++ = COLOR_RGB565_TO_Y(pixel);
-                                }
+                                imlib_rgb565_to_y_row(src16, dst8, x_end - x_start);
                             } else {
                                 const uint16_t *color_palette = data->color_palette;
                                 for (int x = x_start; x < x_end; x++) {
@@ -2727,6 +2734,507 @@ void imlib_draw_row(int x_start, int x_end, int y_row, imlib_draw_row_data_t *da
     #undef BLEND_RGB566
 }
 
+// 24-bit and 32-bit images are drawn by the routines below instead of imlib_draw_row() so that
+// they can be scaled and converted without going through RGB565. Pixels are unpacked into
+// 0xAARRGGBB words, scaled there and then packed into the destination format.
+typedef struct draw_wide_state {
+    image_t *dst_img;
+    image_t *src_img;
+    int dst_x_start, dst_x_end, dst_x_reset, dst_delta_x;
+    int dst_y_start, dst_y_end, dst_y_reset, dst_delta_y;
+    long src_x_frac, src_x_accum_reset;
+    long src_y_frac, src_y_accum_reset;
+    int w_start, w_limit;
+    int h_start, h_limit;
+    int alpha;
+    bool black_background;
+    uint32_t *lines[4];
+    int line_y[4];
+    uint32_t *dst_line;
+    uint32_t *blend_line;
+} draw_wide_state_t;
+
+static bool draw_wide_pixfmt_is_wide(pixformat_t pixfmt) {
+    switch (pixfmt) {
+        case PIXFORMAT_RGB888:
+        case PIXFORMAT_BGR888:
+        case PIXFORMAT_ARGB8888:
+        case PIXFORMAT_ABGR8888:
+        case PIXFORMAT_RGBA8888:
+        case PIXFORMAT_BGRA8888: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+static bool draw_wide_pixfmt_supported(pixformat_t pixfmt) {
+    return (pixfmt == PIXFORMAT_GRAYSCALE) || (pixfmt == PIXFORMAT_RGB565) || draw_wide_pixfmt_is_wide(pixfmt);
+}
+
+// Blends two 0xAARRGGBB words with a 0-256 weight on b, two channels at a time.
+static inline uint32_t draw_wide_lerp(uint32_t a, uint32_t b, uint32_t f) {
+    uint32_t nf = 256 - f;
+    uint32_t rb = ((((a & 0x00FF00FF) * nf) + ((b & 0x00FF00FF) * f) + 0x00800080) >> 8) & 0x00FF00FF;
+    uint32_t ag = ((((a >> 8) & 0x00FF00FF) * nf) + (((b >> 8) & 0x00FF00FF) * f) + 0x00800080) & 0xFF00FF00;
+    return rb | ag;
+}
+
+// Catmull-Rom interpolation with 15-bit fractions (same math as RGB565), not clamped.
+static inline int draw_wide_cubic(int d0, int d1, int d2, int d3, int dx, int dx2, int dx3) {
+    int a0 = d2 - d0;
+    int a1 = (d0 << 1) + (d2 << 2) - (5 * d1) - d3;
+    int a2 = (3 * (d1 - d2)) + d3 - d0;
+    return (((d1 << 16) | 0x8000) + (dx * a0) + (dx2 * a1) + (dx3 * a2)) >> 16;
+}
+
+// Unpacks n pixels of row y into 0xAARRGGBB words. Pixels are read from x0 onwards or from x_map.
+static void draw_wide_unpack(uint32_t *out, image_t *img, int y, int x0, int n, const int *x_map) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                int x = x_map ? x_map[i] : (x0 + i);
+                out[i] = 0xFF000000 | COLOR_Y_TO_RGB888(row_ptr[x]);
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                int x = x_map ? x_map[i] : (x0 + i);
+                int pixel = row_ptr[x];
+                out[i] = 0xFF000000 | (COLOR_RGB565_TO_R8(pixel) << 16) |
+                         (COLOR_RGB565_TO_G8(pixel) << 8) | COLOR_RGB565_TO_B8(pixel);
+            }
+            break;
+        }
+        case PIXFORMAT_RGB888: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                uint8_t *p = row_ptr + ((x_map ? x_map[i] : (x0 + i)) * 3);
+                out[i] = 0xFF000000 | (p[0] << 16) | (p[1] << 8) | p[2];
+            }
+            break;
+        }
+        case PIXFORMAT_BGR888: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                uint8_t *p = row_ptr + ((x_map ? x_map[i] : (x0 + i)) * 3);
+                out[i] = 0xFF000000 | (p[2] << 16) | (p[1] << 8) | p[0];
+            }
+            break;
+        }
+        case PIXFORMAT_ARGB8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                out[i] = row_ptr[x_map ? x_map[i] : (x0 + i)];
+            }
+            break;
+        }
+        case PIXFORMAT_ABGR8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                uint32_t pixel = row_ptr[x_map ? x_map[i] : (x0 + i)];
+                out[i] = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+            }
+            break;
+        }
+        case PIXFORMAT_RGBA8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                uint32_t pixel = row_ptr[x_map ? x_map[i] : (x0 + i)];
+                out[i] = (pixel >> 8) | (pixel << 24);
+            }
+            break;
+        }
+        case PIXFORMAT_BGRA8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y);
+            for (int i = 0; i < n; i++) {
+                out[i] = __builtin_bswap32(row_ptr[x_map ? x_map[i] : (x0 + i)]);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Packs n 0xAARRGGBB words into row y of img starting at x0.
+static void draw_wide_pack(image_t *img, int y, int x0, int n, const uint32_t *in) {
+    switch (img->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            imlib_argb8888_to_y_row(in, IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y) + x0, n);
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y) + x0;
+            for (int i = 0; i < n; i++) {
+                uint32_t pixel = in[i];
+                row_ptr[i] = COLOR_R8_G8_B8_TO_RGB565((pixel >> 16) & 0xFF, (pixel >> 8) & 0xFF, pixel & 0xFF);
+            }
+            break;
+        }
+        case PIXFORMAT_RGB888: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y) + (x0 * 3);
+            for (int i = 0; i < n; i++, row_ptr += 3) {
+                uint32_t pixel = in[i];
+                row_ptr[0] = pixel >> 16;
+                row_ptr[1] = pixel >> 8;
+                row_ptr[2] = pixel;
+            }
+            break;
+        }
+        case PIXFORMAT_BGR888: {
+            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(img, y) + (x0 * 3);
+            for (int i = 0; i < n; i++, row_ptr += 3) {
+                uint32_t pixel = in[i];
+                row_ptr[0] = pixel;
+                row_ptr[1] = pixel >> 8;
+                row_ptr[2] = pixel >> 16;
+            }
+            break;
+        }
+        case PIXFORMAT_ARGB8888: {
+            memcpy(IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y) + x0, in, n * sizeof(uint32_t));
+            break;
+        }
+        case PIXFORMAT_ABGR8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y) + x0;
+            for (int i = 0; i < n; i++) {
+                uint32_t pixel = in[i];
+                row_ptr[i] = (pixel & 0xFF00FF00) | ((pixel >> 16) & 0xFF) | ((pixel & 0xFF) << 16);
+            }
+            break;
+        }
+        case PIXFORMAT_RGBA8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y) + x0;
+            for (int i = 0; i < n; i++) {
+                uint32_t pixel = in[i];
+                row_ptr[i] = (pixel << 8) | (pixel >> 24);
+            }
+            break;
+        }
+        case PIXFORMAT_BGRA8888: {
+            uint32_t *row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(img, y) + x0;
+            for (int i = 0; i < n; i++) {
+                row_ptr[i] = __builtin_bswap32(in[i]);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+// Returns source row y (clamped to the roi) unpacked, caching the last four rows.
+static uint32_t *draw_wide_get_line(draw_wide_state_t *s, int y) {
+    y = IM_MAX(IM_MIN(y, s->h_limit), s->h_start);
+    int slot = y & 3;
+    if (s->line_y[slot] != y) {
+        draw_wide_unpack(s->lines[slot], s->src_img, y, s->w_start, s->w_limit - s->w_start + 1, NULL);
+        s->line_y[slot] = y;
+    }
+    return s->lines[slot];
+}
+
+// Writes dst_line to the destination row, blending with alpha if needed.
+static void draw_wide_put_line(draw_wide_state_t *s, int dst_y) {
+    int n = s->dst_x_end - s->dst_x_start;
+    uint32_t *line = s->dst_line;
+
+    if (s->alpha != 256) {
+        if (s->black_background) {
+            memset(s->blend_line, 0, n * sizeof(uint32_t));
+        } else {
+            draw_wide_unpack(s->blend_line, s->dst_img, dst_y, s->dst_x_start, n, NULL);
+        }
+        for (int i = 0; i < n; i++) {
+            line[i] = draw_wide_lerp(s->blend_line[i], line[i], s->alpha);
+        }
+    }
+
+    draw_wide_pack(s->dst_img, dst_y, s->dst_x_start, n, line);
+}
+
+// Fills x_map with the source column of each destination column, clamped to the roi.
+static void draw_wide_x_map(draw_wide_state_t *s, int *x_map, int *x_frac, int frac_shift, int frac_mask) {
+    int dst_x = s->dst_x_reset;
+    long src_x_accum = s->src_x_accum_reset;
+    for (int x = s->dst_x_start; x < s->dst_x_end; x++) {
+        int i = dst_x - s->dst_x_start;
+        x_map[i] = src_x_accum >> 16;
+        if (x_frac) {
+            x_frac[i] = (src_x_accum >> frac_shift) & frac_mask;
+        }
+        dst_x += s->dst_delta_x;
+        src_x_accum += s->src_x_frac;
+    }
+}
+
+static void draw_wide_nearest(draw_wide_state_t *s) {
+    image_t *src_img = s->src_img, *dst_img = s->dst_img;
+    int n = s->dst_x_end - s->dst_x_start;
+    bool copy = (src_img->pixfmt == dst_img->pixfmt) && (s->alpha == 256);
+    int *x_map = fb_alloc(n * sizeof(int), FB_ALLOC_NO_HINT);
+
+    draw_wide_x_map(s, x_map, NULL, 0, 0);
+    for (int i = 0; i < n; i++) {
+        x_map[i] = IM_MAX(IM_MIN(x_map[i], s->w_limit), s->w_start);
+    }
+
+    // A plain copy needs no column map at all.
+    bool contiguous = (s->src_x_frac == 65536) && (s->dst_delta_x == 1);
+
+    int dst_y = s->dst_y_reset;
+    long src_y_accum = s->src_y_accum_reset;
+    for (int y = s->dst_y_start; y < s->dst_y_end; y++) {
+        int src_y = IM_MAX(IM_MIN(src_y_accum >> 16, s->h_limit), s->h_start);
+
+        if (copy && contiguous) {
+            size_t bpp = src_img->bpp;
+            memcpy(((uint8_t *) imlib_compute_row_ptr(dst_img, dst_y)) + (s->dst_x_start * bpp),
+                   ((uint8_t *) imlib_compute_row_ptr(src_img, src_y)) + (x_map[0] * bpp), n * bpp);
+        } else if (copy && (src_img->bpp == 3)) {
+            uint8_t *src_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(src_img, src_y);
+            uint8_t *dst_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(dst_img, dst_y) + (s->dst_x_start * 3);
+            for (int i = 0; i < n; i++, dst_row_ptr += 3) {
+                uint8_t *p = src_row_ptr + (x_map[i] * 3);
+                dst_row_ptr[0] = p[0];
+                dst_row_ptr[1] = p[1];
+                dst_row_ptr[2] = p[2];
+            }
+        } else if (copy && (src_img->bpp == 4)) {
+            uint32_t *src_row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(src_img, src_y);
+            uint32_t *dst_row_ptr = IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(dst_img, dst_y) + s->dst_x_start;
+            for (int i = 0; i < n; i++) {
+                dst_row_ptr[i] = src_row_ptr[x_map[i]];
+            }
+        } else {
+            draw_wide_unpack(s->dst_line, src_img, src_y, 0, n, x_map);
+            draw_wide_put_line(s, dst_y);
+        }
+
+        dst_y += s->dst_delta_y;
+        src_y_accum += s->src_y_frac;
+    }
+
+    fb_free(); // x_map
+}
+
+static void draw_wide_bilinear(draw_wide_state_t *s) {
+    int n = s->dst_x_end - s->dst_x_start;
+    int *x_map = fb_alloc(n * sizeof(int), FB_ALLOC_NO_HINT);
+    int *x_frac = fb_alloc(n * sizeof(int), FB_ALLOC_NO_HINT);
+
+    draw_wide_x_map(s, x_map, x_frac, 8, 0xFF);
+
+    int dst_y = s->dst_y_reset;
+    long src_y_accum = s->src_y_accum_reset;
+    for (int y = s->dst_y_start; y < s->dst_y_end; y++) {
+        int src_y = src_y_accum >> 16;
+        int y_frac = (src_y_accum >> 8) & 0xFF;
+        uint32_t *line_0 = draw_wide_get_line(s, src_y);
+        uint32_t *line_1 = draw_wide_get_line(s, src_y + 1);
+
+        for (int i = 0; i < n; i++) {
+            int x_0 = IM_MAX(IM_MIN(x_map[i], s->w_limit), s->w_start) - s->w_start;
+            int x_1 = IM_MAX(IM_MIN(x_map[i] + 1, s->w_limit), s->w_start) - s->w_start;
+            uint32_t top = draw_wide_lerp(line_0[x_0], line_0[x_1], x_frac[i]);
+            uint32_t bottom = draw_wide_lerp(line_1[x_0], line_1[x_1], x_frac[i]);
+            s->dst_line[i] = draw_wide_lerp(top, bottom, y_frac);
+        }
+
+        draw_wide_put_line(s, dst_y);
+
+        dst_y += s->dst_delta_y;
+        src_y_accum += s->src_y_frac;
+    }
+
+    fb_free(); // x_frac
+    fb_free(); // x_map
+}
+
+static void draw_wide_bicubic(draw_wide_state_t *s) {
+    int n = s->dst_x_end - s->dst_x_start;
+    int src_w = s->w_limit - s->w_start + 1;
+    int *x_map = fb_alloc(n * sizeof(int), FB_ALLOC_NO_HINT);
+    int *x_frac = fb_alloc(n * sizeof(int), FB_ALLOC_NO_HINT);
+    int16_t *column = fb_alloc(src_w * 4 * sizeof(int16_t), FB_ALLOC_NO_HINT);
+
+    draw_wide_x_map(s, x_map, x_frac, 1, 0x7FFF);
+
+    int dst_y = s->dst_y_reset;
+    long src_y_accum = s->src_y_accum_reset;
+    for (int y = s->dst_y_start; y < s->dst_y_end; y++) {
+        int src_y = src_y_accum >> 16;
+        int dy = (src_y_accum >> 1) & 0x7FFF;
+        int dy2 = (dy * dy) >> 15;
+        int dy3 = (dy2 * dy) >> 15;
+        uint32_t *line_0 = draw_wide_get_line(s, src_y - 1);
+        uint32_t *line_1 = draw_wide_get_line(s, src_y);
+        uint32_t *line_2 = draw_wide_get_line(s, src_y + 1);
+        uint32_t *line_3 = draw_wide_get_line(s, src_y + 2);
+
+        // Vertical pass over the whole roi width, kept unclamped like the RGB565 path.
+        for (int x = 0; x < src_w; x++) {
+            for (int c = 0; c < 4; c++) {
+                int shift = c * 8;
+                column[(x * 4) + c] = draw_wide_cubic((line_0[x] >> shift) & 0xFF, (line_1[x] >> shift) & 0xFF,
+                                                      (line_2[x] >> shift) & 0xFF, (line_3[x] >> shift) & 0xFF,
+                                                      dy, dy2, dy3);
+            }
+        }
+
+        for (int i = 0; i < n; i++) {
+            int x = x_map[i] - s->w_start;
+            int16_t *c_0 = column + (IM_MAX(IM_MIN(x - 1, src_w - 1), 0) * 4);
+            int16_t *c_1 = column + (IM_MAX(IM_MIN(x, src_w - 1), 0) * 4);
+            int16_t *c_2 = column + (IM_MAX(IM_MIN(x + 1, src_w - 1), 0) * 4);
+            int16_t *c_3 = column + (IM_MAX(IM_MIN(x + 2, src_w - 1), 0) * 4);
+            int dx = x_frac[i];
+            int dx2 = (dx * dx) >> 15;
+            int dx3 = (dx2 * dx) >> 15;
+            uint32_t pixel = 0;
+            for (int c = 0; c < 4; c++) {
+                pixel |= __USAT(draw_wide_cubic(c_0[c], c_1[c], c_2[c], c_3[c], dx, dx2, dx3), 8) << (c * 8);
+            }
+            s->dst_line[i] = pixel;
+        }
+
+        draw_wide_put_line(s, dst_y);
+
+        dst_y += s->dst_delta_y;
+        src_y_accum += s->src_y_frac;
+    }
+
+    fb_free(); // column
+    fb_free(); // x_frac
+    fb_free(); // x_map
+}
+
+// Area scaling weights every source pixel by how much of it (in 1/256ths) the destination covers.
+static void draw_wide_area(draw_wide_state_t *s) {
+    int n = s->dst_x_end - s->dst_x_start;
+    int src_w = s->w_limit - s->w_start + 1;
+    long *x_accum = fb_alloc(n * sizeof(long), FB_ALLOC_NO_HINT);
+    uint32_t *acc = fb_alloc(src_w * 4 * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+
+    {
+        int dst_x = s->dst_x_reset;
+        long src_x_accum = s->src_x_accum_reset;
+        for (int x = s->dst_x_start; x < s->dst_x_end; x++) {
+            x_accum[dst_x - s->dst_x_start] = src_x_accum;
+            dst_x += s->dst_delta_x;
+            src_x_accum += s->src_x_frac;
+        }
+    }
+
+    int dst_y = s->dst_y_reset;
+    long src_y_accum = s->src_y_accum_reset;
+    for (int y = s->dst_y_start; y < s->dst_y_end; y++) {
+        long y_start = src_y_accum, y_end = src_y_accum + s->src_y_frac;
+        uint32_t y_weight = 0;
+
+        memset(acc, 0, src_w * 4 * sizeof(uint32_t));
+
+        for (int i = y_start >> 16; (i <= s->h_limit) && (((long) i << 16) < y_end); i++) {
+            uint32_t w = (IM_MIN(y_end, ((long) i + 1) << 16) - IM_MAX(y_start, (long) i << 16)) >> 8;
+            if ((!w) && y_weight) {
+                continue;
+            }
+            w = IM_MAX(w, 1u);
+            uint32_t *line = draw_wide_get_line(s, i);
+            for (int x = 0; x < src_w; x++) {
+                uint32_t pixel = line[x];
+                acc[(x * 4) + 0] += ((pixel >> 24) & 0xFF) * w;
+                acc[(x * 4) + 1] += ((pixel >> 16) & 0xFF) * w;
+                acc[(x * 4) + 2] += ((pixel >> 8) & 0xFF) * w;
+                acc[(x * 4) + 3] += (pixel & 0xFF) * w;
+            }
+            y_weight += w;
+        }
+
+        for (int i = 0; i < n; i++) {
+            long x_start = x_accum[i], x_end = x_start + s->src_x_frac;
+            uint64_t sum[4] = {0, 0, 0, 0};
+            uint64_t weight = 0;
+
+            for (int x = x_start >> 16; (x <= s->w_limit) && (((long) x << 16) < x_end); x++) {
+                uint32_t w = (IM_MIN(x_end, ((long) x + 1) << 16) - IM_MAX(x_start, (long) x << 16)) >> 8;
+                if ((!w) && weight) {
+                    continue;
+                }
+                w = IM_MAX(w, 1u);
+                uint32_t *a = acc + ((IM_MAX(x, s->w_start) - s->w_start) * 4);
+                sum[0] += (uint64_t) a[0] * w;
+                sum[1] += (uint64_t) a[1] * w;
+                sum[2] += (uint64_t) a[2] * w;
+                sum[3] += (uint64_t) a[3] * w;
+                weight += w;
+            }
+
+            weight *= y_weight;
+            uint64_t half = weight >> 1;
+            s->dst_line[i] = ((uint32_t) ((sum[0] + half) / weight) << 24) |
+                             ((uint32_t) ((sum[1] + half) / weight) << 16) |
+                             ((uint32_t) ((sum[2] + half) / weight) << 8) |
+                             ((uint32_t) ((sum[3] + half) / weight));
+        }
+
+        draw_wide_put_line(s, dst_y);
+
+        dst_y += s->dst_delta_y;
+        src_y_accum += s->src_y_frac;
+    }
+
+    fb_free(); // acc
+    fb_free(); // x_accum
+}
+
+static void imlib_draw_image_wide(draw_wide_state_t *s, image_hint_t hint) {
+    image_t new_src_img = {};
+    int src_w = s->w_limit - s->w_start + 1;
+    int n = s->dst_x_end - s->dst_x_start;
+
+    // The source is read while the destination is written so overlapping images need a copy.
+    if (image_overlaps(s->dst_img, s->src_img)) {
+        new_src_img = *s->src_img;
+        new_src_img.stride = 0;
+        new_src_img.data = fb_alloc(image_size(s->src_img), FB_ALLOC_NO_HINT);
+        image_copy_pixels(new_src_img.data, s->src_img);
+        s->src_img = &new_src_img;
+    }
+
+    // One buffer holds the four cached source rows, the output row and the blend row.
+    uint32_t *buffer = fb_alloc(((src_w * 4) + (n * 2)) * sizeof(uint32_t), FB_ALLOC_NO_HINT);
+    for (int i = 0; i < 4; i++) {
+        s->lines[i] = buffer + (i * src_w);
+        s->line_y[i] = -1;
+    }
+    s->dst_line = buffer + (src_w * 4);
+    s->blend_line = s->dst_line + n;
+
+    if (hint & IMAGE_HINT_AREA) {
+        draw_wide_area(s);
+    } else if (hint & IMAGE_HINT_BICUBIC) {
+        draw_wide_bicubic(s);
+    } else if (hint & IMAGE_HINT_BILINEAR) {
+        draw_wide_bilinear(s);
+    } else {
+        draw_wide_nearest(s);
+    }
+
+    fb_free(); // buffer
+    if (s->src_img == &new_src_img) {
+        fb_free();
+    }
+}
+
 // False == Image is black, True == rect valid
 bool imlib_draw_image_rectangle(image_t *dst_img,
                                 image_t *src_img,
@@ -3001,8 +3509,37 @@ void imlib_draw_image(image_t *dst_img,
         src_y_accum_reset -= 0x8000;
     }
 
+    if ((draw_wide_pixfmt_is_wide(src_img->pixfmt) || draw_wide_pixfmt_is_wide(dst_img->pixfmt))
+        && draw_wide_pixfmt_supported(src_img->pixfmt) && draw_wide_pixfmt_supported(dst_img->pixfmt)
+        && (rgb_channel == -1) && (!color_palette) && (!alpha_palette) && (!callback) && (!dst_row_override)) {
+        draw_wide_state_t draw_wide_state = {
+            .dst_img = dst_img,
+            .src_img = src_img,
+            .dst_x_start = dst_x_start,
+            .dst_x_end = dst_x_end,
+            .dst_x_reset = dst_x_reset,
+            .dst_delta_x = dst_delta_x,
+            .dst_y_start = dst_y_start,
+            .dst_y_end = dst_y_end,
+            .dst_y_reset = dst_y_reset,
+            .dst_delta_y = dst_delta_y,
+            .src_x_frac = src_x_frac,
+            .src_x_accum_reset = src_x_accum_reset,
+            .src_y_frac = src_y_frac,
+            .src_y_accum_reset = src_y_accum_reset,
+            .w_start = w_start,
+            .w_limit = w_limit,
+            .h_start = h_start,
+            .h_limit = h_limit,
+            .alpha = alpha,
+            .black_background = hint & IMAGE_HINT_BLACK_BACKGROUND,
+        };
+        imlib_draw_image_wide(&draw_wide_state, hint);
+        return;
+    }
+
     // rgb_channel extracted / color_palette applied image
-    image_t new_src_img;
+    image_t new_src_img = {};
 
     if (((hint & IMAGE_HINT_EXTRACT_RGB_CHANNEL_FIRST) && (rgb_channel != -1) && src_img->is_color)
         || ((hint & IMAGE_HINT_APPLY_COLOR_PALETTE_FIRST) && color_palette)) {
@@ -3042,8 +3579,10 @@ void imlib_draw_image(image_t *dst_img,
     bool is_color_conversion = is_bayer_color_conversion || is_yuv_color_conversion;
 
     // Force a deep copy if we cannot use the image in-place.
-    bool need_deep_copy = (dst_img->data == src_img->data)
-                          && (is_scaling || (src_img_row_bytes < dst_img_row_bytes) || is_color_conversion);
+    // Views may alias their parent at a different offset or pitch, which is never safe in-place.
+    bool need_deep_copy = image_overlaps(dst_img, src_img)
+                          && ((dst_img->data != src_img->data) || (dst_img->stride != src_img->stride)
+                              || is_scaling || (src_img_row_bytes < dst_img_row_bytes) || is_color_conversion);
 
     // Force a deep copy if we are scaling.
     bool is_color_conversion_scaling = is_color_conversion && is_scaling;
@@ -3111,7 +3650,7 @@ void imlib_draw_image(image_t *dst_img,
             new_src_img.pixfmt = src_img->pixfmt;
             size_t size = image_size(&new_src_img);
             new_src_img.data = fb_alloc(size, FB_ALLOC_NO_HINT);
-            memcpy(new_src_img.data, src_img->data, size);
+            image_copy_pixels(new_src_img.data, src_img);
         }
 
         src_img = &new_src_img;
@@ -5406,7 +5945,7 @@ void imlib_flood_fill(image_t *img, int x, int y,
                       float seed_threshold, float floating_threshold,
                       int c, bool invert, bool clear_background, image_t *mask) {
     if ((0 <= x) && (x < img->w) && (0 <= y) && (y < img->h)) {
-        image_t out;
+        image_t out = {};
         out.w = img->w;
         out.h = img->h;
         out.pixfmt = PIXFORMAT_BINARY;
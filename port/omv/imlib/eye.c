@@ -111,6 +111,7 @@ static void find_iris(image_t *src, array_t *gradients, int x_off, int y_off, in
 
 // This function should be called on an ROI detected with the eye Haar cascade.
 void imlib_find_iris(image_t *src, point_t *iris, rectangle_t *roi) {
+    image_assert_packed(src);
     array_t *iris_gradients;
     array_alloc(&iris_gradients, xfree);
 
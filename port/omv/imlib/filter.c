@@ -136,23 +136,28 @@ void imlib_histeq(image_t *img, image_t *mask) {
 //   much change in performance.
 //
 #ifdef IMLIB_ENABLE_MEAN
-void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert, image_t *mask) {
-    int brows = ksize + 1;
-    image_t buf;
-    buf.w = img->w;
-    buf.h = brows;
-    buf.pixfmt = img->pixfmt;
+typedef struct imlib_mean_filter_band {
+    image_t *img, *buf, *mask;
+    int ksize, offset;
+    bool threshold, invert, writeback;
+} imlib_mean_filter_band_t;
+
+static void imlib_mean_filter_band(void *arg, int band, int y_start, int y_end) {
+    imlib_mean_filter_band_t *state = (imlib_mean_filter_band_t *) arg;
+    image_t *img = state->img, *buf = state->buf, *mask = state->mask;
+    const int ksize = state->ksize;
+    int offset = state->offset;
+    bool threshold = state->threshold, invert = state->invert, writeback = state->writeback;
+    int brows = buf->h;
 
     int32_t over32_n = 65536 / (((ksize * 2) + 1) * ((ksize * 2) + 1));
 
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
-            buf.data = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 int pixel, acc = 0;
                 uint32_t *row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                uint32_t *buf_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&buf, (y % brows));
+                uint32_t *buf_row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(buf, (y % brows));
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
@@ -193,31 +198,21 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_BINARY_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
-                if (y >= ksize) {
+                if (writeback && (y >= ksize)) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, (y - ksize)),
-                           IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&buf, ((y - ksize) % brows)),
+                           IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(buf, ((y - ksize) % brows)),
                            IMAGE_BINARY_LINE_LEN_BYTES(img));
                 }
             }
 
-            // Copy any remaining lines from the buffer image...
-            for (int y = IM_MAX(img->h - ksize, 0), yy = img->h; y < yy; y++) {
-                memcpy(IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y),
-                       IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(&buf, (y % brows)),
-                       IMAGE_BINARY_LINE_LEN_BYTES(img));
-            }
-
-            fb_free();
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
-            buf.data = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 int pixel, acc = 0;
                 uint8_t *row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
-                uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % brows));
+                uint8_t *buf_row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(buf, (y % brows));
 
                 for (int x = 0, xx = img->w; x < xx; x++) {
                     if (mask && (!image_get_mask_pixel(mask, x, y))) {
@@ -256,31 +251,21 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_GRAYSCALE_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
-                if (y >= ksize) {
+                if (writeback && (y >= ksize)) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, (y - ksize)),
-                           IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, ((y - ksize) % brows)),
+                           IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(buf, ((y - ksize) % brows)),
                            IMAGE_GRAYSCALE_LINE_LEN_BYTES(img));
                 }
             }
 
-            // Copy any remaining lines from the buffer image...
-            for (int y = IM_MAX(img->h - ksize, 0), yy = img->h; y < yy; y++) {
-                memcpy(IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y),
-                       IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(&buf, (y % brows)),
-                       IMAGE_GRAYSCALE_LINE_LEN_BYTES(img));
-            }
-
-            fb_free();
             break;
         }
         case PIXFORMAT_RGB565: {
             int pixel, r, g, b, r_acc, g_acc, b_acc;
-            buf.data = fb_alloc(IMAGE_RGB565_LINE_LEN_BYTES(img) * brows, FB_ALLOC_NO_HINT);
-
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 uint16_t *row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
-                uint16_t *buf_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows));
+                uint16_t *buf_row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(buf, (y % brows));
 
                 r_acc = g_acc = b_acc = 0;
                 for (int x = 0, xx = img->w; x < xx; x++) {
@@ -336,22 +321,14 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
                     IMAGE_PUT_RGB565_PIXEL_FAST(buf_row_ptr, x, pixel);
                 }
 
-                if (y >= ksize) {
+                if (writeback && (y >= ksize)) {
                     // Transfer buffer lines...
                     memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, (y - ksize)),
-                           IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, ((y - ksize) % brows)),
+                           IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(buf, ((y - ksize) % brows)),
                            IMAGE_RGB565_LINE_LEN_BYTES(img));
                 }
             }
 
-            // Copy any remaining lines from the buffer image...
-            for (int y = IM_MAX(img->h - ksize, 0), yy = img->h; y < yy; y++) {
-                memcpy(IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y),
-                       IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(&buf, (y % brows)),
-                       IMAGE_RGB565_LINE_LEN_BYTES(img));
-            }
-
-            fb_free();
             break;
         }
         default: {
@@ -359,6 +336,63 @@ void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset
         }
     }
 }
+
+void imlib_mean_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert, image_t *mask) {
+    size_t line_len;
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            line_len = IMAGE_BINARY_LINE_LEN_BYTES(img);
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            line_len = IMAGE_GRAYSCALE_LINE_LEN_BYTES(img);
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            line_len = IMAGE_RGB565_LINE_LEN_BYTES(img);
+            break;
+        }
+        default: {
+            return;
+        }
+    }
+
+    // Bands write whole lines into a full size buffer image since the lines a
+    // band reads around its edges belong to its neighbours. Single threaded
+    // filtering only needs a ring of ksize + 1 lines.
+    int bands = imlib_parallel_bands(img->h, IM_MAX(8, ksize + 1));
+
+    if ((bands > 1) && (fb_avail() < (line_len * img->h * 2))) {
+        bands = 1;
+    }
+
+    image_t buf = {};
+    buf.w = img->w;
+    buf.h = (bands > 1) ? img->h : (ksize + 1);
+    buf.pixfmt = img->pixfmt;
+    buf.data = fb_alloc(line_len * buf.h, FB_ALLOC_NO_HINT);
+
+    imlib_mean_filter_band_t state = {
+        .img = img,
+        .buf = &buf,
+        .mask = mask,
+        .ksize = ksize,
+        .offset = offset,
+        .threshold = threshold,
+        .invert = invert,
+        .writeback = (bands <= 1)
+    };
+
+    imlib_parallel_for(img->h, bands, imlib_mean_filter_band, &state);
+
+    // Copy any remaining lines from the buffer image...
+    for (int y = (bands > 1) ? 0 : IM_MAX(img->h - ksize, 0), yy = img->h; y < yy; y++) {
+        memcpy(IMAGE_ROW_PTR(img, line_len, y), IMAGE_ROW_PTR(&buf, line_len, (y % buf.h)), line_len);
+    }
+
+    fb_free();
+}
 #endif // IMLIB_ENABLE_MEAN
 
 #ifdef IMLIB_ENABLE_MEDIAN
@@ -391,7 +425,7 @@ static uint8_t hist_median(uint8_t *data, int len, const int cutoff) {
 void imlib_median_filter(image_t *img, const int ksize, float percentile, bool threshold, int offset, bool invert,
                          image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -644,7 +678,7 @@ static uint8_t find_mode(uint8_t *bins, int len) {
 
 void imlib_mode_filter(image_t *img, const int ksize, bool threshold, int offset, bool invert, image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -963,7 +997,7 @@ void imlib_mode_filter(image_t *img, const int ksize, bool threshold, int offset
 #ifdef IMLIB_ENABLE_MIDPOINT
 void imlib_midpoint_filter(image_t *img, const int ksize, float bias, bool threshold, int offset, bool invert, image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -1245,7 +1279,7 @@ void imlib_morph(image_t *img,
                  bool invert,
                  image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -1508,7 +1542,7 @@ void imlib_bilateral_filter(image_t *img,
                             bool invert,
                             image_t *mask) {
     int brows = ksize + 1;
-    image_t buf;
+    image_t buf = {};
     buf.w = img->w;
     buf.h = brows;
     buf.pixfmt = img->pixfmt;
@@ -1895,7 +1929,7 @@ static void imlib_cartoon_filter_fill(image_t *img, int line, int l, int r, void
 }
 
 void imlib_cartoon_filter(image_t *img, float seed_threshold, float floating_threshold, image_t *mask) {
-    image_t mean_image, fill_image;
+    image_t mean_image = {}, fill_image = {};
 
     mean_image.w = img->w;
     mean_image.h = img->h;
@@ -47,6 +47,7 @@ void gif_open(FIL *fp, int width, int height, bool color, bool loop) {
 }
 
 void gif_add_frame(FIL *fp, image_t *img, uint16_t delay) {
+    image_assert_packed(img);
     file_buffer_on(fp);
 
     if (delay) {
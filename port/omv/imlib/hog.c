@@ -37,6 +37,7 @@ int bin_array_comp(const void *obj0, const void *obj1) {
 }
 
 void imlib_find_hog(image_t *src, rectangle_t *roi, int cell_size) {
+    image_assert_packed(src);
     int s = src->w;
     int w = roi->x + roi->w - 1;
     int h = roi->y + roi->h - 1;
@@ -0,0 +1,413 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Equivalence test for the row kernels in simd.c.
+ *
+ * Every kernel is run on random rows, on all-zero/all-max rows and on rows that
+ * alternate between the two, for every width up to 67 and a few odd and even
+ * frame widths, with the rows starting at aligned and unaligned addresses. The
+ * output must match the per-pixel loop the kernel replaced bit for bit, and the
+ * bytes past the end of each output row must be left untouched.
+ */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "simd.h"
+
+// The imlib.h macros used by the replaced loops.
+#define IM_IS_SIGNED(a)          (__builtin_types_compatible_p(__typeof__(a), signed) || \
+                                  __builtin_types_compatible_p(__typeof__(a), signed long))
+#define IM_IS_UNSIGNED(a)        (__builtin_types_compatible_p(__typeof__(a), unsigned) || \
+                                  __builtin_types_compatible_p(__typeof__(a), unsigned long))
+#define IM_SIGN_COMPARE(a, b)    ((IM_IS_SIGNED(a) && IM_IS_UNSIGNED(b)) || \
+                                  (IM_IS_SIGNED(b) && IM_IS_UNSIGNED(a)))
+
+#define IM_MAX(a, b)                                    \
+    ({__typeof__ (a) _a = (a); __typeof__ (b) _b = (b); \
+      __builtin_choose_expr(IM_SIGN_COMPARE(_a, _b), (void) 0, (_a > _b ? _a : _b)); })
+
+#define IM_MIN(a, b)                                    \
+    ({__typeof__ (a) _a = (a); __typeof__ (b) _b = (b); \
+      __builtin_choose_expr(IM_SIGN_COMPARE(_a, _b), (void) 0, (_a < _b ? _a : _b)); })
+
+#define COLOR_GRAYSCALE_MIN                     0
+#define COLOR_GRAYSCALE_MAX                     255
+
+#define COLOR_RGB565_TO_R8(pixel)             \
+    ({                                        \
+        __typeof__ (pixel) __pixel = (pixel); \
+        __pixel = (__pixel >> 8) & 0xF8;      \
+        __pixel | (__pixel >> 5);             \
+    })
+
+#define COLOR_RGB565_TO_G8(pixel)             \
+    ({                                        \
+        __typeof__ (pixel) __pixel = (pixel); \
+        __pixel = (__pixel >> 3) & 0xFC;      \
+        __pixel | (__pixel >> 6);             \
+    })
+
+#define COLOR_RGB565_TO_B8(pixel)             \
+    ({                                        \
+        __typeof__ (pixel) __pixel = (pixel); \
+        __pixel = (__pixel << 3) & 0xF8;      \
+        __pixel | (__pixel >> 5);             \
+    })
+
+#define COLOR_RGB888_TO_Y(r8, g8, b8)           ((((r8) * 38) + ((g8) * 75) + ((b8) * 15)) >> 7) // 0.299R + 0.587G + 0.114B
+#define COLOR_RGB565_TO_Y(rgb565)                \
+    ({                                           \
+        __typeof__ (rgb565) __rgb565 = (rgb565); \
+        int r = COLOR_RGB565_TO_R8(__rgb565);    \
+        int g = COLOR_RGB565_TO_G8(__rgb565);    \
+        int b = COLOR_RGB565_TO_B8(__rgb565);    \
+        COLOR_RGB888_TO_Y(r, g, b);              \
+    })
+
+// arm_math.h C version.
+static inline uint32_t __SMLAD(uint32_t x, uint32_t y, uint32_t sum) {
+    return ((uint32_t) (((((int32_t) x << 16) >> 16) * (((int32_t) y << 16) >> 16)) +
+                        ((((int32_t) x) >> 16) * (((int32_t) y) >> 16)) +
+                        (((int32_t) sum))));
+}
+
+#define MAX_W   (1921)
+#define GUARD   (64)
+#define CANARY  (0xA5)
+
+enum { FILL_RANDOM, FILL_ZERO, FILL_MAX, FILL_ALTERNATE, FILL_COUNT };
+
+static const char *fill_names[FILL_COUNT] = { "random", "zero", "max", "alternate" };
+
+static uint32_t rng_state = 0x12345678;
+static int failures;
+
+static uint32_t rng(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+static void fill(void *buf, size_t bytes, int mode, int phase) {
+    uint8_t *p = buf;
+    for (size_t i = 0; i < bytes; i++) {
+        switch (mode) {
+            case FILL_RANDOM: p[i] = rng(); break;
+            case FILL_ZERO: p[i] = 0; break;
+            case FILL_MAX: p[i] = 0xFF; break;
+            default: p[i] = (((i + phase) >> 1) & 1) ? 0xFF : 0; break;
+        }
+    }
+}
+
+// Aligned or one byte/element off, output rows are followed by canary bytes.
+typedef struct {
+    uint8_t mem[(MAX_W * 4 * sizeof(float)) + (2 * GUARD)];
+} row_t;
+
+static row_t bufs[8];
+
+static void *row(int i, int offset) {
+    return bufs[i].mem + GUARD + offset;
+}
+
+static void clear_out(int i) {
+    memset(bufs[i].mem, CANARY, sizeof(bufs[i].mem));
+}
+
+static void check(const char *name, int w, int mode, int offset, int i_ref, int i_out, size_t bytes) {
+    const uint8_t *ref = bufs[i_ref].mem;
+    const uint8_t *out = bufs[i_out].mem;
+    for (size_t k = 0; k < sizeof(bufs[0].mem); k++) {
+        if (ref[k] != out[k]) {
+            long at = (long) k - GUARD - offset;
+            if (failures++ < 20) {
+                printf("FAIL %s w=%d %s offset=%d: byte %ld of %zu, expected 0x%02x got 0x%02x\n",
+                       name, w, fill_names[mode], offset, at, bytes, ref[k], out[k]);
+            }
+            return;
+        }
+    }
+}
+
+// Replaced loops.
+
+static void ref_rgb565_to_y(const uint16_t *src16, uint8_t *dst8, int n) {
+    for (int x = 0; x < n; x++) {
+        int pixel = *src16++;
+        *dst8++ = COLOR_RGB565_TO_Y(pixel);
+    }
+}
+
+static void ref_argb8888_to_y(const uint32_t *in, uint8_t *row_ptr, int n) {
+    for (int i = 0; i < n; i++) {
+        uint32_t pixel = in[i];
+        row_ptr[i] = COLOR_RGB888_TO_Y((pixel >> 16) & 0xFF, (pixel >> 8) & 0xFF, pixel & 0xFF);
+    }
+}
+
+static void ref_yuv422_to_y(const uint16_t *rowptr_yuv, uint8_t *row_ptr_8, int n) {
+    for (int x = 0; x < n; x += 2) {
+        uint32_t row_yuv;
+        if (x + 1 < n) {
+            memcpy(&row_yuv, rowptr_yuv + x, sizeof(row_yuv));
+            row_ptr_8[x + 1] = (row_yuv >> 16) & 0xff;
+        } else {
+            row_yuv = rowptr_yuv[x];
+        }
+        row_ptr_8[x] = row_yuv & 0xff;
+    }
+}
+
+static void ref_add(uint8_t *data, const uint8_t *other, int n) {
+    for (int i = 0; i < n; i++) {
+        int p = data[i] + other[i];
+        p = IM_MIN(p, COLOR_GRAYSCALE_MAX);
+        data[i] = p;
+    }
+}
+
+static void ref_sub(uint8_t *data, const uint8_t *other, int n, bool reverse) {
+    for (int i = 0; i < n; i++) {
+        int dataPixel = data[i];
+        int otherPixel = other[i];
+        int p = reverse ? (otherPixel - dataPixel) : (dataPixel - otherPixel);
+        p = IM_MAX(p, COLOR_GRAYSCALE_MIN);
+        data[i] = p;
+    }
+}
+
+static void ref_min(uint8_t *data, const uint8_t *other, int n) {
+    for (int i = 0; i < n; i++) {
+        int dataPixel = data[i];
+        int otherPixel = other[i];
+        data[i] = IM_MIN(dataPixel, otherPixel);
+    }
+}
+
+static void ref_max(uint8_t *data, const uint8_t *other, int n) {
+    for (int i = 0; i < n; i++) {
+        int dataPixel = data[i];
+        int otherPixel = other[i];
+        data[i] = IM_MAX(dataPixel, otherPixel);
+    }
+}
+
+static void ref_difference(uint8_t *data, const uint8_t *other, int n) {
+    for (int i = 0; i < n; i++) {
+        int p = abs(data[i] - other[i]);
+        data[i] = p;
+    }
+}
+
+static void ref_sepconv3_v(const uint8_t *row_0, const uint8_t *row_1, const uint8_t *row_2,
+                           const int8_t *krn, int *buffer, int n) {
+    for (int x = 0; x < n; x++) {
+        int acc = 0;
+        acc = __SMLAD(krn[0], row_0[x], acc);
+        acc = __SMLAD(krn[1], row_1[x], acc);
+        acc = __SMLAD(krn[2], row_2[x], acc);
+        buffer[x] = acc;
+    }
+}
+
+static void ref_integral(const uint8_t *img_data, const uint32_t *prev, uint32_t *sum_data, int n, bool sq) {
+    for (uint32_t s = 0, x = 0; x < (uint32_t) n; x++) {
+        s += sq ? (img_data[x] * img_data[x]) : img_data[x];
+        sum_data[x] = prev ? (s + prev[x]) : s;
+    }
+}
+
+// The to_tensor() kernels have no older loop, check them against the plain definitions.
+
+static void ref_rgb888_to_planar(const uint8_t *src, uint8_t *r, uint8_t *g, uint8_t *b, int n) {
+    for (int i = 0; i < n; i++) {
+        r[i] = src[(i * 3) + 0];
+        g[i] = src[(i * 3) + 1];
+        b[i] = src[(i * 3) + 2];
+    }
+}
+
+static int ref_clamp_u8(int x) {
+    return (x < 0) ? 0 : ((x > 255) ? 255 : x);
+}
+
+static void ref_nv12_to_planar(const uint8_t *y, const uint8_t *uv, uint8_t *r, uint8_t *g, uint8_t *b,
+                               int n, bool nv21) {
+    for (int i = 0; i < n; i++) {
+        const uint8_t *pair = uv + (i & ~1);
+        int u = (nv21 ? pair[1] : pair[0]) - 128;
+        int v = (nv21 ? pair[0] : pair[1]) - 128;
+        int l = y[i] << 14;
+        r[i] = ref_clamp_u8((l + (22970 * v) + 8192) >> 14);
+        g[i] = ref_clamp_u8((l - (5638 * u) - (11700 * v) + 8192) >> 14);
+        b[i] = ref_clamp_u8((l + (29032 * u) + 8192) >> 14);
+    }
+}
+
+static void ref_lerp(const uint8_t *a, const uint8_t *b, uint8_t *dst, int n, int w) {
+    for (int i = 0; i < n; i++) {
+        dst[i] = ((a[i] * (2048 - w)) + (b[i] * w) + 1024) >> 11;
+    }
+}
+
+static void ref_u8_to_f32(const uint8_t *src, float *dst, int stride, int n, float scale, float bias) {
+    for (int i = 0; i < n; i++) {
+        dst[i * stride] = fmaf(src[i], scale, bias);
+    }
+}
+
+static void ref_u8_to_q8(const uint8_t *src, uint8_t *dst, int stride, int n, float scale, float bias, bool is_signed) {
+    for (int i = 0; i < n; i++) {
+        long q = lrintf(fmaf(src[i], scale, bias));
+        q = is_signed ? ((q < -128) ? -128 : ((q > 127) ? 127 : q)) : ((q < 0) ? 0 : ((q > 255) ? 255 : q));
+        dst[i * stride] = (uint8_t) q;
+    }
+}
+
+// Inputs in bufs[0..3], reference output in bufs[4..5], kernel output in bufs[6..7].
+static void test_width(int w, int mode, int offset) {
+    size_t in_bytes = (size_t) MAX_W * 4 * sizeof(float);
+    for (int i = 0; i < 4; i++) {
+        memset(bufs[i].mem, 0, sizeof(bufs[i].mem));
+        fill(row(i, 0), in_bytes, mode, i);
+    }
+
+    #define RUN(name, bytes, ref_call, out_call)     \
+    do {                                             \
+        clear_out(4); clear_out(6);                  \
+        ref_call;                                    \
+        out_call;                                    \
+        check(name, w, mode, offset, 4, 6, bytes);   \
+    } while (0)
+
+    // Read-modify-write kernels start from the same destination row.
+    #define RUN_RMW(name, ref_call, out_call)                        \
+    do {                                                             \
+        clear_out(4); clear_out(6);                                  \
+        memcpy(row(4, offset), row(0, offset), w);                   \
+        memcpy(row(6, offset), row(0, offset), w);                   \
+        ref_call;                                                    \
+        out_call;                                                    \
+        check(name, w, mode, offset, 4, 6, w);                       \
+    } while (0)
+
+    // 16/32-bit rows stay naturally aligned, offset them by whole elements.
+    uint16_t *in16 = row(1, offset * 2);
+    uint32_t *in32 = row(1, offset * 4);
+    const uint8_t *a = row(1, offset);
+    const uint8_t *b = row(2, offset);
+    const uint8_t *c = row(3, offset);
+
+    RUN("rgb565_to_y", w, ref_rgb565_to_y(in16, row(4, offset), w), imlib_rgb565_to_y_row(in16, row(6, offset), w));
+    RUN("argb8888_to_y", w, ref_argb8888_to_y(in32, row(4, offset), w), imlib_argb8888_to_y_row(in32, row(6, offset), w));
+    RUN("yuv422_to_y", w, ref_yuv422_to_y(in16, row(4, offset), w), imlib_yuv422_to_y_row(in16, row(6, offset), w));
+
+    RUN_RMW("add", ref_add(row(4, offset), a, w), imlib_add_u8_row(row(6, offset), a, w));
+    RUN_RMW("sub", ref_sub(row(4, offset), a, w, false), imlib_sub_u8_row(row(6, offset), a, w, false));
+    RUN_RMW("sub_reverse", ref_sub(row(4, offset), a, w, true), imlib_sub_u8_row(row(6, offset), a, w, true));
+    RUN_RMW("min", ref_min(row(4, offset), a, w), imlib_min_u8_row(row(6, offset), a, w));
+    RUN_RMW("max", ref_max(row(4, offset), a, w), imlib_max_u8_row(row(6, offset), a, w));
+    RUN_RMW("difference", ref_difference(row(4, offset), a, w), imlib_difference_u8_row(row(6, offset), a, w));
+
+    static const int8_t kernels[][3] = { { 1, 2, 1 }, { -1, 0, 1 }, { 127, -128, 127 }, { -128, -128, -128 } };
+    for (size_t k = 0; k < sizeof(kernels) / sizeof(kernels[0]); k++) {
+        int *ref_out = row(4, offset * 4), *out = row(6, offset * 4);
+        RUN("sepconv3_v", w * sizeof(int), ref_sepconv3_v(a, b, c, kernels[k], ref_out, w),
+            imlib_sepconv3_v_row(a, b, c, kernels[k], out, w));
+    }
+
+    for (int sq = 0; sq < 2; sq++) {
+        uint32_t *prev = (uint32_t *) row(2, offset * 4);
+        for (int i = 0; i < w; i++) {
+            prev[i] &= 0x7FFFFFFF;
+        }
+        uint32_t *ref_out = row(4, offset * 4), *out = row(6, offset * 4);
+        RUN("integral_first_row", w * 4, ref_integral(a, NULL, ref_out, w, sq), imlib_integral_row(a, NULL, out, w, sq));
+        RUN("integral", w * 4, ref_integral(a, prev, ref_out, w, sq), imlib_integral_row(a, prev, out, w, sq));
+    }
+
+    {
+        uint8_t *r0 = row(4, offset), *g0 = row(5, offset), *b0 = g0 + MAX_W + GUARD;
+        uint8_t *r1 = row(6, offset), *g1 = row(7, offset), *b1 = g1 + MAX_W + GUARD;
+        clear_out(4); clear_out(5); clear_out(6); clear_out(7);
+        ref_rgb888_to_planar(a, r0, g0, b0, w);
+        imlib_rgb888_to_planar_row(a, r1, g1, b1, w);
+        check("rgb888_to_planar", w, mode, offset, 4, 6, w);
+        check("rgb888_to_planar", w, mode, offset, 5, 7, w);
+
+        for (int nv21 = 0; nv21 < 2; nv21++) {
+            clear_out(4); clear_out(5); clear_out(6); clear_out(7);
+            ref_nv12_to_planar(a, b, r0, g0, b0, w, nv21);
+            imlib_nv12_to_planar_row(a, b, r1, g1, b1, w, nv21);
+            check(nv21 ? "nv21_to_planar" : "nv12_to_planar", w, mode, offset, 4, 6, w);
+            check(nv21 ? "nv21_to_planar" : "nv12_to_planar", w, mode, offset, 5, 7, w);
+        }
+    }
+
+    static const int weights[] = { 0, 1, 1023, 1024, 1025, 2047, 2048 };
+    for (size_t k = 0; k < sizeof(weights) / sizeof(weights[0]); k++) {
+        RUN("lerp", w, ref_lerp(a, b, row(4, offset), w, weights[k]), imlib_lerp_u8_row(a, b, row(6, offset), w, weights[k]));
+    }
+
+    // Identity, ImageNet-like normalization, ties at .5 and values far outside the output range.
+    static const float norms[][2] = {
+        { 1.0f, 0.0f }, { 1.0f / 58.395f, -123.675f / 58.395f }, { 0.5f, 0.5f }, { 0.5f, -0.5f },
+        { 1.0f, -128.0f }, { 4.0f, -300.0f }, { -1.0f, 255.0f }, { 0.00390625f, 0.0f },
+    };
+    for (size_t k = 0; k < sizeof(norms) / sizeof(norms[0]); k++) {
+        for (int stride = 1; stride <= 3; stride += 2) {
+            if (w * stride > MAX_W * 4) {
+                continue;
+            }
+            float *ref_f = row(4, offset * 4), *out_f = row(6, offset * 4);
+            RUN("u8_to_f32", w * stride * sizeof(float), ref_u8_to_f32(a, ref_f, stride, w, norms[k][0], norms[k][1]),
+                imlib_u8_to_f32_row(a, out_f, stride, w, norms[k][0], norms[k][1]));
+            for (int is_signed = 0; is_signed < 2; is_signed++) {
+                RUN(is_signed ? "u8_to_i8" : "u8_to_u8", w * stride,
+                    ref_u8_to_q8(a, row(4, offset), stride, w, norms[k][0], norms[k][1], is_signed),
+                    imlib_u8_to_q8_row(a, row(6, offset), stride, w, norms[k][0], norms[k][1], is_signed));
+            }
+        }
+    }
+
+    #undef RUN
+    #undef RUN_RMW
+}
+
+int main(void) {
+    static const int frame_widths[] = { 127, 128, 129, 255, 320, 321, 640, 1023, 1280, 1920, 1921 };
+    int runs = 0;
+
+    for (int mode = 0; mode < FILL_COUNT; mode++) {
+        for (int offset = 0; offset < 2; offset++) {
+            for (int w = 1; w <= 67; w++, runs++) {
+                test_width(w, mode, offset);
+            }
+            for (size_t i = 0; i < sizeof(frame_widths) / sizeof(frame_widths[0]); i++, runs++) {
+                test_width(frame_widths[i], mode, offset);
+            }
+        }
+    }
+
+    #if defined(IMLIB_ENABLE_RVV)
+    const char *path = "RVV";
+    #else
+    const char *path = "scalar";
+    #endif
+
+    if (failures) {
+        printf("simd_test (%s): %d failures in %d runs\n", path, failures, runs);
+        return 1;
+    }
+
+    printf("simd_test (%s): %d runs passed\n", path, runs);
+    return 0;
+}
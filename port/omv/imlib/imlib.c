@@ -9,6 +9,7 @@
  * Image library.
  */
 #include <stdlib.h>
+#include <string.h>
 #include "py/obj.h"
 #include "py/runtime.h"
 
@@ -293,6 +294,104 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y) {
     return false;
 }
 
+static size_t image_line_len_bytes(image_t *ptr) {
+    if (ptr->pixfmt_id == PIXFORMAT_ID_BINARY) {
+        return IMAGE_BINARY_LINE_LEN_BYTES(ptr);
+    }
+    return ptr->w * ptr->bpp;
+}
+
+bool image_view_supported(image_t *ptr, rectangle_t *roi) {
+    switch (ptr->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            // Rows are packed 32 pixels to a word so views have to start on a word and must not
+            // share their last word with pixels outside of the view.
+            return (!(roi->x & UINT32_T_MASK)) && ((!(roi->w & UINT32_T_MASK)) || ((roi->x + roi->w) == ptr->w));
+        }
+        case PIXFORMAT_GRAYSCALE:
+        case PIXFORMAT_RGB565:
+        case PIXFORMAT_ARGB8888:
+        case PIXFORMAT_ABGR8888:
+        case PIXFORMAT_RGBA8888:
+        case PIXFORMAT_BGRA8888:
+        case PIXFORMAT_RGB888:
+        case PIXFORMAT_BGR888: {
+            return true;
+        }
+        default: {
+            return false;
+        }
+    }
+}
+
+void image_init_view(image_t *dst, image_t *src, rectangle_t *roi) {
+    size_t stride = IMAGE_ROW_STRIDE(src, image_line_len_bytes(src));
+    size_t offset = (roi->y * stride) + ((src->pixfmt == PIXFORMAT_BINARY) ?
+                                         ((roi->x >> UINT32_T_SHIFT) * sizeof(uint32_t)) : (roi->x * src->bpp));
+
+    memcpy(dst, src, sizeof(image_t));
+    dst->w = roi->w;
+    dst->h = roi->h;
+    dst->data = src->data + offset;
+    dst->phy_addr = src->phy_addr ? (src->phy_addr + offset) : 0;
+    dst->stride = stride;
+    dst->alloc_type = ALLOC_REF;
+    dst->ref_obj = NULL;
+    dst->pool_id = 0;
+}
+
+bool image_luma_view_supported(image_t *ptr) {
+    return (ptr->pixfmt_id == PIXFORMAT_ID_YUV420) && image_is_packed(ptr);
+}
+
+// NV12/NV21 frames start with a packed w*h Y plane followed by the interleaved chroma plane, so the
+// first w*h bytes are already a valid GRAYSCALE image and algorithms can run on it in place.
+void image_init_luma_view(image_t *dst, image_t *src) {
+    memcpy(dst, src, sizeof(image_t));
+    dst->pixfmt = PIXFORMAT_GRAYSCALE;
+    dst->size = 0;
+    dst->stride = 0;
+    dst->alloc_type = ALLOC_REF;
+    dst->ref_obj = NULL;
+    dst->pool_id = 0;
+}
+
+bool image_is_packed(image_t *ptr) {
+    return (!ptr->stride) || (ptr->is_compressed) || (ptr->stride == image_line_len_bytes(ptr));
+}
+
+void image_assert_packed(image_t *ptr) {
+    if (!image_is_packed(ptr)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Operation not supported on image views, copy() first!"));
+    }
+}
+
+// Copies the pixels of src, which may be a view, into a packed buffer of image_size(src) bytes.
+void image_copy_pixels(void *dst, image_t *src) {
+    if (image_is_packed(src)) {
+        memcpy(dst, src->data, image_size(src));
+    } else {
+        size_t line_len_bytes = image_line_len_bytes(src);
+        for (int y = 0; y < src->h; y++) {
+            memcpy(((uint8_t *) dst) + (y * line_len_bytes), IMAGE_ROW_PTR(src, line_len_bytes, y), line_len_bytes);
+        }
+    }
+}
+
+// Returns true if any byte spanned by the rows of a is also spanned by the rows of b.
+bool image_overlaps(image_t *a, image_t *b) {
+    if ((!a->h) || (!b->h)) {
+        return false;
+    }
+    if (a->is_compressed || b->is_compressed) {
+        return a->data == b->data;
+    }
+    size_t a_line = image_line_len_bytes(a), b_line = image_line_len_bytes(b);
+    uint8_t *a_end = IMAGE_ROW_PTR(a, a_line, a->h - 1) + a_line;
+    uint8_t *b_end = IMAGE_ROW_PTR(b, b_line, b->h - 1) + b_line;
+    return (a->data < b_end) && (b->data < a_end);
+}
+
 // Gamma uncompress
 extern const float xyz_table[256];
 
@@ -604,7 +703,7 @@ void imlib_image_operation(image_t *img, const char *path, image_t *other, int s
         // next window. The vflipped part is here because BMP files can be saved
         // vertically flipped resulting in us reading the image backwards.
         FIL fp;
-        image_t temp;
+        image_t temp = {};
         img_read_settings_t rs;
         bool vflipped = imlib_read_geometry(&fp, &temp, path, &rs);
         if (!IM_EQUAL(img, &temp)) {
@@ -718,6 +817,119 @@ void imlib_image_operation(image_t *img, const char *path, image_t *other, int s
     }
 }
 
+typedef struct imlib_image_operation_band {
+    image_t *img;
+    image_t *other;
+    void *row_ptr;
+    line_op_t op;
+    void *data;
+} imlib_image_operation_band_t;
+
+static void imlib_image_operation_band(void *arg, int band, int y_start, int y_end) {
+    imlib_image_operation_band_t *state = (imlib_image_operation_band_t *) arg;
+    image_t *other = state->other;
+
+    for (int i = y_start; i < y_end; i++) {
+        void *row_ptr = state->row_ptr;
+
+        if (other) {
+            switch (other->pixfmt) {
+                case PIXFORMAT_BINARY: {
+                    row_ptr = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(other, i);
+                    break;
+                }
+                case PIXFORMAT_GRAYSCALE: {
+                    row_ptr = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(other, i);
+                    break;
+                }
+                case PIXFORMAT_RGB565: {
+                    row_ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(other, i);
+                    break;
+                }
+                default: {
+                    return;
+                }
+            }
+        }
+
+        state->op(state->img, i, row_ptr, state->data, false);
+    }
+}
+
+// Same as imlib_image_operation() but runs the rows in parallel bands. Only for line
+// ops that read and write nothing but the given line (no accumulated state).
+void imlib_image_parallel_operation(image_t *img, const char *path, image_t *other, int scalar, line_op_t op, void *data) {
+    // Files are read sequentially and an other image that partially overlaps img
+    // would see rows already written by another band.
+    if (path || (other && image_overlaps(img, other) && (other->data != img->data))) {
+        imlib_image_operation(img, path, other, scalar, op, data);
+        return;
+    }
+
+    int bands = imlib_parallel_bands(img->h, 8);
+
+    if (bands <= 1) {
+        imlib_image_operation(img, path, other, scalar, op, data);
+        return;
+    }
+
+    if (other && !IM_EQUAL(img, other)) {
+        mp_raise_msg(&mp_type_OSError, MP_ERROR_TEXT("Images not equal!"));
+    }
+
+    imlib_image_operation_band_t state = {
+        .img = img,
+        .other = other,
+        .row_ptr = NULL,
+        .op = op,
+        .data = data
+    };
+
+    if (other) {
+        imlib_parallel_for(img->h, bands, imlib_image_operation_band, &state);
+        return;
+    }
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            uint32_t *row_ptr = fb_alloc(IMAGE_BINARY_LINE_LEN_BYTES(img), FB_ALLOC_NO_HINT);
+
+            for (int i = 0, ii = img->w; i < ii; i++) {
+                IMAGE_PUT_BINARY_PIXEL_FAST(row_ptr, i, scalar);
+            }
+
+            state.row_ptr = row_ptr;
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE: {
+            uint8_t *row_ptr = fb_alloc(IMAGE_GRAYSCALE_LINE_LEN_BYTES(img), FB_ALLOC_NO_HINT);
+
+            for (int i = 0, ii = img->w; i < ii; i++) {
+                IMAGE_PUT_GRAYSCALE_PIXEL_FAST(row_ptr, i, scalar);
+            }
+
+            state.row_ptr = row_ptr;
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            uint16_t *row_ptr = fb_alloc(IMAGE_RGB565_LINE_LEN_BYTES(img), FB_ALLOC_NO_HINT);
+
+            for (int i = 0, ii = img->w; i < ii; i++) {
+                IMAGE_PUT_RGB565_PIXEL_FAST(row_ptr, i, scalar);
+            }
+
+            state.row_ptr = row_ptr;
+            break;
+        }
+        default: {
+            return;
+        }
+    }
+
+    imlib_parallel_for(img->h, bands, imlib_image_operation_band, &state);
+    fb_free();
+}
+
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 void imlib_load_image(image_t *img, const char *path) {
     FIL fp;
@@ -747,6 +959,7 @@ void imlib_load_image(image_t *img, const char *path) {
 }
 
 void imlib_save_image(image_t *img, const char *path, rectangle_t *roi, int quality) {
+    image_assert_packed(img);
     save_image_format_t format = imblib_parse_extension(img, path);
     if ((img->pixfmt_id == PIXFORMAT_ID_RGB8 || img->pixfmt_id == PIXFORMAT_ID_ARGB8 ||
         img->pixfmt_id == PIXFORMAT_ID_YUV420) && format != FORMAT_DONT_CARE) {
@@ -848,6 +1061,7 @@ void imlib_zero(image_t *img, image_t *mask, bool invert) {
 // A simple algorithm for correcting lens distortion.
 // See http://www.tannerhelland.com/4743/simple-algorithm-correcting-lens-distortion/
 void imlib_lens_corr(image_t *img, float strength, float zoom, float x_corr, float y_corr) {
+    image_assert_packed(img);
     int w = img->w;
     int h = img->h;
     int halfWidth = w / 2;
@@ -1047,6 +1261,7 @@ void imlib_lens_corr(image_t *img, float strength, float zoom, float x_corr, flo
 ////////////////////////////////////////////////////////////////////////////////
 
 int imlib_image_mean(image_t *src, int *r_mean, int *g_mean, int *b_mean) {
+    image_assert_packed(src);
     int r_s = 0;
     int g_s = 0;
     int b_s = 0;
@@ -1088,6 +1303,7 @@ int imlib_image_mean(image_t *src, int *r_mean, int *g_mean, int *b_mean) {
 
 // One pass standard deviation.
 int imlib_image_std(image_t *src) {
+    image_assert_packed(src);
     int w = src->w;
     int h = src->h;
     int n = w * h;
@@ -1115,23 +1331,49 @@ int imlib_image_std(image_t *src) {
     return fast_sqrtf(v);
 }
 
-void imlib_sepconv3(image_t *img, const int8_t *krn, const float m, const int b) {
+typedef struct imlib_sepconv3_band {
+    image_t *img;
+    const int8_t *krn;
+    float m;
+    int b;
+    int bands;
+    int *buffer; // Two rows of vertical sums per band.
+    uint8_t *halo; // Original rows B-1, B and B+1 around each band boundary B.
+} imlib_sepconv3_band_t;
+
+// Rows owned by the band are read before they are written, rows owned by its
+// neighbours come from the halo that was saved before any band started.
+static inline uint8_t *imlib_sepconv3_row(imlib_sepconv3_band_t *state, int band, int y_start, int y_end, int y) {
+    int w = state->img->w;
+
+    if (y < y_start) {
+        return state->halo + (((band - 1) * 3) + (y - y_start + 1)) * w;
+    } else if ((y >= y_end) && (band < (state->bands - 1))) {
+        return state->halo + ((band * 3) + (y - y_end + 1)) * w;
+    }
+
+    return IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(state->img, y);
+}
+
+static void imlib_sepconv3_band(void *arg, int band, int y_start, int y_end) {
+    imlib_sepconv3_band_t *state = (imlib_sepconv3_band_t *) arg;
+    image_t *img = state->img;
+    const int8_t *krn = state->krn;
+    const float m = state->m;
+    const int b = state->b;
     int ksize = 3;
-    // TODO: Support RGB
-    int *buffer = fb_alloc(img->w * sizeof(*buffer) * 2, FB_ALLOC_NO_HINT);
+    int *buffer = state->buffer + (band * img->w * 2);
 
     // NOTE: This doesn't deal with borders right now. Adding if
     // statements in the inner loop will slow it down significantly.
-    for (int y = 0; y < img->h - ksize; y++) {
-        for (int x = 0; x < img->w; x++) {
-            int acc = 0;
-            //if (IM_X_INSIDE(img, x+k) && IM_Y_INSIDE(img, y+j))
-            acc = __SMLAD(krn[0], IM_GET_GS_PIXEL(img, x, y + 0), acc);
-            acc = __SMLAD(krn[1], IM_GET_GS_PIXEL(img, x, y + 1), acc);
-            acc = __SMLAD(krn[2], IM_GET_GS_PIXEL(img, x, y + 2), acc);
-            buffer[((y % 2) * img->w) + x] = acc;
-        }
-        if (y > 0) {
+    for (int y = IM_MAX(y_start - 1, 0); y < y_end; y++) {
+        uint8_t *row_0 = imlib_sepconv3_row(state, band, y_start, y_end, y + 0);
+        uint8_t *row_1 = imlib_sepconv3_row(state, band, y_start, y_end, y + 1);
+        uint8_t *row_2 = imlib_sepconv3_row(state, band, y_start, y_end, y + 2);
+
+        imlib_sepconv3_v_row(row_0, row_1, row_2, krn, buffer + ((y % 2) * img->w), img->w);
+
+        if ((y > 0) && (y >= y_start)) {
             // flush buffer
             for (int x = 0; x < img->w - ksize; x++) {
                 int acc = 0;
@@ -1144,5 +1386,41 @@ void imlib_sepconv3(image_t *img, const int8_t *krn, const float m, const int b)
             }
         }
     }
+}
+
+void imlib_sepconv3(image_t *img, const int8_t *krn, const float m, const int b) {
+    int ksize = 3;
+    // TODO: Support RGB
+    int h = img->h - ksize;
+    int bands = imlib_parallel_bands(h, 8);
+
+    if (h <= 0) {
+        return;
+    }
+
+    imlib_sepconv3_band_t state = {
+        .img = img,
+        .krn = krn,
+        .m = m,
+        .b = b,
+        .bands = bands,
+        .buffer = fb_alloc(img->w * sizeof(int) * 2 * bands, FB_ALLOC_NO_HINT),
+        .halo = (bands > 1) ? fb_alloc(img->w * 3 * (bands - 1), FB_ALLOC_NO_HINT) : NULL
+    };
+
+    for (int band = 1; band < bands; band++) {
+        int y = (h * band) / bands;
+        for (int i = 0; i < 3; i++) {
+            memcpy(state.halo + (((band - 1) * 3) + i) * img->w,
+                   IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y - 1 + i), img->w);
+        }
+    }
+
+    imlib_parallel_for(h, bands, imlib_sepconv3_band, &state);
+
+    if (bands > 1) {
+        fb_free();
+    }
+
     fb_free();
 }
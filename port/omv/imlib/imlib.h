@@ -26,6 +26,7 @@
 #include "xalloc.h"
 #include "array.h"
 #include "fmath.h"
+#include "simd.h"
 #include "collections.h"
 #include "ff_wrapper.h"
 #include "py/obj.h"
@@ -183,6 +184,9 @@ color_thresholds_list_lnk_data_t;
          (_threshold->BMin <= _b) && (_b <= _threshold->BMax)) ^ _invert; \
     })
 
+#define COLOR_THRESHOLD_RGB888(pixel, threshold, invert) \
+    COLOR_THRESHOLD_RGB565(COLOR_RGB888_TO_RGB565(pixel), threshold, invert)
+
 #define COLOR_BOUND_BINARY(pixel0, pixel1, threshold)    \
     ({                                                   \
         __typeof__ (pixel0) _pixel0 = (pixel0);          \
@@ -275,6 +279,7 @@ color_thresholds_list_lnk_data_t;
 
 #define COLOR_R5_G6_B5_TO_RGB565(r5, g6, b5)    (((r5) << 11) | ((g6) << 5) | (b5))
 #define COLOR_R8_G8_B8_TO_RGB565(r8, g8, b8)    ((((r8) & 0xF8) << 8) | (((g8) & 0xFC) << 3) | ((b8) >> 3))
+#define COLOR_RGB888_TO_RGB565(pixel)           ((((pixel) >> 8) & 0xF800) | (((pixel) >> 5) & 0x07E0) | (((pixel) >> 3) & 0x001F))
 
 #define COLOR_RGB888_TO_Y(r8, g8, b8)           ((((r8) * 38) + ((g8) * 75) + ((b8) * 15)) >> 7) // 0.299R + 0.587G + 0.114B
 #define COLOR_RGB565_TO_Y(rgb565)                \
@@ -326,12 +331,20 @@ extern const int8_t lab_table[196608 / 2];
 #define COLOR_RGB565_TO_B(pixel)                imlib_rgb565_to_b(pixel)
 #endif
 
+// RGB888 pixels are looked up in the RGB565 LAB table. Dropping the low bits first is exactly what
+// to_rgb565() does, so thresholds and statistics match the RGB565 path without converting the frame.
+#define COLOR_RGB888_TO_L(pixel)                COLOR_RGB565_TO_L(COLOR_RGB888_TO_RGB565(pixel))
+#define COLOR_RGB888_TO_A(pixel)                COLOR_RGB565_TO_A(COLOR_RGB888_TO_RGB565(pixel))
+#define COLOR_RGB888_TO_B(pixel)                COLOR_RGB565_TO_B(COLOR_RGB888_TO_RGB565(pixel))
+
 #define COLOR_LAB_TO_RGB565(l, a, b)            imlib_lab_to_rgb(l, a, b)
 #define COLOR_YUV_TO_RGB565(y, u, v)            imlib_yuv_to_rgb((y) + 128, u, v)
 
 #define COLOR_BINARY_TO_GRAYSCALE(pixel)        ((pixel) * COLOR_GRAYSCALE_MAX)
 #define COLOR_BINARY_TO_RGB565(pixel)           COLOR_YUV_TO_RGB565(((pixel) ? 127 : -128), 0, 0)
 #define COLOR_RGB565_TO_BINARY(pixel)           (COLOR_RGB565_TO_Y(pixel) > (((COLOR_Y_MAX - COLOR_Y_MIN) / 2) + COLOR_Y_MIN))
+#define COLOR_BINARY_TO_RGB888(pixel)           ((pixel) ? 0xFFFFFF : 0x000000)
+#define COLOR_RGB888_TO_BINARY(pixel)           COLOR_RGB565_TO_BINARY(COLOR_RGB888_TO_RGB565(pixel))
 #define COLOR_RGB565_TO_GRAYSCALE(pixel)        COLOR_RGB565_TO_Y(pixel)
 #define COLOR_GRAYSCALE_TO_BINARY(pixel)        ((pixel) > \
                                                  (((COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN) / 2) + COLOR_GRAYSCALE_MIN))
@@ -563,12 +576,28 @@ typedef struct image {
     uint8_t alloc_type;
     uint8_t cache;
     uint32_t pool_id;
+    uint32_t stride; // Row pitch in bytes for views, 0 when rows are packed.
 } image_t;
 
 void image_init(image_t *ptr, int w, int h, pixformat_t pixfmt, uint32_t size, void *pixels);
 void image_copy(image_t *dst, image_t *src);
 size_t image_size(image_t *ptr);
 bool image_get_mask_pixel(image_t *ptr, int x, int y);
+// Views alias a rectangle of another image's pixels without copying them.
+bool image_view_supported(image_t *ptr, rectangle_t *roi);
+void image_init_view(image_t *dst, image_t *src, rectangle_t *roi);
+bool image_is_packed(image_t *ptr);
+void image_assert_packed(image_t *ptr);
+void image_copy_pixels(void *dst, image_t *src);
+bool image_overlaps(image_t *a, image_t *b);
+// Luma views alias the Y plane of a YUV420/YVU420 frame as a GRAYSCALE image.
+bool image_luma_view_supported(image_t *ptr);
+void image_init_luma_view(image_t *dst, image_t *src);
+
+// Row pitch in bytes of an image whose packed rows are line_len_bytes long.
+#define IMAGE_ROW_STRIDE(image, line_len_bytes) ((image)->stride ? (image)->stride : (line_len_bytes))
+#define IMAGE_ROW_PTR(image, line_len_bytes, y) \
+    (((uint8_t *) (image)->data) + (IMAGE_ROW_STRIDE(image, line_len_bytes) * (y)))
 
 #define IMAGE_BINARY_LINE_LEN(image)             (((image)->w + UINT32_T_MASK) >> UINT32_T_SHIFT)
 #define IMAGE_BINARY_LINE_LEN_BYTES(image)       (IMAGE_BINARY_LINE_LEN(image) * sizeof(uint32_t))
@@ -579,12 +608,18 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
 #define IMAGE_RGB565_LINE_LEN(image)             ((image)->w)
 #define IMAGE_RGB565_LINE_LEN_BYTES(image)       (IMAGE_RGB565_LINE_LEN(image) * sizeof(uint16_t))
 
+#define IMAGE_BINARY_ROW_PTR(image, y)           ((uint32_t *) IMAGE_ROW_PTR(image, IMAGE_BINARY_LINE_LEN_BYTES(image), y))
+#define IMAGE_GRAYSCALE_ROW_PTR(image, y)        ((uint8_t *) IMAGE_ROW_PTR(image, (image)->w, y))
+#define IMAGE_RGB565_ROW_PTR(image, y)           ((uint16_t *) IMAGE_ROW_PTR(image, (image)->w * 2, y))
+#define IMAGE_RGB888_ROW_PTR(image, y)           ((uint8_t *) IMAGE_ROW_PTR(image, (image)->w * 3, y))
+#define IMAGE_ARGB8888_ROW_PTR(image, y)         ((uint32_t *) IMAGE_ROW_PTR(image, (image)->w * 4, y))
+
 #define IMAGE_GET_BINARY_PIXEL(image, x, y)                                                                              \
     ({                                                                                                                   \
         __typeof__ (image) _image = (image);                                                                             \
         __typeof__ (x) _x = (x);                                                                                         \
         __typeof__ (y) _y = (y);                                                                                         \
-        (((uint32_t *) _image->data)[(((_image->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * _y) + (_x >> UINT32_T_SHIFT)] >> \
+        (IMAGE_BINARY_ROW_PTR(_image, _y)[_x >> UINT32_T_SHIFT] >>                                                       \
          (_x & UINT32_T_MASK)) & 1;                                                                                      \
     })
 
@@ -594,9 +629,10 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                                                               \
         __typeof__ (y) _y = (y);                                                                               \
         __typeof__ (v) _v = (v);                                                                               \
-        size_t _i = (((_image->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * _y) + (_x >> UINT32_T_SHIFT);           \
+        uint32_t *_row = IMAGE_BINARY_ROW_PTR(_image, _y);                                                     \
+        size_t _i = _x >> UINT32_T_SHIFT;                                                                      \
         size_t _j = _x & UINT32_T_MASK;                                                                        \
-        ((uint32_t *) _image->data)[_i] = (((uint32_t *) _image->data)[_i] & (~(1 << _j))) | ((_v & 1) << _j); \
+        _row[_i] = (_row[_i] & (~(1 << _j))) | ((_v & 1) << _j);                                               \
     })
 
 #define IMAGE_CLEAR_BINARY_PIXEL(image, x, y)                                                                          \
@@ -604,8 +640,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);                                                                           \
         __typeof__ (x) _x = (x);                                                                                       \
         __typeof__ (y) _y = (y);                                                                                       \
-        ((uint32_t *) _image->data)[(((_image->w + UINT32_T_MASK) >>                                                   \
-                                      UINT32_T_SHIFT) * _y) + (_x >> UINT32_T_SHIFT)] &= ~(1 << (_x & UINT32_T_MASK)); \
+        IMAGE_BINARY_ROW_PTR(_image, _y)[_x >> UINT32_T_SHIFT] &= ~(1 << (_x & UINT32_T_MASK));                        \
     })
 
 #define IMAGE_SET_BINARY_PIXEL(image, x, y)                                                                                              \
@@ -613,9 +648,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);                                                                                             \
         __typeof__ (x) _x = (x);                                                                                                         \
         __typeof__ (y) _y = (y);                                                                                                         \
-        ((uint32_t *) _image->data)[(((_image->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * _y) + (_x >> UINT32_T_SHIFT)] |= 1 <<             \
-                                                                                                                        (_x &            \
-                                                                                                                         UINT32_T_MASK); \
+        IMAGE_BINARY_ROW_PTR(_image, _y)[_x >> UINT32_T_SHIFT] |= 1 << (_x & UINT32_T_MASK);                                             \
     })
 
 #define IMAGE_GET_GRAYSCALE_PIXEL(image, x, y)             \
@@ -623,7 +656,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);               \
         __typeof__ (x) _x = (x);                           \
         __typeof__ (y) _y = (y);                           \
-        ((uint8_t *) _image->data)[(_image->w * _y) + _x]; \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y)[_x];           \
     })
 
 #define IMAGE_PUT_GRAYSCALE_PIXEL(image, x, y, v)               \
@@ -632,7 +665,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                \
         __typeof__ (y) _y = (y);                                \
         __typeof__ (v) _v = (v);                                \
-        ((uint8_t *) _image->data)[(_image->w * _y) + _x] = _v; \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y)[_x] = _v;           \
     })
 
 #define IMAGE_GET_RGB565_PIXEL(image, x, y)                 \
@@ -640,7 +673,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);                \
         __typeof__ (x) _x = (x);                            \
         __typeof__ (y) _y = (y);                            \
-        ((uint16_t *) _image->data)[(_image->w * _y) + _x]; \
+        IMAGE_RGB565_ROW_PTR(_image, _y)[_x];               \
     })
 
 #define IMAGE_PUT_RGB565_PIXEL(image, x, y, v)                   \
@@ -649,7 +682,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                 \
         __typeof__ (y) _y = (y);                                 \
         __typeof__ (v) _v = (v);                                 \
-        ((uint16_t *) _image->data)[(_image->w * _y) + _x] = _v; \
+        IMAGE_RGB565_ROW_PTR(_image, _y)[_x] = _v;               \
     })
 
 #define IMAGE_GET_YUV_PIXEL(image, x, y)                    \
@@ -657,7 +690,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);                \
         __typeof__ (x) _x = (x);                            \
         __typeof__ (y) _y = (y);                            \
-        ((uint16_t *) _image->data)[(_image->w * _y) + _x]; \
+        IMAGE_RGB565_ROW_PTR(_image, _y)[_x];               \
     })
 
 #define IMAGE_PUT_YUV_PIXEL(image, x, y, v)                      \
@@ -666,7 +699,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                 \
         __typeof__ (y) _y = (y);                                 \
         __typeof__ (v) _v = (v);                                 \
-        ((uint16_t *) _image->data)[(_image->w * _y) + _x] = _v; \
+        IMAGE_RGB565_ROW_PTR(_image, _y)[_x] = _v;               \
     })
 
 #define IMAGE_GET_BAYER_PIXEL(image, x, y)                 \
@@ -674,7 +707,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);               \
         __typeof__ (x) _x = (x);                           \
         __typeof__ (y) _y = (y);                           \
-        ((uint8_t *) _image->data)[(_image->w * _y) + _x]; \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y)[_x];           \
     })
 
 #define IMAGE_PUT_BAYER_PIXEL(image, x, y, v)                   \
@@ -683,30 +716,30 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                \
         __typeof__ (y) _y = (y);                                \
         __typeof__ (v) _v = (v);                                \
-        ((uint8_t *) _image->data)[(_image->w * _y) + _x] = _v; \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y)[_x] = _v;           \
     })
 
-#define IMAGE_GET_RGB888_PIXEL(image, x, y)                \
-    ({                                                     \
-        __typeof__ (image) _image = (image);               \
-        __typeof__ (x) _x = (x);                           \
-        __typeof__ (y) _y = (y);                           \
-        uint32_t offset = ((_image->w * _y) + _x) * 3;     \
-        (((uint8_t *) _image->data)[offset + 2] << 0) |    \
-        (((uint8_t *) _image->data)[offset + 1] << 8) |    \
-        (((uint8_t *) _image->data)[offset + 0] << 16)     \
+#define IMAGE_GET_RGB888_PIXEL(image, x, y)                        \
+    ({                                                             \
+        __typeof__ (image) _image = (image);                       \
+        __typeof__ (x) _x = (x);                                   \
+        __typeof__ (y) _y = (y);                                   \
+        uint8_t *_p = IMAGE_RGB888_ROW_PTR(_image, _y) + (_x * 3); \
+        (_p[2] << 0) |                                             \
+        (_p[1] << 8) |                                             \
+        (_p[0] << 16)                                              \
     })
 
-#define IMAGE_PUT_RGB888_PIXEL(image, x, y, v)                  \
-    ({                                                          \
-        __typeof__ (image) _image = (image);                    \
-        __typeof__ (x) _x = (x);                                \
-        __typeof__ (y) _y = (y);                                \
-        __typeof__ (v) _v = (v);                                \
-        uint32_t offset = ((_image->w * _y) + _x) * 3;          \
-        ((uint8_t *) _image->data)[offset + 2] = _v >> 0;       \
-        ((uint8_t *) _image->data)[offset + 1] = _v >> 8;       \
-        ((uint8_t *) _image->data)[offset + 0] = _v >> 16;      \
+#define IMAGE_PUT_RGB888_PIXEL(image, x, y, v)                     \
+    ({                                                             \
+        __typeof__ (image) _image = (image);                       \
+        __typeof__ (x) _x = (x);                                   \
+        __typeof__ (y) _y = (y);                                   \
+        __typeof__ (v) _v = (v);                                   \
+        uint8_t *_p = IMAGE_RGB888_ROW_PTR(_image, _y) + (_x * 3); \
+        _p[2] = _v >> 0;                                           \
+        _p[1] = _v >> 8;                                           \
+        _p[0] = _v >> 16;                                          \
     })
 
 #define IMAGE_GET_ARGB8888_PIXEL(image, x, y)              \
@@ -714,7 +747,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (image) _image = (image);               \
         __typeof__ (x) _x = (x);                           \
         __typeof__ (y) _y = (y);                           \
-        ((uint32_t *) _image->data)[(_image->w * _y) + _x];\
+        IMAGE_ARGB8888_ROW_PTR(_image, _y)[_x];            \
     })
 
 #define IMAGE_PUT_ARGB8888_PIXEL(image, x, y, v)                \
@@ -723,7 +756,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         __typeof__ (x) _x = (x);                                \
         __typeof__ (y) _y = (y);                                \
         __typeof__ (v) _v = (v);                                \
-        ((uint32_t *) _image->data)[(_image->w * _y) + _x] = _v;\
+        IMAGE_ARGB8888_ROW_PTR(_image, _y)[_x] = _v;            \
     })
 
 #define IMAGE_PUT_YUV420_PIXEL(image, x, y, v) \
@@ -737,7 +770,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
     ({                                                                                        \
         __typeof__ (image) _image = (image);                                                  \
         __typeof__ (y) _y = (y);                                                              \
-        ((uint32_t *) _image->data) + (((_image->w + UINT32_T_MASK) >> UINT32_T_SHIFT) * _y); \
+        IMAGE_BINARY_ROW_PTR(_image, _y);                                                     \
     })
 
 #define IMAGE_GET_BINARY_PIXEL_FAST(row_ptr, x)                       \
@@ -775,7 +808,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
     ({                                                  \
         __typeof__ (image) _image = (image);            \
         __typeof__ (y) _y = (y);                        \
-        ((uint8_t *) _image->data) + (_image->w * _y);  \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y);            \
     })
 
 #define IMAGE_GET_GRAYSCALE_PIXEL_FAST(row_ptr, x) \
@@ -797,7 +830,7 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
     ({                                                  \
         __typeof__ (image) _image = (image);            \
         __typeof__ (y) _y = (y);                        \
-        ((uint16_t *) _image->data) + (_image->w * _y); \
+        IMAGE_RGB565_ROW_PTR(_image, _y);               \
     })
 
 #define IMAGE_GET_RGB565_PIXEL_FAST(row_ptr, x)    \
@@ -815,18 +848,51 @@ bool image_get_mask_pixel(image_t *ptr, int x, int y);
         _row_ptr[_x] = _v;                         \
     })
 
+#define IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(image, y)    \
+    ({                                                  \
+        __typeof__ (image) _image = (image);            \
+        __typeof__ (y) _y = (y);                        \
+        IMAGE_RGB888_ROW_PTR(_image, _y);               \
+    })
+
+#define IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x)      \
+    ({                                               \
+        __typeof__ (row_ptr) _row_ptr = (row_ptr);   \
+        __typeof__ (x) _x = (x);                     \
+        uint8_t *_p = _row_ptr + (_x * 3);           \
+        (_p[0] << 16) | (_p[1] << 8) | (_p[2] << 0); \
+    })
+
+#define IMAGE_PUT_RGB888_PIXEL_FAST(row_ptr, x, v) \
+    ({                                             \
+        __typeof__ (row_ptr) _row_ptr = (row_ptr); \
+        __typeof__ (x) _x = (x);                   \
+        __typeof__ (v) _v = (v);                   \
+        uint8_t *_p = _row_ptr + (_x * 3);         \
+        _p[0] = _v >> 16;                          \
+        _p[1] = _v >> 8;                           \
+        _p[2] = _v >> 0;                           \
+    })
+
+#define IMAGE_COMPUTE_ARGB8888_PIXEL_ROW_PTR(image, y)  \
+    ({                                                  \
+        __typeof__ (image) _image = (image);            \
+        __typeof__ (y) _y = (y);                        \
+        IMAGE_ARGB8888_ROW_PTR(_image, _y);             \
+    })
+
 #define IMAGE_COMPUTE_BAYER_PIXEL_ROW_PTR(image, y)    \
     ({                                                 \
         __typeof__ (image) _image = (image);           \
         __typeof__ (y) _y = (y);                       \
-        ((uint8_t *) _image->data) + (_image->w * _y); \
+        IMAGE_GRAYSCALE_ROW_PTR(_image, _y);           \
     })
 
 #define IMAGE_COMPUTE_YUV_PIXEL_ROW_PTR(image, y)       \
     ({                                                  \
         __typeof__ (image) _image = (image);            \
         __typeof__ (y) _y = (y);                        \
-        ((uint16_t *) _image->data) + (_image->w * _y); \
+        IMAGE_RGB565_ROW_PTR(_image, _y);               \
     })
 
 // Old Image Macros - Will be refactor and removed. But, only after making sure through testing new macros work.
@@ -860,27 +926,27 @@ extern const int kernel_high_pass_3[9];
     ({ __typeof__ (img) _img = (img); \
        __typeof__ (x) _x = (x);       \
        __typeof__ (y) _y = (y);       \
-       ((uint8_t *) _img->pixels)[(_y * _img->w) + _x]; })
+       IMAGE_GRAYSCALE_ROW_PTR(_img, _y)[_x]; })
 
 #define IM_GET_RGB565_PIXEL(img, x, y) \
     ({ __typeof__ (img) _img = (img);  \
        __typeof__ (x) _x = (x);        \
        __typeof__ (y) _y = (y);        \
-       ((uint16_t *) _img->pixels)[(_y * _img->w) + _x]; })
+       IMAGE_RGB565_ROW_PTR(_img, _y)[_x]; })
 
 #define IM_SET_GS_PIXEL(img, x, y, p) \
     ({ __typeof__ (img) _img = (img); \
        __typeof__ (x) _x = (x);       \
        __typeof__ (y) _y = (y);       \
        __typeof__ (p) _p = (p);       \
-       ((uint8_t *) _img->pixels)[(_y * _img->w) + _x] = _p; })
+       IMAGE_GRAYSCALE_ROW_PTR(_img, _y)[_x] = _p; })
 
 #define IM_SET_RGB565_PIXEL(img, x, y, p) \
     ({ __typeof__ (img) _img = (img);     \
        __typeof__ (x) _x = (x);           \
        __typeof__ (y) _y = (y);           \
        __typeof__ (p) _p = (p);           \
-       ((uint16_t *) _img->pixels)[(_y * _img->w) + _x] = _p; })
+       IMAGE_RGB565_ROW_PTR(_img, _y)[_x] = _p; })
 
 #define IM_EQUAL(img0, img1)             \
     ({ __typeof__ (img0) _img0 = (img0); \
@@ -888,7 +954,7 @@ extern const int kernel_high_pass_3[9];
        (_img0->w == _img1->w) && (_img0->h == _img1->h) && (_img0->pixfmt = _img1->pixfmt); })
 
 #define IM_TO_GS_PIXEL(img, x, y) \
-    (img->bpp == 1 ? img->pixels[((y) * img->w) + (x)] : COLOR_RGB565_TO_Y(((uint16_t *) img->pixels)[((y) * img->w) + (x)]) )
+    (img->bpp == 1 ? IMAGE_GRAYSCALE_ROW_PTR(img, y)[x] : COLOR_RGB565_TO_Y(IMAGE_RGB565_ROW_PTR(img, y)[x]) )
 
 typedef struct simple_color {
     uint8_t G;          // Gray
@@ -1223,6 +1289,36 @@ void imlib_debayer_image(image_t *dst, image_t *src);
 void imlib_deyuv_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixformat_t pixfmt, image_t *src);
 void imlib_deyuv_image(image_t *dst, image_t *src);
 
+// Image to tensor conversion.
+typedef enum {
+    IMLIB_TENSOR_UINT8,
+    IMLIB_TENSOR_INT8,
+    IMLIB_TENSOR_FLOAT32
+} imlib_tensor_dtype_t;
+
+typedef struct imlib_tensor_params {
+    imlib_tensor_dtype_t dtype;
+    bool nhwc;
+    int w, h;           // Tensor width and height.
+    bool letterbox;     // Keep the aspect ratio and pad, otherwise stretch to w x h.
+    float mean[3];      // Per channel, output = (pixel - mean) / std.
+    float std[3];
+    uint8_t pad[3];     // Pixel value of the letterbox border, normalized like the image.
+    // Outputs.
+    int c;              // Channel count, 1 for grayscale sources, 3 (R, G, B) otherwise.
+    rectangle_t roi;    // Where the image landed inside the tensor.
+} imlib_tensor_params_t;
+
+bool imlib_tensor_supported(pixformat_t pixfmt);
+void imlib_to_tensor(image_t *src, void *dst, imlib_tensor_params_t *params);
+
+// Band-parallel execution. Bands cover rows [y_start, y_end) and must only write their own rows.
+typedef void (*imlib_band_func_t) (void *arg, int band, int y_start, int y_end);
+void imlib_set_threads(int n);
+int imlib_get_threads(void);
+int imlib_parallel_bands(int h, int min_rows);
+void imlib_parallel_for(int h, int bands, imlib_band_func_t func, void *arg);
+
 /* Color space functions */
 int8_t imlib_rgb565_to_l(uint16_t pixel);
 int8_t imlib_rgb565_to_a(uint16_t pixel);
@@ -1259,6 +1355,7 @@ void png_read(image_t *img, const char *path);
 void png_write(image_t *img, const char *path);
 bool imlib_read_geometry(FIL *fp, image_t *img, const char *path, img_read_settings_t *rs);
 void imlib_image_operation(image_t *img, const char *path, image_t *other, int scalar, line_op_t op, void *data);
+void imlib_image_parallel_operation(image_t *img, const char *path, image_t *other, int scalar, line_op_t op, void *data);
 void imlib_load_image(image_t *img, const char *path);
 void imlib_save_image(image_t *img, const char *path, rectangle_t *roi, int quality);
 
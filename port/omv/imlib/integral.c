@@ -25,27 +25,20 @@ void imlib_integral_image_free(i_image_t *sum) {
 }
 
 void imlib_integral_image(image_t *src, i_image_t *sum) {
+    image_assert_packed(src);
     typeof(*src->data) * img_data = src->data;
     typeof(*sum->data) * sum_data = sum->data;
 
-    // Compute first column to avoid branching
-    for (int s = 0, x = 0; x < src->w; x++) {
-        /* sum of the current row (integer) */
-        s += img_data[x];
-        sum_data[x] = s;
-    }
+    // Compute first row to avoid branching
+    imlib_integral_row(img_data, NULL, sum_data, src->w, false);
 
     for (int y = 1; y < src->h; y++) {
-        /* loop over the number of columns */
-        for (int s = 0, x = 0; x < src->w; x++) {
-            /* sum of the current row (integer) */
-            s += img_data[y * src->w + x];
-            sum_data[y * src->w + x] = s + sum_data[(y - 1) * src->w + x];
-        }
+        imlib_integral_row(img_data + (y * src->w), sum_data + ((y - 1) * src->w), sum_data + (y * src->w), src->w, false);
     }
 }
 
 void imlib_integral_image_scaled(image_t *src, i_image_t *sum) {
+    image_assert_packed(src);
     typeof(*src->data) * img_data = src->data;
     typeof(*sum->data) * sum_data = sum->data;
 
@@ -74,25 +67,16 @@ void imlib_integral_image_scaled(image_t *src, i_image_t *sum) {
 }
 
 void imlib_integral_image_sq(image_t *src, i_image_t *sum) {
+    image_assert_packed(src);
     typeof(*src->data) * img_data = src->data;
     typeof(*sum->data) * sum_data = sum->data;
 
-    // Compute first column to avoid branching
-    for (uint32_t s = 0, x = 0; x < src->w; x++) {
-        /* sum of the current row (integer) */
-        s += img_data[x] * img_data[x];
-        sum_data[x] = s;
-    }
+    // Compute first row to avoid branching
+    imlib_integral_row(img_data, NULL, sum_data, src->w, true);
 
-    for (uint32_t y = 1; y < src->h; y++) {
-        /* loop over the number of columns */
-        for (uint32_t s = 0, x = 0; x < src->w; x++) {
-            /* sum of the current row (integer) */
-            s += img_data[y * src->w + x] * img_data[y * src->w + x];
-            sum_data[y * src->w + x] = s + sum_data[(y - 1) * src->w + x];
-        }
+    for (int y = 1; y < src->h; y++) {
+        imlib_integral_row(img_data + (y * src->w), sum_data + ((y - 1) * src->w), sum_data + (y * src->w), src->w, true);
     }
-
 }
 
 uint32_t imlib_integral_lookup(i_image_t *sum, int x, int y, int w, int h) {
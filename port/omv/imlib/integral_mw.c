@@ -96,6 +96,7 @@ void imlib_integral_mw_scale(rectangle_t *roi, mw_image_t *sum, int w, int h) {
 }
 
 void imlib_integral_mw(image_t *src, mw_image_t *sum) {
+    image_assert_packed(src);
     // Image pointers
     typeof(*sum->data) * sum_data = sum->data;
 
@@ -129,6 +130,7 @@ void imlib_integral_mw(image_t *src, mw_image_t *sum) {
 }
 
 void imlib_integral_mw_sq(image_t *src, mw_image_t *sum) {
+    image_assert_packed(src);
     // Image pointers
     typeof(*sum->data) * sum_data = sum->data;
 
@@ -162,6 +164,7 @@ void imlib_integral_mw_sq(image_t *src, mw_image_t *sum) {
 }
 
 void imlib_integral_mw_shift(image_t *src, mw_image_t *sum, int n) {
+    image_assert_packed(src);
     // Shift integral image rows by n lines
     for (int y = 0; y < sum->h; y++) {
         sum->swap[y] = sum->data[(y + n) % sum->h];
@@ -191,6 +194,7 @@ void imlib_integral_mw_shift(image_t *src, mw_image_t *sum, int n) {
 }
 
 void imlib_integral_mw_shift_sq(image_t *src, mw_image_t *sum, int n) {
+    image_assert_packed(src);
     // Shift integral image rows by n lines
     for (int y = 0; y < sum->h; y++) {
         sum->swap[y] = sum->data[(y + n) % sum->h];
@@ -220,6 +224,7 @@ void imlib_integral_mw_shift_sq(image_t *src, mw_image_t *sum, int n) {
 }
 
 void imlib_integral_mw_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq, rectangle_t *roi) {
+    image_assert_packed(src);
     // Image data pointers
     typeof(*sum->data) * sum_data = sum->data;
     typeof(*sum->data) * ssq_data = ssq->data;
@@ -261,6 +266,7 @@ void imlib_integral_mw_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq, rectan
 }
 
 void imlib_integral_mw_shift_ss(image_t *src, mw_image_t *sum, mw_image_t *ssq, rectangle_t *roi, int n) {
+    image_assert_packed(src);
     // Shift integral image rows by n lines
     for (int y = 0; y < sum->h; y++) {
         sum->swap[y] = sum->data[(y + n) % sum->h];
@@ -713,6 +713,7 @@ static void imlib_rgb_max(image_t *img, uint32_t *r_out, uint32_t *g_out, uint32
 }
 
 void imlib_awb(image_t *img, bool max) {
+    image_assert_packed(img);
     uint32_t area = img->w * img->h;
     uint32_t r_out, g_out, b_out;
 
@@ -962,32 +963,21 @@ void imlib_awb(image_t *img, bool max) {
     }
 }
 
-void imlib_ccm(image_t *img, float *ccm, bool offset) {
-    float rr = ccm[0], rg = ccm[3], rb = ccm[6], ro = 0.f;
-    float gr = ccm[1], gg = ccm[4], gb = ccm[7], go = 0.f;
-    float br = ccm[2], bg = ccm[5], bb = ccm[8], bo = 0.f;
-
-    if (offset) {
-        ro = ccm[9];
-        go = ccm[10];
-        bo = ccm[11];
-    }
-
-    int i_rr = IM_MIN(fast_roundf(rr * 64), 1024);
-    int i_rg = IM_MIN(fast_roundf(rg * 32), 512);
-    int i_rb = IM_MIN(fast_roundf(rb * 64), 1024);
-
-    int i_gr = IM_MIN(fast_roundf(gr * 64), 1024);
-    int i_gg = IM_MIN(fast_roundf(gg * 32), 512);
-    int i_gb = IM_MIN(fast_roundf(gb * 64), 1024);
-
-    int i_br = IM_MIN(fast_roundf(br * 64), 1024);
-    int i_bg = IM_MIN(fast_roundf(bg * 32), 512);
-    int i_bb = IM_MIN(fast_roundf(bb * 64), 1024);
-
-    int i_ro = IM_MIN(fast_roundf(ro * 64), 1024);
-    int i_go = IM_MIN(fast_roundf(go * 32), 512);
-    int i_bo = IM_MIN(fast_roundf(bo * 64), 1024);
+typedef struct imlib_ccm_band {
+    image_t *img;
+    bool offset;
+    int i_rr, i_rg, i_rb, i_ro;
+    int i_gr, i_gg, i_gb, i_go;
+    int i_br, i_bg, i_bb, i_bo;
+} imlib_ccm_band_t;
+
+static void imlib_ccm_band(void *arg, int band, int y_start, int y_end) {
+    imlib_ccm_band_t *state = (imlib_ccm_band_t *) arg;
+    image_t *img = state->img;
+    bool offset = state->offset;
+    int i_rr = state->i_rr, i_rg = state->i_rg, i_rb = state->i_rb, i_ro = state->i_ro;
+    int i_gr = state->i_gr, i_gg = state->i_gg, i_gb = state->i_gb, i_go = state->i_go;
+    int i_br = state->i_br, i_bg = state->i_bg, i_bb = state->i_bb, i_bo = state->i_bo;
 
     #if defined(ARM_MATH_DSP)
     long smuad_rr_rb = __PKHBT(i_rb, i_rr, 16);
@@ -997,8 +987,8 @@ void imlib_ccm(image_t *img, float *ccm, bool offset) {
 
     switch (img->pixfmt) {
         case PIXFORMAT_RGB565: {
-            uint16_t *ptr = (uint16_t *) img->data;
-            long n = img->w * img->h; // must be signed for count down loop
+            uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y_start);
+            long n = img->w * (y_end - y_start); // must be signed for count down loop
 
             if (offset) {
                 for (; n > 0; n -= 1) {
@@ -1048,8 +1038,112 @@ void imlib_ccm(image_t *img, float *ccm, bool offset) {
     }
 }
 
+void imlib_ccm(image_t *img, float *ccm, bool offset) {
+    image_assert_packed(img);
+    float rr = ccm[0], rg = ccm[3], rb = ccm[6], ro = 0.f;
+    float gr = ccm[1], gg = ccm[4], gb = ccm[7], go = 0.f;
+    float br = ccm[2], bg = ccm[5], bb = ccm[8], bo = 0.f;
+
+    if (offset) {
+        ro = ccm[9];
+        go = ccm[10];
+        bo = ccm[11];
+    }
+
+    int i_rr = IM_MIN(fast_roundf(rr * 64), 1024);
+    int i_rg = IM_MIN(fast_roundf(rg * 32), 512);
+    int i_rb = IM_MIN(fast_roundf(rb * 64), 1024);
+
+    int i_gr = IM_MIN(fast_roundf(gr * 64), 1024);
+    int i_gg = IM_MIN(fast_roundf(gg * 32), 512);
+    int i_gb = IM_MIN(fast_roundf(gb * 64), 1024);
+
+    int i_br = IM_MIN(fast_roundf(br * 64), 1024);
+    int i_bg = IM_MIN(fast_roundf(bg * 32), 512);
+    int i_bb = IM_MIN(fast_roundf(bb * 64), 1024);
+
+    int i_ro = IM_MIN(fast_roundf(ro * 64), 1024);
+    int i_go = IM_MIN(fast_roundf(go * 32), 512);
+    int i_bo = IM_MIN(fast_roundf(bo * 64), 1024);
+
+    imlib_ccm_band_t state = {
+        .img = img,
+        .offset = offset,
+        .i_rr = i_rr, .i_rg = i_rg, .i_rb = i_rb, .i_ro = i_ro,
+        .i_gr = i_gr, .i_gg = i_gg, .i_gb = i_gb, .i_go = i_go,
+        .i_br = i_br, .i_bg = i_bg, .i_bb = i_bb, .i_bo = i_bo
+    };
+
+    imlib_parallel_for(img->h, imlib_parallel_bands(img->h, 8), imlib_ccm_band, &state);
+}
+
+typedef struct imlib_gamma_band {
+    image_t *img;
+    int *p_lut, *r_lut, *g_lut, *b_lut;
+} imlib_gamma_band_t;
+
+static void imlib_gamma_band(void *arg, int band, int y_start, int y_end) {
+    imlib_gamma_band_t *state = (imlib_gamma_band_t *) arg;
+    image_t *img = state->img;
+
+    switch (img->pixfmt) {
+        case PIXFORMAT_BINARY: {
+            int *p_lut = state->p_lut;
+
+            for (int y = y_start; y < y_end; y++) {
+                uint32_t *data = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
+                for (int x = 0, xx = img->w; x < xx; x++) {
+                    int dataPixel = IMAGE_GET_BINARY_PIXEL_FAST(data, x);
+                    int p = p_lut[dataPixel];
+                    IMAGE_PUT_BINARY_PIXEL_FAST(data, x, p);
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_GRAYSCALE:
+        case PIXFORMAT_BAYER_ANY:
+        case PIXFORMAT_YUV_ANY: {
+            int *p_lut = state->p_lut;
+            uint8_t *ptr = ((uint8_t *) img->data) + (img->w * img->bpp * y_start);
+            int n = img->w * (y_end - y_start);
+
+            if (img->bpp == 2) {
+                for (; n > 0; n--, ptr += 2) {
+                    *ptr = p_lut[*ptr];
+                }
+            } else {
+                for (; n > 0; n--, ptr += 1) {
+                    *ptr = p_lut[*ptr];
+                }
+            }
+            break;
+        }
+        case PIXFORMAT_RGB565: {
+            int *r_lut = state->r_lut, *g_lut = state->g_lut, *b_lut = state->b_lut;
+            uint16_t *ptr = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y_start);
+            int n = img->w * (y_end - y_start);
+
+            for (; n > 0; n--) {
+                int dataPixel = *ptr;
+                int r = r_lut[COLOR_RGB565_TO_R5(dataPixel)];
+                int g = g_lut[COLOR_RGB565_TO_G6(dataPixel)];
+                int b = b_lut[COLOR_RGB565_TO_B5(dataPixel)];
+                *ptr++ = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
 void imlib_gamma(image_t *img, float gamma, float contrast, float brightness) {
+    image_assert_packed(img);
     gamma = IM_DIV(1.0, gamma);
+    imlib_gamma_band_t state = { .img = img };
+    int bands = imlib_parallel_bands(img->h, 8);
+
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
             float pScale = COLOR_BINARY_MAX - COLOR_BINARY_MIN;
@@ -1061,15 +1155,8 @@ void imlib_gamma(image_t *img, float gamma, float contrast, float brightness) {
                 p_lut[i] = IM_MIN(IM_MAX(p, COLOR_BINARY_MIN), COLOR_BINARY_MAX);
             }
 
-            for (int y = 0, yy = img->h; y < yy; y++) {
-                uint32_t *data = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
-                for (int x = 0, xx = img->w; x < xx; x++) {
-                    int dataPixel = IMAGE_GET_BINARY_PIXEL_FAST(data, x);
-                    int p = p_lut[dataPixel];
-                    IMAGE_PUT_BINARY_PIXEL_FAST(data, x, p);
-                }
-            }
-
+            state.p_lut = p_lut;
+            imlib_parallel_for(img->h, bands, imlib_gamma_band, &state);
             fb_free();
             break;
         }
@@ -1085,19 +1172,8 @@ void imlib_gamma(image_t *img, float gamma, float contrast, float brightness) {
                 p_lut[i] = IM_MIN(IM_MAX(p, COLOR_GRAYSCALE_MIN), COLOR_GRAYSCALE_MAX);
             }
 
-            uint8_t *ptr = (uint8_t *) img->data;
-            int n = img->w * img->h;
-
-            if (img->bpp == 2) {
-                for (; n > 0; n--, ptr += 2) {
-                    *ptr = p_lut[*ptr];
-                }
-            } else {
-                for (; n > 0; n--, ptr += 1) {
-                    *ptr = p_lut[*ptr];
-                }
-            }
-
+            state.p_lut = p_lut;
+            imlib_parallel_for(img->h, bands, imlib_gamma_band, &state);
             fb_free();
             break;
         }
@@ -1127,17 +1203,10 @@ void imlib_gamma(image_t *img, float gamma, float contrast, float brightness) {
                 b_lut[i] = IM_MIN(IM_MAX(b, COLOR_B5_MIN), COLOR_B5_MAX);
             }
 
-            uint16_t *ptr = (uint16_t *) img->data;
-            int n = img->w * img->h;
-
-            for (; n > 0; n--) {
-                int dataPixel = *ptr;
-                int r = r_lut[COLOR_RGB565_TO_R5(dataPixel)];
-                int g = g_lut[COLOR_RGB565_TO_G6(dataPixel)];
-                int b = b_lut[COLOR_RGB565_TO_B5(dataPixel)];
-                *ptr++ = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
-            }
-
+            state.r_lut = r_lut;
+            state.g_lut = g_lut;
+            state.b_lut = b_lut;
+            imlib_parallel_for(img->h, bands, imlib_gamma_band, &state);
             fb_free();
             fb_free();
             fb_free();
@@ -52,6 +52,7 @@ const static uint8_t uniform_tbl[256] = {
 };
 
 uint8_t *imlib_lbp_desc(image_t *image, rectangle_t *roi) {
+    image_assert_packed(image);
     int s = image->w; //stride
     int RX = roi->w / LBP_NUM_REGIONS;
     int RY = roi->h / LBP_NUM_REGIONS;
@@ -2694,7 +2694,7 @@ void imlib_lsd_find_line_segments(list_t *out,
                                   unsigned int max_theta_diff) {
     uint8_t *grayscale_image = fb_alloc(roi->w * roi->h, FB_ALLOC_NO_HINT);
 
-    image_t img;
+    image_t img = {};
     img.w = roi->w;
     img.h = roi->h;
     img.pixfmt = PIXFORMAT_GRAYSCALE;
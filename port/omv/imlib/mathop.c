@@ -11,10 +11,12 @@
 #include "imlib.h"
 
 #ifdef IMLIB_ENABLE_MATH_OPS
-void imlib_negate(image_t *img) {
+static void imlib_negate_band(void *arg, int band, int y_start, int y_end) {
+    image_t *img = (image_t *) arg;
+
     switch (img->pixfmt) {
         case PIXFORMAT_BINARY: {
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 uint32_t *data = IMAGE_COMPUTE_BINARY_PIXEL_ROW_PTR(img, y);
                 int x = 0, xx = img->w;
                 uint32_t *s = data;
@@ -32,7 +34,7 @@ void imlib_negate(image_t *img) {
             break;
         }
         case PIXFORMAT_GRAYSCALE: {
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, y);
                 int x = 0, xx = img->w;
                 uint32_t a, b, *s = (uint32_t *) data;
@@ -51,7 +53,7 @@ void imlib_negate(image_t *img) {
             break;
         }
         case PIXFORMAT_RGB565: {
-            for (int y = 0, yy = img->h; y < yy; y++) {
+            for (int y = y_start; y < y_end; y++) {
                 uint16_t *data = IMAGE_COMPUTE_RGB565_PIXEL_ROW_PTR(img, y);
                 for (int x = 0, xx = img->w; x < xx; x++) {
                     int dataPixel = IMAGE_GET_RGB565_PIXEL_FAST(data, x);
@@ -66,6 +68,10 @@ void imlib_negate(image_t *img) {
     }
 }
 
+void imlib_negate(image_t *img) {
+    imlib_parallel_for(img->h, imlib_parallel_bands(img->h, 8), imlib_negate_band, img);
+}
+
 typedef struct imlib_replace_line_op_state {
     bool hmirror, vflip, transpose;
     image_t *mask;
@@ -138,13 +144,14 @@ void imlib_replace(image_t *img,
                    bool vflip,
                    bool transpose,
                    image_t *mask) {
-    bool in_place = img->data == other->data;
+    bool in_place = image_overlaps(img, other);
     image_t temp;
 
     if (in_place) {
         memcpy(&temp, other, sizeof(image_t));
+        temp.stride = 0;
         temp.data = fb_alloc(image_size(&temp), FB_ALLOC_NO_HINT);
-        memcpy(temp.data, other->data, image_size(&temp));
+        image_copy_pixels(temp.data, other);
         other = &temp;
     }
 
@@ -186,6 +193,11 @@ static void imlib_add_line_op(image_t *img, int line, void *other, void *data, b
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            if (!mask) {
+                imlib_add_u8_row(data, (uint8_t *) other, img->w);
+                break;
+            }
+
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
                     int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
@@ -221,7 +233,7 @@ static void imlib_add_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_add(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_add_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_add_line_op, mask);
 }
 
 typedef struct imlib_sub_line_op_state {
@@ -249,6 +261,11 @@ static void imlib_sub_line_op(image_t *img, int line, void *other, void *data, b
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            if (!mask) {
+                imlib_sub_u8_row(data, (uint8_t *) other, img->w, reverse);
+                break;
+            }
+
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
                     int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
@@ -293,7 +310,7 @@ void imlib_sub(image_t *img, const char *path, image_t *other, int scalar, bool
     imlib_sub_line_op_state_t state;
     state.reverse = reverse;
     state.mask = mask;
-    imlib_image_operation(img, path, other, scalar, imlib_sub_line_op, &state);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_sub_line_op, &state);
 }
 
 typedef struct imlib_mul_line_op_state {
@@ -375,7 +392,7 @@ void imlib_mul(image_t *img, const char *path, image_t *other, int scalar, bool
     imlib_mul_line_op_state_t state;
     state.invert = invert;
     state.mask = mask;
-    imlib_image_operation(img, path, other, scalar, imlib_mul_line_op, &state);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_mul_line_op, &state);
 }
 
 typedef struct imlib_div_line_op_state {
@@ -464,7 +481,7 @@ void imlib_div(image_t *img, const char *path, image_t *other, int scalar, bool
     state.invert = invert;
     state.mod = mod;
     state.mask = mask;
-    imlib_image_operation(img, path, other, scalar, imlib_div_line_op, &state);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_div_line_op, &state);
 }
 
 static void imlib_min_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -485,6 +502,11 @@ static void imlib_min_line_op(image_t *img, int line, void *other, void *data, b
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            if (!mask) {
+                imlib_min_u8_row(data, (uint8_t *) other, img->w);
+                break;
+            }
+
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
                     int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
@@ -516,7 +538,7 @@ static void imlib_min_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_min(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_min_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_min_line_op, mask);
 }
 
 static void imlib_max_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -537,6 +559,11 @@ static void imlib_max_line_op(image_t *img, int line, void *other, void *data, b
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            if (!mask) {
+                imlib_max_u8_row(data, (uint8_t *) other, img->w);
+                break;
+            }
+
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
                     int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
@@ -568,7 +595,7 @@ static void imlib_max_line_op(image_t *img, int line, void *other, void *data, b
 }
 
 void imlib_max(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_max_line_op, mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_max_line_op, mask);
 }
 
 static void imlib_difference_line_op(image_t *img, int line, void *other, void *data, bool vflipped) {
@@ -589,6 +616,11 @@ static void imlib_difference_line_op(image_t *img, int line, void *other, void *
         }
         case PIXFORMAT_GRAYSCALE: {
             uint8_t *data = IMAGE_COMPUTE_GRAYSCALE_PIXEL_ROW_PTR(img, line);
+            if (!mask) {
+                imlib_difference_u8_row(data, (uint8_t *) other, img->w);
+                break;
+            }
+
             for (int i = 0, j = img->w; i < j; i++) {
                 if ((!mask) || image_get_mask_pixel(mask, i, line)) {
                     int dataPixel = IMAGE_GET_GRAYSCALE_PIXEL_FAST(data, i);
@@ -620,7 +652,7 @@ static void imlib_difference_line_op(image_t *img, int line, void *other, void *
 }
 
 void imlib_difference(image_t *img, const char *path, image_t *other, int scalar, image_t *mask) {
-    imlib_image_operation(img, path, other, scalar, imlib_difference_line_op,  mask);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_difference_line_op,  mask);
 }
 
 typedef struct imlib_blend_line_op_state {
@@ -681,6 +713,6 @@ void imlib_blend(image_t *img, const char *path, image_t *other, int scalar, flo
     imlib_blend_line_op_t state;
     state.alpha = alpha;
     state.mask = mask;
-    imlib_image_operation(img, path, other, scalar, imlib_blend_line_op, &state);
+    imlib_image_parallel_operation(img, path, other, scalar, imlib_blend_line_op, &state);
 }
 #endif //IMLIB_ENABLE_MATH_OPS
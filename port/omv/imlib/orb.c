@@ -376,6 +376,7 @@ static void image_scale(image_t *src, image_t *dst) {
 
 array_t *orb_find_keypoints(image_t *img, bool normalized, int threshold,
                             float scale_factor, int max_keypoints, corner_detector_t corner_detector, rectangle_t *roi) {
+    image_assert_packed(img);
     array_t *kpts;
     array_alloc(&kpts, xfree);
 
@@ -0,0 +1,158 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Band-parallel execution of row-local image operations.
+ *
+ * An image is split into a fixed set of horizontal bands which depend only on
+ * the image height and the band count. Bands are handed out to a small pool of
+ * worker threads (the calling thread works too) and each band writes only its
+ * own rows, so the output is bit-identical to running the bands one after the
+ * other no matter which thread ends up processing which band.
+ *
+ * Band functions run outside of the MicroPython VM: they must not allocate
+ * from the GC heap, call fb_alloc()/fb_free() or raise exceptions. Any scratch
+ * memory a band needs has to be allocated by the caller before dispatching.
+ */
+#include <pthread.h>
+#include "imlib.h"
+
+#ifndef IMLIB_PARALLEL_MAX_THREADS
+#define IMLIB_PARALLEL_MAX_THREADS    (8)
+#endif
+
+#ifndef IMLIB_PARALLEL_STACK_SIZE
+#define IMLIB_PARALLEL_STACK_SIZE     (16 * 1024)
+#endif
+
+typedef struct imlib_pool {
+    pthread_mutex_t run_lock; // Serializes dispatches.
+    pthread_mutex_t lock;     // Protects everything below.
+    pthread_cond_t work_cond;
+    pthread_cond_t done_cond;
+    pthread_t workers[IMLIB_PARALLEL_MAX_THREADS - 1];
+    int n_workers;
+    int threads;
+    // Current job.
+    imlib_band_func_t func;
+    void *arg;
+    int h;
+    int bands;
+    int next_band;
+    int pending;
+} imlib_pool_t;
+
+static imlib_pool_t pool = {
+    .run_lock = PTHREAD_MUTEX_INITIALIZER,
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .work_cond = PTHREAD_COND_INITIALIZER,
+    .done_cond = PTHREAD_COND_INITIALIZER,
+    .threads = 1,
+};
+
+// Runs bands of the current job until none are left. Called with pool.lock held.
+static void imlib_pool_drain(void) {
+    while (pool.next_band < pool.bands) {
+        int band = pool.next_band++;
+        imlib_band_func_t func = pool.func;
+        void *arg = pool.arg;
+        int y_start = (pool.h * band) / pool.bands;
+        int y_end = (pool.h * (band + 1)) / pool.bands;
+
+        pthread_mutex_unlock(&pool.lock);
+        func(arg, band, y_start, y_end);
+        pthread_mutex_lock(&pool.lock);
+
+        if (!--pool.pending) {
+            pthread_cond_signal(&pool.done_cond);
+        }
+    }
+}
+
+static void *imlib_pool_worker(void *unused) {
+    pthread_mutex_lock(&pool.lock);
+
+    for (;;) {
+        while (pool.next_band >= pool.bands) {
+            pthread_cond_wait(&pool.work_cond, &pool.lock);
+        }
+
+        imlib_pool_drain();
+    }
+
+    return NULL;
+}
+
+static void imlib_pool_spawn(int n_workers) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, IMLIB_PARALLEL_STACK_SIZE);
+
+    while (pool.n_workers < n_workers) {
+        if (pthread_create(&pool.workers[pool.n_workers], &attr, imlib_pool_worker, NULL)) {
+            // Run with the workers we have. The output does not depend on it.
+            break;
+        }
+        pthread_detach(pool.workers[pool.n_workers++]);
+    }
+
+    pthread_attr_destroy(&attr);
+}
+
+void imlib_set_threads(int n) {
+    pthread_mutex_lock(&pool.lock);
+    pool.threads = IM_MIN(IM_MAX(n, 1), IMLIB_PARALLEL_MAX_THREADS);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+int imlib_get_threads(void) {
+    return pool.threads;
+}
+
+int imlib_parallel_bands(int h, int min_rows) {
+    int bands = h / IM_MAX(min_rows, 1);
+    return IM_MIN(IM_MAX(bands, 1), pool.threads);
+}
+
+void imlib_parallel_for(int h, int bands, imlib_band_func_t func, void *arg) {
+    bands = IM_MIN(bands, h);
+
+    if (bands <= 1) {
+        if (h > 0) {
+            func(arg, 0, 0, h);
+        }
+        return;
+    }
+
+    // A dispatch from another thread (or from inside a band) is already using
+    // the pool. Run the same bands inline instead of waiting on it.
+    if (pthread_mutex_trylock(&pool.run_lock)) {
+        for (int band = 0; band < bands; band++) {
+            func(arg, band, (h * band) / bands, (h * (band + 1)) / bands);
+        }
+        return;
+    }
+
+    pthread_mutex_lock(&pool.lock);
+    imlib_pool_spawn(IM_MIN(bands, pool.threads) - 1);
+    pool.func = func;
+    pool.arg = arg;
+    pool.h = h;
+    pool.bands = bands;
+    pool.next_band = 0;
+    pool.pending = bands;
+    pthread_cond_broadcast(&pool.work_cond);
+
+    imlib_pool_drain();
+
+    while (pool.pending) {
+        pthread_cond_wait(&pool.done_cond, &pool.lock);
+    }
+
+    pthread_mutex_unlock(&pool.lock);
+    pthread_mutex_unlock(&pool.run_lock);
+}
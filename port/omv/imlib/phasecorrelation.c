@@ -15,6 +15,7 @@
 #define isinff __builtin_isinff
 
 void imlib_logpolar_int(image_t *dst, image_t *src, rectangle_t *roi, bool linear, bool reverse) {
+    image_assert_packed(src);
     int w = roi->w; // == dst_w
     int h = roi->h; // == dst_h
     int w_2 = w / 2;
@@ -243,7 +244,8 @@ void imlib_logpolar_int(image_t *dst, image_t *src, rectangle_t *roi, bool linea
 
 #if defined(IMLIB_ENABLE_LOGPOLAR) || defined(IMLIB_ENABLE_LINPOLAR)
 void imlib_logpolar(image_t *img, bool linear, bool reverse) {
-    image_t img_2;
+    image_assert_packed(img);
+    image_t img_2 = {};
     img_2.w = img->w;
     img_2.h = img->h;
     img_2.pixfmt = img->pixfmt;
@@ -278,6 +280,8 @@ void imlib_phasecorrelate(image_t *img0,
                           float *rotation,
                           float *scale,
                           float *response) {
+    image_assert_packed(img0);
+    image_assert_packed(img1);
     // Step 1 - Get Rotation/Scale Differences
     if ((!logpolar) && fix_rotation_scale) {
         fft2d_controller_t fft0, fft1;
@@ -420,7 +424,7 @@ void imlib_phasecorrelate(image_t *img0,
         *scale = 0;
     }
 
-    image_t img0_fixed;
+    image_t img0_fixed = {};
     rectangle_t roi0_fixed;
 
     // Step 2 - Fix Rotation/Scale Differences
@@ -478,7 +482,7 @@ void imlib_phasecorrelate(image_t *img0,
 
     // Step 3 - Get Translation Differences
     {
-        image_t img0alt, img1alt;
+        image_t img0alt = {}, img1alt = {};
         rectangle_t roi0alt, roi1alt;
 
         if (logpolar) {
@@ -96,6 +96,7 @@ unsigned lodepng_convert_cb(unsigned char *out, const unsigned char *in,
 
 #if defined(IMLIB_ENABLE_PNG_ENCODER)
 bool png_compress(image_t *src, image_t *dst) {
+    image_assert_packed(src);
     #if (TIME_PNG == 1)
     mp_uint_t start = mp_hal_ticks_ms();
     #endif
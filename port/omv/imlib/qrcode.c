@@ -3057,7 +3057,7 @@ void imlib_find_qrcodes(list_t *out, image_t *ptr, rectangle_t *roi)
 
     uint8_t *grayscale_image = quirc_begin(controller, NULL, NULL);
 
-    image_t img;
+    image_t img = {};
     img.w = roi->w;
     img.h = roi->h;
     img.pixfmt = PIXFORMAT_GRAYSCALE;
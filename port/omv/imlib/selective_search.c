@@ -196,6 +196,7 @@ static void image_scale(image_t *src, image_t *dst) {
 }
 
 array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, float a2, float a3) {
+    image_assert_packed(src);
     int i, j;
     int num = 0;
     int width = 0, height = 0;
@@ -214,6 +215,8 @@ array_t *imlib_selective_search(image_t *src, float t, int min_size, float a1, f
         img = fb_alloc(sizeof(image_t), FB_ALLOC_NO_HINT);
         img->w = width;
         img->h = height;
+        img->pixfmt = PIXFORMAT_RGB565;
+        img->stride = 0;
         img->pixels = fb_alloc(width * height * 2, FB_ALLOC_NO_HINT);
         image_scale(src, img);
     }
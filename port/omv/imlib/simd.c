@@ -0,0 +1,371 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Row kernels for the hot imlib loops.
+ *
+ * Every kernel has a scalar reference implementation and, when IMLIB_ENABLE_RVV
+ * is defined (RVV 1.0 intrinsics available), a RISC-V Vector implementation that
+ * produces exactly the same output. Kernels are strip-mined with vsetvl so they
+ * take any n and any vector length.
+ *
+ * Only simd.h is included so the scalar path can be checked on a host against
+ * the per-pixel loops it replaced, see host/simd_test.c.
+ */
+#include <math.h>
+#include <stdlib.h>
+#include "simd.h"
+
+#if defined(IMLIB_ENABLE_RVV)
+#include <riscv_vector.h>
+#endif
+
+void imlib_rgb565_to_y_row(const uint16_t *src, uint8_t *dst, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e16m2(n);
+        vuint16m2_t pixel = __riscv_vle16_v_u16m2(src, vl);
+        vuint16m2_t r = __riscv_vand_vx_u16m2(__riscv_vsrl_vx_u16m2(pixel, 8, vl), 0xF8, vl);
+        vuint16m2_t g = __riscv_vand_vx_u16m2(__riscv_vsrl_vx_u16m2(pixel, 3, vl), 0xFC, vl);
+        vuint16m2_t b = __riscv_vand_vx_u16m2(__riscv_vsll_vx_u16m2(pixel, 3, vl), 0xF8, vl);
+        r = __riscv_vor_vv_u16m2(r, __riscv_vsrl_vx_u16m2(r, 5, vl), vl);
+        g = __riscv_vor_vv_u16m2(g, __riscv_vsrl_vx_u16m2(g, 6, vl), vl);
+        b = __riscv_vor_vv_u16m2(b, __riscv_vsrl_vx_u16m2(b, 5, vl), vl);
+        // (r * 38) + (g * 75) + (b * 15) <= 32640, fits in 16 bits.
+        vuint16m2_t y = __riscv_vmul_vx_u16m2(r, 38, vl);
+        y = __riscv_vmacc_vx_u16m2(y, 75, g, vl);
+        y = __riscv_vmacc_vx_u16m2(y, 15, b, vl);
+        __riscv_vse8_v_u8m1(dst, __riscv_vnsrl_wx_u8m1(y, 7, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        int pixel = src[i];
+        int r = (pixel >> 8) & 0xF8;
+        int g = (pixel >> 3) & 0xFC;
+        int b = (pixel << 3) & 0xF8;
+        r |= r >> 5;
+        g |= g >> 6;
+        b |= b >> 5;
+        dst[i] = ((r * 38) + (g * 75) + (b * 15)) >> 7;
+    }
+    #endif
+}
+
+void imlib_argb8888_to_y_row(const uint32_t *src, uint8_t *dst, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e32m4(n);
+        vuint32m4_t pixel = __riscv_vle32_v_u32m4(src, vl);
+        vuint32m4_t r = __riscv_vand_vx_u32m4(__riscv_vsrl_vx_u32m4(pixel, 16, vl), 0xFF, vl);
+        vuint32m4_t g = __riscv_vand_vx_u32m4(__riscv_vsrl_vx_u32m4(pixel, 8, vl), 0xFF, vl);
+        vuint32m4_t b = __riscv_vand_vx_u32m4(pixel, 0xFF, vl);
+        vuint32m4_t y = __riscv_vmul_vx_u32m4(r, 38, vl);
+        y = __riscv_vmacc_vx_u32m4(y, 75, g, vl);
+        y = __riscv_vmacc_vx_u32m4(y, 15, b, vl);
+        vuint16m2_t y16 = __riscv_vnsrl_wx_u16m2(y, 7, vl);
+        __riscv_vse8_v_u8m1(dst, __riscv_vnsrl_wx_u8m1(y16, 0, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        uint32_t pixel = src[i];
+        dst[i] = ((((pixel >> 16) & 0xFF) * 38) + (((pixel >> 8) & 0xFF) * 75) + ((pixel & 0xFF) * 15)) >> 7;
+    }
+    #endif
+}
+
+void imlib_yuv422_to_y_row(const uint16_t *src, uint8_t *dst, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e16m2(n);
+        __riscv_vse8_v_u8m1(dst, __riscv_vnsrl_wx_u8m1(__riscv_vle16_v_u16m2(src, vl), 0, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = src[i] & 0xFF;
+    }
+    #endif
+}
+
+void imlib_add_u8_row(uint8_t *dst, const uint8_t *src, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        vuint8m4_t a = __riscv_vle8_v_u8m4(dst, vl);
+        vuint8m4_t b = __riscv_vle8_v_u8m4(src, vl);
+        __riscv_vse8_v_u8m4(dst, __riscv_vsaddu_vv_u8m4(a, b, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        int p = dst[i] + src[i];
+        dst[i] = (p > 255) ? 255 : p;
+    }
+    #endif
+}
+
+void imlib_sub_u8_row(uint8_t *dst, const uint8_t *src, int n, bool reverse) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        vuint8m4_t a = __riscv_vle8_v_u8m4(dst, vl);
+        vuint8m4_t b = __riscv_vle8_v_u8m4(src, vl);
+        __riscv_vse8_v_u8m4(dst, reverse ? __riscv_vssubu_vv_u8m4(b, a, vl) : __riscv_vssubu_vv_u8m4(a, b, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        int p = reverse ? (src[i] - dst[i]) : (dst[i] - src[i]);
+        dst[i] = (p < 0) ? 0 : p;
+    }
+    #endif
+}
+
+void imlib_min_u8_row(uint8_t *dst, const uint8_t *src, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        vuint8m4_t a = __riscv_vle8_v_u8m4(dst, vl);
+        vuint8m4_t b = __riscv_vle8_v_u8m4(src, vl);
+        __riscv_vse8_v_u8m4(dst, __riscv_vminu_vv_u8m4(a, b, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = (dst[i] < src[i]) ? dst[i] : src[i];
+    }
+    #endif
+}
+
+void imlib_max_u8_row(uint8_t *dst, const uint8_t *src, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        vuint8m4_t a = __riscv_vle8_v_u8m4(dst, vl);
+        vuint8m4_t b = __riscv_vle8_v_u8m4(src, vl);
+        __riscv_vse8_v_u8m4(dst, __riscv_vmaxu_vv_u8m4(a, b, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = (dst[i] > src[i]) ? dst[i] : src[i];
+    }
+    #endif
+}
+
+void imlib_difference_u8_row(uint8_t *dst, const uint8_t *src, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        vuint8m4_t a = __riscv_vle8_v_u8m4(dst, vl);
+        vuint8m4_t b = __riscv_vle8_v_u8m4(src, vl);
+        vuint8m4_t hi = __riscv_vmaxu_vv_u8m4(a, b, vl);
+        vuint8m4_t lo = __riscv_vminu_vv_u8m4(a, b, vl);
+        __riscv_vse8_v_u8m4(dst, __riscv_vsub_vv_u8m4(hi, lo, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = abs(dst[i] - src[i]);
+    }
+    #endif
+}
+
+void imlib_sepconv3_v_row(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2,
+                          const int8_t *krn, int *dst, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, r0 += vl, r1 += vl, r2 += vl, dst += vl) {
+        vl = __riscv_vsetvl_e16m2(n);
+        vint16m2_t p0 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(r0, vl), vl));
+        vint16m2_t p1 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(r1, vl), vl));
+        vint16m2_t p2 = __riscv_vreinterpret_v_u16m2_i16m2(__riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(r2, vl), vl));
+        vint32m4_t acc = __riscv_vwmul_vx_i32m4(p0, krn[0], vl);
+        acc = __riscv_vwmacc_vx_i32m4(acc, krn[1], p1, vl);
+        acc = __riscv_vwmacc_vx_i32m4(acc, krn[2], p2, vl);
+        __riscv_vse32_v_i32m4(dst, acc, vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = (krn[0] * r0[i]) + (krn[1] * r1[i]) + (krn[2] * r2[i]);
+    }
+    #endif
+}
+
+#if defined(IMLIB_ENABLE_RVV)
+// Inclusive prefix sum of x plus carry, in log2(vl) slide steps. Returns the last sum in carry.
+static inline vuint32m4_t imlib_prefix_sum_u32m4(vuint32m4_t x, uint32_t *carry, size_t vl) {
+    vuint32m4_t zero = __riscv_vmv_v_x_u32m4(0, vl);
+
+    for (size_t k = 1; k < vl; k <<= 1) {
+        x = __riscv_vadd_vv_u32m4(x, __riscv_vslideup_vx_u32m4(zero, x, k, vl), vl);
+    }
+
+    x = __riscv_vadd_vx_u32m4(x, *carry, vl);
+    *carry = __riscv_vmv_x_s_u32m4_u32(__riscv_vslidedown_vx_u32m4(x, vl - 1, vl));
+    return x;
+}
+#endif
+
+void imlib_integral_row(const uint8_t *src, const uint32_t *prev, uint32_t *dst, int n, bool sq) {
+    #if defined(IMLIB_ENABLE_RVV)
+    uint32_t s = 0;
+
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl) {
+        vl = __riscv_vsetvl_e32m4(n);
+        vuint16m2_t p = __riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(src, vl), vl);
+        vuint32m4_t x = sq ? __riscv_vwmulu_vv_u32m4(p, p, vl) : __riscv_vzext_vf2_u32m4(p, vl);
+        x = imlib_prefix_sum_u32m4(x, &s, vl);
+
+        if (prev) {
+            x = __riscv_vadd_vv_u32m4(x, __riscv_vle32_v_u32m4(prev, vl), vl);
+            prev += vl;
+        }
+
+        __riscv_vse32_v_u32m4(dst, x, vl);
+    }
+    #else
+    uint32_t s = 0;
+
+    for (int i = 0; i < n; i++) {
+        s += sq ? (src[i] * src[i]) : src[i];
+        dst[i] = prev ? (s + prev[i]) : s;
+    }
+    #endif
+}
+
+void imlib_rgb888_to_planar_row(const uint8_t *src, uint8_t *r, uint8_t *g, uint8_t *b, int n) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl * 3, r += vl, g += vl, b += vl) {
+        vl = __riscv_vsetvl_e8m4(n);
+        __riscv_vse8_v_u8m4(r, __riscv_vlse8_v_u8m4(src + 0, 3, vl), vl);
+        __riscv_vse8_v_u8m4(g, __riscv_vlse8_v_u8m4(src + 1, 3, vl), vl);
+        __riscv_vse8_v_u8m4(b, __riscv_vlse8_v_u8m4(src + 2, 3, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++, src += 3) {
+        r[i] = src[0];
+        g[i] = src[1];
+        b[i] = src[2];
+    }
+    #endif
+}
+
+// BT.601 full range, Q14 coefficients. uv points at the interleaved chroma row
+// (U first for NV12, V first for NV21), each chroma pair is shared by 2 pixels.
+#define IMLIB_NV_RV    (22970) // 1.402
+#define IMLIB_NV_GU    (5638)  // 0.344136
+#define IMLIB_NV_GV    (11700) // 0.714136
+#define IMLIB_NV_BU    (29032) // 1.772
+#define IMLIB_NV_ROUND (1 << 13)
+
+void imlib_nv12_to_planar_row(const uint8_t *y, const uint8_t *uv, uint8_t *r, uint8_t *g, uint8_t *b,
+                              int n, bool nv21) {
+    int u_off = nv21 ? 1 : 0;
+    int v_off = nv21 ? 0 : 1;
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl, i = 0; n > 0; n -= vl, i += vl) {
+        vl = __riscv_vsetvl_e8m1(n);
+        // Chroma index of pixel i + k is ((i + k) & ~1), relative to (i & ~1).
+        vuint16m2_t idx = __riscv_vadd_vx_u16m2(__riscv_vid_v_u16m2(vl), i & 1, vl);
+        idx = __riscv_vand_vx_u16m2(idx, ~1, vl);
+        const uint8_t *uv_row = uv + (i & ~1);
+        vint32m4_t u = __riscv_vreinterpret_v_u32m4_i32m4(
+            __riscv_vzext_vf4_u32m4(__riscv_vluxei16_v_u8m1(uv_row + u_off, idx, vl), vl));
+        vint32m4_t v = __riscv_vreinterpret_v_u32m4_i32m4(
+            __riscv_vzext_vf4_u32m4(__riscv_vluxei16_v_u8m1(uv_row + v_off, idx, vl), vl));
+        vint32m4_t l = __riscv_vreinterpret_v_u32m4_i32m4(__riscv_vzext_vf4_u32m4(__riscv_vle8_v_u8m1(y + i, vl), vl));
+        u = __riscv_vsub_vx_i32m4(u, 128, vl);
+        v = __riscv_vsub_vx_i32m4(v, 128, vl);
+        l = __riscv_vadd_vx_i32m4(__riscv_vsll_vx_i32m4(l, 14, vl), IMLIB_NV_ROUND, vl);
+
+        vint32m4_t c[3];
+        c[0] = __riscv_vmacc_vx_i32m4(l, IMLIB_NV_RV, v, vl);
+        c[1] = __riscv_vnmsac_vx_i32m4(__riscv_vnmsac_vx_i32m4(l, IMLIB_NV_GU, u, vl), IMLIB_NV_GV, v, vl);
+        c[2] = __riscv_vmacc_vx_i32m4(l, IMLIB_NV_BU, u, vl);
+        uint8_t *dst[3] = { r + i, g + i, b + i };
+
+        for (int k = 0; k < 3; k++) {
+            vint32m4_t t = __riscv_vsra_vx_i32m4(c[k], 14, vl);
+            t = __riscv_vmin_vx_i32m4(__riscv_vmax_vx_i32m4(t, 0, vl), 255, vl);
+            vuint16m2_t t16 = __riscv_vnsrl_wx_u16m2(__riscv_vreinterpret_v_i32m4_u32m4(t), 0, vl);
+            __riscv_vse8_v_u8m1(dst[k], __riscv_vnsrl_wx_u8m1(t16, 0, vl), vl);
+        }
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        int u = uv[(i & ~1) + u_off] - 128;
+        int v = uv[(i & ~1) + v_off] - 128;
+        int l = (y[i] << 14) + IMLIB_NV_ROUND;
+        int cr = (l + IMLIB_NV_RV * v) >> 14;
+        int cg = (l - IMLIB_NV_GU * u - IMLIB_NV_GV * v) >> 14;
+        int cb = (l + IMLIB_NV_BU * u) >> 14;
+        r[i] = (cr < 0) ? 0 : ((cr > 255) ? 255 : cr);
+        g[i] = (cg < 0) ? 0 : ((cg > 255) ? 255 : cg);
+        b[i] = (cb < 0) ? 0 : ((cb > 255) ? 255 : cb);
+    }
+    #endif
+}
+
+// dst = (a * (2048 - w) + b * w + 1024) >> 11, w in [0, 2048].
+void imlib_lerp_u8_row(const uint8_t *a, const uint8_t *b, uint8_t *dst, int n, int w) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, a += vl, b += vl, dst += vl) {
+        vl = __riscv_vsetvl_e8m1(n);
+        vuint16m2_t pa = __riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(a, vl), vl);
+        vuint16m2_t pb = __riscv_vzext_vf2_u16m2(__riscv_vle8_v_u8m1(b, vl), vl);
+        vuint32m4_t acc = __riscv_vwmulu_vx_u32m4(pa, 2048 - w, vl);
+        acc = __riscv_vwmaccu_vx_u32m4(acc, w, pb, vl);
+        acc = __riscv_vadd_vx_u32m4(acc, 1024, vl);
+        __riscv_vse8_v_u8m1(dst, __riscv_vnsrl_wx_u8m1(__riscv_vnsrl_wx_u16m2(acc, 11, vl), 0, vl), vl);
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i] = ((a[i] * (2048 - w)) + (b[i] * w) + 1024) >> 11;
+    }
+    #endif
+}
+
+// dst[i * stride] = src[i] * scale + bias, computed with a fused multiply-add.
+void imlib_u8_to_f32_row(const uint8_t *src, float *dst, int stride, int n, float scale, float bias) {
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl * stride) {
+        vl = __riscv_vsetvl_e32m4(n);
+        vfloat32m4_t x = __riscv_vfcvt_f_xu_v_f32m4(__riscv_vzext_vf4_u32m4(__riscv_vle8_v_u8m1(src, vl), vl), vl);
+        x = __riscv_vfmadd_vf_f32m4(x, scale, __riscv_vfmv_v_f_f32m4(bias, vl), vl);
+        if (stride == 1) {
+            __riscv_vse32_v_f32m4(dst, x, vl);
+        } else {
+            __riscv_vsse32_v_f32m4(dst, stride * sizeof(float), x, vl);
+        }
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        dst[i * stride] = fmaf(src[i], scale, bias);
+    }
+    #endif
+}
+
+// dst[i * stride] = saturate(round(src[i] * scale + bias)), rounding to nearest even.
+void imlib_u8_to_q8_row(const uint8_t *src, uint8_t *dst, int stride, int n, float scale, float bias, bool is_signed) {
+    int lo = is_signed ? -128 : 0;
+    int hi = is_signed ? 127 : 255;
+    #if defined(IMLIB_ENABLE_RVV)
+    for (size_t vl; n > 0; n -= vl, src += vl, dst += vl * stride) {
+        vl = __riscv_vsetvl_e32m4(n);
+        vfloat32m4_t x = __riscv_vfcvt_f_xu_v_f32m4(__riscv_vzext_vf4_u32m4(__riscv_vle8_v_u8m1(src, vl), vl), vl);
+        x = __riscv_vfmadd_vf_f32m4(x, scale, __riscv_vfmv_v_f_f32m4(bias, vl), vl);
+        vint32m4_t q = __riscv_vfcvt_x_f_v_i32m4(x, vl);
+        q = __riscv_vmin_vx_i32m4(__riscv_vmax_vx_i32m4(q, lo, vl), hi, vl);
+        vuint16m2_t q16 = __riscv_vnsrl_wx_u16m2(__riscv_vreinterpret_v_i32m4_u32m4(q), 0, vl);
+        vuint8m1_t q8 = __riscv_vnsrl_wx_u8m1(q16, 0, vl);
+        if (stride == 1) {
+            __riscv_vse8_v_u8m1(dst, q8, vl);
+        } else {
+            __riscv_vsse8_v_u8m1(dst, stride, q8, vl);
+        }
+    }
+    #else
+    for (int i = 0; i < n; i++) {
+        long q = lrintf(fmaf(src[i], scale, bias));
+        dst[i * stride] = (uint8_t) ((q < lo) ? lo : ((q > hi) ? hi : q));
+    }
+    #endif
+}
@@ -0,0 +1,37 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Row kernels (RVV when IMLIB_ENABLE_RVV is defined, scalar otherwise).
+ *
+ * Kept free of imlib.h so the kernels also build on a host, see host/Makefile.
+ */
+#ifndef __SIMD_H__
+#define __SIMD_H__
+#include <stdbool.h>
+#include <stdint.h>
+#include "imlib_config.h"
+
+void imlib_rgb565_to_y_row(const uint16_t *src, uint8_t *dst, int n);
+void imlib_argb8888_to_y_row(const uint32_t *src, uint8_t *dst, int n);
+void imlib_yuv422_to_y_row(const uint16_t *src, uint8_t *dst, int n);
+void imlib_add_u8_row(uint8_t *dst, const uint8_t *src, int n);
+void imlib_sub_u8_row(uint8_t *dst, const uint8_t *src, int n, bool reverse);
+void imlib_min_u8_row(uint8_t *dst, const uint8_t *src, int n);
+void imlib_max_u8_row(uint8_t *dst, const uint8_t *src, int n);
+void imlib_difference_u8_row(uint8_t *dst, const uint8_t *src, int n);
+void imlib_sepconv3_v_row(const uint8_t *r0, const uint8_t *r1, const uint8_t *r2,
+                          const int8_t *krn, int *dst, int n);
+void imlib_integral_row(const uint8_t *src, const uint32_t *prev, uint32_t *dst, int n, bool sq);
+void imlib_rgb888_to_planar_row(const uint8_t *src, uint8_t *r, uint8_t *g, uint8_t *b, int n);
+void imlib_nv12_to_planar_row(const uint8_t *y, const uint8_t *uv, uint8_t *r, uint8_t *g, uint8_t *b,
+                              int n, bool nv21);
+void imlib_lerp_u8_row(const uint8_t *a, const uint8_t *b, uint8_t *dst, int n, int w);
+void imlib_u8_to_f32_row(const uint8_t *src, float *dst, int stride, int n, float scale, float bias);
+void imlib_u8_to_q8_row(const uint8_t *src, uint8_t *dst, int stride, int n, float scale, float bias, bool is_signed);
+
+#endif // __SIMD_H__
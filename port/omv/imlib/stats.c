@@ -411,6 +411,109 @@ void imlib_get_histogram(histogram_t *out, image_t *ptr, rectangle_t *roi, list_
 
             break;
         }
+        case PIXFORMAT_RGB888: {
+            memset(out->LBins, 0, out->LBinCount * sizeof(uint32_t));
+            memset(out->ABins, 0, out->ABinCount * sizeof(uint32_t));
+            memset(out->BBins, 0, out->BBinCount * sizeof(uint32_t));
+
+            int pixel_count = roi->w * roi->h;
+            float l_mult = (out->LBinCount - 1) / ((float) (COLOR_L_MAX - COLOR_L_MIN));
+            float a_mult = (out->ABinCount - 1) / ((float) (COLOR_A_MAX - COLOR_A_MIN));
+            float b_mult = (out->BBinCount - 1) / ((float) (COLOR_B_MAX - COLOR_B_MIN));
+
+            if ((!thresholds) || (!list_size(thresholds))) {
+                // Fast histogram code when no color thresholds list...
+                if (!other) {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y);
+                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            int pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x));
+                            ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
+                            ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
+                            ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                        }
+                    }
+                } else {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                        uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y),
+                                *other_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(other, y);
+                        for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                            int pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x));
+                            int other_pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(other_row_ptr, x));
+                            int r = abs(COLOR_RGB565_TO_R5(pixel) - COLOR_RGB565_TO_R5(other_pixel));
+                            int g = abs(COLOR_RGB565_TO_G6(pixel) - COLOR_RGB565_TO_G6(other_pixel));
+                            int b = abs(COLOR_RGB565_TO_B5(pixel) - COLOR_RGB565_TO_B5(other_pixel));
+                            pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                            ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
+                            ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
+                            ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                        }
+                    }
+                }
+            } else {
+                // Reset pixel count.
+                pixel_count = 0;
+                if (!other) {
+                    for (list_lnk_t *it = iterator_start_from_head(thresholds); it; it = iterator_next(it)) {
+                        color_thresholds_list_lnk_data_t lnk_data;
+                        iterator_get(thresholds, it, &lnk_data);
+
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y);
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                                int pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x));
+                                if (COLOR_THRESHOLD_RGB565(pixel, &lnk_data, invert)) {
+                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
+                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
+                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                                    pixel_count++;
+                                }
+                            }
+                        }
+                    }
+                } else {
+                    for (list_lnk_t *it = iterator_start_from_head(thresholds); it; it = iterator_next(it)) {
+                        color_thresholds_list_lnk_data_t lnk_data;
+                        iterator_get(thresholds, it, &lnk_data);
+
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y++) {
+                            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y),
+                                    *other_row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(other, y);
+                            for (int x = roi->x, xx = roi->x + roi->w; x < xx; x++) {
+                                int pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x));
+                                int other_pixel = COLOR_RGB888_TO_RGB565(IMAGE_GET_RGB888_PIXEL_FAST(other_row_ptr, x));
+                                int r = abs(COLOR_RGB565_TO_R5(pixel) - COLOR_RGB565_TO_R5(other_pixel));
+                                int g = abs(COLOR_RGB565_TO_G6(pixel) - COLOR_RGB565_TO_G6(other_pixel));
+                                int b = abs(COLOR_RGB565_TO_B5(pixel) - COLOR_RGB565_TO_B5(other_pixel));
+                                pixel = COLOR_R5_G6_B5_TO_RGB565(r, g, b);
+                                if (COLOR_THRESHOLD_RGB565(pixel, &lnk_data, invert)) {
+                                    ((uint32_t *) out->LBins)[fast_roundf((COLOR_RGB565_TO_L(pixel) - COLOR_L_MIN) * l_mult)]++;
+                                    ((uint32_t *) out->ABins)[fast_roundf((COLOR_RGB565_TO_A(pixel) - COLOR_A_MIN) * a_mult)]++;
+                                    ((uint32_t *) out->BBins)[fast_roundf((COLOR_RGB565_TO_B(pixel) - COLOR_B_MIN) * b_mult)]++;
+                                    pixel_count++;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+
+            float pixels = IM_DIV(1, ((float) pixel_count));
+
+            for (int i = 0, j = out->LBinCount; i < j; i++) {
+                out->LBins[i] = ((uint32_t *) out->LBins)[i] * pixels;
+            }
+
+            for (int i = 0, j = out->ABinCount; i < j; i++) {
+                out->ABins[i] = ((uint32_t *) out->ABins)[i] * pixels;
+            }
+
+            for (int i = 0, j = out->BBinCount; i < j; i++) {
+                out->BBins[i] = ((uint32_t *) out->BBins)[i] * pixels;
+            }
+
+            break;
+        }
         default: {
             break;
         }
@@ -448,6 +551,7 @@ void imlib_get_percentile(percentile_t *out, pixformat_t pixfmt, histogram_t *pt
             }
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             {
                 float mult = (COLOR_L_MAX - COLOR_L_MIN) / ((float) (ptr->LBinCount - 1));
@@ -541,6 +645,7 @@ void imlib_get_threshold(threshold_t *out, pixformat_t pixfmt, histogram_t *ptr)
                 (ostu(ptr->LBinCount, ptr->LBins) * (COLOR_GRAYSCALE_MAX - COLOR_GRAYSCALE_MIN)) / (ptr->LBinCount - 1);
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             out->LValue = (ostu(ptr->LBinCount, ptr->LBins) * (COLOR_L_MAX - COLOR_L_MIN)) / (ptr->LBinCount - 1);
             out->AValue = (ostu(ptr->ABinCount, ptr->ABins) * (COLOR_A_MAX - COLOR_A_MIN)) / (ptr->ABinCount - 1);
@@ -654,6 +759,7 @@ void imlib_get_statistics(statistics_t *out, pixformat_t pixfmt, histogram_t *pt
             out->LSTDev = fast_floorf(fast_sqrtf(stdev - (avg * avg)));
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             {
                 float mult = (COLOR_L_MAX - COLOR_L_MIN) / ((float) (ptr->LBinCount - 1));
@@ -926,6 +1032,26 @@ bool imlib_get_regression(find_lines_list_lnk_data_t *out,
                     }
                     break;
                 }
+                case PIXFORMAT_RGB888: {
+                    for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+                        uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y);
+                        for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
+                            if (COLOR_THRESHOLD_RGB888(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x), &lnk_data, invert)) {
+                                blob_x1 = IM_MIN(blob_x1, x);
+                                blob_y1 = IM_MIN(blob_y1, y);
+                                blob_x2 = IM_MAX(blob_x2, x);
+                                blob_y2 = IM_MAX(blob_y2, y);
+                                blob_pixels += 1;
+                                blob_cx += x;
+                                blob_cy += y;
+                                blob_a += x * x;
+                                blob_b += x * y;
+                                blob_c += y * y;
+                            }
+                        }
+                    }
+                    break;
+                }
                 default: {
                     break;
                 }
@@ -1091,6 +1217,28 @@ bool imlib_get_regression(find_lines_list_lnk_data_t *out,
                         }
                         break;
                     }
+                    case PIXFORMAT_RGB888: {
+                        for (int y = roi->y, yy = roi->y + roi->h; y < yy; y += y_stride) {
+                            uint8_t *row_ptr = IMAGE_COMPUTE_RGB888_PIXEL_ROW_PTR(ptr, y);
+                            for (int x = roi->x + (y % x_stride), xx = roi->x + roi->w; x < xx; x += x_stride) {
+                                if (COLOR_THRESHOLD_RGB888(IMAGE_GET_RGB888_PIXEL_FAST(row_ptr, x), &lnk_data, invert)) {
+                                    blob_x1 = IM_MIN(blob_x1, x);
+                                    blob_y1 = IM_MIN(blob_y1, y);
+                                    blob_x2 = IM_MAX(blob_x2, x);
+                                    blob_y2 = IM_MAX(blob_y2, y);
+                                    blob_pixels += 1;
+                                    x_histogram[x]++;
+                                    y_histogram[y]++;
+
+                                    if (points_count < points_max) {
+                                        point_init(&points[points_count], x, y);
+                                        points_count += 1;
+                                    }
+                                }
+                            }
+                        }
+                        break;
+                    }
                     default: {
                         break;
                     }
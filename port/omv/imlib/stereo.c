@@ -134,7 +134,7 @@ void imlib_stereo_disparity(image_t *img, bool reversed, int max_disparity, int
 
     float disparity_scale = COLOR_GRAYSCALE_MAX / max_disparity;
 
-    image_t buf;
+    image_t buf = {};
     buf.w = width_2;
     buf.h = BLOCK_H_D;
     buf.pixfmt = img->pixfmt;
@@ -119,6 +119,8 @@ static float find_block_ncc(image_t *f, image_t *t, i_image_t *sum, int t_mean,
 }
 
 float imlib_template_match_ds(image_t *f, image_t *t, rectangle_t *r) {
+    image_assert_packed(f);
+    image_assert_packed(t);
     point_t pts[9];
 
     // Integral images
@@ -218,6 +220,8 @@ float imlib_template_match_ds(image_t *f, image_t *t, rectangle_t *r) {
  *
  */
 float imlib_template_match_ex(image_t *f, image_t *t, rectangle_t *roi, int step, rectangle_t *r) {
+    image_assert_packed(f);
+    image_assert_packed(t);
     int den_b = 0;
     float corr = 0.0f;
 
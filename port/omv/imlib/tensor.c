@@ -0,0 +1,266 @@
+/*
+ * This file is part of the OpenMV project.
+ *
+ * Copyright (c) 2013-2021 Ibrahim Abdelkader <iabdalkader@openmv.io>
+ * Copyright (c) 2013-2021 Kwabena W. Agyeman <kwagyeman@openmv.io>
+ *
+ * This work is licensed under the MIT license, see the file LICENSE for details.
+ *
+ * Image to tensor conversion.
+ *
+ * Converts an image into a model input tensor in one pass over the source:
+ * each tensor row loads at most two source rows into planar channel rows
+ * (deinterleaving RGB888 or converting NV12/NV21 on the fly), resizes them
+ * with a bilinear filter and normalizes them straight into the tensor memory
+ * as uint8, int8 or float32, NCHW or NHWC. Rows are processed in parallel bands.
+ */
+#include "imlib.h"
+#include "fb_alloc.h"
+
+#define TENSOR_COEF_BITS    11
+#define TENSOR_COEF_ONE     (1 << TENSOR_COEF_BITS)
+
+typedef struct tensor_state {
+    image_t *src;
+    imlib_tensor_params_t *params;
+    uint8_t *dst;
+    size_t elem_size;
+    int c;
+    float scale[3];
+    float bias[3];
+    // Horizontal sampling table for the roi.w tensor columns covered by the image.
+    uint16_t *x0;
+    uint16_t *x1;
+    uint16_t *wx;
+    bool resize;
+    // Per band scratch: 2 cached source rows (3 planes each), 1 blended row, 1 tensor row.
+    uint8_t *scratch;
+    size_t band_size;
+} tensor_state_t;
+
+bool imlib_tensor_supported(pixformat_t pixfmt) {
+    switch (pixfmt) {
+        case PIXFORMAT_GRAYSCALE:
+        case PIXFORMAT_RGB888:
+        case PIXFORMAT_BGR888:
+        case PIXFORMAT_RGBP888:
+        case PIXFORMAT_BGRP888:
+        case PIXFORMAT_YUV420:
+        case PIXFORMAT_YVU420:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Source coordinate aligned on pixel centers: s = (d + 0.5) * src / dst - 0.5.
+static void tensor_map_coord(int d, int src_n, int dst_n, int *s0, int *s1, int *w) {
+    int64_t fp = ((((int64_t) (2 * d + 1) * src_n) << TENSOR_COEF_BITS) / (2 * dst_n)) - (TENSOR_COEF_ONE / 2);
+    fp = IM_MAX(fp, 0);
+    *s0 = fp >> TENSOR_COEF_BITS;
+    *w = fp & (TENSOR_COEF_ONE - 1);
+    if (*s0 >= (src_n - 1)) {
+        *s0 = src_n - 1;
+        *w = 0;
+    }
+    *s1 = *s0 + (*w ? 1 : 0);
+}
+
+// Returns R, G, B (or gray) planes of source row y. Planar and grayscale rows are
+// returned in place, everything else is converted into buf (3 * width bytes).
+static void tensor_load_row(image_t *src, int y, uint8_t *buf, const uint8_t **planes) {
+    int w = src->w;
+    uint8_t *r = buf, *g = buf + w, *b = buf + (2 * w);
+
+    switch (src->pixfmt) {
+        case PIXFORMAT_GRAYSCALE: {
+            planes[0] = IMAGE_GRAYSCALE_ROW_PTR(src, y);
+            return;
+        }
+        case PIXFORMAT_RGBP888:
+        case PIXFORMAT_BGRP888: {
+            bool bgr = src->pixfmt == PIXFORMAT_BGRP888;
+            size_t plane = src->w * src->h;
+            uint8_t *row = src->data + (y * w);
+            planes[bgr ? 2 : 0] = row;
+            planes[1] = row + plane;
+            planes[bgr ? 0 : 2] = row + (2 * plane);
+            return;
+        }
+        case PIXFORMAT_RGB888:
+        case PIXFORMAT_BGR888: {
+            uint8_t *row = src->data + (y * w * 3);
+            if (src->pixfmt == PIXFORMAT_BGR888) {
+                imlib_rgb888_to_planar_row(row, b, g, r, w);
+            } else {
+                imlib_rgb888_to_planar_row(row, r, g, b, w);
+            }
+            break;
+        }
+        case PIXFORMAT_YUV420:
+        case PIXFORMAT_YVU420: {
+            uint8_t *uv = src->data + (w * src->h) + (w * (y / 2));
+            imlib_nv12_to_planar_row(src->data + (y * w), uv, r, g, b, w, src->pixfmt == PIXFORMAT_YVU420);
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+
+    planes[0] = r;
+    planes[1] = g;
+    planes[2] = b;
+}
+
+static void tensor_put_row(tensor_state_t *state, int y, int ch, const uint8_t *row) {
+    imlib_tensor_params_t *params = state->params;
+    int stride = params->nhwc ? state->c : 1;
+    size_t offset = params->nhwc ? ((((size_t) y * params->w) * state->c) + ch) :
+                    ((((size_t) ch * params->h) + y) * params->w);
+    void *dst = state->dst + (offset * state->elem_size);
+
+    if (params->dtype == IMLIB_TENSOR_FLOAT32) {
+        imlib_u8_to_f32_row(row, dst, stride, params->w, state->scale[ch], state->bias[ch]);
+    } else if ((params->dtype == IMLIB_TENSOR_UINT8) && (stride == 1) &&
+               (state->scale[ch] == 1.0f) && (state->bias[ch] == 0.0f)) {
+        memcpy(dst, row, params->w);
+    } else {
+        imlib_u8_to_q8_row(row, dst, stride, params->w, state->scale[ch], state->bias[ch],
+                           params->dtype == IMLIB_TENSOR_INT8);
+    }
+}
+
+static void tensor_band(void *arg, int band, int y_start, int y_end) {
+    tensor_state_t *state = arg;
+    imlib_tensor_params_t *params = state->params;
+    image_t *src = state->src;
+    rectangle_t *roi = &params->roi;
+    int sw = src->w;
+
+    uint8_t *scratch = state->scratch + (band * state->band_size);
+    uint8_t *rows[2] = { scratch, scratch + (3 * sw) };
+    uint8_t *blend = scratch + (6 * sw);
+    uint8_t *out = blend + sw;
+    const uint8_t *planes[2][3];
+    int cached[2] = { -1, -1 };
+
+    for (int y = y_start; y < y_end; y++) {
+        int ty = y - roi->y;
+
+        if ((ty < 0) || (ty >= roi->h)) {
+            for (int ch = 0; ch < state->c; ch++) {
+                memset(out, params->pad[ch], params->w);
+                tensor_put_row(state, y, ch, out);
+            }
+            continue;
+        }
+
+        int y0, y1, wy;
+        if (state->resize) {
+            tensor_map_coord(ty, src->h, roi->h, &y0, &y1, &wy);
+        } else {
+            y0 = y1 = ty;
+            wy = 0;
+        }
+
+        // Consecutive tensor rows mostly share source rows, keep the last two loaded.
+        int s0 = (cached[0] == y0) ? 0 : ((cached[1] == y0) ? 1 : -1);
+        if (s0 < 0) {
+            s0 = (cached[0] == y1) ? 1 : 0;
+            tensor_load_row(src, y0, rows[s0], planes[s0]);
+            cached[s0] = y0;
+        }
+        int s1 = (cached[0] == y1) ? 0 : ((cached[1] == y1) ? 1 : -1);
+        if (s1 < 0) {
+            s1 = !s0;
+            tensor_load_row(src, y1, rows[s1], planes[s1]);
+            cached[s1] = y1;
+        }
+
+        for (int ch = 0; ch < state->c; ch++) {
+            const uint8_t *line = planes[s0][ch];
+            if (wy) {
+                imlib_lerp_u8_row(line, planes[s1][ch], blend, sw, wy);
+                line = blend;
+            }
+
+            memset(out, params->pad[ch], roi->x);
+            memset(out + roi->x + roi->w, params->pad[ch], params->w - roi->x - roi->w);
+            uint8_t *o = out + roi->x;
+            if (state->resize) {
+                for (int x = 0; x < roi->w; x++) {
+                    int w = state->wx[x];
+                    o[x] = ((line[state->x0[x]] * (TENSOR_COEF_ONE - w)) +
+                            (line[state->x1[x]] * w) + (TENSOR_COEF_ONE / 2)) >> TENSOR_COEF_BITS;
+                }
+            } else {
+                memcpy(o, line, roi->w);
+            }
+            tensor_put_row(state, y, ch, out);
+        }
+    }
+}
+
+void imlib_to_tensor(image_t *src, void *dst, imlib_tensor_params_t *params) {
+    int sw = src->w, sh = src->h;
+    rectangle_t *roi = &params->roi;
+
+    params->c = (src->pixfmt == PIXFORMAT_GRAYSCALE) ? 1 : 3;
+
+    if (params->letterbox) {
+        // Scale to fit and center, same as the usual YOLO letterbox.
+        float ratio = IM_MIN(params->w / (float) sw, params->h / (float) sh);
+        roi->w = IM_MIN(IM_MAX(fast_roundf(sw * ratio), 1), params->w);
+        roi->h = IM_MIN(IM_MAX(fast_roundf(sh * ratio), 1), params->h);
+        roi->x = (params->w - roi->w) / 2;
+        roi->y = (params->h - roi->h) / 2;
+    } else {
+        roi->x = 0;
+        roi->y = 0;
+        roi->w = params->w;
+        roi->h = params->h;
+    }
+
+    tensor_state_t state = {
+        .src = src,
+        .params = params,
+        .dst = dst,
+        .elem_size = (params->dtype == IMLIB_TENSOR_FLOAT32) ? sizeof(float) : sizeof(uint8_t),
+        .c = params->c,
+        .resize = (roi->w != sw) || (roi->h != sh),
+    };
+
+    for (int ch = 0; ch < state.c; ch++) {
+        state.scale[ch] = 1.0f / params->std[ch];
+        state.bias[ch] = -params->mean[ch] / params->std[ch];
+    }
+
+    if (state.resize) {
+        state.x0 = fb_alloc(roi->w * sizeof(uint16_t) * 3, FB_ALLOC_NO_HINT);
+        state.x1 = state.x0 + roi->w;
+        state.wx = state.x1 + roi->w;
+        for (int x = 0; x < roi->w; x++) {
+            int x0, x1, w;
+            tensor_map_coord(x, sw, roi->w, &x0, &x1, &w);
+            state.x0[x] = x0;
+            state.x1[x] = x1;
+            state.wx[x] = w;
+        }
+    }
+
+    state.band_size = (7 * sw) + params->w;
+    int bands = imlib_parallel_bands(params->h, 8);
+
+    if ((bands > 1) && (fb_avail() < (state.band_size * bands * 2))) {
+        bands = 1;
+    }
+
+    state.scratch = fb_alloc(state.band_size * bands, FB_ALLOC_NO_HINT);
+    imlib_parallel_for(params->h, bands, tensor_band, &state);
+    fb_free(); // scratch
+
+    if (state.resize) {
+        fb_free(); // x tables
+    }
+}
@@ -16,6 +16,16 @@ void imlib_deyuv_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixf
 
     uint16_t *rowptr_yuv = ((uint16_t *) src->data) + (y_row * src_w);
 
+    if (pixfmt == PIXFORMAT_GRAYSCALE) {
+        // Whole pixel pairs are just the Y bytes, the loop below handles the edge.
+        int n = (IM_MIN(x_end, src_w) - x_start) & ~1;
+
+        if (n > 0) {
+            imlib_yuv422_to_y_row(rowptr_yuv + x_start, ((uint8_t *) dst_row_ptr) + x_start, n);
+            x_start += n;
+        }
+    }
+
     // If the image is an odd width this will go for the last loop and we drop the last column.
     for (int x = x_start; x < x_end; x += 2) {
         int32_t row_yuv; // signed
@@ -101,8 +111,15 @@ void imlib_deyuv_line(int x_start, int x_end, int y_row, void *dst_row_ptr, pixf
     }
 }
 
-void imlib_deyuv_image(image_t *dst, image_t *src) {
-    for (int y = 0, src_w = src->w, src_h = src->h; y < src_h; y++) {
+typedef struct imlib_deyuv_band {
+    image_t *dst, *src;
+} imlib_deyuv_band_t;
+
+static void imlib_deyuv_band(void *arg, int band, int y_start, int y_end) {
+    image_t *dst = ((imlib_deyuv_band_t *) arg)->dst;
+    image_t *src = ((imlib_deyuv_band_t *) arg)->src;
+
+    for (int y = y_start, src_w = src->w; y < y_end; y++) {
         void *row_ptr = NULL;
 
         switch (dst->pixfmt) {
@@ -123,3 +140,10 @@ void imlib_deyuv_image(image_t *dst, image_t *src) {
         imlib_deyuv_line(0, src_w, y, row_ptr, dst->pixfmt, src);
     }
 }
+
+void imlib_deyuv_image(image_t *dst, image_t *src) {
+    imlib_deyuv_band_t state = { .dst = dst, .src = src };
+    // In place conversions read rows that other bands have already written.
+    int bands = image_overlaps(dst, src) ? 1 : imlib_parallel_bands(src->h, 8);
+    imlib_parallel_for(src->h, bands, imlib_deyuv_band, &state);
+}
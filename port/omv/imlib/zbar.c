@@ -8713,10 +8713,11 @@ void zbar_scanner_get_state (const zbar_scanner_t *scn,
 
 void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
 {
-    uint8_t *grayscale_image = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->data : fb_alloc(roi->w * roi->h, FB_ALLOC_NO_HINT);
+    bool in_place = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) && image_is_packed(ptr);
+    uint8_t *grayscale_image = in_place ? ptr->data : fb_alloc(roi->w * roi->h, FB_ALLOC_NO_HINT);
 
-    if (ptr->pixfmt != PIXFORMAT_GRAYSCALE) {
-        image_t img;
+    if (!in_place) {
+        image_t img = {};
         img.w = roi->w;
         img.h = roi->h;
         img.pixfmt = PIXFORMAT_GRAYSCALE;
@@ -8731,12 +8732,12 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
 
     zbar_image_t image;
     image.format = *((int *) "Y800");
-    image.width = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->w : roi->w;
-    image.height = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->h : roi->h;
+    image.width = in_place ? ptr->w : roi->w;
+    image.height = in_place ? ptr->h : roi->h;
     image.data = grayscale_image;
-    image.datalen = ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->w : roi->w) * ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? ptr->h : roi->h);
-    image.crop_x = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->x : 0;
-    image.crop_y = (ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? roi->y : 0;
+    image.datalen = (in_place ? ptr->w : roi->w) * (in_place ? ptr->h : roi->h);
+    image.crop_x = in_place ? roi->x : 0;
+    image.crop_y = in_place ? roi->y : 0;
     image.crop_w = roi->w;
     image.crop_h = roi->h;
     image.userdata = 0;
@@ -8751,15 +8752,15 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
                 find_barcodes_list_lnk_data_t lnk_data;
 
                 rectangle_init(&(lnk_data.rect),
-                               zbar_symbol_get_loc_x(symbol, 0) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
-                               zbar_symbol_get_loc_y(symbol, 0) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y),
+                               zbar_symbol_get_loc_x(symbol, 0) + (in_place ? 0 : roi->x),
+                               zbar_symbol_get_loc_y(symbol, 0) + (in_place ? 0 : roi->y),
                                (zbar_symbol_get_loc_size(symbol) == 1) ? 1 : 0,
                                (zbar_symbol_get_loc_size(symbol) == 1) ? 1 : 0);
 
                 for (size_t k = 1, l = zbar_symbol_get_loc_size(symbol); k < l; k++) {
                     rectangle_t temp;
-                    rectangle_init(&temp, zbar_symbol_get_loc_x(symbol, k) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->x),
-                            zbar_symbol_get_loc_y(symbol, k) + ((ptr->pixfmt == PIXFORMAT_GRAYSCALE) ? 0 : roi->y), 0, 0);
+                    rectangle_init(&temp, zbar_symbol_get_loc_x(symbol, k) + (in_place ? 0 : roi->x),
+                            zbar_symbol_get_loc_y(symbol, k) + (in_place ? 0 : roi->y), 0, 0);
                     rectangle_united(&(lnk_data.rect), &temp);
                 }
 
@@ -8858,7 +8859,7 @@ void imlib_find_barcodes(list_t *out, image_t *ptr, rectangle_t *roi)
 
     zbar_image_scanner_destroy(scanner);
     fb_free(); // umm_init_x();
-    if (ptr->pixfmt != PIXFORMAT_GRAYSCALE) {
+    if (!in_place) {
         fb_free(); // grayscale_image;
     }
 }
@@ -40,6 +40,31 @@ image_t *py_helper_arg_to_image_grayscale(const mp_obj_t arg) {
     return arg_img;
 }
 
+// YUV420/YVU420 frames are returned as a GRAYSCALE view of their Y plane built in the caller
+// provided luma struct, so grayscale algorithms run on camera frames in place without a copy.
+image_t *py_helper_arg_to_luma(const mp_obj_t arg, image_t *luma) {
+    image_t *arg_img = py_image_cobj(arg);
+
+    if (image_luma_view_supported(arg_img)) {
+        image_init_luma_view(luma, arg_img);
+        return luma;
+    }
+
+    return arg_img;
+}
+
+image_t *py_helper_arg_to_luma_mutable(const mp_obj_t arg, image_t *luma) {
+    image_t *arg_img = py_helper_arg_to_luma(arg, luma);
+    PY_ASSERT_TRUE_MSG(arg_img->is_mutable, "Image is not mutable!");
+    return arg_img;
+}
+
+image_t *py_helper_arg_to_luma_grayscale(const mp_obj_t arg, image_t *luma) {
+    image_t *arg_img = py_helper_arg_to_luma(arg, luma);
+    PY_ASSERT_TRUE_MSG(arg_img->pixfmt == PIXFORMAT_GRAYSCALE, "Image is not grayscale!");
+    return arg_img;
+}
+
 image_t *py_helper_keyword_to_image_mutable(uint n_args, const mp_obj_t *args, uint arg_index,
                                             mp_map_t *kw_args, mp_obj_t kw, image_t *default_val) {
     mp_map_elem_t *kw_arg = mp_map_lookup(kw_args, kw, MP_MAP_LOOKUP);
@@ -36,6 +36,10 @@
 #if defined(IMLIB_ENABLE_IMAGE_IO)
 #include "py_imageio.h"
 #endif
+#if MICROPY_PY_NNCASE_RUNTIME
+#include "nncase_type.h"
+#include "kpu.h"
+#endif
 
 static const mp_obj_type_t py_cascade_type;
 static const mp_obj_type_t py_image_type;
@@ -416,6 +420,7 @@ static void py_image_print(const mp_print_t *print, mp_obj_t self, mp_print_kind
 static mp_obj_t py_image_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value) {
     py_image_obj_t *self = self_in;
     image_t *image = py_image_cobj(self);
+    image_assert_packed(image);
     if (value == MP_OBJ_NULL) {
         // delete
     } else if (value == MP_OBJ_SENTINEL) {
@@ -662,7 +667,7 @@ static mp_obj_t py_image_subscr(mp_obj_t self_in, mp_obj_t index, mp_obj_t value
 
 static mp_int_t py_image_get_buffer(mp_obj_t self_in, mp_buffer_info_t *bufinfo, mp_uint_t flags) {
     py_image_obj_t *self = self_in;
-    if (flags == MP_BUFFER_READ) {
+    if ((flags == MP_BUFFER_READ) && image_is_packed(&self->_cobj)) {
         bufinfo->buf = self->_cobj.data;
         bufinfo->len = image_size(&self->_cobj);
         bufinfo->typecode = 'b';
@@ -689,11 +694,13 @@ static mp_obj_t py_image_del(mp_obj_t img_obj) {
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_del_obj, py_image_del);
 
 static mp_obj_t py_image_phyaddr(mp_obj_t img_obj) {
+    image_assert_packed((image_t *) py_image_cobj(img_obj));
     return mp_obj_new_int(((image_t *) py_image_cobj(img_obj))->phy_addr);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_phyaddr_obj, py_image_phyaddr);
 
 static mp_obj_t py_image_virtaddr(mp_obj_t img_obj) {
+    image_assert_packed((image_t *) py_image_cobj(img_obj));
     return mp_obj_new_int(((image_t *) py_image_cobj(img_obj))->data);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_virtaddr_obj, py_image_virtaddr);
@@ -707,6 +714,8 @@ extern void memcpy_fast(void *dst, void *src, size_t size);
 static mp_obj_t py_image_copy_to(mp_obj_t img_obj, mp_obj_t dst_img_obj) {
     image_t *image = py_image_cobj(img_obj);
     image_t *dst_image = py_image_cobj(dst_img_obj);
+    image_assert_packed(image);
+    image_assert_packed(dst_image);
 
     if (image_size(image) != image_size(dst_image))
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("image size or format mismatch"));
@@ -719,6 +728,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_2(py_image_copy_to_obj, py_image_copy_to);
 static mp_obj_t py_image_copy_from(mp_obj_t img_obj, mp_obj_t obj) {
     image_t *image = py_image_cobj(img_obj);
     mp_buffer_info_t bufinfo;
+    image_assert_packed(image);
 
     mp_get_buffer_raise(obj, &bufinfo, MP_BUFFER_READ);
     if (image_size(image) != bufinfo.len)
@@ -735,6 +745,7 @@ static mp_obj_t py_image_to_numpy_ref(mp_obj_t img_obj) {
     size_t shape[4];
     uint32_t pixfmt = image->pixfmt;
 
+    image_assert_packed(image);
     if (pixfmt == PIXFORMAT_RGBP888 || pixfmt == PIXFORMAT_BGRP888) {
         ndim = 3;
         dtype = NDARRAY_UINT8;
@@ -772,6 +783,126 @@ static mp_obj_t py_image_to_numpy_ref(mp_obj_t img_obj) {
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_to_numpy_ref_obj, py_image_to_numpy_ref);
 
+#if MICROPY_PY_NNCASE_RUNTIME
+// Scalar or 3 values, one per channel.
+static void py_image_tensor_channels(mp_obj_t obj, float *x) {
+    if (mp_obj_is_int(obj) || mp_obj_is_float(obj)) {
+        x[0] = x[1] = x[2] = mp_obj_get_float(obj);
+    } else {
+        mp_obj_t *items;
+        mp_obj_get_array_fixed_n(obj, 3, &items);
+        for (int i = 0; i < 3; i++) {
+            x[i] = mp_obj_get_float(items[i]);
+        }
+    }
+}
+
+STATIC mp_obj_t py_image_to_tensor(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t *image = py_image_cobj(args[0]);
+    imlib_tensor_params_t params = {0};
+
+    image_assert_packed(image);
+    if (!imlib_tensor_supported(image->pixfmt)) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("image format not support"));
+    }
+
+    int arg_dtype = py_helper_keyword_int(n_args, args, 1, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_dtype), NDARRAY_UINT8);
+    switch (arg_dtype) {
+        case NDARRAY_UINT8:
+            params.dtype = IMLIB_TENSOR_UINT8;
+            break;
+        case NDARRAY_INT8:
+            params.dtype = IMLIB_TENSOR_INT8;
+            break;
+        case NDARRAY_FLOAT:
+            params.dtype = IMLIB_TENSOR_FLOAT32;
+            break;
+        default:
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("dtype must be uint8, int8 or float"));
+    }
+
+    const char *arg_layout = mp_obj_str_get_str(
+        py_helper_keyword_object(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_layout), MP_OBJ_NEW_QSTR(MP_QSTR_NCHW)));
+    if (!strcmp(arg_layout, "NHWC")) {
+        params.nhwc = true;
+    } else if (strcmp(arg_layout, "NCHW")) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("layout must be NCHW or NHWC"));
+    }
+
+    py_image_tensor_channels(py_helper_keyword_object(n_args, args, 3, kw_args,
+                                                      MP_OBJ_NEW_QSTR(MP_QSTR_mean), mp_obj_new_int(0)), params.mean);
+    py_image_tensor_channels(py_helper_keyword_object(n_args, args, 4, kw_args,
+                                                      MP_OBJ_NEW_QSTR(MP_QSTR_std), mp_obj_new_int(1)), params.std);
+    for (int i = 0; i < 3; i++) {
+        if (params.std[i] == 0.0f) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("std must not be 0"));
+        }
+    }
+
+    mp_obj_t arg_letterbox = py_helper_keyword_object(n_args, args, 5, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_letterbox), mp_const_none);
+    if (arg_letterbox != mp_const_none) {
+        mp_obj_t *size;
+        mp_obj_get_array_fixed_n(arg_letterbox, 2, &size);
+        params.letterbox = true;
+        params.w = mp_obj_get_int(size[0]);
+        params.h = mp_obj_get_int(size[1]);
+        if ((params.w <= 0) || (params.h <= 0) || (params.w > INT16_MAX) || (params.h > INT16_MAX)) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("invalid letterbox size"));
+        }
+    } else {
+        params.w = image->w;
+        params.h = image->h;
+    }
+
+    float pad[3];
+    py_image_tensor_channels(py_helper_keyword_object(n_args, args, 6, kw_args,
+                                                      MP_OBJ_NEW_QSTR(MP_QSTR_pad_value), mp_obj_new_int(0)), pad);
+    for (int i = 0; i < 3; i++) {
+        params.pad[i] = IM_MIN(IM_MAX(fast_roundf(pad[i]), 0), 255);
+    }
+
+    int c = (image->pixfmt == PIXFORMAT_GRAYSCALE) ? 1 : 3;
+    finite_data shape = { .data_size = 4 };
+    shape.data[0] = 1;
+    shape.data[1] = params.nhwc ? params.h : c;
+    shape.data[2] = params.nhwc ? params.w : params.h;
+    shape.data[3] = params.nhwc ? c : params.w;
+
+    // Reuse the caller's tensor when given, so every frame lands in the same MMZ buffer.
+    mp_obj_t arg_out = py_helper_keyword_object(n_args, args, 7, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_out), mp_const_none);
+    mp_runtime_tensor_obj_t *tensor;
+    if (arg_out != mp_const_none) {
+        PY_ASSERT_TYPE(arg_out, &rt_type);
+        tensor = MP_OBJ_TO_PTR(arg_out);
+    } else {
+        runtime_tensor *r_tensor = runtime_tensor_create(mp_dtype_to_nncase((char) arg_dtype), shape);
+        if (!r_tensor) {
+            mp_raise_msg(&mp_type_RuntimeError, MP_ERROR_TEXT("cannot create tensor"));
+        }
+        tensor = m_new_obj_with_finaliser(mp_runtime_tensor_obj_t);
+        tensor->base.type = &rt_type;
+        tensor->r_tensor = r_tensor;
+        tensor->has_views = false;
+        tensor->deferred = NULL;
+    }
+
+    rt_to_ndarray_info info;
+    to_numpy(mp_runtime_tensor_get(MP_OBJ_FROM_PTR(tensor)), &info);
+    if ((info.dtype_ != arg_dtype) || (info.len_ != ((size_t) c * params.w * params.h))) {
+        mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("tensor shape or dtype mismatch"));
+    }
+
+    fb_alloc_mark();
+    imlib_to_tensor(image, info.data_, &params);
+    fb_alloc_free_till_mark();
+
+    // Flush the CPU cache so the KPU/ai2d reads what was just written.
+    runtime_tensor_sync(tensor->r_tensor, true);
+    return MP_OBJ_FROM_PTR(tensor);
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_to_tensor_obj, 1, py_image_to_tensor);
+#endif // MICROPY_PY_NNCASE_RUNTIME
+
 static mp_obj_t py_image_width(mp_obj_t img_obj) {
     return mp_obj_new_int(((image_t *) py_image_cobj(img_obj))->w);
 }
@@ -795,6 +926,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_size_obj, py_image_size);
 
 static mp_obj_t py_image_bytearray(mp_obj_t img_obj) {
     image_t *arg_img = (image_t *) py_image_cobj(img_obj);
+    image_assert_packed(arg_img);
     return mp_obj_new_bytearray_by_ref(image_size(arg_img), arg_img->data);
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_bytearray_obj, py_image_bytearray);
@@ -926,7 +1058,7 @@ static mp_obj_t py_image_mean_pool(mp_obj_t img_obj, mp_obj_t x_div_obj, mp_obj_
     PY_ASSERT_TRUE_MSG(arg_y_div >= 1, "Height divisor must be greater than >= 1");
     PY_ASSERT_TRUE_MSG(arg_y_div <= arg_img->h, "Height divisor must be less than <= img height");
 
-    image_t out_img;
+    image_t out_img = {};
     out_img.w = arg_img->w / arg_x_div;
     out_img.h = arg_img->h / arg_y_div;
     out_img.pixfmt = arg_img->pixfmt;
@@ -951,7 +1083,7 @@ static mp_obj_t py_image_mean_pooled(size_t n_args, const mp_obj_t *args, mp_map
     PY_ASSERT_TRUE_MSG(arg_y_div >= 1, "Height divisor must be greater than >= 1");
     PY_ASSERT_TRUE_MSG(arg_y_div <= arg_img->h, "Height divisor must be less than <= img height");
 
-    image_t out_img;
+    image_t out_img = {};
     out_img.w = arg_img->w / arg_x_div;
     out_img.h = arg_img->h / arg_y_div;
     out_img.pixfmt = arg_img->pixfmt;
@@ -977,7 +1109,7 @@ static mp_obj_t py_image_midpoint_pool(size_t n_args, const mp_obj_t *args, mp_m
     int arg_bias = py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bias), 0.5) * 256;
     PY_ASSERT_TRUE_MSG((0 <= arg_bias) && (arg_bias <= 256), "Error: 0 <= bias <= 1!");
 
-    image_t out_img;
+    image_t out_img = {};
     out_img.w = arg_img->w / arg_x_div;
     out_img.h = arg_img->h / arg_y_div;
     out_img.pixfmt = arg_img->pixfmt;
@@ -1005,7 +1137,7 @@ static mp_obj_t py_image_midpoint_pooled(size_t n_args, const mp_obj_t *args, mp
     int arg_bias = py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bias), 0.5) * 256;
     PY_ASSERT_TRUE_MSG((0 <= arg_bias) && (arg_bias <= 256), "Error: 0 <= bias <= 1!");
 
-    image_t out_img;
+    image_t out_img = {};
     out_img.w = arg_img->w / arg_x_div;
     out_img.h = arg_img->h / arg_y_div;
     out_img.pixfmt = arg_img->pixfmt;
@@ -1020,7 +1152,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_midpoint_pooled_obj, 3, py_image_midp
 static mp_obj_t py_image_to(pixformat_t pixfmt, const uint16_t *default_color_palette, bool copy_to_fb,
                             mp_obj_t copy_default, bool quality_is_first_arg, bool encode_for_ide_default,
                             size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *src_img = py_image_cobj(args[0]);
+    mp_obj_t src_obj = args[0];
+    image_t *src_img = py_image_cobj(src_obj);
 
     int quality_default = 90;
     if (quality_is_first_arg && (n_args > 1)) {
@@ -1093,28 +1226,82 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, const uint16_t *default_color_pa
     }
 
     bool arg_e = py_helper_keyword_int(n_args, args, 13, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_encode_for_ide), encode_for_ide_default);
+
+    // A view shares the source pixels, so only a plain crop can be returned without copying.
+    bool arg_view = py_helper_keyword_int(n_args, args, 14, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_view), false);
+    if (arg_view) {
+        // YUV420/YVU420 frames can also be viewed as GRAYSCALE through their Y plane.
+        image_t luma_img;
+        if ((pixfmt == PIXFORMAT_GRAYSCALE) && image_luma_view_supported(src_img)) {
+            image_init_luma_view(&luma_img, src_img);
+            src_img = &luma_img;
+        }
+
+        if (((pixfmt != PIXFORMAT_INVALID) && (pixfmt != src_img->pixfmt)) ||
+            (arg_x_scale != 1) ||
+            (arg_y_scale != 1) ||
+            (arg_rgb_channel != -1) ||
+            (arg_alpha != 256) ||
+            (color_palette != NULL) ||
+            (alpha_palette != NULL)) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Only cropping is supported for views!"));
+        }
+
+        if (!image_view_supported(src_img, &arg_roi)) {
+            mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Views are not supported for this image format!"));
+        }
+
+        image_t view_img;
+        image_init_view(&view_img, src_img, &arg_roi);
+        view_img.ref_obj = src_obj;
+        return py_image_from_struct(&view_img);
+    }
+
     image_t temp_img;
     bool dst_is_rgb888 = false;
     bool src_is_rgb888 = false;
 
-    if (pixfmt == PIXFORMAT_RGB888) {
+    // RGB888 is scaled and converted natively by imlib_draw_image() when both sides are formats
+    // its wide path handles. Channel extraction, palettes, other sources and the JPEG/PNG/BINARY
+    // destinations (the encoders and the legacy draw path cannot read RGB888) still go through RGB565.
+    pixformat_t dst_pixfmt = (pixfmt == PIXFORMAT_INVALID) ? src_img->pixfmt : pixfmt;
+    bool src_is_native = (src_img->pixfmt == PIXFORMAT_GRAYSCALE) ||
+                         (src_img->pixfmt == PIXFORMAT_RGB565) ||
+                         (src_img->pixfmt == PIXFORMAT_RGB888) ||
+                         (src_img->pixfmt == PIXFORMAT_BGR888) ||
+                         (src_img->pixfmt_id == PIXFORMAT_ID_ARGB8);
+    bool dst_is_native = (dst_pixfmt == PIXFORMAT_GRAYSCALE) ||
+                         (dst_pixfmt == PIXFORMAT_RGB565) ||
+                         (dst_pixfmt == PIXFORMAT_RGB888) ||
+                         (dst_pixfmt == PIXFORMAT_BGR888) ||
+                         (dst_pixfmt == PIXFORMAT_ARGB8888) ||
+                         (dst_pixfmt == PIXFORMAT_ABGR8888) ||
+                         (dst_pixfmt == PIXFORMAT_RGBA8888) ||
+                         (dst_pixfmt == PIXFORMAT_BGRA8888);
+    bool rgb888_via_rgb565 = (arg_rgb_channel != -1) || color_palette || alpha_palette ||
+                             (!src_is_native) || (!dst_is_native);
+
+    if ((pixfmt == PIXFORMAT_RGB888) && rgb888_via_rgb565) {
         dst_is_rgb888 = true;
         pixfmt = PIXFORMAT_RGB565;
     }
 
-    if (src_img->pixfmt == PIXFORMAT_RGB888) {
+    if ((src_img->pixfmt == PIXFORMAT_RGB888) && rgb888_via_rgb565) {
         src_is_rgb888 = true;
         memcpy(&temp_img, src_img, sizeof(image_t));
         temp_img.pixfmt = PIXFORMAT_RGB565;
         temp_img.alloc_type = ALLOC_MPGC;
+        temp_img.stride = 0;
         temp_img.data = xalloc(image_size(&temp_img));
 
-        uint8_t *rgb888 = src_img->data;
         uint16_t *rgb565 = (uint16_t *)temp_img.data;
 
-        for (int i = 0; i < src_img->w * src_img->h; i++) {
-            *rgb565++ = COLOR_R8_G8_B8_TO_RGB565(rgb888[0], rgb888[1], rgb888[2]);
-            rgb888 += 3;
+        for (int y = 0; y < src_img->h; y++) {
+            uint8_t *rgb888 = IMAGE_RGB888_ROW_PTR(src_img, y);
+            for (int x = 0; x < src_img->w; x++) {
+                *rgb565++ = COLOR_R8_G8_B8_TO_RGB565(rgb888[0], rgb888[1], rgb888[2]);
+                rgb888 += 3;
+            }
         }
 
         src_img = &temp_img;
@@ -1213,7 +1400,8 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, const uint16_t *default_color_pa
     } else if (dst_img.is_compressed) {
         fb_alloc_mark();
 
-        bool simple = (arg_x_scale == 1) &&
+        bool simple = image_is_packed(src_img) &&
+                      (arg_x_scale == 1) &&
                       (arg_y_scale == 1) &&
                       (arg_roi.x == 0) &&
                       (arg_roi.y == 0) &&
@@ -1233,6 +1421,7 @@ static mp_obj_t py_image_to(pixformat_t pixfmt, const uint16_t *default_color_pa
                 temp.h = dst_img.h;
                 temp.pixfmt = PIXFORMAT_RGB565; // TODO PIXFORMAT_ARGB8888
                 temp.size = 0;
+                temp.stride = 0;
                 temp.data = fb_alloc(image_size(&temp), FB_ALLOC_NO_HINT);
                 imlib_draw_image(&temp, src_img, 0, 0, arg_x_scale, arg_y_scale, &arg_roi,
                                  arg_rgb_channel, arg_alpha, color_palette, alpha_palette,
@@ -1830,7 +2019,7 @@ STATIC mp_obj_t py_image_mask_rectangle(size_t n_args, const mp_obj_t *args, mp_
     }
 
     fb_alloc_mark();
-    image_t temp;
+    image_t temp = {};
     temp.w = arg_img->w;
     temp.h = arg_img->h;
     temp.pixfmt = PIXFORMAT_BINARY;
@@ -1863,7 +2052,7 @@ STATIC mp_obj_t py_image_mask_circle(size_t n_args, const mp_obj_t *args, mp_map
     }
 
     fb_alloc_mark();
-    image_t temp;
+    image_t temp = {};
     temp.w = arg_img->w;
     temp.h = arg_img->h;
     temp.pixfmt = PIXFORMAT_BINARY;
@@ -1902,7 +2091,7 @@ STATIC mp_obj_t py_image_mask_ellipse(size_t n_args, const mp_obj_t *args, mp_ma
     }
 
     fb_alloc_mark();
-    image_t temp;
+    image_t temp = {};
     temp.w = arg_img->w;
     temp.h = arg_img->h;
     temp.pixfmt = PIXFORMAT_BINARY;
@@ -2045,13 +2234,18 @@ STATIC mp_obj_t py_image_binary(size_t n_args, const mp_obj_t *args, mp_map_t *k
                                    "Can't convert to bitmap in place!");
                 break;
             }
+            case PIXFORMAT_RGB888: {
+                PY_ASSERT_TRUE_MSG(((arg_img->w * 3) >= sizeof(uint32_t)),
+                                   "Can't convert to bitmap in place!");
+                break;
+            }
             default: {
                 break;
             }
         }
     }
 
-    image_t out;
+    image_t out = {};
     out.w = arg_img->w;
     out.h = arg_img->h;
     out.pixfmt = arg_to_bitmap ? PIXFORMAT_BINARY  : arg_img->pixfmt;
@@ -2237,8 +2431,12 @@ STATIC mp_obj_t py_image_erode(size_t n_args, const mp_obj_t *args, mp_map_t *kw
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_erode(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_erode(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2253,8 +2451,12 @@ STATIC mp_obj_t py_image_dilate(size_t n_args, const mp_obj_t *args, mp_map_t *k
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_dilate(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_dilate(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2268,8 +2470,12 @@ STATIC mp_obj_t py_image_open(size_t n_args, const mp_obj_t *args, mp_map_t *kw_
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_open(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_open(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2283,8 +2489,12 @@ STATIC mp_obj_t py_image_close(size_t n_args, const mp_obj_t *args, mp_map_t *kw
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_close(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_close(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2315,6 +2525,7 @@ STATIC mp_obj_t py_image_replace(size_t n_args, const mp_obj_t *args, mp_map_t *
         py_helper_keyword_to_image_mutable_mask(n_args, args, 5, kw_args);
 
     if (arg_transpose) {
+        image_assert_packed(arg_img);
         size_t size0 = image_size(arg_img);
         int w = arg_img->w;
         int h = arg_img->h;
@@ -2564,8 +2775,12 @@ STATIC mp_obj_t py_image_top_hat(size_t n_args, const mp_obj_t *args, mp_map_t *
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_top_hat(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_top_hat(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2579,8 +2794,12 @@ STATIC mp_obj_t py_image_black_hat(size_t n_args, const mp_obj_t *args, mp_map_t
     image_t *arg_msk =
         py_helper_keyword_to_image_mutable_mask(n_args, args, 3, kw_args);
 
+    image_t luma_img;
+    image_t *arg_img =
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
+
     fb_alloc_mark();
-    imlib_black_hat(py_helper_arg_to_image_mutable(args[0]), arg_ksize, arg_threshold, arg_msk);
+    imlib_black_hat(arg_img, arg_ksize, arg_threshold, arg_msk);
     fb_alloc_free_till_mark();
     return args[0];
 }
@@ -2712,8 +2931,9 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_midpoint_obj, 2, py_image_midpoint);
 
 #ifdef IMLIB_ENABLE_MORPH
 STATIC mp_obj_t py_image_morph(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
+    image_t luma_img;
     image_t *arg_img =
-        py_helper_arg_to_image_mutable(args[0]);
+        py_helper_arg_to_luma_mutable(args[0], &luma_img);
     int arg_ksize =
         py_helper_arg_to_ksize(args[1]);
 
@@ -3168,6 +3388,7 @@ static void py_statistics_print(const mp_print_t *print, mp_obj_t self_in, mp_pr
                       mp_obj_get_int(self->LUQ));
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             mp_printf(print,
                       "{\"l_mean\":%d, \"l_median\":%d, \"l_mode\":%d, \"l_stdev\":%d, \"l_min\":%d, \"l_max\":%d, \"l_lq\":%d, \"l_uq\":%d,"
@@ -3446,6 +3667,7 @@ static void py_percentile_print(const mp_print_t *print, mp_obj_t self_in, mp_pr
                       mp_obj_get_int(self->LValue));
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             mp_printf(print, "{\"l_value:%d\", \"a_value\":%d, \"b_value\":%d}",
                       mp_obj_get_int(self->LValue),
@@ -3539,6 +3761,7 @@ static void py_threshold_print(const mp_print_t *print, mp_obj_t self_in, mp_pri
                       mp_obj_get_int(self->LValue));
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             mp_printf(print, "{\"l_value\":%d, \"a_value\":%d, \"b_value\":%d}",
                       mp_obj_get_int(self->LValue),
@@ -3634,6 +3857,7 @@ static void py_histogram_print(const mp_print_t *print, mp_obj_t self_in, mp_pri
             mp_printf(print, "}");
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             mp_printf(print, "{\"l_bins\":");
             mp_obj_print_helper(print, self->LBins, kind);
@@ -3850,7 +4074,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_get_histogram(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     list_t thresholds;
     list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
@@ -3895,6 +4120,7 @@ static mp_obj_t py_image_get_histogram(size_t n_args, const mp_obj_t *args, mp_m
             list_free(&thresholds);
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             int l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
                                                (COLOR_L_MAX - COLOR_L_MIN + 1));
@@ -3951,7 +4177,8 @@ static mp_obj_t py_image_get_histogram(size_t n_args, const mp_obj_t *args, mp_m
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_get_histogram_obj, 1, py_image_get_histogram);
 
 static mp_obj_t py_image_get_statistics(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     list_t thresholds;
     list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
@@ -3996,6 +4223,7 @@ static mp_obj_t py_image_get_statistics(size_t n_args, const mp_obj_t *args, mp_
             list_free(&thresholds);
             break;
         }
+        case PIXFORMAT_RGB888:
         case PIXFORMAT_RGB565: {
             int l_bins = py_helper_keyword_int(n_args, args, n_args, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_bins),
                                                (COLOR_L_MAX - COLOR_L_MIN + 1));
@@ -4176,7 +4404,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_get_regression(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     list_t thresholds;
     list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
@@ -4746,7 +4975,8 @@ static bool py_image_find_blobs_merge_cb(void *fun_obj, find_blobs_list_lnk_data
 }
 
 static mp_obj_t py_image_find_blobs(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     list_t thresholds;
     list_init(&thresholds, sizeof(color_thresholds_list_lnk_data_t));
@@ -4823,7 +5053,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_blobs_obj, 2, py_image_find_blob
 
 #ifdef IMLIB_ENABLE_FIND_LINES
 static mp_obj_t py_image_find_lines(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -4869,7 +5100,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_lines_obj, 1, py_image_find_line
 
 #ifdef IMLIB_ENABLE_FIND_LINE_SEGMENTS
 static mp_obj_t py_image_find_line_segments(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -4994,7 +5226,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_circles(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -5139,7 +5372,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_rects(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -5341,7 +5575,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_qrcodes(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -5597,7 +5832,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_apriltags(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -5806,7 +6042,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_datamatrices(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -5980,7 +6217,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_barcodes(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_image_cobj(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -6113,7 +6351,8 @@ STATIC MP_DEFINE_CONST_OBJ_TYPE(
     );
 
 static mp_obj_t py_image_find_displacement(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
     image_t *arg_template_img = py_helper_arg_to_image_mutable(args[1]);
 
     rectangle_t roi;
@@ -6150,7 +6389,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_displacement_obj, 2, py_image_fi
 
 #ifdef IMLIB_FIND_TEMPLATE
 static mp_obj_t py_image_find_template(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
     image_t *arg_template = py_helper_arg_to_image_grayscale(args[1]);
     float arg_thresh = mp_obj_get_float(args[2]);
 
@@ -6194,7 +6434,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_template_obj, 3, py_image_find_t
 #endif // IMLIB_FIND_TEMPLATE
 
 static mp_obj_t py_image_find_features(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_mutable(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_mutable(args[0], &luma_img);
     cascade_t *cascade = py_cascade_cobj(args[1]);
     cascade->threshold = py_helper_keyword_float(n_args, args, 2, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_threshold), 0.5f);
     cascade->scale_factor = py_helper_keyword_float(n_args, args, 3, kw_args, MP_OBJ_NEW_QSTR(MP_QSTR_scale_factor), 1.5f);
@@ -6229,7 +6470,8 @@ static mp_obj_t py_image_find_features(size_t n_args, const mp_obj_t *args, mp_m
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_features_obj, 2, py_image_find_features);
 
 static mp_obj_t py_image_find_eye(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -6248,7 +6490,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_eye_obj, 2, py_image_find_eye);
 
 #ifdef IMLIB_ENABLE_FIND_LBP
 static mp_obj_t py_image_find_lbp(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -6263,7 +6506,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_lbp_obj, 2, py_image_find_lbp);
 
 #ifdef IMLIB_ENABLE_FIND_KEYPOINTS
 static mp_obj_t py_image_find_keypoints(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -6304,7 +6548,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_keypoints_obj, 1, py_image_find_
 
 #ifdef IMLIB_ENABLE_BINARY_OPS
 static mp_obj_t py_image_find_edges(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
     edge_detector_t edge_type = mp_obj_get_int(args[1]);
 
     rectangle_t roi;
@@ -6343,7 +6588,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_find_edges_obj, 2, py_image_find_edge
 
 #ifdef IMLIB_ENABLE_HOG
 static mp_obj_t py_image_find_hog(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *arg_img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *arg_img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
 
     rectangle_t roi;
     py_helper_keyword_rectangle_roi(arg_img, n_args, args, 1, kw_args, &roi);
@@ -6390,7 +6636,8 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_selective_search_obj, 1, py_image_sel
 
 #ifdef IMLIB_ENABLE_STEREO_DISPARITY
 static mp_obj_t py_image_stereo_disparity(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
-    image_t *img = py_helper_arg_to_image_grayscale(args[0]);
+    image_t luma_img;
+    image_t *img = py_helper_arg_to_luma_grayscale(args[0], &luma_img);
 
     if (img->w % 2) {
         mp_raise_msg(&mp_type_ValueError, MP_ERROR_TEXT("Image width must be even!"));
@@ -6423,6 +6670,9 @@ static const mp_rom_map_elem_t locals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_copy_to),             MP_ROM_PTR(&py_image_copy_to_obj)},
     {MP_ROM_QSTR(MP_QSTR_copy_from),           MP_ROM_PTR(&py_image_copy_from_obj)},
     {MP_ROM_QSTR(MP_QSTR_to_numpy_ref),        MP_ROM_PTR(&py_image_to_numpy_ref_obj)},
+#if MICROPY_PY_NNCASE_RUNTIME
+    {MP_ROM_QSTR(MP_QSTR_to_tensor),           MP_ROM_PTR(&py_image_to_tensor_obj)},
+#endif
     {MP_ROM_QSTR(MP_QSTR_phyaddr),             MP_ROM_PTR(&py_image_phyaddr_obj)},
     {MP_ROM_QSTR(MP_QSTR_virtaddr),            MP_ROM_PTR(&py_image_virtaddr_obj)},
     {MP_ROM_QSTR(MP_QSTR_poolid),              MP_ROM_PTR(&py_image_poolid_obj)},
@@ -7226,6 +7476,19 @@ mp_obj_t py_image_fb_stat(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args
 }
 STATIC MP_DEFINE_CONST_FUN_OBJ_KW(py_image_fb_stat_obj, 0, py_image_fb_stat);
 
+STATIC mp_obj_t py_image_set_threads(mp_obj_t threads_obj) {
+    int threads = mp_obj_get_int(threads_obj);
+    PY_ASSERT_TRUE_MSG(threads >= 1, "Expected threads >= 1");
+    imlib_set_threads(threads);
+    return mp_const_none;
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_image_set_threads_obj, py_image_set_threads);
+
+STATIC mp_obj_t py_image_get_threads(void) {
+    return mp_obj_new_int(imlib_get_threads());
+}
+STATIC MP_DEFINE_CONST_FUN_OBJ_0(py_image_get_threads_obj, py_image_get_threads);
+
 #if defined(IMLIB_ENABLE_DESCRIPTOR)
 #if defined(IMLIB_ENABLE_IMAGE_FILE_IO)
 mp_obj_t py_image_load_descriptor(size_t n_args, const mp_obj_t *args, mp_map_t *kw_args) {
@@ -7550,6 +7813,8 @@ static const mp_rom_map_elem_t globals_dict_table[] = {
     {MP_ROM_QSTR(MP_QSTR_yuv_to_rgb),          MP_ROM_PTR(&py_image_yuv_to_rgb_obj)},
     {MP_ROM_QSTR(MP_QSTR_yuv_to_lab),          MP_ROM_PTR(&py_image_yuv_to_lab_obj)},
     {MP_ROM_QSTR(MP_QSTR_fb_stat),             MP_ROM_PTR(&py_image_fb_stat_obj)},
+    {MP_ROM_QSTR(MP_QSTR_set_threads),         MP_ROM_PTR(&py_image_set_threads_obj)},
+    {MP_ROM_QSTR(MP_QSTR_get_threads),         MP_ROM_PTR(&py_image_get_threads_obj)},
     {MP_ROM_QSTR(MP_QSTR_Image),               MP_ROM_PTR(&py_image_load_image_obj)},
     {MP_ROM_QSTR(MP_QSTR_HaarCascade),         MP_ROM_PTR(&py_image_load_cascade_obj)},
     #if defined(IMLIB_ENABLE_DESCRIPTOR) && defined(IMLIB_ENABLE_IMAGE_FILE_IO)
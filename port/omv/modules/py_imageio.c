@@ -173,6 +173,7 @@ STATIC MP_DEFINE_CONST_FUN_OBJ_1(py_imageio_size_obj, py_imageio_size);
 STATIC mp_obj_t py_imageio_write(mp_obj_t self, mp_obj_t img_obj) {
     py_imageio_obj_t *stream = py_imageio_obj(self);
     image_t *image = py_image_cobj(img_obj);
+    image_assert_packed(image);
 
     uint32_t ms = mp_hal_ticks_ms(), elapsed_ms = ms - stream->ms;
     stream->ms = ms;
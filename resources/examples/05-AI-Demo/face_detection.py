@@ -29,6 +29,12 @@ class FaceDetectionApp(AIBase):
         self.debug_mode = debug_mode  # 是否开启调试模式
         self.ai2d = Ai2d(debug_mode)  # 实例化Ai2d，用于实现模型预处理
         self.ai2d.set_ai2d_dtype(nn.ai2d_format.NCHW_FMT, nn.ai2d_format.NCHW_FMT, np.uint8, np.uint8)  # 设置Ai2d的输入输出格式和类型
+        # 后处理上下文，anchors和结果数组只在这里分配一次，每帧复用
+        self.max_faces = 32
+        self.det_ctx = aidemo.face_det_create(self.model_input_size[1], self.anchors, self.max_faces)
+        self.det_bbox = np.zeros((self.max_faces, 4), dtype=np.float)
+        self.det_kps = np.zeros((self.max_faces, 10), dtype=np.float)
+        self.det_score = np.zeros((self.max_faces,), dtype=np.float)
 
     # 配置预处理操作，这里使用了pad和resize，Ai2d支持crop/shift/pad/resize/affine，具体代码请打开/sdcard/app/libs/AI2D.py查看
     def config_preprocess(self, input_image_size=None):
@@ -39,14 +45,15 @@ class FaceDetectionApp(AIBase):
             self.ai2d.resize(nn.interp_method.tf_bilinear, nn.interp_mode.half_pixel)  # 缩放图像
             self.ai2d.build([1,3,ai2d_input_size[1],ai2d_input_size[0]],[1,3,self.model_input_size[1],self.model_input_size[0]])  # 构建预处理流程
 
-    # 自定义当前任务的后处理，results是模型输出array列表，这里使用了aidemo库的face_det_post_process接口
+    # 自定义当前任务的后处理，results是模型输出array列表，这里使用了aidemo库的face_det_run接口
+    # 结果写入预先分配的数组，返回人脸个数n，前n行有效
     def postprocess(self, results):
         with ScopedTiming("postprocess", self.debug_mode > 0):
-            post_ret = aidemo.face_det_post_process(self.confidence_threshold, self.nms_threshold, self.model_input_size[1], self.anchors, self.rgb888p_size, results)
-            if len(post_ret) == 0:
-                return post_ret
+            n = aidemo.face_det_run(self.det_ctx, self.confidence_threshold, self.nms_threshold, self.rgb888p_size, results, self.det_bbox, self.det_kps, self.det_score)
+            if n == 0:
+                return []
             else:
-                return post_ret[0]
+                return self.det_bbox[:n]
 
     # 绘制检测结果到画面上
     def draw_result(self, pl, dets):
@@ -64,6 +71,10 @@ class FaceDetectionApp(AIBase):
             else:
                 pl.osd_img.clear()
 
+    def deinit(self):
+        aidemo.face_det_destroy(self.det_ctx)
+        super().deinit()
+
     # 获取padding参数
     def get_padding_param(self):
         dst_w = self.model_input_size[0]  # 模型输入宽度
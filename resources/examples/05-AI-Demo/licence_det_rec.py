@@ -77,6 +77,22 @@ class LicenceRecognitionApp(AIBase):
             self.ai2d.resize(nn.interp_method.tf_bilinear, nn.interp_mode.half_pixel)
             self.ai2d.build([1,3,ai2d_input_size[1],ai2d_input_size[0]],[1,3,self.model_input_size[1],self.model_input_size[0]])
 
+    # 配置批量预处理，使用affine直接从原图抠出车牌并拉伸到模型输入尺寸，每个车牌的仿射矩阵在run_batch时传入
+    def config_batch_preprocess(self):
+        with ScopedTiming("set batch preprocess config",self.debug_mode > 0):
+            self.ai2d.affine(nn.interp_method.cv2_bilinear,0, 0, 127, 1,[1,0,0,0,1,0])
+            self.ai2d.build([1,3,self.rgb888p_size[1],self.rgb888p_size[0]],[1,3,self.model_input_size[1],self.model_input_size[0]])
+
+    # 一次ai2d调用抠出所有车牌，转成识别模型要求的[1,1,h,w]灰度图后逐个识别
+    def run_batch(self,input_np,matrix):
+        crops=self.ai2d.run_batch(input_np,matrix).to_numpy()
+        grays=aidemo.ocr_rec_gray(crops,len(matrix))
+        rec_res=[]
+        for gray in grays:
+            results=self.inference([nn.from_numpy(gray)])
+            rec_res.append(self.postprocess(results))
+        return rec_res
+
     # 自定义后处理，results是模型输出的array列表
     def postprocess(self,results):
         with ScopedTiming("postprocess",self.debug_mode > 0):
@@ -113,22 +129,17 @@ class LicenceRec:
         self.licence_det=LicenceDetectionApp(self.licence_det_kmodel,model_input_size=self.det_input_size,confidence_threshold=self.confidence_threshold,nms_threshold=self.nms_threshold,rgb888p_size=self.rgb888p_size,display_size=self.display_size,debug_mode=0)
         self.licence_rec=LicenceRecognitionApp(self.licence_rec_kmodel,model_input_size=self.rec_input_size,rgb888p_size=self.rgb888p_size)
         self.licence_det.config_preprocess()
+        self.licence_rec.config_batch_preprocess()
 
     # run函数
     def run(self,input_np):
         # 执行车牌检测
         det_boxes=self.licence_det.run(input_np)
-        # 将车牌部分抠出来
-        imgs_array_boxes = aidemo.ocr_rec_preprocess(input_np,[self.rgb888p_size[1],self.rgb888p_size[0]],det_boxes)
-        imgs_array = imgs_array_boxes[0]
-        boxes = imgs_array_boxes[1]
+        # 计算每个车牌的仿射矩阵，用ai2d一次抠出所有车牌并完成识别
+        matrix,boxes = aidemo.ocr_rec_affine(det_boxes,[self.rec_input_size[1],self.rec_input_size[0]])
         rec_res = []
-        for img_array in imgs_array:
-            # 对每一个检测到的车牌进行识别
-            self.licence_rec.config_preprocess(input_image_size=[img_array.shape[3],img_array.shape[2]])
-            licence_str=self.licence_rec.run(img_array)
-            rec_res.append(licence_str)
-            gc.collect()
+        if matrix:
+            rec_res=self.licence_rec.run_batch(input_np,matrix)
         return det_boxes,rec_res
 
     # 绘制车牌检测识别效果
@@ -188,6 +188,8 @@ if __name__ == "__main__":
     dict_path="/sdcard/examples/utils/pinyin.txt"
     # 汉字转拼音字典文件
     phase_path="/sdcard/examples/utils/small_pinyin.txt"
+    # 两个字典都可以换成 port/ai_demo/tts_zh/host 的 pinyin_dict_compile 编译的 .bin 文件，
+    # 启动时直接映射，不再逐行解析文本
     # 拼音转音素映射文件
     mapfile="/sdcard/examples/utils/phone_map.txt"
     # 输入中文语句
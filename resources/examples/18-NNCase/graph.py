@@ -0,0 +1,58 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import gc
+
+# We will explain how to chain ai2d, several kmodels and the built-in detection
+# post-process in one nncase_runtime.graph in this test script.
+# Intermediate tensors are allocated once when the graph is declared and passed
+# between the stages in C; run() only returns the outputs asked for.
+# Replace the kmodel paths with your own detection (3 float32 outputs) and
+# classification models.
+
+det_kpu = nn.kpu()
+det_kpu.load_kmodel("/sdcard/app/tests/kmodel/det_320.kmodel")
+cls_kpu = nn.kpu()
+cls_kpu.load_kmodel("/sdcard/app/tests/kmodel/cls_224.kmodel")
+
+frame_shape = [1,3,624,1024]
+
+# frame -> 320x320 detection input
+det_ai2d = nn.ai2d()
+det_ai2d.set_dtype(nn.ai2d_format.NCHW_FMT, nn.ai2d_format.NCHW_FMT, np.uint8, np.uint8)
+det_ai2d.set_resize_param(True, nn.interp_method.tf_bilinear, nn.interp_mode.half_pixel)
+det_builder = det_ai2d.build(frame_shape, [1,3,320,320])
+
+# each detected box -> 224x224 classification input
+crop_ai2d = nn.ai2d()
+crop_ai2d.set_dtype(nn.ai2d_format.NCHW_FMT, nn.ai2d_format.NCHW_FMT, np.uint8, np.uint8)
+crop_ai2d.set_crop_param(True, 0, 0, 224, 224)
+crop_ai2d.set_resize_param(True, nn.interp_method.tf_bilinear, nn.interp_mode.half_pixel)
+crop_builder = crop_ai2d.build(frame_shape, [1,3,224,224])
+
+g = nn.graph()
+g.input("frame")
+g.ai2d("det_in", det_builder, "frame")
+g.kpu(["p3", "p4", "p5"], det_kpu, ["det_in"])
+g.detect("boxes", ["p3", "p4", "p5"], "anchorfree", [320,320], [1024,624], [8,16,32], 80, 0.5, 0.45)
+# one classification run per box, "scores" is stacked along the first axis
+g.crop("rois", crop_builder, "frame", "boxes", max_boxes=8)
+g.kpu(["scores"], cls_kpu, ["rois"])
+
+frame = nn.from_numpy(np.zeros(frame_shape, dtype=np.uint8))
+for i in range(10):
+    boxes, scores = g.run({"frame": frame}, ["boxes", "scores"])
+    # scores refers to graph memory, the next run() overwrites it
+    for box, score in zip(boxes, scores):
+        print(box, np.argmax(score))
+
+# run() outputs keep the graph memory alive, drop them before release() so it is freed at once
+del boxes, scores
+g.release()
+del g
+del frame
+del det_builder
+del crop_builder
+del det_kpu
+del cls_kpu
+gc.collect()
+nn.shrink_memory_pool()
@@ -0,0 +1,40 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import image
+import gc
+
+# We will explain how to use `Image.to_tensor()` in this test script.
+# to_tensor() converts, letterboxes and normalizes an image in one pass and
+# writes the result straight into a runtime_tensor, without going through
+# ai2d or an intermediate ndarray. RGB888/RGBP888/YUV420 images are supported.
+
+# init kpu and load kmodel
+kpu = nn.kpu()
+kpu.load_kmodel("/sdcard/examples/18-NNCase/face_detection/face_detection_320.kmodel")
+
+# load a RGBP888 test image
+data_file = "/sdcard/examples/18-NNCase/face_detection/face_detection_ai2d_input.bin"
+data = np.fromfile(data_file, dtype=np.uint8)
+img = image.Image(1024, 624, image.RGBP888, alloc=image.ALLOC_REF, data=data)
+
+# the first call allocates the tensor, uint8 NCHW [1,3,320,320]
+kpu_input = img.to_tensor(np.uint8, letterbox=(320, 320), pad_value=(104, 117, 123))
+kpu.set_input_tensor(0, kpu_input)
+
+for frame in range(3):
+    # later frames are written into the same tensor
+    img.to_tensor(np.uint8, letterbox=(320, 320), pad_value=(104, 117, 123), out=kpu_input)
+    kpu.run()
+    for i in range(kpu.outputs_size()):
+        result = kpu.get_output_tensor(i).to_numpy()
+        print("result: ", i, result.flatten()[-5:])
+
+# float models: normalize with mean/std, e.g. NHWC float32 in [0, 1]
+float_input = img.to_tensor(np.float, layout="NHWC", std=255, letterbox=(320, 320))
+print(float_input.to_numpy().shape)
+
+del float_input
+del kpu_input
+del kpu
+gc.collect()
+nn.shrink_memory_pool()
@@ -0,0 +1,45 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import gc
+
+# We will explain how to use `run_async()`/`wait()` in this test script,
+# so that post-processing of frame N overlaps KPU inference of frame N+1.
+# Outputs are double-buffered: the arrays returned for frame N stay valid
+# while frame N+1 is running, and are overwritten by frame N+2.
+# run_async() copies the inputs before it returns, so the input tensor can be
+# refilled for the next frame (e.g. by ai2d) while the KPU is busy.
+
+# init kpu and load kmodel
+kpu = nn.kpu()
+kpu.load_kmodel("/sdcard/examples/18-NNCase/face_detection/face_detection_320.kmodel")
+
+with open('/sdcard/examples/18-NNCase/face_detection/face_detection_ai2d_output.bin', 'rb') as f:
+    data = f.read()
+
+input_data = np.frombuffer(data, dtype=np.uint8)
+input_data = input_data.reshape((1,3,320,320))
+input_tensor = nn.from_numpy(input_data)
+
+def postprocess(results):
+    for i in range(len(results)):
+        print("result: ", i, results[i].flatten()[-5:])
+
+# start the first frame
+kpu.set_input_tensor(0, input_tensor)
+kpu.run_async()
+
+for frame in range(5):
+    # wait for frame N, raises RuntimeError if inference failed
+    kpu.wait()
+    results = [kpu.get_output_tensor(i).to_numpy() for i in range(kpu.outputs_size())]
+
+    # start frame N+1, then post-process frame N while the KPU is busy
+    kpu.set_input_tensor(0, input_tensor)
+    kpu.run_async()
+    postprocess(results)
+    print("frame", frame, "kpu done:", kpu.done())
+
+kpu.wait()
+del kpu
+gc.collect()
+nn.shrink_memory_pool()
@@ -0,0 +1,48 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import os
+import gc
+
+# We will explain how to record kmodel outputs on the board in this test script.
+# The recording is replayed by the host nncase backend (port/kpu/host), which
+# lets the ai2d/graph/post-process code run on a PC without the KPU:
+# copy <kmodel>.replay next to the kmodel path used on the PC.
+
+kmodel = "/sdcard/examples/18-NNCase/face_detection/face_detection_320.kmodel"
+replay_dir = kmodel + ".replay"
+
+kpu = nn.kpu()
+kpu.load_kmodel(kmodel)
+
+data = np.fromfile("/sdcard/examples/18-NNCase/face_detection/face_detection_ai2d_output.bin", dtype=np.uint8)
+input_tensor = nn.from_numpy(data.reshape((1,3,320,320)))
+kpu.set_input_tensor(0, input_tensor)
+
+try:
+    os.mkdir(replay_dir)
+except OSError:
+    pass
+
+def describe(kind, array):
+    # dtype as the ulab typecode character, e.g. B or f
+    return "%s %s %s\n" % (kind, chr(array.dtype), ",".join([str(d) for d in array.shape]))
+
+frames = 5
+with open(replay_dir + "/manifest", "w") as manifest:
+    for i in range(kpu.inputs_size()):
+        manifest.write(describe("input", kpu.get_input_tensor(i).to_numpy()))
+    for i in range(kpu.outputs_size()):
+        manifest.write(describe("output", kpu.get_output_tensor(i).to_numpy()))
+    manifest.write("frames %d\n" % frames)
+
+# one raw file per output and frame: output<i>_<frame>.bin
+for k in range(frames):
+    kpu.run()
+    for i in range(kpu.outputs_size()):
+        with open("%s/output%d_%d.bin" % (replay_dir, i, k), "wb") as f:
+            f.write(kpu.get_output_tensor(i).to_numpy().tobytes())
+
+del input_tensor
+del kpu
+gc.collect()
+nn.shrink_memory_pool()
@@ -0,0 +1,35 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import gc
+
+# We will explain how to use the built-in profiler in this test script.
+# The profiler times ai2d, KPU, tensor map/sync/to_numpy and the aicube/aidemo
+# post-process functions in C, without the interpreter overhead of time.ticks_us().
+# When it is stopped, the cost is a single flag check per instrumented call.
+
+kpu = nn.kpu()
+kpu.load_kmodel("/sdcard/examples/18-NNCase/face_detection/face_detection_320.kmodel")
+
+data = np.fromfile("/sdcard/examples/18-NNCase/face_detection/face_detection_ai2d_output.bin", dtype=np.uint8)
+input_tensor = nn.from_numpy(data.reshape((1,3,320,320)))
+
+# start(reset=True) drops everything recorded before
+nn.profiler_start()
+for i in range(50):
+    kpu.set_input_tensor(0, input_tensor)
+    kpu.run()
+    results = [kpu.get_output_tensor(j).to_numpy() for j in range(kpu.outputs_size())]
+nn.profiler_stop()
+
+# per stage min/avg/p99/max in microseconds and bytes allocated inside the stage
+stats = nn.profiler_dump()
+for name in stats:
+    s = stats[name]
+    print("%-24s n=%4d min=%8.1f avg=%8.1f p99=%8.1f max=%8.1f bytes=%d" %
+          (name, s["count"], s["min_us"], s["avg_us"], s["p99_us"], s["max_us"], s["bytes"]))
+print(nn.profiler_info())
+
+del input_tensor
+del kpu
+gc.collect()
+nn.shrink_memory_pool()
@@ -0,0 +1,33 @@
+import nncase_runtime as nn
+import ulab.numpy as np
+import gc
+
+# We will explain how to size the nncase tensor pool up front in this test script.
+# from_numpy and the tensors of nn.graph come from a pool keyed by
+# dtype and shape; a released tensor goes back to the pool and the next tensor with
+# the same dtype and shape reuses it without allocating. release() returns a tensor
+# right away, otherwise it goes back when the garbage collector frees it.
+# A tensor with to_numpy() views goes back only after the views are gone, use
+# to_numpy(copy=True) when the result is kept and the tensor should be reused at once.
+# Tensors bound to a kpu are only reused after the kpu binds another tensor.
+
+shape = [1,3,320,320]
+
+# allocate two input tensors before the loop, so the first frames do not allocate either
+nn.tensor_pool_reserve(shape, np.uint8, 2)
+# keep at most 4MB of unreserved free tensors
+nn.tensor_pool_config(4 * 1024 * 1024)
+
+data = np.zeros(shape, dtype=np.uint8)
+for i in range(100):
+    tensor = nn.from_numpy(data)
+    # ... kpu.set_input_tensor(0, tensor); kpu.run()
+    tensor.release()
+
+# allocs stays at the reserved count, every other from_numpy was a reuse
+print(nn.tensor_pool_info())
+
+del data
+gc.collect()
+# releases the free tensors of the pool, then the nncase memory pool
+nn.shrink_memory_pool()
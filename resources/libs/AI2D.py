@@ -14,6 +14,11 @@ class Ai2d:
         self.ai2d_input_tensor=None
         # ai2d输出tensor对象
         self.ai2d_output_tensor=None
+        # ai2d输出tensor的shape
+        self.ai2d_output_shape=None
+        # run_batch的输出tensor对象及其可容纳的ROI个数
+        self.ai2d_batch_tensor=None
+        self.ai2d_batch_size=0
         self.debug_mode=debug_mode
 
     # 设置ai2d计算过程中的输入输出数据类型，输入输出数据格式
@@ -66,10 +71,37 @@ class Ai2d:
         with ScopedTiming("ai2d build",self.debug_mode > 0):
             # ai2d构造函数
             self.ai2d_builder = self.ai2d.build(ai2d_input_shape, ai2d_output_shape)
+            self.ai2d_output_shape=ai2d_output_shape
+            self.ai2d_batch_tensor=None
+            self.ai2d_batch_size=0
             # 定义ai2d输出数据(即kmodel的输入数据，所以数据分辨率和模型的input_size一致)，并转换成tensor
             output_data = np.ones((ai2d_output_shape[0],ai2d_output_shape[1],ai2d_output_shape[2],ai2d_output_shape[3]),dtype=np.uint8)
             self.ai2d_output_tensor = nn.from_numpy(output_data)
 
+    # build之后只更换crop区域，例如逐个人脸crop，相同参数的schedule会从缓存中复用
+    def update_crop(self,start_x,start_y,width,height):
+        with ScopedTiming("ai2d update crop",self.debug_mode > 0):
+            self.ai2d_builder.update_crop(start_x,start_y,width,height)
+
+    # build之后只更换仿射矩阵M，其他affine参数保持不变
+    def update_affine(self,M):
+        with ScopedTiming("ai2d update affine",self.debug_mode > 0):
+            self.ai2d_builder.update_affine(M)
+
+    # 使用build好的配置批量处理多个ROI，每个ROI只替换crop区域或仿射矩阵
+    # rois中每一项为[x,y,w,h]或仿射矩阵M(6个值)，返回shape为[N,C,H,W]的tensor，N>=len(rois)，第i个ROI的结果在第i个切片
+    def run_batch(self,input_np,rois):
+        with ScopedTiming("ai2d run batch",self.debug_mode > 0):
+            n=len(rois)
+            if n>self.ai2d_batch_size:
+                shape=self.ai2d_output_shape
+                output_data = np.ones((n,shape[1],shape[2],shape[3]),dtype=np.uint8)
+                self.ai2d_batch_tensor = nn.from_numpy(output_data)
+                self.ai2d_batch_size=n
+            self.ai2d_input_tensor = nn.from_numpy(input_np)
+            self.ai2d_builder.run_batch(self.ai2d_input_tensor, self.ai2d_batch_tensor, rois)
+            return self.ai2d_batch_tensor
+
     # 使用ai2d完成预处理
     def run(self,input_np):
         with ScopedTiming("ai2d run",self.debug_mode > 0):